@@ -0,0 +1 @@
+/root/repo/inc/cleaning/alru.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/inc/ocf_cache.h
\ No newline at end of file
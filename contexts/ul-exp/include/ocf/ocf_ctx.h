@@ -0,0 +1 @@
+/root/repo/inc/ocf_ctx.h
\ No newline at end of file
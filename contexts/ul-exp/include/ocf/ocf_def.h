@@ -0,0 +1 @@
+/root/repo/inc/ocf_def.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/inc/ocf_err.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/inc/ocf_logger.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/inc/ocf_queue.h
\ No newline at end of file
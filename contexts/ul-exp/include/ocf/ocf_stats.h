@@ -0,0 +1 @@
+/root/repo/inc/ocf_stats.h
\ No newline at end of file
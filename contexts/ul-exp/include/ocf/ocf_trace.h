@@ -0,0 +1 @@
+/root/repo/inc/ocf_trace.h
\ No newline at end of file
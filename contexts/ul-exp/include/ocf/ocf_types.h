@@ -0,0 +1 @@
+/root/repo/inc/ocf_types.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/inc/ocf_volume.h
\ No newline at end of file
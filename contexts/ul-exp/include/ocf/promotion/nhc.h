@@ -0,0 +1 @@
+/root/repo/inc/promotion/nhc.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/inc/promotion/tinylfu.h
\ No newline at end of file
@@ -188,6 +188,15 @@ cache_obj_setup(ocf_ctx_t ctx, ocf_cache_t *cache,
     else
         return -1;
 
+    /**
+     * Multi-factor modes gate backfills through the NHC promotion
+     * policy, so that probing does not flood the cache device.
+     */
+    if (cache_mode == BENCH_CACHE_MODE_MFWA
+        || cache_mode == BENCH_CACHE_MODE_MFWB
+        || cache_mode == BENCH_CACHE_MODE_MFWT)
+        cache_cfg.promotion_policy = ocf_promotion_nhc;
+
     /**
      * Set cache device configuration to default, and assign volume type
      * as CACHE_VOL_TYPE.
@@ -253,6 +262,15 @@ cache_obj_setup(ocf_ctx_t ctx, ocf_cache_t *cache,
         return ret;
     }
 
+    /** Cache write budget of NHC promotions, 0 means unlimited. */
+    if (cache_cfg.promotion_policy == ocf_promotion_nhc) {
+        ret = ocf_mngt_cache_promotion_set_param(*cache, ocf_promotion_nhc,
+                                                 ocf_nhc_write_budget,
+                                                 NHC_WRITE_BUDGET_MIBS);
+        if (ret)
+            return ret;
+    }
+
     /** Setup device log. */
     cache_log = malloc(sizeof(struct cache_log_entry) * CACHE_LOG_SIZE);
 
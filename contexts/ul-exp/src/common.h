@@ -36,6 +36,11 @@ extern const bool CTX_PRINT_DEBUG_MSG;
 extern const bool DEVICE_LOG_ENABLE;
 extern const bool MONITOR_LOG_ENABLE;
 
+extern const bool TRACE_RING_ENABLE;
+extern const uint32_t TRACE_RING_ENTRIES;
+
+extern const uint32_t NHC_WRITE_BUDGET_MIBS;
+
 #define __FILEBASE__ (strrchr(__FILE__, '/') ? strrchr(__FILE__, '/') + 1 \
                                              : __FILE__)
 
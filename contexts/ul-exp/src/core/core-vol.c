@@ -33,6 +33,7 @@ struct req_entry {
     struct list_head head;
     struct ocf_io *io;
     double start_time_ms;
+    uint64_t start_time_ns;     /** For trace ring, monotonic. */
 };
 
 static struct req_entry submit_queue;
@@ -190,6 +191,7 @@ _submit_thread_func(void *args)
     struct req_entry *entry;
     struct ocf_io *io;
     double start_time_ms;
+    uint64_t start_time_ns;
 
     DEBUG("SUBMIT: core submission thread launched");
 
@@ -215,6 +217,7 @@ _submit_thread_func(void *args)
         entry = list_first_entry(&submit_queue.head, struct req_entry, head);
         io = entry->io;
         start_time_ms = entry->start_time_ms;
+        start_time_ns = entry->start_time_ns;
 
         list_del(&entry->head);
         free(entry);
@@ -236,6 +239,7 @@ _submit_thread_func(void *args)
             break;
         }
 
+        ocf_trace_ring_dev_io(io, OCF_TRACE_DEV_CORE, start_time_ns);
         io->end(io, 0);
     }
 
@@ -370,6 +374,7 @@ core_vol_submit_io(struct ocf_io *io)
 
     entry->io = io;
     entry->start_time_ms = get_cur_time_ms();
+    entry->start_time_ns = env_get_time_ns();
 
     env_mutex_lock(&submit_queue_lock);
 
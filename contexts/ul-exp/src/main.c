@@ -23,6 +23,13 @@ const bool OCF_LOGGER_INFO_MSG = false;
 const bool DEVICE_LOG_ENABLE  = false;
 const bool MONITOR_LOG_ENABLE = false;
 
+/** Built-in OCF trace ring, dumped into `logs/trace-ring.bin`. */
+const bool TRACE_RING_ENABLE = false;
+const uint32_t TRACE_RING_ENTRIES = 1 << 16;
+
+/** Cache write bandwidth for MF mode promotions in MiB/s, 0 = unlimited. */
+const uint32_t NHC_WRITE_BUDGET_MIBS = 0;
+
 
 /** Global parameters. */
 const char *cache_sock_name = "cache-sock";
@@ -44,6 +51,7 @@ FILE *fmonitor = NULL;
 #include "core/core-vol.h"
 #include "core/core-obj.h"
 #include "fuzzy/fuzzy-test.h"
+#include "trace/trace-dump.h"
 #include "common.h"
 
 
@@ -115,6 +123,7 @@ _print_statistics(struct ocf_stats_usage *stats_usage,
            "         |     total           %8lu pages    %3lu.%02lu %%\n"
            "\n"
            "    reqs |  read |     hit $   %8lu reqs     %3lu.%02lu %%\n"
+           "         |       | offload/$   %8lu reqs     %3lu.%02lu %%\n"
            "         |       | part miss   %8lu reqs     %3lu.%02lu %%\n"
            "         |       | full miss   %8lu reqs     %3lu.%02lu %%\n"
            "         |       |     total   %8lu reqs     %3lu.%02lu %%\n"
@@ -167,6 +176,9 @@ _print_statistics(struct ocf_stats_usage *stats_usage,
            stats_reqs->rd_hits.value,
            stats_reqs->rd_hits.fraction / 100,
            stats_reqs->rd_hits.fraction % 100,
+           stats_reqs->rd_offloadable_hits.value,
+           stats_reqs->rd_offloadable_hits.fraction / 100,
+           stats_reqs->rd_offloadable_hits.fraction % 100,
            stats_reqs->rd_partial_misses.value,
            stats_reqs->rd_partial_misses.fraction / 100,
            stats_reqs->rd_partial_misses.fraction % 100,
@@ -467,6 +479,14 @@ main(int argc, char *argv[])
             error("Unable to start monitor thread", ret);
     }
 
+    /** Start tracing, if enabled. */
+    if (TRACE_RING_ENABLE) {
+        ret = trace_dump_start(cache, "logs/trace-ring.bin",
+                               TRACE_RING_ENTRIES);
+        if (ret)
+            error("Unable to start trace ring dumper", ret);
+    }
+
     /** 6. Perform workload. */
     if (fuzzy_testing)
         ret = perform_workload_fuzzy(core, 30000);
@@ -487,6 +507,10 @@ main(int argc, char *argv[])
         || cache_mode == BENCH_CACHE_MODE_MFWT)
         ocf_mngt_mf_monitor_stop();
 
+    /** Stop tracing and flush remaining records. */
+    if (TRACE_RING_ENABLE)
+        trace_dump_stop();
+
     /** 9. Force device volume submission threads to stop. */
     cache_vol_force_stop();
     core_vol_force_stop();
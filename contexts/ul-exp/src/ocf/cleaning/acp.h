@@ -0,0 +1 @@
+/root/repo/src/cleaning/acp.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/cleaning/alru.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/cleaning/alru.h
\ No newline at end of file
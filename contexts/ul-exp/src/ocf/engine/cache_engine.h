@@ -0,0 +1 @@
+/root/repo/src/engine/cache_engine.h
\ No newline at end of file
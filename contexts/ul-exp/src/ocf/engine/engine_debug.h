@@ -0,0 +1 @@
+/root/repo/src/engine/engine_debug.h
\ No newline at end of file
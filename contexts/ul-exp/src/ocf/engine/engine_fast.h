@@ -0,0 +1 @@
+/root/repo/src/engine/engine_fast.h
\ No newline at end of file
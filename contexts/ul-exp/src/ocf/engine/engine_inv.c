@@ -0,0 +1 @@
+/root/repo/src/engine/engine_inv.c
\ No newline at end of file
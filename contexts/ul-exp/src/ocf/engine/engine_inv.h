@@ -0,0 +1 @@
+/root/repo/src/engine/engine_inv.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/engine/engine_mfwb.c
\ No newline at end of file
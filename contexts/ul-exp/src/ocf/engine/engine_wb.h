@@ -0,0 +1 @@
+/root/repo/src/engine/engine_wb.h
\ No newline at end of file
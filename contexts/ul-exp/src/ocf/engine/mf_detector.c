@@ -0,0 +1 @@
+/root/repo/src/engine/mf_detector.c
\ No newline at end of file
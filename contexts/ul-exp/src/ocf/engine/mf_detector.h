@@ -0,0 +1 @@
+/root/repo/src/engine/mf_detector.h
\ No newline at end of file
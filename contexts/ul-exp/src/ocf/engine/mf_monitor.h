@@ -0,0 +1 @@
+/root/repo/src/engine/mf_monitor.h
\ No newline at end of file
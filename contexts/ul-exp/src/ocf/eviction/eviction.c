@@ -0,0 +1 @@
+/root/repo/src/eviction/eviction.c
\ No newline at end of file
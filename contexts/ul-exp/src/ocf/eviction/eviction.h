@@ -0,0 +1 @@
+/root/repo/src/eviction/eviction.h
\ No newline at end of file
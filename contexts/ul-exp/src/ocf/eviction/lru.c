@@ -0,0 +1 @@
+/root/repo/src/eviction/lru.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/eviction/lru.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/eviction/lru_structs.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/eviction/ops.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/eviction/s3fifo.c
\ No newline at end of file
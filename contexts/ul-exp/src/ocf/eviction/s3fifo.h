@@ -0,0 +1 @@
+/root/repo/src/eviction/s3fifo.h
\ No newline at end of file
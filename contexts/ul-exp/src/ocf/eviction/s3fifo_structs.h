@@ -0,0 +1 @@
+/root/repo/src/eviction/s3fifo_structs.h
\ No newline at end of file
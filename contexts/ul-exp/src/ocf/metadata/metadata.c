@@ -0,0 +1 @@
+/root/repo/src/metadata/metadata.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/metadata/metadata.h
\ No newline at end of file
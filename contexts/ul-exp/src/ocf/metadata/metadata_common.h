@@ -0,0 +1 @@
+/root/repo/src/metadata/metadata_common.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/metadata/metadata_eviction_policy.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/metadata/metadata_hash.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/metadata/metadata_lookup.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/metadata/metadata_partition.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/metadata/metadata_updater.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/metadata/metadata_updater_priv.h
\ No newline at end of file
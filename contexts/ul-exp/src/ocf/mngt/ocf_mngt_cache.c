@@ -0,0 +1 @@
+/root/repo/src/mngt/ocf_mngt_cache.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/mngt/ocf_mngt_common.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/mngt/ocf_mngt_core.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/ocf_cache.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/ocf_cache_priv.h
\ No newline at end of file
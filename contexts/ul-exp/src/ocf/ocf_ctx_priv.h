@@ -0,0 +1 @@
+/root/repo/src/ocf_ctx_priv.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/ocf_freelist.c
\ No newline at end of file
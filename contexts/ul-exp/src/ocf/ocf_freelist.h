@@ -0,0 +1 @@
+/root/repo/src/ocf_freelist.h
\ No newline at end of file
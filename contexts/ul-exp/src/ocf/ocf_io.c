@@ -0,0 +1 @@
+/root/repo/src/ocf_io.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/ocf_io_class.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/ocf_logger.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/ocf_logger_priv.h
\ No newline at end of file
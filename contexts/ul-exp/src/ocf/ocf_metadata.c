@@ -0,0 +1 @@
+/root/repo/src/ocf_metadata.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/ocf_mrc.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/ocf_mrc.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/ocf_request.c
\ No newline at end of file
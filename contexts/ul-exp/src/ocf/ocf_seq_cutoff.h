@@ -0,0 +1 @@
+/root/repo/src/ocf_seq_cutoff.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/ocf_stats.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/ocf_stats_builder.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/ocf_trace.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/ocf_trace_ring.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/promotion/nhc/nhc.c
\ No newline at end of file
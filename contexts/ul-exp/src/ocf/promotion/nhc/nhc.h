@@ -0,0 +1 @@
+/root/repo/src/promotion/nhc/nhc.h
\ No newline at end of file
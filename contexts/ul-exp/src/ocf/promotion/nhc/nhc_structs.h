@@ -0,0 +1 @@
+/root/repo/src/promotion/nhc/nhc_structs.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/promotion/nhit/nhit.h
\ No newline at end of file
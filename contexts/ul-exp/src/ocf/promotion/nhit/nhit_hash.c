@@ -0,0 +1 @@
+/root/repo/src/promotion/nhit/nhit_hash.c
\ No newline at end of file
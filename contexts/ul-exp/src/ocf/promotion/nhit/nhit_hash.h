@@ -0,0 +1 @@
+/root/repo/src/promotion/nhit/nhit_hash.h
\ No newline at end of file
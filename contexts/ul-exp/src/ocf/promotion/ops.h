@@ -0,0 +1 @@
+/root/repo/src/promotion/ops.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/promotion/promotion.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/promotion/promotion.h
\ No newline at end of file
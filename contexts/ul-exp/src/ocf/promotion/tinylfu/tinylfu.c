@@ -0,0 +1 @@
+/root/repo/src/promotion/tinylfu/tinylfu.c
\ No newline at end of file
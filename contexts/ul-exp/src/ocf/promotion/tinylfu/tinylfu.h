@@ -0,0 +1 @@
+/root/repo/src/promotion/tinylfu/tinylfu.h
\ No newline at end of file
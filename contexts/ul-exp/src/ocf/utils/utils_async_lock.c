@@ -0,0 +1 @@
+/root/repo/src/utils/utils_async_lock.c
\ No newline at end of file
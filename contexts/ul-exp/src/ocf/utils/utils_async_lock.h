@@ -0,0 +1 @@
+/root/repo/src/utils/utils_async_lock.h
\ No newline at end of file
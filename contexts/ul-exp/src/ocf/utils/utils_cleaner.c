@@ -0,0 +1 @@
+/root/repo/src/utils/utils_cleaner.c
\ No newline at end of file
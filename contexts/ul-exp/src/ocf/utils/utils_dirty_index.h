@@ -0,0 +1 @@
+/root/repo/src/utils/utils_dirty_index.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/utils/utils_freq_sketch.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/utils/utils_freq_sketch.h
\ No newline at end of file
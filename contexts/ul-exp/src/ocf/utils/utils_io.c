@@ -0,0 +1 @@
+/root/repo/src/utils/utils_io.c
\ No newline at end of file
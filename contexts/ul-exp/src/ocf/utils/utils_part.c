@@ -0,0 +1 @@
+/root/repo/src/utils/utils_part.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/utils/utils_pipeline.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/utils/utils_rbtree.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/utils/utils_realloc.c
\ No newline at end of file
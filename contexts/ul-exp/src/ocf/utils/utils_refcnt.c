@@ -0,0 +1 @@
+/root/repo/src/utils/utils_refcnt.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/utils/utils_refcnt.h
\ No newline at end of file
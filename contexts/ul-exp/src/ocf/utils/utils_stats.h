@@ -0,0 +1 @@
+/root/repo/src/utils/utils_stats.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/src/utils/utils_token_bucket.h
\ No newline at end of file
@@ -0,0 +1,126 @@
+/**
+ * Background dumper of OCF built-in trace ring into a binary file.
+ */
+
+
+#include <ocf/ocf.h>
+#include "ocf_env.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "common.h"
+#include "trace-dump.h"
+
+
+/** Records drained at once. */
+#define TRACE_DUMP_BATCH 4096
+
+/** Sleep between drains when rings are empty. */
+#define TRACE_DUMP_IDLE_US 10000
+
+
+static ocf_cache_t dump_cache = NULL;
+static FILE *dump_file = NULL;
+static pthread_t dump_thread;
+static env_atomic dump_should_stop;
+static struct ocf_trace_rec *dump_buf = NULL;
+
+
+/**
+ * Drain all rings once, returns number of records written.
+ */
+static uint32_t
+_trace_dump_drain(void)
+{
+    uint32_t count;
+
+    count = ocf_trace_ring_drain(dump_cache, dump_buf, TRACE_DUMP_BATCH);
+    if (count)
+        fwrite(dump_buf, sizeof(*dump_buf), count, dump_file);
+
+    return count;
+}
+
+static void *
+_trace_dump_func(void *args)
+{
+    while (!env_atomic_read(&dump_should_stop)) {
+        if (!_trace_dump_drain())
+            usleep(TRACE_DUMP_IDLE_US);
+    }
+
+    /** Flush whatever was recorded before stop. */
+    while (_trace_dump_drain())
+        ;
+
+    return NULL;
+}
+
+
+/**
+ * Start trace ring of given cache and dump it into `path` until
+ * `trace_dump_stop()` is called.
+ */
+int
+trace_dump_start(ocf_cache_t cache, const char *path, uint32_t ring_entries)
+{
+    struct trace_dump_hdr hdr = {
+        .magic = TRACE_DUMP_MAGIC,
+        .version = TRACE_DUMP_VERSION,
+        .rec_size = sizeof(struct ocf_trace_rec),
+    };
+    int ret;
+
+    dump_buf = malloc(sizeof(*dump_buf) * TRACE_DUMP_BATCH);
+    if (dump_buf == NULL)
+        return -ENOMEM;
+
+    dump_file = fopen(path, "wb");
+    if (dump_file == NULL) {
+        free(dump_buf);
+        return -errno;
+    }
+
+    fwrite(&hdr, sizeof(hdr), 1, dump_file);
+
+    ret = ocf_mngt_start_trace_ring(cache, ring_entries);
+    if (ret)
+        goto err;
+
+    dump_cache = cache;
+    env_atomic_set(&dump_should_stop, 0);
+
+    ret = pthread_create(&dump_thread, NULL, _trace_dump_func, NULL);
+    if (ret) {
+        ocf_mngt_stop_trace_ring(cache);
+        goto err;
+    }
+
+    return 0;
+
+err:
+    fclose(dump_file);
+    free(dump_buf);
+    return ret;
+}
+
+/**
+ * Stop tracing, write remaining records and close the file.
+ */
+void
+trace_dump_stop(void)
+{
+    if (dump_file == NULL)
+        return;
+
+    ocf_mngt_stop_trace_ring(dump_cache);
+
+    env_atomic_set(&dump_should_stop, 1);
+    pthread_join(dump_thread, NULL);
+
+    fclose(dump_file);
+    free(dump_buf);
+    dump_file = NULL;
+}
@@ -0,0 +1,39 @@
+/**
+ * Background dumper of OCF built-in trace ring into a binary file.
+ *
+ * File layout: one `struct trace_dump_hdr`, followed by raw
+ * `struct ocf_trace_rec` records in drain order. Use `trace-decode`
+ * to print it in human readable form.
+ */
+
+
+#ifndef __TRACE_DUMP_H__
+#define __TRACE_DUMP_H__
+
+
+#include <stdint.h>
+#include <ocf/ocf.h>
+
+
+#define TRACE_DUMP_MAGIC   0x474e495246434f00ULL  /** "\0OCFRING". */
+#define TRACE_DUMP_VERSION 3
+
+
+/**
+ * Trace file header. Record size is stored to let the decoder reject
+ * files written with different record layout.
+ */
+struct __attribute__((__packed__)) trace_dump_hdr {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t rec_size;
+};
+
+
+int trace_dump_start(ocf_cache_t cache, const char *path,
+                     uint32_t ring_entries);
+
+void trace_dump_stop(void);
+
+
+#endif
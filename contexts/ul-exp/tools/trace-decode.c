@@ -0,0 +1,286 @@
+/**
+ * Offline decoder of trace files written by `trace_dump`.
+ *
+ * Usage: trace-decode [-c] <trace-file>
+ *
+ * By default prints one line per record: time relative to the first
+ * record in us, queue id, request sequence id, record type and its
+ * arguments.
+ *
+ * With `-c` emits Chrome trace-event JSON instead, loadable by
+ * chrome://tracing and ui.perfetto.dev. Requests and their paths become
+ * nested async slices keyed by sequence id, device IOs become async
+ * slices on per-device tracks and multi-factor switches counter tracks.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include <ocf/ocf.h>
+
+#include "trace/trace-dump.h"
+
+
+static const char *path_names[] = {
+    [ocf_lat_cache_read]        = "cache_read",
+    [ocf_lat_core_read_offload] = "core_read_offload",
+    [ocf_lat_core_read_miss]    = "core_read_miss",
+    [ocf_lat_backfill]          = "backfill",
+    [ocf_lat_wb_write]          = "wb_write",
+    [ocf_lat_lock_wait]         = "lock_wait",
+};
+
+static const char *
+_path_name(uint8_t path)
+{
+    if (path >= ocf_lat_path_max)
+        return "unknown";
+
+    return path_names[path];
+}
+
+static const char *dev_names[] = {
+    [OCF_TRACE_DEV_CACHE] = "cache_dev",
+    [OCF_TRACE_DEV_CORE]  = "core_dev",
+};
+
+static const char *counter_names[] = {
+    [ocf_trace_counter_load_admit] = "load_admit",
+    [ocf_trace_counter_data_admit] = "data_admit",
+};
+
+static const char *
+_counter_name(uint8_t counter)
+{
+    if (counter > ocf_trace_counter_data_admit)
+        return "unknown";
+
+    return counter_names[counter];
+}
+
+static void
+_print_rec(const struct ocf_trace_rec *rec, uint64_t base_ns)
+{
+    printf("%14.3lf q%-3u sid %-10lu ",
+           (double) (rec->timestamp - base_ns) / 1000.0,
+           rec->queue_id, rec->sid);
+
+    switch (rec->type) {
+    case ocf_trace_rec_submit:
+        printf("submit   %c addr %lu len %u\n", rec->arg,
+               rec->value, rec->len);
+        break;
+    case ocf_trace_rec_path_start:
+        printf("start    %s addr %lu len %u\n", _path_name(rec->arg),
+               rec->value, rec->len);
+        break;
+    case ocf_trace_rec_path_end:
+        printf("end      %s took %.3lf us\n", _path_name(rec->arg),
+               (double) rec->value / 1000.0);
+        break;
+    case ocf_trace_rec_complete:
+        printf("complete %s addr %lu len %u\n", rec->arg ? "hit" : "miss",
+               rec->value, rec->len);
+        break;
+    case ocf_trace_rec_engine:
+        printf("engine   %s addr %lu len %u\n", rec->arg ? "W" : "R",
+               rec->value, rec->len);
+        break;
+    case ocf_trace_rec_dev_io:
+        printf("dev_io   %s %s addr %lu len %u took %.3lf us\n",
+               dev_names[rec->arg & 1], (rec->arg >> 1) ? "W" : "R",
+               rec->sid, rec->len, (double) rec->value / 1000.0);
+        break;
+    case ocf_trace_rec_counter:
+        printf("counter  %s = %lu\n", _counter_name(rec->arg), rec->value);
+        break;
+    case ocf_trace_rec_lost:
+        printf("lost     %lu records\n", rec->value);
+        break;
+    default:
+        printf("unknown record type %u\n", rec->type);
+        break;
+    }
+}
+
+
+/**
+ * Chrome trace-event JSON output. All events belong to a single process,
+ * queues and devices are separate threads (tracks).
+ */
+#define CHROME_TID_DEV_BASE 1000
+
+static bool chrome_first_event = true;
+static uint64_t chrome_dev_io_id = 0;
+
+static void
+_chrome_event(const char *fmt, ...)
+{
+    va_list args;
+
+    printf(chrome_first_event ? "\n  " : ",\n  ");
+    chrome_first_event = false;
+
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+}
+
+static void
+_chrome_rec(const struct ocf_trace_rec *rec, uint64_t base_ns)
+{
+    double ts = (double) (rec->timestamp - base_ns) / 1000.0;
+    double start;
+    uint8_t dev;
+
+    switch (rec->type) {
+    case ocf_trace_rec_submit:
+        _chrome_event("{\"name\": \"io %c\", \"cat\": \"req\", "
+                      "\"ph\": \"b\", \"id\": %lu, \"pid\": 0, "
+                      "\"tid\": %u, \"ts\": %.3lf, \"args\": "
+                      "{\"addr\": %lu, \"len\": %u}}",
+                      rec->arg, rec->sid, rec->queue_id, ts,
+                      rec->value, rec->len);
+        break;
+    case ocf_trace_rec_complete:
+        _chrome_event("{\"name\": \"io\", \"cat\": \"req\", "
+                      "\"ph\": \"e\", \"id\": %lu, \"pid\": 0, "
+                      "\"tid\": %u, \"ts\": %.3lf, \"args\": "
+                      "{\"hit\": %u}}",
+                      rec->sid, rec->queue_id, ts, rec->arg);
+        break;
+    case ocf_trace_rec_path_start:
+        _chrome_event("{\"name\": \"%s\", \"cat\": \"req\", "
+                      "\"ph\": \"b\", \"id\": %lu, \"pid\": 0, "
+                      "\"tid\": %u, \"ts\": %.3lf}",
+                      _path_name(rec->arg), rec->sid, rec->queue_id, ts);
+        break;
+    case ocf_trace_rec_path_end:
+        _chrome_event("{\"name\": \"%s\", \"cat\": \"req\", "
+                      "\"ph\": \"e\", \"id\": %lu, \"pid\": 0, "
+                      "\"tid\": %u, \"ts\": %.3lf}",
+                      _path_name(rec->arg), rec->sid, rec->queue_id, ts);
+        break;
+    case ocf_trace_rec_engine:
+        _chrome_event("{\"name\": \"engine\", \"cat\": \"req\", "
+                      "\"ph\": \"n\", \"id\": %lu, \"pid\": 0, "
+                      "\"tid\": %u, \"ts\": %.3lf}",
+                      rec->sid, rec->queue_id, ts);
+        break;
+    case ocf_trace_rec_dev_io:
+        dev = rec->arg & 1;
+        start = ts - (double) rec->value / 1000.0;
+        chrome_dev_io_id++;
+        _chrome_event("{\"name\": \"%s %s\", \"cat\": \"dev\", "
+                      "\"ph\": \"b\", \"id\": \"d%lu\", \"pid\": 0, "
+                      "\"tid\": %u, \"ts\": %.3lf, \"args\": "
+                      "{\"addr\": %lu, \"len\": %u}}",
+                      dev_names[dev], (rec->arg >> 1) ? "W" : "R",
+                      chrome_dev_io_id, CHROME_TID_DEV_BASE + dev, start,
+                      rec->sid, rec->len);
+        _chrome_event("{\"name\": \"%s %s\", \"cat\": \"dev\", "
+                      "\"ph\": \"e\", \"id\": \"d%lu\", \"pid\": 0, "
+                      "\"tid\": %u, \"ts\": %.3lf}",
+                      dev_names[dev], (rec->arg >> 1) ? "W" : "R",
+                      chrome_dev_io_id, CHROME_TID_DEV_BASE + dev, ts);
+        break;
+    case ocf_trace_rec_counter:
+        _chrome_event("{\"name\": \"%s\", \"ph\": \"C\", "
+                      "\"pid\": 0, \"ts\": %.3lf, \"args\": "
+                      "{\"value\": %.6lf}}",
+                      _counter_name(rec->arg), ts,
+                      (double) rec->value / 1000000.0);
+        break;
+    case ocf_trace_rec_lost:
+        _chrome_event("{\"name\": \"lost %lu records\", \"ph\": \"i\", "
+                      "\"s\": \"g\", \"pid\": 0, \"tid\": %u, "
+                      "\"ts\": %.3lf}",
+                      rec->value, rec->queue_id, ts);
+        break;
+    default:
+        break;
+    }
+}
+
+static void
+_chrome_begin(void)
+{
+    printf("{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+
+    _chrome_event("{\"name\": \"thread_name\", \"ph\": \"M\", "
+                  "\"pid\": 0, \"tid\": %u, \"args\": "
+                  "{\"name\": \"cache device\"}}",
+                  CHROME_TID_DEV_BASE + OCF_TRACE_DEV_CACHE);
+    _chrome_event("{\"name\": \"thread_name\", \"ph\": \"M\", "
+                  "\"pid\": 0, \"tid\": %u, \"args\": "
+                  "{\"name\": \"core device\"}}",
+                  CHROME_TID_DEV_BASE + OCF_TRACE_DEV_CORE);
+}
+
+static void
+_chrome_end(void)
+{
+    printf("\n]}\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+    struct trace_dump_hdr hdr;
+    struct ocf_trace_rec rec;
+    uint64_t base_ns = 0;
+    bool first = true;
+    bool chrome = false;
+    const char *path;
+    FILE *f;
+
+    if (argc == 3 && ! strcmp(argv[1], "-c")) {
+        chrome = true;
+        path = argv[2];
+    } else if (argc == 2) {
+        path = argv[1];
+    } else {
+        fprintf(stderr, "Usage: %s [-c] <trace-file>\n", argv[0]);
+        return 1;
+    }
+
+    f = fopen(path, "rb");
+    if (f == NULL) {
+        perror("fopen");
+        return 1;
+    }
+
+    if (fread(&hdr, sizeof(hdr), 1, f) != 1
+        || hdr.magic != TRACE_DUMP_MAGIC
+        || hdr.version != TRACE_DUMP_VERSION
+        || hdr.rec_size != sizeof(rec)) {
+        fprintf(stderr, "%s: not a trace file or unsupported version\n",
+                path);
+        fclose(f);
+        return 1;
+    }
+
+    if (chrome)
+        _chrome_begin();
+
+    while (fread(&rec, sizeof(rec), 1, f) == 1) {
+        if (first) {
+            base_ns = rec.timestamp;
+            first = false;
+        }
+
+        if (chrome)
+            _chrome_rec(&rec, base_ns);
+        else
+            _print_rec(&rec, base_ns);
+    }
+
+    if (chrome)
+        _chrome_end();
+
+    fclose(f);
+    return 0;
+}
@@ -8,6 +8,54 @@
 #include <execinfo.h>
 
 /* ALLOCATOR */
+
+/*
+ * Slab allocator with per-thread magazines (after Bonwick & Adams).
+ *
+ * Each thread keeps two magazines (loaded and previous) of free objects and
+ * serves allocations from them without any synchronization. Only when both
+ * are exhausted (or both full on free) the thread exchanges a magazine with
+ * the global depot under a spinlock. When the depot has no full magazines a
+ * new slab of objects is carved out of a single calloc'ed chunk.
+ *
+ * If thread's magazines cannot be set up, or there is no memory for an empty
+ * magazine on free, objects go through a shared freelist in the depot, linked
+ * in place of object data. Refill takes objects from it before growing.
+ *
+ * Objects coming from a fresh slab are already zeroed, so zeroing is only
+ * done for objects which have been recycled.
+ */
+#define ENV_ALLOCATOR_MAGAZINE_SIZE	32
+#define ENV_ALLOCATOR_SLAB_ITEMS	ENV_ALLOCATOR_MAGAZINE_SIZE
+
+#define ENV_ALLOCATOR_ITEM_DIRTY	(1 << 0)
+
+struct _env_allocator_magazine {
+	struct _env_allocator_magazine *next;
+	uint32_t rounds;
+	void *objs[ENV_ALLOCATOR_MAGAZINE_SIZE];
+};
+
+struct _env_allocator_slab {
+	struct _env_allocator_slab *next;
+	char data[];
+};
+
+/* Per-thread magazine cache */
+struct _env_allocator_cpu {
+	struct _env_allocator_magazine *loaded;
+	struct _env_allocator_magazine *prev;
+
+	/*!< Statistics, updated by owner thread only */
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t allocs;
+	uint64_t frees;
+
+	struct list_head list;
+	env_allocator *allocator;
+};
+
 struct _env_allocator {
 	/*!< Memory pool ID unique name */
 	char *name;
@@ -15,8 +63,29 @@ struct _env_allocator {
 	/*!< Size of specific item of memory pool */
 	uint32_t item_size;
 
-	/*!< Number of currently allocated items in pool */
-	env_atomic count;
+	/*!< Size of user part of the item */
+	uint32_t obj_size;
+
+	/*!< Key of per-thread magazine cache */
+	pthread_key_t key;
+	bool key_valid;
+
+	/*!< Depot protecting all fields below */
+	env_spinlock lock;
+	struct _env_allocator_magazine *full;
+	struct _env_allocator_magazine *empty;
+	struct _env_allocator_slab *slabs;
+	struct _env_allocator_item *free_items;
+	struct list_head cpus;
+
+	/*!< Statistics of threads which already exited */
+	struct env_allocator_stats retired;
+};
+
+struct _env_allocator_item {
+	uint32_t flags;
+	uint32_t cpu;
+	char data[];
 };
 
 static inline size_t env_allocator_align(size_t size)
@@ -26,23 +95,209 @@ static inline size_t env_allocator_align(size_t size)
 	return (1ULL << 32) >> __builtin_clz(size - 1);
 }
 
-struct _env_allocator_item {
-	uint32_t flags;
-	uint32_t cpu;
-	char data[];
-};
+static inline struct _env_allocator_item **_env_allocator_item_next(
+		struct _env_allocator_item *item)
+{
+	return (struct _env_allocator_item **)item->data;
+}
 
-void *env_allocator_new(env_allocator *allocator)
+/* Shared freelist, called with depot lock held */
+static void _env_allocator_put_free(env_allocator *allocator,
+		struct _env_allocator_item *item)
+{
+	*_env_allocator_item_next(item) = allocator->free_items;
+	allocator->free_items = item;
+}
+
+static struct _env_allocator_item *_env_allocator_get_free(
+		env_allocator *allocator)
+{
+	struct _env_allocator_item *item = allocator->free_items;
+
+	if (item)
+		allocator->free_items = *_env_allocator_item_next(item);
+
+	return item;
+}
+
+static struct _env_allocator_magazine *_env_allocator_get_empty(
+		env_allocator *allocator)
+{
+	struct _env_allocator_magazine *mag = allocator->empty;
+
+	if (mag) {
+		allocator->empty = mag->next;
+		return mag;
+	}
+
+	return calloc(1, sizeof(*mag));
+}
+
+static void _env_allocator_cpu_release(void *priv)
+{
+	struct _env_allocator_cpu *cpu = priv;
+	env_allocator *allocator = cpu->allocator;
+	struct _env_allocator_magazine *mags[] = { cpu->loaded, cpu->prev };
+	int i;
+
+	env_spinlock_lock(&allocator->lock);
+
+	for (i = 0; i < ARRAY_SIZE(mags); i++) {
+		if (mags[i]->rounds) {
+			mags[i]->next = allocator->full;
+			allocator->full = mags[i];
+		} else {
+			mags[i]->next = allocator->empty;
+			allocator->empty = mags[i];
+		}
+	}
+
+	allocator->retired.hits += cpu->hits;
+	allocator->retired.misses += cpu->misses;
+	allocator->retired.allocs += cpu->allocs;
+	allocator->retired.frees += cpu->frees;
+	list_del(&cpu->list);
+
+	env_spinlock_unlock(&allocator->lock);
+
+	free(cpu);
+}
+
+static struct _env_allocator_cpu *_env_allocator_get_cpu(
+		env_allocator *allocator)
+{
+	struct _env_allocator_cpu *cpu = pthread_getspecific(allocator->key);
+
+	if (likely(cpu))
+		return cpu;
+
+	cpu = calloc(1, sizeof(*cpu));
+	if (!cpu)
+		return NULL;
+
+	cpu->allocator = allocator;
+
+	env_spinlock_lock(&allocator->lock);
+	cpu->loaded = _env_allocator_get_empty(allocator);
+	cpu->prev = _env_allocator_get_empty(allocator);
+	if (cpu->loaded && cpu->prev)
+		list_add(&cpu->list, &allocator->cpus);
+	env_spinlock_unlock(&allocator->lock);
+
+	if (!cpu->loaded || !cpu->prev)
+		goto err;
+
+	if (pthread_setspecific(allocator->key, cpu)) {
+		_env_allocator_cpu_release(cpu);
+		return NULL;
+	}
+
+	return cpu;
+
+err:
+	free(cpu->loaded);
+	free(cpu->prev);
+	free(cpu);
+	return NULL;
+}
+
+/* Fill empty magazine with objects from newly allocated slab */
+static int _env_allocator_grow(env_allocator *allocator,
+		struct _env_allocator_magazine *mag)
+{
+	struct _env_allocator_slab *slab;
+	struct _env_allocator_item *item;
+	int i;
+
+	slab = calloc(1, sizeof(*slab) +
+			(size_t)allocator->item_size * ENV_ALLOCATOR_SLAB_ITEMS);
+	if (!slab)
+		return -ENOMEM;
+
+	for (i = 0; i < ENV_ALLOCATOR_SLAB_ITEMS; i++) {
+		item = (void *)(slab->data + (size_t)i * allocator->item_size);
+		mag->objs[mag->rounds++] = item;
+	}
+
+	env_spinlock_lock(&allocator->lock);
+	slab->next = allocator->slabs;
+	allocator->slabs = slab;
+	env_spinlock_unlock(&allocator->lock);
+
+	return 0;
+}
+
+static struct _env_allocator_item *_env_allocator_refill(
+		env_allocator *allocator, struct _env_allocator_cpu *cpu)
 {
-	struct _env_allocator_item *item = NULL;
+	struct _env_allocator_magazine *mag;
+
+	cpu->misses++;
+
+	env_spinlock_lock(&allocator->lock);
+	mag = allocator->full;
+	if (mag) {
+		allocator->full = mag->next;
+		cpu->prev->next = allocator->empty;
+		allocator->empty = cpu->prev;
+		cpu->prev = cpu->loaded;
+		cpu->loaded = mag;
+	} else {
+		while (cpu->loaded->rounds < ENV_ALLOCATOR_MAGAZINE_SIZE &&
+				allocator->free_items) {
+			cpu->loaded->objs[cpu->loaded->rounds++] =
+				_env_allocator_get_free(allocator);
+		}
+	}
+	env_spinlock_unlock(&allocator->lock);
+
+	if (!cpu->loaded->rounds &&
+			_env_allocator_grow(allocator, cpu->loaded)) {
+		return NULL;
+	}
 
-	item = calloc(1, allocator->item_size);
+	return cpu->loaded->objs[--cpu->loaded->rounds];
+}
 
-	if (item) {
-		item->cpu = 0;
-		env_atomic_inc(&allocator->count);
+void *env_allocator_new(env_allocator *allocator)
+{
+	struct _env_allocator_cpu *cpu;
+	struct _env_allocator_magazine *tmp;
+	struct _env_allocator_item *item;
+
+	cpu = _env_allocator_get_cpu(allocator);
+	if (unlikely(!cpu)) {
+		env_spinlock_lock(&allocator->lock);
+		item = _env_allocator_get_free(allocator);
+		if (item)
+			allocator->retired.allocs++;
+		env_spinlock_unlock(&allocator->lock);
+
+		if (unlikely(!item))
+			return NULL;
+	} else if (likely(cpu->loaded->rounds)) {
+		item = cpu->loaded->objs[--cpu->loaded->rounds];
+		cpu->hits++;
+	} else if (cpu->prev->rounds) {
+		tmp = cpu->loaded;
+		cpu->loaded = cpu->prev;
+		cpu->prev = tmp;
+		item = cpu->loaded->objs[--cpu->loaded->rounds];
+		cpu->hits++;
+	} else {
+		item = _env_allocator_refill(allocator, cpu);
+		if (unlikely(!item))
+			return NULL;
+	}
+
+	if (item->flags & ENV_ALLOCATOR_ITEM_DIRTY) {
+		memset(item->data, 0, allocator->obj_size);
+		item->flags = 0;
 	}
 
+	if (likely(cpu))
+		cpu->allocs++;
+
 	return &item->data;
 }
 
@@ -58,7 +313,26 @@ env_allocator *env_allocator_create(uint32_t size, const char *fmt_name, ...)
 		goto err;
 	}
 
-	allocator->item_size = size + sizeof(struct _env_allocator_item);
+	INIT_LIST_HEAD(&allocator->cpus);
+	allocator->obj_size = size;
+	/* Freed item has to fit shared freelist link */
+	allocator->item_size = DIV_ROUND_UP(
+			MAX(size, sizeof(struct _env_allocator_item *)) +
+			sizeof(struct _env_allocator_item),
+			sizeof(uint64_t)) * sizeof(uint64_t);
+
+	if (env_spinlock_init(&allocator->lock)) {
+		free(allocator);
+		allocator = NULL;
+		error = __LINE__;
+		goto err;
+	}
+
+	if (pthread_key_create(&allocator->key, _env_allocator_cpu_release)) {
+		error = __LINE__;
+		goto err;
+	}
+	allocator->key_valid = true;
 
 	/* Format allocator name */
 	va_start(args, fmt_name);
@@ -91,20 +365,114 @@ void env_allocator_del(env_allocator *allocator, void *obj)
 {
 	struct _env_allocator_item *item =
 		container_of(obj, struct _env_allocator_item, data);
+	struct _env_allocator_cpu *cpu;
+	struct _env_allocator_magazine *mag;
+
+	item->flags |= ENV_ALLOCATOR_ITEM_DIRTY;
+
+	cpu = _env_allocator_get_cpu(allocator);
+	if (unlikely(!cpu)) {
+		env_spinlock_lock(&allocator->lock);
+		_env_allocator_put_free(allocator, item);
+		allocator->retired.frees++;
+		env_spinlock_unlock(&allocator->lock);
+		return;
+	}
+
+	cpu->frees++;
+
+	if (likely(cpu->loaded->rounds < ENV_ALLOCATOR_MAGAZINE_SIZE)) {
+		cpu->loaded->objs[cpu->loaded->rounds++] = item;
+		return;
+	}
+
+	if (!cpu->prev->rounds) {
+		mag = cpu->loaded;
+		cpu->loaded = cpu->prev;
+		cpu->prev = mag;
+		cpu->loaded->objs[cpu->loaded->rounds++] = item;
+		return;
+	}
+
+	/* Both magazines are full - return one to the depot */
+	env_spinlock_lock(&allocator->lock);
+	mag = _env_allocator_get_empty(allocator);
+	if (unlikely(!mag)) {
+		_env_allocator_put_free(allocator, item);
+		env_spinlock_unlock(&allocator->lock);
+		return;
+	}
+	cpu->prev->next = allocator->full;
+	allocator->full = cpu->prev;
+	cpu->prev = cpu->loaded;
+	cpu->loaded = mag;
+	env_spinlock_unlock(&allocator->lock);
+
+	cpu->loaded->objs[cpu->loaded->rounds++] = item;
+}
+
+void env_allocator_get_stats(env_allocator *allocator,
+		struct env_allocator_stats *stats)
+{
+	struct _env_allocator_cpu *cpu;
+
+	env_spinlock_lock(&allocator->lock);
 
-	env_atomic_dec(&allocator->count);
+	*stats = allocator->retired;
+	list_for_each_entry(cpu, &allocator->cpus, list) {
+		stats->hits += cpu->hits;
+		stats->misses += cpu->misses;
+		stats->allocs += cpu->allocs;
+		stats->frees += cpu->frees;
+	}
 
-	free(item);
+	env_spinlock_unlock(&allocator->lock);
+}
+
+static void _env_allocator_free_magazines(struct _env_allocator_magazine *mag)
+{
+	struct _env_allocator_magazine *next;
+
+	while (mag) {
+		next = mag->next;
+		free(mag);
+		mag = next;
+	}
 }
 
 void env_allocator_destroy(env_allocator *allocator)
 {
+	struct _env_allocator_cpu *cpu, *tmp;
+	struct _env_allocator_slab *slab;
+	struct env_allocator_stats stats;
+
 	if (allocator) {
-		if (env_atomic_read(&allocator->count)) {
-			printf("Not all objects deallocated\n");
-			ENV_WARN(true, OCF_PREFIX_SHORT" Cleanup problem\n");
+		if (allocator->key_valid) {
+			env_allocator_get_stats(allocator, &stats);
+			if (stats.allocs != stats.frees) {
+				printf("Not all objects deallocated\n");
+				ENV_WARN(true, OCF_PREFIX_SHORT" Cleanup problem\n");
+			}
+
+			/* Threads won't call destructor once key is deleted */
+			pthread_key_delete(allocator->key);
+		}
+
+		list_for_each_entry_safe(cpu, tmp, &allocator->cpus, list) {
+			free(cpu->loaded);
+			free(cpu->prev);
+			free(cpu);
+		}
+		_env_allocator_free_magazines(allocator->full);
+		_env_allocator_free_magazines(allocator->empty);
+
+		while (allocator->slabs) {
+			slab = allocator->slabs;
+			allocator->slabs = slab->next;
+			free(slab);
 		}
 
+		env_spinlock_destroy(&allocator->lock);
 		free(allocator->name);
 		free(allocator);
 	}
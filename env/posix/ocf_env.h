@@ -31,6 +31,10 @@
 #include <sys/mman.h>
 #include <zlib.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "ocf_env_list.h"
 #include "ocf_env_headers.h"
 #include "ocf/ocf_err.h"
@@ -206,6 +210,20 @@ void *env_allocator_new(env_allocator *allocator);
 
 void env_allocator_del(env_allocator *allocator, void *item);
 
+struct env_allocator_stats {
+	/*!< Allocations served from per-thread magazines */
+	uint64_t hits;
+
+	/*!< Allocations which had to go to the depot or a new slab */
+	uint64_t misses;
+
+	uint64_t allocs;
+	uint64_t frees;
+};
+
+void env_allocator_get_stats(env_allocator *allocator,
+		struct env_allocator_stats *stats);
+
 /* MUTEX */
 typedef struct {
 	pthread_mutex_t m;
@@ -483,6 +501,24 @@ static inline long env_atomic64_cmpxchg(env_atomic64 *a, long old_v, long new_v)
 	return __sync_val_compare_and_swap(&a->counter, old_v, new_v);
 }
 
+/* Order loads before the barrier against loads after it */
+static inline void env_smp_rmb(void)
+{
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+/* Order stores before the barrier against stores after it */
+static inline void env_smp_wmb(void)
+{
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/* Order all accesses before the barrier against all accesses after it */
+static inline void env_smp_mb(void)
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
 /* SPIN LOCKS */
 typedef struct {
 	pthread_spinlock_t lock;
@@ -582,12 +618,76 @@ static inline bool env_bit_test(int nr, const volatile unsigned long *addr)
 	return !!(*byte & mask);
 }
 
+/* Index of least significant set bit, value must not be zero */
+static inline unsigned int env_bit_ffs(uint32_t value)
+{
+	return __builtin_ctz(value);
+}
+
+/* Index of least significant set bit, value must not be zero */
+static inline unsigned int env_bit_ffs64(uint64_t value)
+{
+	return __builtin_ctzll(value);
+}
+
+/* Index of most significant set bit, value must not be zero */
+static inline unsigned int env_bit_fls64(uint64_t value)
+{
+	return 63 - __builtin_clzll(value);
+}
+
+/* Mask with bit set for every byte of 16 byte group equal to value,
+ * group has to be 16 bytes aligned */
+static inline uint32_t env_bytes_match16(const uint8_t *group, uint8_t value)
+{
+#if defined(__SSE2__)
+	__m128i bytes = _mm_load_si128((const __m128i *)group);
+
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(value)));
+#else
+	uint32_t mask = 0;
+	int i;
+
+	for (i = 0; i < 16; i++) {
+		if (group[i] == value)
+			mask |= 1U << i;
+	}
+
+	return mask;
+#endif
+}
+
 /* SCHEDULING */
 static inline int env_in_interrupt(void)
 {
 	return 0;
 }
 
+/* CPU the caller runs on, caller may be migrated right after the call */
+static inline unsigned env_get_current_cpu(void)
+{
+	int cpu = sched_getcpu();
+
+	return cpu < 0 ? 0 : cpu;
+}
+
+/* Busy wait loop hint */
+static inline void env_cpu_relax(void)
+{
+#if defined(__SSE2__)
+	_mm_pause();
+#endif
+}
+
+/* Monotonic time in nanoseconds, for latency measurement and tracing */
+static inline uint64_t env_get_time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
 static inline uint64_t env_get_tick_count(void)
 {
 	struct timeval tv;
@@ -13,6 +13,7 @@
 enum ocf_cleaning_acp_parameters {
 	ocf_acp_wake_up_time,
 	ocf_acp_flush_max_buffers,
+	ocf_acp_rate_limit,
 };
 
 /**
@@ -42,6 +43,17 @@ enum ocf_cleaning_acp_parameters {
 /** Dirty cache lines to be flushed in one cycle default value */
 #define OCF_ACP_DEFAULT_FLUSH_MAX_BUFFERS	128
 
+/**
+ * ACP cleaning thread core write rate limit in MiB/s, 0 means unlimited
+ */
+
+/** Cleaning rate limit minimum value */
+#define OCF_ACP_MIN_RATE_LIMIT			0
+/** Cleaning rate limit maximum value */
+#define OCF_ACP_MAX_RATE_LIMIT			65536
+/** Cleaning rate limit default value */
+#define OCF_ACP_DEFAULT_RATE_LIMIT		0
+
 /**
  * @}
  */
@@ -15,6 +15,8 @@ enum ocf_cleaning_alru_parameters {
 	ocf_alru_stale_buffer_time,
 	ocf_alru_flush_max_buffers,
 	ocf_alru_activity_threshold,
+	ocf_alru_rate_limit,
+	ocf_alru_hot_threshold,
 };
 
 /**
@@ -66,6 +68,30 @@ enum ocf_cleaning_alru_parameters {
 /** Idle time before flushing thread can start default value */
 #define OCF_ALRU_DEFAULT_ACTIVITY_THRESHOLD	10000
 
+/**
+ * ALRU cleaning thread core write rate limit in MiB/s, 0 means unlimited.
+ * When set, pacing replaces idle time based activity detection.
+ */
+
+/** Cleaning rate limit minimum value */
+#define OCF_ALRU_MIN_RATE_LIMIT			0
+/** Cleaning rate limit maximum value */
+#define OCF_ALRU_MAX_RATE_LIMIT			65536
+/** Cleaning rate limit default value */
+#define OCF_ALRU_DEFAULT_RATE_LIMIT		0
+
+/**
+ * ALRU cleaning thread estimated number of read hits to dirty cache line
+ * after which it is cleaned ahead of age order, 0 means disabled
+ */
+
+/** Hot dirty line threshold minimum value */
+#define OCF_ALRU_MIN_HOT_THRESHOLD		0
+/** Hot dirty line threshold maximum value */
+#define OCF_ALRU_MAX_HOT_THRESHOLD		16
+/** Hot dirty line threshold default value */
+#define OCF_ALRU_DEFAULT_HOT_THRESHOLD		4
+
 /**
  * @}
  */
@@ -25,6 +25,8 @@
 #include "cleaning/alru.h"
 #include "cleaning/acp.h"
 #include "promotion/nhit.h"
+#include "promotion/tinylfu.h"
+#include "promotion/nhc.h"
 #include "ocf_metadata.h"
 #include "ocf_metadata_updater.h"
 #include "ocf_io_class.h"
@@ -214,6 +214,14 @@ typedef enum {
 	ocf_eviction_lru = 0,
 		/*!< Last recently used eviction policy */
 
+	ocf_eviction_lru_sharded,
+		/*!< LRU split into multiple lists per partition, with hits
+		 * recorded as CLOCK reference bits */
+
+	ocf_eviction_s3fifo,
+		/*!< Scan resistant S3-FIFO eviction policy (small, main and
+		 * ghost FIFO queues) */
+
 	ocf_eviction_max,
 		/*!< Stopper of enumerator */
 
@@ -231,6 +239,14 @@ typedef enum {
 	ocf_promotion_nhit,
 		/*!< Line can be inserted after N requests for it */
 
+	ocf_promotion_tinylfu,
+		/*!< Line can be inserted when its estimated access frequency
+		 * reaches N */
+
+	ocf_promotion_nhc,
+		/*!< Multi-factor caching - line can be inserted while
+		 * data_admit is on, within cache write budget */
+
 	ocf_promotion_max,
 		/*!< Stopper of enumerator */
 
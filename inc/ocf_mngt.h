@@ -289,6 +289,13 @@ struct ocf_mngt_cache_config {
 	 * @brief If set, try to submit all I/O in fast path.
 	 */
 	bool use_submit_io_fast;
+
+	/**
+	 * @brief Keep per hash bucket groups of tags in DRAM, probed with
+	 *        SIMD on lookup, so most of lookups do not walk collision
+	 *        chains
+	 */
+	bool use_lookup_tags;
 };
 
 /**
@@ -313,6 +320,7 @@ static inline void ocf_mngt_cache_config_set_default(
 	cfg->locked = false;
 	cfg->pt_unaligned_io = false;
 	cfg->use_submit_io_fast = false;
+	cfg->use_lookup_tags = false;
 }
 
 /**
@@ -682,6 +690,34 @@ void ocf_mngt_core_purge(ocf_core_t core,
  */
 void ocf_mngt_cache_flush_interrupt(ocf_cache_t cache);
 
+#define OCF_MNGT_FLUSH_STREAMS_DEFAULT 4
+#define OCF_MNGT_FLUSH_STREAMS_MAX 64
+
+/**
+ * @brief Set number of flush streams in flight per core
+ *
+ * Dirty data of each core is sorted by core address and split into up to
+ * given number of ranges, flushed concurrently.
+ *
+ * @param[in] cache Cache instance
+ * @param[in] streams Number of streams (1 - OCF_MNGT_FLUSH_STREAMS_MAX)
+ *
+ * @retval 0 Number of streams has been set successfully
+ * @retval Non-zero Error occurred
+ */
+int ocf_mngt_cache_set_flush_streams(ocf_cache_t cache, uint32_t streams);
+
+/**
+ * @brief Get number of flush streams in flight per core
+ *
+ * @param[in] cache Cache instance
+ * @param[out] streams Number of streams
+ *
+ * @retval 0 Number of streams has been retrieved successfully
+ * @retval Non-zero Error occurred
+ */
+int ocf_mngt_cache_get_flush_streams(ocf_cache_t cache, uint32_t *streams);
+
 /**
  * @brief Completion callback of save operation
  *
@@ -891,6 +927,35 @@ struct ocf_mngt_io_classes_config {
 int ocf_mngt_cache_io_classes_configure(ocf_cache_t cache,
 		const struct ocf_mngt_io_classes_config *cfg);
 
+/**
+ * @brief Set interval of IO class target sizes rebalancing
+ *
+ * Periodically sets target sizes of IO classes to minimize total number
+ * of misses, based on estimated miss ratio curves of IO classes, within
+ * min and max sizes of each IO class. Eviction takes cache lines from
+ * IO classes above their target size first.
+ *
+ * @param[in] cache Cache handle
+ * @param[in] interval_ms Rebalancing interval in milliseconds, 0 disables
+ *
+ * @retval 0 Interval has been set successfully
+ * @retval Non-zero Error occurred
+ */
+int ocf_mngt_cache_set_io_classes_balance(ocf_cache_t cache,
+		uint32_t interval_ms);
+
+/**
+ * @brief Get interval of IO class target sizes rebalancing
+ *
+ * @param[in] cache Cache handle
+ * @param[out] interval_ms Rebalancing interval in milliseconds
+ *
+ * @retval 0 Interval has been retrieved successfully
+ * @retval Non-zero Error occurred
+ */
+int ocf_mngt_cache_get_io_classes_balance(ocf_cache_t cache,
+		uint32_t *interval_ms);
+
 /**
  * @brief Asociate new UUID value with given core
  *
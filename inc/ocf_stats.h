@@ -84,6 +84,9 @@ struct ocf_stats_requests {
 	struct ocf_stat wr_pt;
 	struct ocf_stat serviced;
 	struct ocf_stat total;
+	struct ocf_stat rd_offloadable_hits;
+		/*!< Read hits without dirty data, which could be serviced
+		 * from core, fraction is relative to read hits */
 };
 
 /**
@@ -150,6 +153,93 @@ struct ocf_stats_errors {
 	struct ocf_stat total;
 };
 
+/**
+ * @brief Per second rates over statistics interval
+ *
+ * Requests and errors are given in requests per second, blocks in 4 KiB
+ * blocks per second. Occupancy and dirty are signed rates of change
+ * in 4 KiB blocks per second.
+ */
+struct ocf_stats_rates {
+	uint64_t rd_reqs;
+	uint64_t rd_hits;
+	uint64_t wr_reqs;
+	uint64_t wr_hits;
+	uint64_t pt_reqs;
+	uint64_t total_reqs;
+	uint64_t core_volume_rd;
+	uint64_t core_volume_wr;
+	uint64_t cache_volume_rd;
+	uint64_t cache_volume_wr;
+	uint64_t volume_rd;
+	uint64_t volume_wr;
+	uint64_t errors;
+	int64_t occupancy;
+	int64_t dirty;
+};
+
+/**
+ * @brief Statistics for interval between two snapshots
+ */
+struct ocf_stats_interval {
+	/** Interval length in microseconds */
+	uint64_t duration_us;
+	/** Usage at the end of interval */
+	struct ocf_stats_usage usage;
+	/** Requests serviced within interval */
+	struct ocf_stats_requests req;
+	/** Blocks transferred within interval */
+	struct ocf_stats_blocks blocks;
+	/** Errors reported within interval */
+	struct ocf_stats_errors errors;
+	/** Per second rates within interval */
+	struct ocf_stats_rates rates;
+};
+
+/**
+ * @brief Request paths with latency accounting
+ */
+typedef enum {
+	ocf_lat_cache_read,
+		/*!< Read serviced from cache volume */
+	ocf_lat_core_read_offload,
+		/*!< Read hit redirected to core volume by load_admit */
+	ocf_lat_core_read_miss,
+		/*!< Read miss serviced from core volume */
+	ocf_lat_backfill,
+		/*!< Promotion backfill write to cache volume */
+	ocf_lat_wb_write,
+		/*!< Write-back write to cache volume */
+	ocf_lat_lock_wait,
+		/*!< Wait for cache line locks before resume */
+	ocf_lat_path_max,
+} ocf_lat_path_t;
+
+/** Linear sub-buckets per power of two (as bit count) */
+#define OCF_STATS_LAT_SUB_BITS 3
+
+/** Highest power of two (in ns) with separate buckets, ~34 s */
+#define OCF_STATS_LAT_MAX_EXP 35
+
+/** Number of latency histogram buckets */
+#define OCF_STATS_LAT_BUCKETS \
+	((OCF_STATS_LAT_MAX_EXP - OCF_STATS_LAT_SUB_BITS + 2) << \
+			OCF_STATS_LAT_SUB_BITS)
+
+/**
+ * @brief Log-linear latency histogram
+ *
+ * Each power of two of nanoseconds is split into 2^OCF_STATS_LAT_SUB_BITS
+ * equal buckets, so relative error of a bucket is below 12.5%. Use
+ * ocf_stats_latency_bucket_ns() to get lower bound of given bucket.
+ */
+struct ocf_stats_latency {
+	/** Number of samples */
+	uint64_t count;
+	/** Samples per bucket */
+	uint64_t buckets[OCF_STATS_LAT_BUCKETS];
+};
+
 /**
  * @param Collect statistics for given cache
  *
@@ -229,6 +319,164 @@ int ocf_stats_collect_part_cache(ocf_cache_t cache, ocf_part_id_t part_id,
 		struct ocf_stats_usage *usage, struct ocf_stats_requests *req,
 		struct ocf_stats_blocks *blocks);
 
+/**
+ * @brief Allocate statistics snapshot
+ *
+ * Snapshot can be taken repeatedly, so usually two snapshots are allocated
+ * once and reused for all intervals.
+ *
+ * @param[out] snapshot Snapshot handle
+ *
+ * @retval 0 Success
+ * @retval Non-zero Error
+ */
+int ocf_stats_snapshot_alloc(ocf_stats_snapshot_t *snapshot);
+
+/**
+ * @brief Free statistics snapshot
+ *
+ * @param[in] snapshot Snapshot handle
+ */
+void ocf_stats_snapshot_free(ocf_stats_snapshot_t snapshot);
+
+/**
+ * @brief Take snapshot of cumulative core statistics
+ *
+ * Snapshot only reads counters, it does not lock nor stop IO.
+ *
+ * @param[in] core Core handle
+ * @param[in] snapshot Snapshot handle
+ *
+ * @retval 0 Success
+ * @retval Non-zero Error
+ */
+int ocf_stats_snapshot_core(ocf_core_t core, ocf_stats_snapshot_t snapshot);
+
+/**
+ * @brief Take snapshot of cumulative cache statistics
+ *
+ * @param[in] cache Cache handle
+ * @param[in] snapshot Snapshot handle
+ *
+ * @retval 0 Success
+ * @retval Non-zero Error
+ */
+int ocf_stats_snapshot_cache(ocf_cache_t cache, ocf_stats_snapshot_t snapshot);
+
+/**
+ * @brief Compute statistics for interval between two snapshots
+ *
+ * Both snapshots have to be taken for the same core or cache. Counters
+ * which went backwards (statistics reset within interval) are counted
+ * from zero.
+ *
+ * @param[in] from Snapshot taken at the beginning of interval
+ * @param[in] to Snapshot taken at the end of interval
+ * @param[out] interval Interval statistics
+ *
+ * @retval 0 Success
+ * @retval Non-zero Error
+ */
+int ocf_stats_snapshot_delta(ocf_stats_snapshot_t from,
+		ocf_stats_snapshot_t to, struct ocf_stats_interval *interval);
+
+/**
+ * @brief Collect latency histogram of given path for core
+ *
+ * @param[in] core Core handle
+ * @param[in] path Request path
+ * @param[out] lat Latency histogram summed over all IO classes
+ *
+ * @retval 0 Success
+ * @retval Non-zero Error
+ */
+int ocf_stats_collect_latency_core(ocf_core_t core, ocf_lat_path_t path,
+		struct ocf_stats_latency *lat);
+
+/**
+ * @brief Collect latency histogram of given path for core and IO class
+ *
+ * @param[in] core Core handle
+ * @param[in] part_id IO class id
+ * @param[in] path Request path
+ * @param[out] lat Latency histogram
+ *
+ * @retval 0 Success
+ * @retval Non-zero Error
+ */
+int ocf_stats_collect_latency_part_core(ocf_core_t core,
+		ocf_part_id_t part_id, ocf_lat_path_t path,
+		struct ocf_stats_latency *lat);
+
+/**
+ * @brief Get lower bound of latency histogram bucket
+ *
+ * @param[in] bucket Bucket index
+ *
+ * @retval Lower bound in nanoseconds
+ */
+uint64_t ocf_stats_latency_bucket_ns(uint32_t bucket);
+
+/**
+ * @brief Get latency percentile from histogram
+ *
+ * @param[in] lat Latency histogram
+ * @param[in] permille Percentile in 1/1000 units (e.g. 999 for p99.9)
+ *
+ * @retval Upper bound of bucket containing percentile in nanoseconds
+ */
+uint64_t ocf_stats_latency_percentile(const struct ocf_stats_latency *lat,
+		uint32_t permille);
+
+/** Number of points of estimated miss ratio curve */
+#define OCF_STATS_MRC_POINTS 64
+
+/**
+ * @brief Miss ratio curve estimated from sampled reuse distances (SHARDS)
+ */
+struct ocf_stats_mrc {
+	/** Cache size difference between points, in cache lines */
+	uint64_t step;
+
+	/** Sampled accesses the curve is built from */
+	uint64_t samples;
+
+	/** Current spatial sampling rate in ppm */
+	uint32_t sample_rate;
+
+	/** Miss ratio (x 10000) for cache of (i + 1) * step cache lines */
+	uint32_t miss_ratio[OCF_STATS_MRC_POINTS];
+};
+
+/**
+ * @brief Collect estimated miss ratio curve of core
+ *
+ * @param[in] core Core handle
+ * @param[in] step Cache lines between curve points, 0 to cover twice
+ *		the current cache size
+ * @param[out] mrc Miss ratio curve
+ *
+ * @retval 0 Success
+ * @retval Non-zero Error
+ */
+int ocf_stats_collect_mrc_core(ocf_core_t core, uint64_t step,
+		struct ocf_stats_mrc *mrc);
+
+/**
+ * @brief Collect estimated miss ratio curve of IO class, over all cores
+ *
+ * @param[in] cache Cache handle
+ * @param[in] part_id IO class id
+ * @param[in] step Cache lines between curve points, 0 to cover twice
+ *		the current cache size
+ * @param[out] mrc Miss ratio curve
+ *
+ * @retval 0 Success
+ * @retval Non-zero Error
+ */
+int ocf_stats_collect_mrc_part(ocf_cache_t cache, ocf_part_id_t part_id,
+		uint64_t step, struct ocf_stats_mrc *mrc);
+
 /**
  * @brief Initialize or reset core statistics
  *
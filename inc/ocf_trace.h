@@ -145,6 +145,142 @@ struct ocf_event_io_cmpl {
 };
 
 
+/**
+ * @brief Built-in trace ring record types
+ */
+typedef enum {
+	/** IO submitted to core, arg is operation, value is address */
+	ocf_trace_rec_submit,
+
+	/** Request entered path (route decision, device submit or lock
+	 * wait), arg is ocf_lat_path_t, value is address */
+	ocf_trace_rec_path_start,
+
+	/** Request left path (device completion or lock granted), arg is
+	 * ocf_lat_path_t, value is time spent in path in ns */
+	ocf_trace_rec_path_end,
+
+	/** IO completed, arg is 1 for hit, value is address */
+	ocf_trace_rec_complete,
+
+	/** Request picked up by engine from queue, arg is direction,
+	 * value is address */
+	ocf_trace_rec_engine,
+
+	/** Device IO completed, arg is OCF_TRACE_DEV_* | direction << 1,
+	 * value is time since device submit in ns, sid is device address */
+	ocf_trace_rec_dev_io,
+
+	/** Counter changed, arg is ocf_trace_counter_t, value is new value */
+	ocf_trace_rec_counter,
+
+	/** Records overwritten before they were drained, value is count */
+	ocf_trace_rec_lost,
+} ocf_trace_rec_type_t;
+
+/**
+ * @brief Fixed size record of built-in trace ring
+ */
+struct ocf_trace_rec {
+	/** Monotonic time stamp in ns */
+	uint64_t timestamp;
+
+	/** Request sequence ID, shared by all records of the same IO */
+	log_sid_t sid;
+
+	/** Record type dependent value */
+	uint64_t value;
+
+	/** Length of IO in bytes */
+	uint32_t len;
+
+	/** Queue which produced the record */
+	uint16_t queue_id;
+
+	/** Record type (ocf_trace_rec_type_t) */
+	uint8_t type;
+
+	/** Record type dependent argument */
+	uint8_t arg;
+};
+
+/** Device ids of ocf_trace_rec_dev_io records */
+#define OCF_TRACE_DEV_CACHE	0
+#define OCF_TRACE_DEV_CORE	1
+
+/**
+ * @brief Counters traced with ocf_trace_rec_counter records
+ */
+typedef enum {
+	/** Multi-factor load_admit in parts per million */
+	ocf_trace_counter_load_admit,
+
+	/** Multi-factor data_admit probability in parts per million */
+	ocf_trace_counter_data_admit,
+} ocf_trace_counter_t;
+
+/**
+ * @brief Start built-in trace ring
+ *
+ * Allocates ring for every IO queue of the cache (and for queues
+ * created later on) and starts recording. When ring is full oldest
+ * records are overwritten and reported as ocf_trace_rec_lost on drain.
+ *
+ * @param[in] cache Cache handle
+ * @param[in] entries Records per queue, has to be a power of 2
+ *
+ * @retval 0 Tracing started successfully
+ * @retval Non-zero Error
+ */
+int ocf_mngt_start_trace_ring(ocf_cache_t cache, uint32_t entries);
+
+/**
+ * @brief Stop built-in trace ring
+ *
+ * Rings stay allocated, so records not yet drained can still be
+ * collected with ocf_trace_ring_drain().
+ *
+ * @param[in] cache Cache handle
+ */
+void ocf_mngt_stop_trace_ring(ocf_cache_t cache);
+
+/**
+ * @brief Drain records from trace rings of all cache IO queues
+ *
+ * Must not be called concurrently for the same cache.
+ *
+ * @param[in] cache Cache handle
+ * @param[out] recs Records buffer
+ * @param[in] max Size of records buffer
+ *
+ * @retval Number of records stored in buffer
+ */
+uint32_t ocf_trace_ring_drain(ocf_cache_t cache, struct ocf_trace_rec *recs,
+		uint32_t max);
+
+/**
+ * @brief Record device IO completion in trace ring
+ *
+ * Intended to be called by volume implementations right before
+ * completing IO.
+ *
+ * @param[in] io Completed IO
+ * @param[in] dev OCF_TRACE_DEV_CACHE or OCF_TRACE_DEV_CORE
+ * @param[in] submit_ns Time of IO submission (env_get_time_ns())
+ */
+void ocf_trace_ring_dev_io(struct ocf_io *io, uint8_t dev,
+		uint64_t submit_ns);
+
+/**
+ * @brief Record counter change in trace ring
+ *
+ * @param[in] cache Cache handle
+ * @param[in] counter Counter id
+ * @param[in] value New counter value
+ */
+void ocf_trace_ring_counter(ocf_cache_t cache, ocf_trace_counter_t counter,
+		uint64_t value);
+
 /** @brief Push log callback.
  *
  * @param[in] cache OCF cache
@@ -92,4 +92,9 @@ typedef struct ocf_metadata_updater *ocf_metadata_updater_t;
  */
 typedef struct ocf_logger *ocf_logger_t;
 
+/**
+ * @brief handle to statistics snapshot
+ */
+typedef struct ocf_stats_snapshot *ocf_stats_snapshot_t;
+
 #endif
@@ -0,0 +1,29 @@
+/*
+ * Copyright(c) 2019-2020 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __OCF_PROMOTION_NHC_H__
+#define __OCF_PROMOTION_NHC_H__
+
+enum ocf_nhc_param {
+	ocf_nhc_doorkeeper,
+	ocf_nhc_write_budget,
+	ocf_nhc_trickle_threshold,
+	ocf_nhc_param_max
+};
+
+/* Promote only lines accessed at least twice in recent history */
+#define OCF_NHC_DOORKEEPER_DEFAULT 1
+
+/* Cache write bandwidth for promotions in MiB/s, 0 means unlimited */
+#define OCF_NHC_MIN_WRITE_BUDGET 0
+#define OCF_NHC_MAX_WRITE_BUDGET 65536
+#define OCF_NHC_WRITE_BUDGET_DEFAULT 0
+
+/* Estimated accesses required for promotion in trickle admission mode */
+#define OCF_NHC_MIN_TRICKLE_THRESHOLD 2
+#define OCF_NHC_MAX_TRICKLE_THRESHOLD 16
+#define OCF_NHC_TRICKLE_THRESHOLD_DEFAULT 4
+
+#endif /* __OCF_PROMOTION_NHC_H__ */
@@ -0,0 +1,23 @@
+/*
+ * Copyright(c) 2019-2020 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __OCF_PROMOTION_TINYLFU_H__
+#define __OCF_PROMOTION_TINYLFU_H__
+
+enum ocf_tinylfu_param {
+	ocf_tinylfu_insertion_threshold,
+	ocf_tinylfu_trigger_threshold,
+	ocf_tinylfu_param_max
+};
+
+#define OCF_TINYLFU_MIN_THRESHOLD 1
+#define OCF_TINYLFU_MAX_THRESHOLD 16
+#define OCF_TINYLFU_THRESHOLD_DEFAULT 3
+
+#define OCF_TINYLFU_MIN_TRIGGER 0
+#define OCF_TINYLFU_MAX_TRIGGER 100
+#define OCF_TINYLFU_TRIGGER_DEFAULT 80
+
+#endif /* __OCF_PROMOTION_TINYLFU_H__ */
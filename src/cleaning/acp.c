@@ -278,14 +278,18 @@ void cleaning_policy_acp_setup(struct ocf_cache *cache)
 
 	config->thread_wakeup_time = OCF_ACP_DEFAULT_WAKE_UP;
 	config->flush_max_buffers = OCF_ACP_DEFAULT_FLUSH_MAX_BUFFERS;
+	config->rate_limit = OCF_ACP_DEFAULT_RATE_LIMIT;
 }
 
 int cleaning_policy_acp_initialize(struct ocf_cache *cache,
 		int init_metadata)
 {
+	struct acp_cleaning_policy_config *config;
 	struct acp_context *acp;
 	int err, i;
 
+	config = (void *)&cache->conf_meta->cleaning[ocf_cleaning_acp].data;
+
 	/* bug if max chunk number would overflow dirty_no array type */
 #if defined (BUILD_BUG_ON)
 	BUILD_BUG_ON(ACP_CHUNK_SIZE / ocf_cache_line_size_min >=
@@ -328,6 +332,7 @@ int cleaning_policy_acp_initialize(struct ocf_cache *cache,
 	}
 
 	_acp_rebuild(cache);
+	ocf_cleaner_set_rate_limit(cache, config->rate_limit);
 	ocf_kick_cleaner(cache);
 
 	return 0;
@@ -361,6 +366,18 @@ int cleaning_policy_acp_set_cleaning_param(ocf_cache_t cache,
 			"buffers flushed per iteration: %d\n",
 			config->flush_max_buffers);
 		break;
+	case ocf_acp_rate_limit:
+		OCF_CLEANING_CHECK_PARAM(cache, param_value,
+				OCF_ACP_MIN_RATE_LIMIT,
+				OCF_ACP_MAX_RATE_LIMIT,
+				"rate_limit");
+		config->rate_limit = param_value;
+		if (cache->conf_meta->cleaning_policy_type ==
+				ocf_cleaning_acp) {
+			ocf_cleaner_set_rate_limit(cache, param_value);
+		}
+		OCF_DEBUG_PARAM(cache, "rate limit %u MiB/s", param_value);
+		break;
 	default:
 		return -OCF_ERR_INVAL;
 	}
@@ -382,6 +399,9 @@ int cleaning_policy_acp_get_cleaning_param(ocf_cache_t cache,
 	case ocf_acp_wake_up_time:
 		*param_value = config->thread_wakeup_time;
 		break;
+	case ocf_acp_rate_limit:
+		*param_value = config->rate_limit;
+		break;
 	default:
 		return -OCF_ERR_INVAL;
 	}
@@ -396,8 +416,10 @@ static ocf_cache_line_t _acp_trylock_dirty(struct ocf_cache *cache,
 {
 	struct ocf_map_info info;
 	bool locked = false;
+	env_atomic *reader;
 
-	ocf_metadata_hash_lock_rd(&cache->metadata.lock, core_id, core_line);
+	reader = ocf_metadata_hash_lock_rd(&cache->metadata.lock, core_id,
+			core_line);
 
 	ocf_engine_lookup_map_entry(cache, &info, core_id,
 			core_line);
@@ -408,7 +430,8 @@ static ocf_cache_line_t _acp_trylock_dirty(struct ocf_cache *cache,
 		locked = true;
 	}
 
-	ocf_metadata_hash_unlock_rd(&cache->metadata.lock, core_id, core_line);
+	ocf_metadata_hash_unlock_rd(&cache->metadata.lock, core_id, core_line,
+			reader);
 
 	return locked ? info.coll_idx : cache->device->collision_table_entries;
 }
@@ -556,9 +579,18 @@ void cleaning_policy_acp_perform_cleaning(ocf_cache_t cache,
 	struct acp_cleaning_policy_config *config;
 	struct acp_context *acp = _acp_get_ctx_from_cache(cache);
 	struct acp_state *state = &acp->state;
+	uint32_t flush_max_buffers;
 
 	acp->cmpl = cmpl;
 
+	config = (void *)&cache->conf_meta->cleaning[ocf_cleaning_acp].data;
+
+	flush_max_buffers = ocf_cleaner_pace(cache, config->flush_max_buffers);
+	if (!flush_max_buffers) {
+		cmpl(&cache->cleaner, ocf_cleaner_pace_delay(cache));
+		return;
+	}
+
 	if (!state->in_progress) {
 		/* get next chunk to clean */
 		state->chunk = _acp_get_cleaning_candidate(cache);
@@ -576,12 +608,12 @@ void cleaning_policy_acp_perform_cleaning(ocf_cache_t cache,
 
 	ACP_DEBUG_INIT(acp);
 
-	config = (void *)&cache->conf_meta->cleaning[ocf_cleaning_acp].data;
-
-	if (_acp_prepare_flush_data(acp, config->flush_max_buffers))
+	if (_acp_prepare_flush_data(acp, flush_max_buffers)) {
+		ocf_cleaner_pace_consume(cache, acp->flush.size);
 		_acp_flush(acp);
-	else
+	} else {
 		_acp_flush_end(acp, 0);
+	}
 }
 
 static void _acp_update_bucket(struct acp_context *acp,
@@ -16,6 +16,7 @@ struct acp_cleaning_policy_meta {
 struct acp_cleaning_policy_config {
 	uint32_t thread_wakeup_time;	/* in milliseconds*/
 	uint32_t flush_max_buffers;	/* in lines */
+	uint32_t rate_limit;		/* in MiB/s, 0 - unlimited */
 };
 
 #endif
@@ -11,6 +11,7 @@
 #include "../utils/utils_cleaner.h"
 #include "../utils/utils_part.h"
 #include "../utils/utils_realloc.h"
+#include "../utils/utils_freq_sketch.h"
 #include "../concurrency/ocf_cache_line_concurrency.h"
 #include "../ocf_def_priv.h"
 #include "cleaning_priv.h"
@@ -43,9 +44,16 @@
 #define OCF_DEBUG_PARAM(cache, format, ...)
 #endif
 
+/* Hot dirty lines waiting to be cleaned ahead of age order */
+#define ALRU_HOT_QUEUE_SIZE 4096
+
+/* Cache lines per dirty hit sketch counter */
+#define ALRU_HOT_SKETCH_RATIO 4
+
 struct alru_flush_ctx {
 	struct ocf_cleaner_attribs attribs;
 	bool flush_perfomed;
+	bool paced;
 	uint32_t clines_no;
 	ocf_cache_t cache;
 	ocf_cleaner_end_t cmpl;
@@ -53,8 +61,19 @@ struct alru_flush_ctx {
 	size_t flush_data_limit;
 };
 
+struct alru_hot_queue {
+	env_spinlock lock;
+	struct ocf_freq_sketch *sketch;
+	/* Lines present in queue or collected for current flush */
+	unsigned long *queued;
+	uint32_t head;
+	uint32_t count;
+	ocf_cache_line_t lines[ALRU_HOT_QUEUE_SIZE];
+};
+
 struct alru_context {
 	struct alru_flush_ctx flush_ctx;
+	struct alru_hot_queue hot;
 	env_spinlock list_lock[OCF_IO_CLASS_MAX];
 };
 
@@ -397,6 +416,86 @@ void cleaning_policy_alru_set_hot_cache_line(struct ocf_cache *cache,
 	env_spinlock_unlock(&alru->list_lock[part_id]);
 }
 
+/*
+ * Track read hits to dirty lines, which can't be offloaded to core. Lines
+ * hit often enough are queued to be cleaned before the age ordered ones.
+ */
+void cleaning_policy_alru_dirty_hit(struct ocf_cache *cache,
+		ocf_core_id_t core_id, uint64_t core_line, uint32_t cache_line)
+{
+	struct alru_context *alru = cache->cleaner.cleaning_policy_context;
+	struct alru_hot_queue *hot = &alru->hot;
+	struct alru_cleaning_policy_config *config;
+	uint64_t hash;
+	bool kick = false;
+
+	config = (void *)&cache->conf_meta->cleaning[ocf_cleaning_alru].data;
+
+	if (!config->hot_threshold)
+		return;
+
+	/* Already waiting for cleaner */
+	if (env_bit_test(cache_line, hot->queued))
+		return;
+
+	hash = ocf_freq_sketch_hash(core_id, core_line);
+	ocf_freq_sketch_record(hot->sketch, hash);
+	if (ocf_freq_sketch_estimate(hot->sketch, hash) < config->hot_threshold)
+		return;
+
+	env_spinlock_lock(&hot->lock);
+
+	if (hot->count < ALRU_HOT_QUEUE_SIZE &&
+			!env_bit_test(cache_line, hot->queued)) {
+		env_bit_set(cache_line, hot->queued);
+		hot->lines[(hot->head + hot->count) % ALRU_HOT_QUEUE_SIZE] =
+				cache_line;
+		kick = (hot->count++ == 0);
+	}
+
+	env_spinlock_unlock(&hot->lock);
+
+	if (kick)
+		ocf_kick_cleaner(cache);
+}
+
+static int _alru_hot_init(struct ocf_cache *cache, struct alru_hot_queue *hot)
+{
+	uint32_t entries = cache->device->collision_table_entries;
+	int error;
+
+	hot->sketch = ocf_freq_sketch_create(
+			OCF_DIV_ROUND_UP(entries, ALRU_HOT_SKETCH_RATIO));
+	if (!hot->sketch)
+		return -OCF_ERR_NO_MEM;
+
+	hot->queued = env_vzalloc(OCF_DIV_ROUND_UP(entries,
+			8 * sizeof(long)) * sizeof(long));
+	if (!hot->queued) {
+		error = -OCF_ERR_NO_MEM;
+		goto err_queued;
+	}
+
+	error = env_spinlock_init(&hot->lock);
+	if (error)
+		goto err_lock;
+
+	return 0;
+
+err_lock:
+	env_vfree(hot->queued);
+err_queued:
+	ocf_freq_sketch_destroy(hot->sketch);
+	return error;
+}
+
+static void _alru_hot_deinit(struct alru_hot_queue *hot)
+{
+	env_spinlock_destroy(&hot->lock);
+	env_vfree(hot->queued);
+	ocf_freq_sketch_destroy(hot->sketch);
+}
+
 static void _alru_rebuild(struct ocf_cache *cache)
 {
 	struct ocf_user_part *part;
@@ -460,6 +559,8 @@ void cleaning_policy_alru_setup(struct ocf_cache *cache)
 	config->stale_buffer_time = OCF_ALRU_DEFAULT_STALENESS_TIME;
 	config->flush_max_buffers = OCF_ALRU_DEFAULT_FLUSH_MAX_BUFFERS;
 	config->activity_threshold = OCF_ALRU_DEFAULT_ACTIVITY_THRESHOLD;
+	config->rate_limit = OCF_ALRU_DEFAULT_RATE_LIMIT;
+	config->hot_threshold = OCF_ALRU_DEFAULT_HOT_THRESHOLD;
 }
 
 int cleaning_policy_alru_initialize(ocf_cache_t cache, int init_metadata)
@@ -467,9 +568,12 @@ int cleaning_policy_alru_initialize(ocf_cache_t cache, int init_metadata)
 	struct ocf_user_part *part;
 	ocf_part_id_t part_id;
 	struct alru_context *alru;
+	struct alru_cleaning_policy_config *config;
 	int error = 0;
 	unsigned i;
 
+	config = (void *)&cache->conf_meta->cleaning[ocf_cleaning_alru].data;
+
 	alru = env_vzalloc(sizeof(*alru));
 	if (!alru) {
 		ocf_cache_log(cache, log_err, "alru context allocation error\n");
@@ -482,6 +586,9 @@ int cleaning_policy_alru_initialize(ocf_cache_t cache, int init_metadata)
 			break;
 	}
 
+	if (!error)
+		error = _alru_hot_init(cache, &alru->hot);
+
 	if (error) {
 		while (i--)
 			env_spinlock_destroy(&alru->list_lock[i]);
@@ -500,6 +607,7 @@ int cleaning_policy_alru_initialize(ocf_cache_t cache, int init_metadata)
 	if (init_metadata)
 		_alru_rebuild(cache);
 
+	ocf_cleaner_set_rate_limit(cache, config->rate_limit);
 	ocf_kick_cleaner(cache);
 
 	return 0;
@@ -510,6 +618,8 @@ void cleaning_policy_alru_deinitialize(struct ocf_cache *cache)
 	struct alru_context *alru = cache->cleaner.cleaning_policy_context;
 	unsigned i;
 
+	_alru_hot_deinit(&alru->hot);
+
 	for (i = 0; i < OCF_IO_CLASS_MAX; i++)
 		env_spinlock_destroy(&alru->list_lock[i]);
 
@@ -564,6 +674,28 @@ int cleaning_policy_alru_set_cleaning_param(ocf_cache_t cache,
 				"activity time threshold: %d\n",
 				config->activity_threshold);
 		break;
+	case ocf_alru_rate_limit:
+		OCF_CLEANING_CHECK_PARAM(cache, param_value,
+				OCF_ALRU_MIN_RATE_LIMIT,
+				OCF_ALRU_MAX_RATE_LIMIT,
+				"rate_limit");
+		config->rate_limit = param_value;
+		if (cache->conf_meta->cleaning_policy_type ==
+				ocf_cleaning_alru) {
+			ocf_cleaner_set_rate_limit(cache, param_value);
+		}
+		OCF_DEBUG_PARAM(cache, "rate limit %u MiB/s", param_value);
+		break;
+	case ocf_alru_hot_threshold:
+		OCF_CLEANING_CHECK_PARAM(cache, param_value,
+				OCF_ALRU_MIN_HOT_THRESHOLD,
+				OCF_ALRU_MAX_HOT_THRESHOLD,
+				"hot_threshold");
+		config->hot_threshold = param_value;
+		ocf_cache_log(cache, log_info, "Write-back flush thread hot "
+				"dirty line threshold: %d\n",
+				config->hot_threshold);
+		break;
 	default:
 		return -OCF_ERR_INVAL;
 	}
@@ -591,6 +723,12 @@ int cleaning_policy_alru_get_cleaning_param(ocf_cache_t cache,
 	case ocf_alru_activity_threshold:
 		*param_value = config->activity_threshold;
 		break;
+	case ocf_alru_rate_limit:
+		*param_value = config->rate_limit;
+		break;
+	case ocf_alru_hot_threshold:
+		*param_value = config->hot_threshold;
+		break;
 	default:
 		return -OCF_ERR_INVAL;
 	}
@@ -639,12 +777,21 @@ static bool clean_later(ocf_cache_t cache, uint32_t *delta)
 
 static bool is_cleanup_possible(ocf_cache_t cache)
 {
+	struct alru_context *alru = cache->cleaner.cleaning_policy_context;
 	struct alru_cleaning_policy_config *config;
 	uint32_t delta;
 
 	config = (void *)&cache->conf_meta->cleaning[ocf_cleaning_alru].data;
 
-	if (check_for_io_activity(cache, config)) {
+	/* Hot dirty lines pin read hits to cache volume, so they are
+	 * cleaned without waiting for idle or wake up time */
+	if (alru->hot.count && config->flush_max_buffers)
+		return true;
+
+	/* With rate limit set, cleaning is paced instead of waiting
+	 * for idle */
+	if (!ocf_cleaner_is_paced(cache) &&
+			check_for_io_activity(cache, config)) {
 		OCF_DEBUG_PARAM(cache, "IO activity detected");
 		return false;
 	}
@@ -712,6 +859,37 @@ static bool block_is_busy(struct ocf_cache *cache,
 	return false;
 }
 
+static int get_hot_data_to_flush(struct alru_context *alru)
+{
+	struct alru_flush_ctx *fctx = &alru->flush_ctx;
+	struct alru_hot_queue *hot = &alru->hot;
+	ocf_cache_t cache = fctx->cache;
+	ocf_cache_line_t cache_line;
+	int to_flush = 0;
+
+	env_spinlock_lock(&hot->lock);
+
+	while (hot->count && to_flush < fctx->clines_no) {
+		cache_line = hot->lines[hot->head];
+		hot->head = (hot->head + 1) % ALRU_HOT_QUEUE_SIZE;
+		hot->count--;
+
+		/* Line might have been cleaned or remapped since queued */
+		if (metadata_test_dirty(cache, cache_line) &&
+				!block_is_busy(cache, cache_line)) {
+			get_block_to_flush(&fctx->flush_data[to_flush],
+					cache_line, cache);
+			to_flush++;
+		} else {
+			env_bit_clear(cache_line, hot->queued);
+		}
+	}
+
+	env_spinlock_unlock(&hot->lock);
+
+	return to_flush;
+}
+
 static int get_data_to_flush(struct alru_context *alru)
 {
 	struct alru_flush_ctx *fctx = &alru->flush_ctx;
@@ -721,11 +899,13 @@ static int get_data_to_flush(struct alru_context *alru)
 	ocf_cache_line_t cache_line;
 	struct ocf_user_part *part;
 	uint32_t last_access;
-	int to_flush = 0;
+	int to_flush, hot_no, i;
 	int part_id = OCF_IO_CLASS_ID_MAX;
 
 	config = (void *)&cache->conf_meta->cleaning[ocf_cleaning_alru].data;
 
+	to_flush = hot_no = get_hot_data_to_flush(alru);
+
 	for_each_part(cache, part, part_id) {
 		env_spinlock_lock(&alru->list_lock[part_id]);
 
@@ -743,7 +923,10 @@ static int get_data_to_flush(struct alru_context *alru)
 				goto end;
 			}
 
-			if (!block_is_busy(cache, cache_line)) {
+			/* Skip hot lines, already collected or queued */
+			if (!block_is_busy(cache, cache_line) &&
+					!env_bit_test(cache_line,
+						alru->hot.queued)) {
 				get_block_to_flush(&fctx->flush_data[to_flush], cache_line,
 						cache);
 				to_flush++;
@@ -757,7 +940,13 @@ static int get_data_to_flush(struct alru_context *alru)
 	}
 
 end:
-	OCF_DEBUG_PARAM(cache, "Collected items_to_clean=%u", to_flush);
+	for (i = 0; i < hot_no; i++) {
+		env_bit_clear(fctx->flush_data[i].cache_line,
+				alru->hot.queued);
+	}
+
+	OCF_DEBUG_PARAM(cache, "Collected items_to_clean=%u, hot=%u",
+			to_flush, hot_no);
 
 	return to_flush;
 }
@@ -773,7 +962,12 @@ static void alru_clean_complete(void *priv, int err)
 
 	config = (void *)&cache->conf_meta->cleaning[ocf_cleaning_alru].data;
 
-	interval = fctx->flush_perfomed ? 0 : config->thread_wakeup_time * 1000;
+	if (fctx->paced)
+		interval = ocf_cleaner_pace_delay(cache);
+	else if (fctx->flush_perfomed)
+		interval = 0;
+	else
+		interval = config->thread_wakeup_time * 1000;
 
 	fctx->cmpl(&fctx->cache->cleaner, interval);
 }
@@ -789,6 +983,13 @@ static void alru_clean(struct alru_context *alru)
 		return;
 	}
 
+	fctx->clines_no = ocf_cleaner_pace(cache, fctx->clines_no);
+	if (!fctx->clines_no) {
+		fctx->paced = true;
+		alru_clean_complete(fctx, 0);
+		return;
+	}
+
 	if (ocf_metadata_try_start_exclusive_access(&cache->metadata.lock)) {
 		alru_clean_complete(fctx, 0);
 		return;
@@ -805,6 +1006,7 @@ static void alru_clean(struct alru_context *alru)
 	to_clean = get_data_to_flush(alru);
 	if (to_clean > 0) {
 		fctx->flush_perfomed = true;
+		ocf_cleaner_pace_consume(cache, to_clean);
 		ocf_cleaner_do_flush_data_async(cache, fctx->flush_data, to_clean,
 				&fctx->attribs);
 		ocf_metadata_end_exclusive_access(&cache->metadata.lock);
@@ -840,6 +1042,7 @@ void cleaning_alru_perform_cleaning(ocf_cache_t cache, ocf_cleaner_end_t cmpl)
 	fctx->cache = cache;
 	fctx->cmpl = cmpl;
 	fctx->flush_perfomed = false;
+	fctx->paced = false;
 
 	alru_clean(alru);
 }
@@ -20,6 +20,8 @@ int cleaning_policy_alru_purge_range(ocf_cache_t cache, int core_id,
 		uint64_t start_byte, uint64_t end_byte);
 void cleaning_policy_alru_set_hot_cache_line(ocf_cache_t cache,
 		uint32_t cache_line);
+void cleaning_policy_alru_dirty_hit(ocf_cache_t cache, ocf_core_id_t core_id,
+		uint64_t core_line, uint32_t cache_line);
 int cleaning_policy_alru_set_cleaning_param(ocf_cache_t cache,
 		uint32_t param_id, uint32_t param_value);
 int cleaning_policy_alru_get_cleaning_param(ocf_cache_t cache,
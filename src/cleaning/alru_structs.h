@@ -20,6 +20,8 @@ struct alru_cleaning_policy_config {
 	uint32_t stale_buffer_time;	/* in seconds */
 	uint32_t flush_max_buffers;	/* in lines */
 	uint32_t activity_threshold;	/* in milliseconds */
+	uint32_t rate_limit;		/* in MiB/s, 0 - unlimited */
+	uint32_t hot_threshold;		/* in dirty hits, 0 - disabled */
 };
 
 struct alru_cleaning_policy {
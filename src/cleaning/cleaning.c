@@ -13,6 +13,8 @@
 #include "../mngt/ocf_mngt_common.h"
 #include "../metadata/metadata.h"
 #include "../ocf_queue_priv.h"
+#include "../utils/utils_cache_line.h"
+#include "../engine/cache_engine.h"
 
 struct cleaning_policy_ops cleaning_policy_ops[ocf_cleaning_max] = {
 	[ocf_cleaning_nop] = {
@@ -25,6 +27,7 @@ struct cleaning_policy_ops cleaning_policy_ops[ocf_cleaning_max] = {
 		.purge_cache_block = cleaning_policy_alru_purge_cache_block,
 		.purge_range = cleaning_policy_alru_purge_range,
 		.set_hot_cache_line = cleaning_policy_alru_set_hot_cache_line,
+		.dirty_hit = cleaning_policy_alru_dirty_hit,
 		.initialize = cleaning_policy_alru_initialize,
 		.deinitialize = cleaning_policy_alru_deinitialize,
 		.set_cleaning_param = cleaning_policy_alru_set_cleaning_param,
@@ -64,6 +67,96 @@ void ocf_kick_cleaner(ocf_cache_t cache)
 	ctx_cleaner_kick(cache->owner, &cache->cleaner);
 }
 
+static inline uint64_t _ocf_cleaner_pace_burst(uint64_t rate)
+{
+	return OCF_MAX(rate / 10, (uint64_t)MiB);
+}
+
+/* Rate limit in MiB/s, 0 means unlimited */
+void ocf_cleaner_set_rate_limit(ocf_cache_t cache, uint32_t rate_limit)
+{
+	uint64_t rate = (uint64_t)rate_limit * MiB;
+
+	ocf_token_bucket_init(&cache->cleaner.pacing, rate,
+			_ocf_cleaner_pace_burst(rate));
+}
+
+/*
+ * Pace rate in bytes/s, 0 means unlimited. Unlike rate limit set by
+ * cleaning policy parameter, tokens left in bucket are kept, so that
+ * it may be retuned often without exclusive access.
+ */
+void ocf_cleaner_set_pace_rate(ocf_cache_t cache, uint64_t rate)
+{
+	ocf_token_bucket_set_rate(&cache->cleaner.pacing, rate,
+			_ocf_cleaner_pace_burst(rate));
+}
+
+bool ocf_cleaner_is_paced(ocf_cache_t cache)
+{
+	return !!ocf_token_bucket_rate(&cache->cleaner.pacing);
+}
+
+/* Number of lines, at most given one, which may be cleaned now */
+uint32_t ocf_cleaner_pace(ocf_cache_t cache, uint32_t lines)
+{
+	struct ocf_token_bucket *tb = &cache->cleaner.pacing;
+
+	if (!ocf_token_bucket_rate(tb))
+		return lines;
+
+	ocf_token_bucket_refill(tb);
+
+	return OCF_MIN((uint64_t)lines,
+			env_atomic64_read(&tb->tokens) / ocf_line_size(cache));
+}
+
+/* Charge lines actually sent for cleaning, not more than last pace */
+void ocf_cleaner_pace_consume(ocf_cache_t cache, uint32_t lines)
+{
+	ocf_token_bucket_take(&cache->cleaner.pacing,
+			(uint64_t)lines * ocf_line_size(cache));
+}
+
+/* Time in ms after which at least one line may be cleaned */
+uint32_t ocf_cleaner_pace_delay(ocf_cache_t cache)
+{
+	uint64_t rate = ocf_token_bucket_rate(&cache->cleaner.pacing);
+
+	if (!rate)
+		return 0;
+
+	return OCF_DIV_ROUND_UP(ocf_line_size(cache) * 1000, rate);
+}
+
+/*
+ * Report read hit to dirty cache lines, which has to be serviced from cache
+ * volume. Dirty state is taken from request lookup, lines are held by
+ * request cache line locks, so no metadata lock is needed.
+ */
+void ocf_cleaning_req_dirty_hit(struct ocf_request *req)
+{
+	ocf_cache_t cache = req->cache;
+	ocf_cleaning_t type = cache->conf_meta->cleaning_policy_type;
+	ocf_core_id_t core_id = ocf_core_get_id(req->core);
+	struct ocf_map_info *entry;
+	uint32_t i;
+
+	ENV_BUG_ON(type >= ocf_cleaning_max);
+
+	if (!cleaning_policy_ops[type].dirty_hit)
+		return;
+
+	for (i = 0; i < req->core_line_count; i++) {
+		entry = &req->map[i];
+
+		if (entry->status == LOOKUP_HIT && entry->dirty) {
+			cleaning_policy_ops[type].dirty_hit(cache, core_id,
+					entry->core_line, entry->coll_idx);
+		}
+	}
+}
+
 void ocf_cleaner_set_cmpl(ocf_cleaner_t cleaner, ocf_cleaner_end_t fn)
 {
 	cleaner->end = fn;
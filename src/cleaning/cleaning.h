@@ -10,6 +10,7 @@
 #include "nop_structs.h"
 #include "acp_structs.h"
 #include "ocf/ocf_cleaner.h"
+#include "../utils/utils_token_bucket.h"
 
 #define CLEANING_POLICY_CONFIG_BYTES 256
 #define CLEANING_POLICY_TYPE_MAX 4
@@ -49,6 +50,8 @@ struct cleaning_policy_ops {
 	int (*purge_range)(ocf_cache_t cache, int core_id,
 			uint64_t start_byte, uint64_t end_byte);
 	void (*set_hot_cache_line)(ocf_cache_t cache, uint32_t cache_line);
+	void (*dirty_hit)(ocf_cache_t cache, ocf_core_id_t core_id,
+			uint64_t core_line, uint32_t cache_line);
 	int (*set_cleaning_param)(ocf_cache_t cache, uint32_t param_id,
 			uint32_t param_value);
 	int (*get_cleaning_param)(ocf_cache_t cache, uint32_t param_id,
@@ -64,6 +67,8 @@ struct ocf_cleaner {
 	ocf_queue_t io_queue;
 	ocf_cleaner_end_t end;
 	void *priv;
+	/* Limits core writes issued by cleaning policy, in bytes/s */
+	struct ocf_token_bucket pacing;
 };
 
 int ocf_start_cleaner(ocf_cache_t cache);
@@ -72,4 +77,18 @@ void ocf_kick_cleaner(ocf_cache_t cache);
 
 void ocf_stop_cleaner(ocf_cache_t cache);
 
+void ocf_cleaner_set_rate_limit(ocf_cache_t cache, uint32_t rate_limit);
+
+void ocf_cleaner_set_pace_rate(ocf_cache_t cache, uint64_t rate);
+
+bool ocf_cleaner_is_paced(ocf_cache_t cache);
+
+uint32_t ocf_cleaner_pace(ocf_cache_t cache, uint32_t lines);
+
+void ocf_cleaner_pace_consume(ocf_cache_t cache, uint32_t lines);
+
+uint32_t ocf_cleaner_pace_delay(ocf_cache_t cache);
+
+void ocf_cleaning_req_dirty_hit(struct ocf_request *req);
+
 #endif
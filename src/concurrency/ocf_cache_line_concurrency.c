@@ -35,26 +35,26 @@
 
 #define _WAITERS_LIST_ITEM(cache_line) ((cache_line) % _WAITERS_LIST_ENTRIES)
 
-struct __waiter {
-	ocf_cache_line_t line;
-	void *ctx;
-	uint32_t ctx_id;
-	ocf_req_async_lock_cb cb;
-	struct list_head item;
-	int rw;
-};
+#define _WAITER(iter) (list_entry(iter, struct ocf_map_waiter, item))
 
 struct __waiters_list {
 	struct list_head head;
 	env_spinlock lock;
 };
 
+/*
+ * Waiters are preallocated with request map, linked on hashed waiters lists.
+ * Every cache line has also a waiter bit, set under waiters list lock
+ * before lock attempt of request which is going to wait, and cleared once
+ * no waiter for the line is left. Lock and unlock of line without waiters
+ * use atomics only and never touch waiters list.
+ */
 struct ocf_cache_line_concurrency {
-	env_rwsem lock;
+	env_mutex lock;
 	env_atomic *access;
+	unsigned long *waiting_lines;
 	env_atomic waiting;
 	size_t access_limit;
-	env_allocator *allocator;
 	struct __waiters_list waiters_lsts[_WAITERS_LIST_ENTRIES];
 
 };
@@ -63,15 +63,11 @@ struct ocf_cache_line_concurrency {
  *
  */
 
-#define ALLOCATOR_NAME_FMT "ocf_%s_cache_concurrency"
-#define ALLOCATOR_NAME_MAX (sizeof(ALLOCATOR_NAME_FMT) + OCF_CACHE_NAME_SIZE)
-
 int ocf_cache_line_concurrency_init(struct ocf_cache *cache)
 {
 	uint32_t i;
 	int error = 0;
 	struct ocf_cache_line_concurrency *c;
-	char name[ALLOCATOR_NAME_MAX];
 	ocf_cache_line_t line_entries = ocf_metadata_collision_table_entries(
 						cache);
 
@@ -79,13 +75,13 @@ int ocf_cache_line_concurrency_init(struct ocf_cache *cache)
 
 	OCF_DEBUG_TRACE(cache);
 
-	c = env_vmalloc(sizeof(*c));
+	c = env_vzalloc(sizeof(*c));
 	if (!c) {
 		error = __LINE__;
 		goto ocf_cache_line_concurrency_init;
 	}
 
-	error = env_rwsem_init(&c->lock);
+	error = env_mutex_init(&c->lock);
 	if (error) {
 		env_vfree(c);
 		error = __LINE__;
@@ -103,14 +99,9 @@ int ocf_cache_line_concurrency_init(struct ocf_cache *cache)
 		goto ocf_cache_line_concurrency_init;
 	}
 
-	if (snprintf(name, sizeof(name), ALLOCATOR_NAME_FMT,
-			ocf_cache_get_name(cache)) < 0) {
-		error = __LINE__;
-		goto ocf_cache_line_concurrency_init;
-	}
-
-	c->allocator = env_allocator_create(sizeof(struct __waiter), name);
-	if (!c->allocator) {
+	c->waiting_lines = env_vzalloc(OCF_DIV_ROUND_UP(line_entries,
+			sizeof(unsigned long) * 8) * sizeof(unsigned long));
+	if (!c->waiting_lines) {
 		error = __LINE__;
 		goto ocf_cache_line_concurrency_init;
 	}
@@ -153,7 +144,7 @@ void ocf_cache_line_concurrency_deinit(struct ocf_cache *cache)
 
 	concurrency = cache->device->concurrency.cache_line;
 
-	env_rwsem_destroy(&concurrency->lock);
+	env_mutex_destroy(&concurrency->lock);
 
 	for (i = 0; i < _WAITERS_LIST_ENTRIES; i++)
 		env_spinlock_destroy(&concurrency->waiters_lsts[i].lock);
@@ -162,8 +153,7 @@ void ocf_cache_line_concurrency_deinit(struct ocf_cache *cache)
 		OCF_REALLOC_DEINIT(&concurrency->access,
 				&concurrency->access_limit);
 
-	if (concurrency->allocator)
-		env_allocator_destroy(concurrency->allocator);
+	env_vfree(concurrency->waiting_lines);
 
 	env_vfree(concurrency);
 	cache->device->concurrency.cache_line = NULL;
@@ -176,6 +166,9 @@ size_t ocf_cache_line_concurrency_size_of(struct ocf_cache *cache)
 	size = sizeof(env_atomic);
 	size *= cache->device->collision_table_entries;
 
+	size += OCF_DIV_ROUND_UP(cache->device->collision_table_entries,
+			sizeof(unsigned long) * 8) * sizeof(unsigned long);
+
 	size += sizeof(struct ocf_cache_line_concurrency);
 
 	return size;
@@ -184,6 +177,15 @@ size_t ocf_cache_line_concurrency_size_of(struct ocf_cache *cache)
 /*
  *
  */
+static inline bool __waiter_bit(struct ocf_cache_line_concurrency *c,
+		ocf_cache_line_t line)
+{
+	return env_bit_test(line, c->waiting_lines);
+}
+
+/*
+ * Must be called under waiters list lock
+ */
 static inline bool __are_waiters(struct ocf_cache_line_concurrency *c,
 		ocf_cache_line_t line)
 {
@@ -191,16 +193,13 @@ static inline bool __are_waiters(struct ocf_cache_line_concurrency *c,
 	struct list_head *iter;
 	uint32_t idx = _WAITERS_LIST_ITEM(line);
 	struct __waiters_list *lst = &c->waiters_lsts[idx];
-	struct __waiter *waiter;
 
-	/* If list empty that means there are no waiters on cache line */
-	if (list_empty(&lst->head))
+	/* No waiter bit means there are no waiters on cache line */
+	if (!__waiter_bit(c, line))
 		return false;
 
 	list_for_each(iter, &lst->head) {
-		waiter = list_entry(iter, struct __waiter, item);
-
-		if (waiter->line == line) {
+		if (_WAITER(iter)->line == line) {
 			are = true;
 			break;
 		}
@@ -209,15 +208,29 @@ static inline bool __are_waiters(struct ocf_cache_line_concurrency *c,
 	return are;
 }
 
+/*
+ * Clear waiter bit if no waiter for the line is left, must be called under
+ * waiters list lock
+ */
+static inline void __update_waiter_bit(struct ocf_cache_line_concurrency *c,
+		ocf_cache_line_t line)
+{
+	if (!__are_waiters(c, line))
+		env_bit_clear(line, c->waiting_lines);
+}
+
 /*
  *
  */
 static inline void __add_waiter(struct ocf_cache_line_concurrency *c,
-		ocf_cache_line_t line, struct __waiter *waiter)
+		ocf_cache_line_t line, struct ocf_request *req, uint32_t ctx_id)
 {
 	uint32_t idx = _WAITERS_LIST_ITEM(line);
 	struct __waiters_list *lst = &c->waiters_lsts[idx];
+	struct ocf_map_waiter *waiter = &req->waiters[ctx_id];
 
+	waiter->req = req;
+	waiter->line = line;
 	list_add_tail(&waiter->item, &lst->head);
 }
 
@@ -278,15 +291,17 @@ static inline bool __try_lock_rd(struct ocf_cache_line_concurrency *c,
 }
 
 /*
- *
+ * Release is a full barrier, so unlocker either sees waiter bit set by
+ * request about to wait or that request lock attempt sees released line
  */
 static inline void __unlock_wr(struct ocf_cache_line_concurrency *c,
 		ocf_cache_line_t line)
 {
 	env_atomic *access = &c->access[line];
+	int prev = env_atomic_cmpxchg(access, OCF_CACHE_LINE_ACCESS_WR,
+			OCF_CACHE_LINE_ACCESS_IDLE);
 
-	ENV_BUG_ON(env_atomic_read(access) != OCF_CACHE_LINE_ACCESS_WR);
-	env_atomic_set(access, OCF_CACHE_LINE_ACCESS_IDLE);
+	ENV_BUG_ON(prev != OCF_CACHE_LINE_ACCESS_WR);
 }
 
 /*
@@ -305,70 +320,9 @@ static inline void __unlock_rd(struct ocf_cache_line_concurrency *c,
 /*
  *
  */
-static inline bool __try_lock_wr2wr(struct ocf_cache_line_concurrency *c,
-		ocf_cache_line_t line)
-{
-	env_atomic *access = &c->access[line];
-
-	ENV_BUG_ON(env_atomic_read(access) != OCF_CACHE_LINE_ACCESS_WR);
-	return true;
-}
-
-/*
- *
- */
-static inline bool __try_lock_wr2rd(struct ocf_cache_line_concurrency *c,
-		ocf_cache_line_t line)
+static void _req_on_lock(struct ocf_request *req, uint32_t ctx_id,
+		ocf_cache_line_t line, int rw)
 {
-	env_atomic *access = &c->access[line];
-
-	ENV_BUG_ON(env_atomic_read(access) != OCF_CACHE_LINE_ACCESS_WR);
-	env_atomic_set(access, OCF_CACHE_LINE_ACCESS_ONE_RD);
-	return true;
-}
-
-/*
- *
- */
-static inline bool __try_lock_rd2wr(struct ocf_cache_line_concurrency *c,
-		ocf_cache_line_t line)
-{
-	env_atomic *access = &c->access[line];
-
-	int v = env_atomic_read(access);
-
-	ENV_BUG_ON(v == OCF_CACHE_LINE_ACCESS_IDLE);
-	ENV_BUG_ON(v == OCF_CACHE_LINE_ACCESS_WR);
-
-	v = env_atomic_cmpxchg(access, OCF_CACHE_LINE_ACCESS_ONE_RD,
-			OCF_CACHE_LINE_ACCESS_WR);
-
-	return (v == OCF_CACHE_LINE_ACCESS_ONE_RD);
-}
-
-/*
- *
- */
-static inline bool __try_lock_rd2rd(struct ocf_cache_line_concurrency *c,
-		ocf_cache_line_t line)
-{
-	env_atomic *access = &c->access[line];
-
-	int v = env_atomic_read(access);
-
-	ENV_BUG_ON(v == OCF_CACHE_LINE_ACCESS_IDLE);
-	ENV_BUG_ON(v == OCF_CACHE_LINE_ACCESS_WR);
-
-	return true;
-}
-
-/*
- *
- */
-static void _req_on_lock(void *ctx, ocf_req_async_lock_cb cb,
-		uint32_t ctx_id, ocf_cache_line_t line, int rw)
-{
-	struct ocf_request *req = ctx;
 	struct ocf_cache_line_concurrency *c = req->cache->device->concurrency.
 			cache_line;
 
@@ -382,344 +336,188 @@ static void _req_on_lock(void *ctx, ocf_req_async_lock_cb cb,
 	if (env_atomic_dec_return(&req->lock_remaining) == 0) {
 		/* All cache line locked, resume request */
 		OCF_DEBUG_RQ(req, "Resume");
-		ENV_BUG_ON(!cb);
+		ENV_BUG_ON(!req->lock_cb);
 		env_atomic_dec(&c->waiting);
-		cb(req);
+		req->lock_cb(req);
 	}
 }
 
 /*
- *
+ * Attempt to lock cache line for write.
+ * In case cache line is locked, attempt to add request on wait list.
  */
 static inline bool __lock_cache_line_wr(struct ocf_cache_line_concurrency *c,
-		const ocf_cache_line_t line, ocf_req_async_lock_cb cb,
-		void *ctx, uint32_t ctx_id)
+		const ocf_cache_line_t line, struct ocf_request *req,
+		uint32_t ctx_id)
 {
-	struct __waiter *waiter;
 	bool locked = false;
-	bool waiting = false;
 	unsigned long flags = 0;
 
 	if (__try_lock_wr(c, line)) {
 		/* No activity before look get */
-		if (cb)
-			_req_on_lock(ctx, cb, ctx_id, line, OCF_WRITE);
+		if (req)
+			_req_on_lock(req, ctx_id, line, OCF_WRITE);
 		return true;
 	}
 
-	waiter = NULL;
-	if (cb) {
-		/* Need to create waiter */
-		waiter = env_allocator_new(c->allocator);
-		if (!waiter)
-			return false;
-	}
+	if (!req)
+		return false;
 
 	__lock_waiters_list(c, line, flags);
 
-	/* At the moment list is protected, double check if the cache line is
-	 * unlocked
+	/* Announce waiter before double checking if the cache line is
+	 * unlocked, so unlocker can not miss it
 	 */
+	env_bit_set(line, c->waiting_lines);
+
 	if (__try_lock_wr(c, line)) {
 		/* Look get */
 		locked = true;
-	} else if (cb) {
-		/* Setup waiters filed */
-		waiter->line = line;
-		waiter->ctx = ctx;
-		waiter->ctx_id = ctx_id;
-		waiter->cb = cb;
-		waiter->rw = OCF_WRITE;
-		INIT_LIST_HEAD(&waiter->item);
-
+		__update_waiter_bit(c, line);
+	} else {
 		/* Add to waiters list */
-		__add_waiter(c, line, waiter);
-		waiting = true;
+		__add_waiter(c, line, req, ctx_id);
 	}
 
 	__unlock_waiters_list(c, line, flags);
 
-	if (locked && cb)
-		_req_on_lock(ctx, cb, ctx_id, line, OCF_WRITE);
-	if (!waiting && waiter)
-		env_allocator_del(c->allocator, waiter);
+	if (locked)
+		_req_on_lock(req, ctx_id, line, OCF_WRITE);
 
-	return locked || waiting;
+	return true;
 }
 
 /*
  * Attempt to lock cache line for read.
- * In case cache line is locked,  attempt to add caller on wait list.
+ * In case cache line is locked,  attempt to add request on wait list.
  */
 static inline bool __lock_cache_line_rd(struct ocf_cache_line_concurrency *c,
-		const ocf_cache_line_t line, ocf_req_async_lock_cb cb,
-		void *ctx, uint32_t ctx_id)
+		const ocf_cache_line_t line, struct ocf_request *req,
+		uint32_t ctx_id)
 {
-	struct __waiter *waiter;
 	bool locked = false;
-	bool waiting = false;
 	unsigned long flags = 0;
 
-	if (__try_lock_rd_idle(c, line)) {
-		/* No activity before look get, it is first reader */
-		if (cb)
-			_req_on_lock(ctx, cb, ctx_id, line, OCF_READ);
+	if (__try_lock_rd_idle(c, line) ||
+			(!__waiter_bit(c, line) && __try_lock_rd(c, line))) {
+		/* No activity before look get or only other readers */
+		if (req)
+			_req_on_lock(req, ctx_id, line, OCF_READ);
 		return true;
 	}
 
-	waiter = NULL;
+	if (!req)
+		return false;
 
-repeat:
 	/* Lock waiters list */
 	__lock_waiters_list(c, line, flags);
 
 	if (!__are_waiters(c, line)) {
-		/* No waiters at the moment */
+		/* No waiters at the moment, announce the one to come and check
+		 * if read lock can be obtained */
+		env_bit_set(line, c->waiting_lines);
 
-		/* Check if read lock can be obtained */
 		if (__try_lock_rd(c, line)) {
 			/* Cache line locked */
 			locked = true;
+			env_bit_clear(line, c->waiting_lines);
 			goto unlock;
 		}
 	}
 
-	if (!cb)
-		goto unlock;
-
-	if (!waiter) {
-		/* Need to create waiters and add it into list */
-		__unlock_waiters_list(c, line, flags);
-		waiter = env_allocator_new(c->allocator);
-		if (!waiter)
-			goto end;
-		goto repeat;
-	}
-
-	/* Setup waiters field */
-	waiter->line = line;
-	waiter->ctx = ctx;
-	waiter->ctx_id = ctx_id;
-	waiter->cb = cb;
-	waiter->rw = OCF_READ;
-	INIT_LIST_HEAD(&waiter->item);
-
 	/* Add to waiters list */
-	__add_waiter(c, line, waiter);
-	waiting = true;
+	__add_waiter(c, line, req, ctx_id);
 
 unlock:
 	__unlock_waiters_list(c, line, flags);
 
-end:
-	if (locked && cb)
-		_req_on_lock(ctx, cb, ctx_id, line, OCF_READ);
-	if (!waiting && waiter)
-		env_allocator_del(c->allocator, waiter);
+	if (locked)
+		_req_on_lock(req, ctx_id, line, OCF_READ);
 
-	return locked || waiting;
+	return true;
 }
 
-static inline void __unlock_cache_line_rd_common(struct ocf_cache_line_concurrency *c,
+/*
+ * Hand cache line over to waiters after it was released, must be called
+ * under waiters list lock
+ */
+static inline void __wake_waiters(struct ocf_cache_line_concurrency *c,
 		const ocf_cache_line_t line)
 {
 	bool locked = false;
-	bool exchanged = true;
-	uint32_t i = 0;
 
 	uint32_t idx = _WAITERS_LIST_ITEM(line);
 	struct __waiters_list *lst = &c->waiters_lsts[idx];
-	struct __waiter *waiter;
+	struct ocf_map_waiter *waiter;
+	struct ocf_request *req;
 
 	struct list_head *iter, *next;
 
-	/*
-	 * Lock exchange scenario
-	 * 1. RD -> IDLE
-	 * 2. RD -> RD
-	 * 3. RD -> WR
-	 */
-
-	/* Check is requested page is on the list */
+	/* Grant lock to waiters in FIFO order until first one which can not
+	 * get it */
 	list_for_each_safe(iter, next, &lst->head) {
-		waiter = list_entry(iter, struct __waiter, item);
+		waiter = _WAITER(iter);
 
 		if (line != waiter->line)
 			continue;
 
-		if (exchanged) {
-			if (waiter->rw == OCF_WRITE)
-				locked = __try_lock_rd2wr(c, line);
-			else if (waiter->rw == OCF_READ)
-				locked = __try_lock_rd2rd(c, line);
-			else
-				ENV_BUG();
-		} else {
-			if (waiter->rw == OCF_WRITE)
-				locked = __try_lock_wr(c, line);
-			else if (waiter->rw == OCF_READ)
-				locked = __try_lock_rd(c, line);
-			else
-				ENV_BUG();
-		}
+		req = waiter->req;
 
-		i++;
+		if (req->lock_rw == OCF_WRITE)
+			locked = __try_lock_wr(c, line);
+		else if (req->lock_rw == OCF_READ)
+			locked = __try_lock_rd(c, line);
+		else
+			ENV_BUG();
 
-		if (locked) {
-			exchanged = false;
-			list_del(iter);
+		if (!locked)
+			break;
 
-			_req_on_lock(waiter->ctx, waiter->cb, waiter->ctx_id,
-					line, waiter->rw);
+		list_del(iter);
 
-			env_allocator_del(c->allocator, waiter);
-		} else {
-			break;
-		}
+		_req_on_lock(req, waiter - req->waiters, line, req->lock_rw);
 	}
 
-	if (exchanged) {
-		/* No exchange, no waiters on the list, unlock and return
-		 * WR -> IDLE
-		 */
-		__unlock_rd(c, line);
-	}
+	__update_waiter_bit(c, line);
 }
 
-/*
- *
- */
-static inline void __unlock_cache_line_rd(struct ocf_cache_line_concurrency *c,
+static inline void __unlock_cache_line_wake(
+		struct ocf_cache_line_concurrency *c,
 		const ocf_cache_line_t line)
 {
 	unsigned long flags = 0;
 
+	if (!__waiter_bit(c, line))
+		return;
+
 	/* Lock waiters list */
 	__lock_waiters_list(c, line, flags);
-	__unlock_cache_line_rd_common(c, line);
+	__wake_waiters(c, line);
 	__unlock_waiters_list(c, line, flags);
 }
 
-
-static inline void __unlock_cache_line_wr_common(struct ocf_cache_line_concurrency *c,
-		const ocf_cache_line_t line)
-{
-	uint32_t i = 0;
-	bool locked = false;
-	bool exchanged = true;
-
-	uint32_t idx = _WAITERS_LIST_ITEM(line);
-	struct __waiters_list *lst = &c->waiters_lsts[idx];
-	struct __waiter *waiter;
-
-	struct list_head *iter, *next;
-
-	/*
-	 * Lock exchange scenario
-	 * 1. WR -> IDLE
-	 * 2. WR -> RD
-	 * 3. WR -> WR
-	 */
-
-	/* Check is requested page is on the list */
-	list_for_each_safe(iter, next, &lst->head) {
-		waiter = list_entry(iter, struct __waiter, item);
-
-		if (line != waiter->line)
-			continue;
-
-		if (exchanged) {
-			if (waiter->rw == OCF_WRITE)
-				locked = __try_lock_wr2wr(c, line);
-			else if (waiter->rw == OCF_READ)
-				locked = __try_lock_wr2rd(c, line);
-			else
-				ENV_BUG();
-		} else {
-			if (waiter->rw == OCF_WRITE)
-				locked = __try_lock_wr(c, line);
-			else if (waiter->rw == OCF_READ)
-				locked = __try_lock_rd(c, line);
-			else
-				ENV_BUG();
-		}
-
-		i++;
-
-		if (locked) {
-			exchanged = false;
-			list_del(iter);
-
-			_req_on_lock(waiter->ctx, waiter->cb, waiter->ctx_id, line,
-					waiter->rw);
-
-			env_allocator_del(c->allocator, waiter);
-		} else {
-			break;
-		}
-	}
-
-	if (exchanged) {
-		/* No exchange, no waiters on the list, unlock and return
-		 * WR -> IDLE
-		 */
-		__unlock_wr(c, line);
-	}
-}
-
 /*
  *
  */
-static inline void __unlock_cache_line_wr(struct ocf_cache_line_concurrency *c,
+static inline void __unlock_cache_line_rd(struct ocf_cache_line_concurrency *c,
 		const ocf_cache_line_t line)
 {
-	unsigned long flags = 0;
-
-	/* Lock waiters list */
-	__lock_waiters_list(c, line, flags);
-	__unlock_cache_line_wr_common(c, line);
-	__unlock_waiters_list(c, line, flags);
+	__unlock_rd(c, line);
+	__unlock_cache_line_wake(c, line);
 }
 
 /*
- * Safely remove cache line lock waiter from waiting list.
- * Request can be assigned with lock asynchronously at any point of time,
- * so need to check lock state under a common lock.
+ *
  */
-static inline void __remove_line_from_waiters_list(struct ocf_cache_line_concurrency *c,
-	struct ocf_request *req, int i, void *ctx, int rw)
+static inline void __unlock_cache_line_wr(struct ocf_cache_line_concurrency *c,
+		const ocf_cache_line_t line)
 {
-	ocf_cache_line_t line = req->map[i].coll_idx;
-	uint32_t idx = _WAITERS_LIST_ITEM(line);
-	struct __waiters_list *lst = &c->waiters_lsts[idx];
-	struct list_head *iter, *next;
-	struct __waiter *waiter;
-	unsigned long flags = 0;
-
-	__lock_waiters_list(c, line, flags);
-
-	if (rw == OCF_READ && req->map[i].rd_locked) {
-		__unlock_cache_line_rd_common(c, line);
-		req->map[i].rd_locked = false;
-	} else if (rw == OCF_WRITE && req->map[i].wr_locked) {
-		__unlock_cache_line_wr_common(c, line);
-		req->map[i].wr_locked = false;
-	} else {
-		list_for_each_safe(iter, next, &lst->head) {
-			waiter = list_entry(iter, struct __waiter, item);
-			if (waiter->ctx == ctx) {
-				list_del(iter);
-				env_allocator_del(c->allocator, waiter);
-			}
-		}
-	}
-
-	__unlock_waiters_list(c, line, flags);
+	__unlock_wr(c, line);
+	__unlock_cache_line_wake(c, line);
 }
 
-/* Try to read-lock request without adding waiters. Function should be called
- * under read lock, multiple threads may attempt to acquire the lock
- * concurrently. */
+/* Try to read-lock request without adding waiters, using atomics only.
+ * Multiple threads may attempt to acquire the lock concurrently. */
 static int _ocf_req_trylock_rd(struct ocf_request *req)
 {
 	int32_t i;
@@ -743,7 +541,7 @@ static int _ocf_req_trylock_rd(struct ocf_request *req)
 		ENV_BUG_ON(req->map[i].rd_locked);
 		ENV_BUG_ON(req->map[i].wr_locked);
 
-		if (__lock_cache_line_rd(c, line, NULL, NULL, 0)) {
+		if (__lock_cache_line_rd(c, line, NULL, 0)) {
 			/* cache line locked */
 			req->map[i].rd_locked = true;
 		} else {
@@ -761,7 +559,7 @@ static int _ocf_req_trylock_rd(struct ocf_request *req)
 			line = req->map[i].coll_idx;
 
 			if (req->map[i].rd_locked) {
-				__unlock_rd(c, line);
+				__unlock_cache_line_rd(c, line);
 				req->map[i].rd_locked = false;
 			}
 		}
@@ -772,7 +570,7 @@ static int _ocf_req_trylock_rd(struct ocf_request *req)
 
 /*
  * Read-lock request cache lines. Must be called under cacheline concurrency
- * write lock.
+ * mutex.
  */
 static int _ocf_req_lock_rd(struct ocf_request *req, ocf_req_async_lock_cb cb)
 {
@@ -782,6 +580,9 @@ static int _ocf_req_lock_rd(struct ocf_request *req, ocf_req_async_lock_cb cb)
 	ocf_cache_line_t line;
 	int ret = OCF_LOCK_NOT_ACQUIRED;
 
+	req->lock_cb = cb;
+	req->lock_rw = OCF_READ;
+
 	ENV_BUG_ON(env_atomic_read(&req->lock_remaining));
 
 	env_atomic_inc(&c->waiting);
@@ -801,11 +602,9 @@ static int _ocf_req_lock_rd(struct ocf_request *req, ocf_req_async_lock_cb cb)
 		ENV_BUG_ON(req->map[i].rd_locked);
 		ENV_BUG_ON(req->map[i].wr_locked);
 
-		if (!__lock_cache_line_rd(c, line, cb, req, i)) {
-			/* lock not acquired and not added to wait list */
-			ret = -OCF_ERR_NO_MEM;
-			goto err;
-		}
+		/* Waiter is embedded in map entry, so line is either
+		 * locked or request is added to wait list */
+		__lock_cache_line_rd(c, line, req, i);
 	}
 
 	if (env_atomic_dec_return(&req->lock_remaining) == 0) {
@@ -814,17 +613,6 @@ static int _ocf_req_lock_rd(struct ocf_request *req, ocf_req_async_lock_cb cb)
 	}
 
 	return ret;
-
-err:
-	for (; i >= 0; i--) {
-		__remove_line_from_waiters_list(c, req, i, req,
-				OCF_READ);
-	}
-	env_atomic_set(&req->lock_remaining, 0);
-	env_atomic_dec(&c->waiting);
-
-	return ret;
-
 }
 
 int ocf_req_async_lock_rd(struct ocf_request *req, ocf_req_async_lock_cb cb)
@@ -833,22 +621,22 @@ int ocf_req_async_lock_rd(struct ocf_request *req, ocf_req_async_lock_cb cb)
 		req->cache->device->concurrency.cache_line;
 	int lock;
 
-	env_rwsem_down_read(&c->lock);
+	/* Uncontended case takes all lines with atomics only */
 	lock = _ocf_req_trylock_rd(req);
-	env_rwsem_up_read(&c->lock);
 
 	if (lock != OCF_LOCK_ACQUIRED) {
-		env_rwsem_down_write(&c->lock);
+		/* Waiting requests are added one at a time, so they queue
+		 * on all their lines in the same order */
+		env_mutex_lock(&c->lock);
 		lock = _ocf_req_lock_rd(req, cb);
-		env_rwsem_up_write(&c->lock);
+		env_mutex_unlock(&c->lock);
 	}
 
 	return lock;
 }
 
-/* Try to write-lock request without adding waiters. Function should be called
- * under read lock, multiple threads may attempt to acquire the lock
- * concurrently. */
+/* Try to write-lock request without adding waiters, using atomics only.
+ * Multiple threads may attempt to acquire the lock concurrently. */
 static int _ocf_req_trylock_wr(struct ocf_request *req)
 {
 	int32_t i;
@@ -870,7 +658,7 @@ static int _ocf_req_trylock_wr(struct ocf_request *req)
 		ENV_BUG_ON(req->map[i].rd_locked);
 		ENV_BUG_ON(req->map[i].wr_locked);
 
-		if (__lock_cache_line_wr(c, line, NULL, NULL, 0)) {
+		if (__lock_cache_line_wr(c, line, NULL, 0)) {
 			/* cache line locked */
 			req->map[i].wr_locked = true;
 		} else {
@@ -888,7 +676,7 @@ static int _ocf_req_trylock_wr(struct ocf_request *req)
 			line = req->map[i].coll_idx;
 
 			if (req->map[i].wr_locked) {
-				__unlock_wr(c, line);
+				__unlock_cache_line_wr(c, line);
 				req->map[i].wr_locked = false;
 			}
 		}
@@ -899,7 +687,7 @@ static int _ocf_req_trylock_wr(struct ocf_request *req)
 
 /*
  * Write-lock request cache lines. Must be called under cacheline concurrency
- * write lock.
+ * mutex.
  */
 static int _ocf_req_lock_wr(struct ocf_request *req, ocf_req_async_lock_cb cb)
 {
@@ -909,6 +697,9 @@ static int _ocf_req_lock_wr(struct ocf_request *req, ocf_req_async_lock_cb cb)
 	ocf_cache_line_t line;
 	int ret = OCF_LOCK_NOT_ACQUIRED;
 
+	req->lock_cb = cb;
+	req->lock_rw = OCF_WRITE;
+
 	ENV_BUG_ON(env_atomic_read(&req->lock_remaining));
 	ENV_BUG_ON(!cb);
 
@@ -929,11 +720,9 @@ static int _ocf_req_lock_wr(struct ocf_request *req, ocf_req_async_lock_cb cb)
 		ENV_BUG_ON(req->map[i].rd_locked);
 		ENV_BUG_ON(req->map[i].wr_locked);
 
-		if (!__lock_cache_line_wr(c, line, cb, req, i)) {
-			/* lock not acquired and not added to wait list */
-			ret = -OCF_ERR_NO_MEM;
-			goto err;
-		}
+		/* Waiter is embedded in map entry, so line is either
+		 * locked or request is added to wait list */
+		__lock_cache_line_wr(c, line, req, i);
 	}
 
 	if (env_atomic_dec_return(&req->lock_remaining) == 0) {
@@ -941,16 +730,6 @@ static int _ocf_req_lock_wr(struct ocf_request *req, ocf_req_async_lock_cb cb)
 		env_atomic_dec(&c->waiting);
 	}
 
-	return ret;
-
-err:
-	for (; i >= 0; i--) {
-		__remove_line_from_waiters_list(c, req, i, req,
-				OCF_WRITE);
-	}
-	env_atomic_set(&req->lock_remaining, 0);
-	env_atomic_dec(&c->waiting);
-
 	return ret;
 }
 
@@ -960,14 +739,15 @@ int ocf_req_async_lock_wr(struct ocf_request *req, ocf_req_async_lock_cb cb)
 		req->cache->device->concurrency.cache_line;
 	int lock;
 
-	env_rwsem_down_read(&c->lock);
+	/* Uncontended case takes all lines with atomics only */
 	lock = _ocf_req_trylock_wr(req);
-	env_rwsem_up_read(&c->lock);
 
 	if (lock != OCF_LOCK_ACQUIRED) {
-		env_rwsem_down_write(&c->lock);
+		/* Waiting requests are added one at a time, so they queue
+		 * on all their lines in the same order */
+		env_mutex_lock(&c->lock);
 		lock = _ocf_req_lock_wr(req, cb);
-		env_rwsem_up_write(&c->lock);
+		env_mutex_unlock(&c->lock);
 	}
 
 	return lock;
@@ -1119,6 +899,9 @@ bool ocf_cache_line_are_waiters(struct ocf_cache *cache,
 
 	ENV_BUG_ON(line >= cache->device->collision_table_entries);
 
+	if (!__waiter_bit(c, line))
+		return false;
+
 	/* Lock waiters list */
 	__lock_waiters_list(c, line, flags);
 
@@ -1142,7 +925,7 @@ uint32_t ocf_cache_line_concurrency_suspended_no(struct ocf_cache *cache)
 bool ocf_cache_line_try_lock_rd(struct ocf_cache *cache, ocf_cache_line_t line)
 {
 	struct ocf_cache_line_concurrency *c = cache->device->concurrency.cache_line;
-	return __lock_cache_line_rd(c, line, NULL, NULL, 0);
+	return __lock_cache_line_rd(c, line, NULL, 0);
 }
 
 /*
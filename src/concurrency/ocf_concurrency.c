@@ -5,12 +5,32 @@
 
 #include "ocf_concurrency.h"
 
+static int ocf_eviction_ref_init(struct ocf_cache *cache)
+{
+	uint64_t bits = cache->device->collision_table_entries;
+
+	cache->device->concurrency.eviction_ref = env_vzalloc(
+			OCF_DIV_ROUND_UP(bits, 8 * sizeof(unsigned long)) *
+			sizeof(unsigned long));
+
+	return cache->device->concurrency.eviction_ref ? 0 : -OCF_ERR_NO_MEM;
+}
+
+static void ocf_eviction_ref_deinit(struct ocf_cache *cache)
+{
+	env_vfree(cache->device->concurrency.eviction_ref);
+	cache->device->concurrency.eviction_ref = NULL;
+}
+
 int ocf_concurrency_init(struct ocf_cache *cache)
 {
 	int result = 0;
 
 	result = ocf_cache_line_concurrency_init(cache);
 
+	if (!result)
+		result = ocf_eviction_ref_init(cache);
+
 	if (result)
 		ocf_concurrency_deinit(cache);
 
@@ -19,6 +39,7 @@ int ocf_concurrency_init(struct ocf_cache *cache)
 
 void ocf_concurrency_deinit(struct ocf_cache *cache)
 {
+	ocf_eviction_ref_deinit(cache);
 	ocf_cache_line_concurrency_deinit(cache);
 }
 
@@ -6,20 +6,54 @@
 #include "ocf_metadata_concurrency.h"
 #include "../metadata/metadata_misc.h"
 
+/* Busy wait iterations before lock waiter starts sleeping */
+#define OCF_METADATA_LOCK_SPIN_MAX	1024
+
+/*
+ * Single step of lock wait loop. Spins shortly, as metadata locks are
+ * held for short time, then sleeps to let preempted lock holder run
+ * instead of burning CPU.
+ */
+static inline void _ocf_metadata_lock_wait(unsigned *spins)
+{
+	if (*spins < OCF_METADATA_LOCK_SPIN_MAX) {
+		(*spins)++;
+		env_cpu_relax();
+	} else {
+		env_msleep(1);
+	}
+}
+
 int ocf_metadata_concurrency_init(struct ocf_metadata_lock *metadata_lock)
 {
 	int err = 0;
+	unsigned evp_iter;
 	unsigned i;
 
-	err = env_spinlock_init(&metadata_lock->eviction);
-	if (err)
-		return err;
+	for (evp_iter = 0; evp_iter < OCF_NUM_EVICTION_LISTS; evp_iter++) {
+		err = env_spinlock_init(&metadata_lock->eviction[evp_iter]);
+		if (err)
+			goto eviction_err;
+	}
 
 	env_rwlock_init(&metadata_lock->status);
 	err = env_rwsem_init(&metadata_lock->global);
 	if (err)
 		goto rwsem_err;
 
+	/* Each CPU counter in its own CPU cache line */
+	metadata_lock->global_readers_no = env_get_execution_context_count();
+	metadata_lock->global_readers_mem = env_vzalloc(
+			sizeof(*metadata_lock->global_readers) *
+			metadata_lock->global_readers_no + 64);
+	if (!metadata_lock->global_readers_mem) {
+		err = -OCF_ERR_NO_MEM;
+		goto readers_err;
+	}
+	metadata_lock->global_readers = (void *)(OCF_DIV_ROUND_UP(
+			(unsigned long)metadata_lock->global_readers_mem, 64) * 64);
+	env_atomic_set(&metadata_lock->global_block, 0);
+
 	for (i = 0; i < OCF_IO_CLASS_MAX; i++) {
 		err = env_spinlock_init(&metadata_lock->partition[i]);
 		if (err)
@@ -31,9 +65,14 @@ int ocf_metadata_concurrency_init(struct ocf_metadata_lock *metadata_lock)
 spinlocks_err:
 	while (i--)
 		env_spinlock_destroy(&metadata_lock->partition[i]);
+	env_vfree(metadata_lock->global_readers_mem);
+readers_err:
+	env_rwsem_destroy(&metadata_lock->global);
 rwsem_err:
 	env_rwlock_destroy(&metadata_lock->status);
-	env_spinlock_destroy(&metadata_lock->eviction);
+eviction_err:
+	while (evp_iter--)
+		env_spinlock_destroy(&metadata_lock->eviction[evp_iter]);
 	return err;
 }
 
@@ -45,8 +84,11 @@ void ocf_metadata_concurrency_deinit(struct ocf_metadata_lock *metadata_lock)
 		env_spinlock_destroy(&metadata_lock->partition[i]);
 	}
 
-	env_spinlock_destroy(&metadata_lock->eviction);
+	for (i = 0; i < OCF_NUM_EVICTION_LISTS; i++)
+		env_spinlock_destroy(&metadata_lock->eviction[i]);
+
 	env_rwlock_destroy(&metadata_lock->status);
+	env_vfree(metadata_lock->global_readers_mem);
 	env_rwsem_destroy(&metadata_lock->global);
 }
 
@@ -57,7 +99,8 @@ int ocf_metadata_concurrency_attached_init(
 	uint32_t i;
 	int err = 0;
 
-	metadata_lock->hash = env_vzalloc(sizeof(env_rwsem) *
+	/* Hash bucket locks are plain words, zeroed memory is unlocked */
+	metadata_lock->hash = env_vzalloc(sizeof(env_atomic64) *
 			hash_table_entries);
 	metadata_lock->collision_pages = env_vzalloc(sizeof(env_rwsem) *
 			colision_table_pages);
@@ -70,21 +113,6 @@ int ocf_metadata_concurrency_attached_init(
 		return -OCF_ERR_NO_MEM;
 	}
 
-	for (i = 0; i < hash_table_entries; i++) {
-		err = env_rwsem_init(&metadata_lock->hash[i]);
-		if (err)
-			 break;
-	}
-	if (err) {
-		while (i--)
-			env_rwsem_destroy(&metadata_lock->hash[i]);
-		env_vfree(metadata_lock->hash);
-		metadata_lock->hash = NULL;
-		ocf_metadata_concurrency_attached_deinit(metadata_lock);
-		return err;
-	}
-
-
 	for (i = 0; i < colision_table_pages; i++) {
 		err = env_rwsem_init(&metadata_lock->collision_pages[i]);
 		if (err)
@@ -112,8 +140,6 @@ void ocf_metadata_concurrency_attached_deinit(
 	uint32_t i;
 
 	if (metadata_lock->hash) {
-		for (i = 0; i < metadata_lock->num_hash_entries; i++)
-			env_rwsem_destroy(&metadata_lock->hash[i]);
 		env_vfree(metadata_lock->hash);
 		metadata_lock->hash = NULL;
 		metadata_lock->num_hash_entries = 0;
@@ -128,83 +154,221 @@ void ocf_metadata_concurrency_attached_deinit(
 	}
 }
 
+/*
+ * Global metadata lock is a big-reader lock: shared access only increments
+ * counter of current CPU and checks that no exclusive access is pending.
+ * Exclusive access takes the rwsem (which serializes writers and blocks
+ * readers arriving meanwhile), sets block flag and waits for sum of per CPU
+ * counters to drop to zero. Counter of the CPU reader locked on is returned
+ * as shared access handle and released on unlock, so each counter stays
+ * balanced even if reader migrates to other CPU meanwhile.
+ */
+static inline int _ocf_metadata_global_readers(
+		struct ocf_metadata_lock *metadata_lock)
+{
+	int sum = 0;
+	unsigned i;
+
+	for (i = 0; i < metadata_lock->global_readers_no; i++)
+		sum += env_atomic_read(&metadata_lock->global_readers[i].count);
+
+	return sum;
+}
+
+static inline env_atomic *_ocf_metadata_global_reader(
+		struct ocf_metadata_lock *metadata_lock)
+{
+	unsigned cpu = env_get_current_cpu();
+
+	return &metadata_lock->global_readers[cpu %
+			metadata_lock->global_readers_no].count;
+}
+
+static inline env_atomic *_ocf_metadata_try_lock_global_rd(
+		struct ocf_metadata_lock *metadata_lock)
+{
+	env_atomic *reader = _ocf_metadata_global_reader(metadata_lock);
+
+	/* Atomic increment is full barrier, so either exclusive access
+	 * sees this reader or reader sees block flag */
+	env_atomic_inc(reader);
+
+	if (likely(!env_atomic_read(&metadata_lock->global_block)))
+		return reader;
+
+	env_atomic_dec(reader);
+	return NULL;
+}
+
 void ocf_metadata_start_exclusive_access(
 		struct ocf_metadata_lock *metadata_lock)
 {
-        env_rwsem_down_write(&metadata_lock->global);
+	unsigned spins = 0;
+
+	env_rwsem_down_write(&metadata_lock->global);
+	env_atomic_cmpxchg(&metadata_lock->global_block, 0, 1);
+
+	/* Wait for readers in flight, sleeping if they take long */
+	while (_ocf_metadata_global_readers(metadata_lock))
+		_ocf_metadata_lock_wait(&spins);
 }
 
 int ocf_metadata_try_start_exclusive_access(
 		struct ocf_metadata_lock *metadata_lock)
 {
-	return env_rwsem_down_write_trylock(&metadata_lock->global);
+	int result;
+
+	result = env_rwsem_down_write_trylock(&metadata_lock->global);
+	if (result)
+		return result;
+
+	env_atomic_cmpxchg(&metadata_lock->global_block, 0, 1);
+
+	if (_ocf_metadata_global_readers(metadata_lock)) {
+		env_atomic_set(&metadata_lock->global_block, 0);
+		env_rwsem_up_write(&metadata_lock->global);
+		return -OCF_ERR_NO_LOCK;
+	}
+
+	return 0;
 }
 
 void ocf_metadata_end_exclusive_access(
 		struct ocf_metadata_lock *metadata_lock)
 {
-        env_rwsem_up_write(&metadata_lock->global);
+	env_atomic_set(&metadata_lock->global_block, 0);
+	env_rwsem_up_write(&metadata_lock->global);
 }
 
-void ocf_metadata_start_shared_access(
+env_atomic *ocf_metadata_start_shared_access(
 		struct ocf_metadata_lock *metadata_lock)
 {
-        env_rwsem_down_read(&metadata_lock->global);
+	env_atomic *reader;
+
+	while (!(reader = _ocf_metadata_try_lock_global_rd(metadata_lock))) {
+		/* Sleep until exclusive access is released */
+		env_rwsem_down_read(&metadata_lock->global);
+		env_rwsem_up_read(&metadata_lock->global);
+	}
+
+	return reader;
 }
 
-int ocf_metadata_try_start_shared_access(
+env_atomic *ocf_metadata_try_start_shared_access(
 		struct ocf_metadata_lock *metadata_lock)
 {
-	return env_rwsem_down_read_trylock(&metadata_lock->global);
+	return _ocf_metadata_try_lock_global_rd(metadata_lock);
+}
+
+void ocf_metadata_end_shared_access(struct ocf_metadata_lock *metadata_lock,
+		env_atomic *reader)
+{
+	ENV_BUG_ON(!reader);
+
+	env_atomic_dec(reader);
+}
+
+/*
+ * Hash bucket lock word: reader count in low bits, writer and writer
+ * pending bits and version in high 32 bits, bumped on every write unlock.
+ * Lookups may skip locking and validate that version of all buckets did
+ * not change instead. Writer waiting for readers to drain sets pending bit,
+ * which keeps new readers out, so that writers are not starved.
+ */
+#define OCF_HASH_LOCK_WRITER		(1L << 31)
+#define OCF_HASH_LOCK_WRITER_PENDING	(1L << 30)
+#define OCF_HASH_LOCK_READERS		(OCF_HASH_LOCK_WRITER_PENDING - 1)
+#define OCF_HASH_LOCK_VERSION		(1L << 32)
+
+static inline bool _ocf_hash_try_lock_rd(env_atomic64 *lock)
+{
+	long val = env_atomic64_read(lock);
+
+	if (val & (OCF_HASH_LOCK_WRITER | OCF_HASH_LOCK_WRITER_PENDING))
+		return false;
+
+	return env_atomic64_cmpxchg(lock, val, val + 1) == val;
+}
+
+static inline bool _ocf_hash_try_lock_wr(env_atomic64 *lock)
+{
+	long val = env_atomic64_read(lock);
+
+	if (val & (OCF_HASH_LOCK_WRITER | OCF_HASH_LOCK_READERS))
+		return false;
+
+	/* Pending bit of other waiting writers is set again on their next
+	 * attempt */
+	return env_atomic64_cmpxchg(lock, val,
+			(val & ~OCF_HASH_LOCK_WRITER_PENDING) |
+			OCF_HASH_LOCK_WRITER) == val;
 }
 
-void ocf_metadata_end_shared_access(struct ocf_metadata_lock *metadata_lock)
+static inline void _ocf_hash_set_wr_pending(env_atomic64 *lock)
 {
-        env_rwsem_up_read(&metadata_lock->global);
+	long val = env_atomic64_read(lock);
+
+	if (!(val & OCF_HASH_LOCK_WRITER_PENDING)) {
+		env_atomic64_cmpxchg(lock, val,
+				val | OCF_HASH_LOCK_WRITER_PENDING);
+	}
 }
 
 void ocf_metadata_hash_lock(struct ocf_metadata_lock *metadata_lock,
 		ocf_cache_line_t hash, int rw)
 {
+	env_atomic64 *lock;
+	unsigned spins = 0;
+
 	ENV_BUG_ON(hash >= metadata_lock->num_hash_entries);
 
-	if (rw == OCF_METADATA_WR)
-		env_rwsem_down_write(&metadata_lock->hash[hash]);
-	else if (rw == OCF_METADATA_RD)
-		env_rwsem_down_read(&metadata_lock->hash[hash]);
-	else
+	lock = &metadata_lock->hash[hash];
+
+	if (rw == OCF_METADATA_WR) {
+		while (!_ocf_hash_try_lock_wr(lock)) {
+			_ocf_hash_set_wr_pending(lock);
+			_ocf_metadata_lock_wait(&spins);
+		}
+	} else if (rw == OCF_METADATA_RD) {
+		while (!_ocf_hash_try_lock_rd(lock))
+			_ocf_metadata_lock_wait(&spins);
+	} else {
 		ENV_BUG();
+	}
 }
 
 void ocf_metadata_hash_unlock(struct ocf_metadata_lock *metadata_lock,
 		ocf_cache_line_t hash, int rw)
 {
+	env_atomic64 *lock;
+
 	ENV_BUG_ON(hash >= metadata_lock->num_hash_entries);
 
-	if (rw == OCF_METADATA_WR)
-		env_rwsem_up_write(&metadata_lock->hash[hash]);
-	else if (rw == OCF_METADATA_RD)
-		env_rwsem_up_read(&metadata_lock->hash[hash]);
-	else
+	lock = &metadata_lock->hash[hash];
+
+	if (rw == OCF_METADATA_WR) {
+		env_atomic64_add(OCF_HASH_LOCK_VERSION - OCF_HASH_LOCK_WRITER,
+				lock);
+	} else if (rw == OCF_METADATA_RD) {
+		env_atomic64_dec(lock);
+	} else {
 		ENV_BUG();
+	}
 }
 
 int ocf_metadata_hash_try_lock(struct ocf_metadata_lock *metadata_lock,
 		ocf_cache_line_t hash, int rw)
 {
-	int result = -1;
+	bool result = false;
 
 	ENV_BUG_ON(hash >= metadata_lock->num_hash_entries);
 
-	if (rw == OCF_METADATA_WR) {
-		result = env_rwsem_down_write_trylock(
-				&metadata_lock->hash[hash]);
-	} else if (rw == OCF_METADATA_RD) {
-		result = env_rwsem_down_read_trylock(
-				&metadata_lock->hash[hash]);
-	} else {
+	if (rw == OCF_METADATA_WR)
+		result = _ocf_hash_try_lock_wr(&metadata_lock->hash[hash]);
+	else if (rw == OCF_METADATA_RD)
+		result = _ocf_hash_try_lock_rd(&metadata_lock->hash[hash]);
+	else
 		ENV_BUG();
-	}
 
 	if (!result)
 		return -1;
@@ -215,44 +379,50 @@ int ocf_metadata_hash_try_lock(struct ocf_metadata_lock *metadata_lock,
 /* NOTE: attempt to acquire hash lock for multiple core lines may end up
  * in deadlock. In order to hash lock multiple core lines safely, use
  * ocf_req_hash_lock_* functions */
-void ocf_metadata_hash_lock_rd(struct ocf_metadata_lock *metadata_lock,
+env_atomic *ocf_metadata_hash_lock_rd(struct ocf_metadata_lock *metadata_lock,
 		uint32_t core_id, uint64_t core_line)
 {
 	ocf_cache_line_t hash = ocf_metadata_hash_func(metadata_lock->cache,
 			core_line, core_id);
+	env_atomic *reader;
 
-	ocf_metadata_start_shared_access(metadata_lock);
+	reader = ocf_metadata_start_shared_access(metadata_lock);
 	ocf_metadata_hash_lock(metadata_lock, hash, OCF_METADATA_RD);
+
+	return reader;
 }
 
 void ocf_metadata_hash_unlock_rd(struct ocf_metadata_lock *metadata_lock,
-		uint32_t core_id, uint64_t core_line)
+		uint32_t core_id, uint64_t core_line, env_atomic *reader)
 {
 	ocf_cache_line_t hash = ocf_metadata_hash_func(metadata_lock->cache,
 			core_line, core_id);
 
 	ocf_metadata_hash_unlock(metadata_lock, hash, OCF_METADATA_RD);
-	ocf_metadata_end_shared_access(metadata_lock);
+	ocf_metadata_end_shared_access(metadata_lock, reader);
 }
 
-void ocf_metadata_hash_lock_wr(struct ocf_metadata_lock *metadata_lock,
+env_atomic *ocf_metadata_hash_lock_wr(struct ocf_metadata_lock *metadata_lock,
 		uint32_t core_id, uint64_t core_line)
 {
 	ocf_cache_line_t hash = ocf_metadata_hash_func(metadata_lock->cache,
 			core_line, core_id);
+	env_atomic *reader;
 
-	ocf_metadata_start_shared_access(metadata_lock);
+	reader = ocf_metadata_start_shared_access(metadata_lock);
 	ocf_metadata_hash_lock(metadata_lock, hash, OCF_METADATA_WR);
+
+	return reader;
 }
 
 void ocf_metadata_hash_unlock_wr(struct ocf_metadata_lock *metadata_lock,
-		uint32_t core_id, uint64_t core_line)
+		uint32_t core_id, uint64_t core_line, env_atomic *reader)
 {
 	ocf_cache_line_t hash = ocf_metadata_hash_func(metadata_lock->cache,
 			core_line, core_id);
 
 	ocf_metadata_hash_unlock(metadata_lock, hash, OCF_METADATA_WR);
-	ocf_metadata_end_shared_access(metadata_lock);
+	ocf_metadata_end_shared_access(metadata_lock, reader);
 }
 
 /* number of hash entries */
@@ -309,7 +479,8 @@ void ocf_req_hash_lock_rd(struct ocf_request *req)
 {
 	ocf_cache_line_t hash;
 
-	ocf_metadata_start_shared_access(&req->cache->metadata.lock);
+	req->global_reader = ocf_metadata_start_shared_access(
+			&req->cache->metadata.lock);
 	for_each_req_hash_asc(req, hash) {
 		ocf_metadata_hash_lock(&req->cache->metadata.lock, hash,
 				OCF_METADATA_RD);
@@ -324,14 +495,17 @@ void ocf_req_hash_unlock_rd(struct ocf_request *req)
 		ocf_metadata_hash_unlock(&req->cache->metadata.lock, hash,
 				OCF_METADATA_RD);
 	}
-	ocf_metadata_end_shared_access(&req->cache->metadata.lock);
+	ocf_metadata_end_shared_access(&req->cache->metadata.lock,
+			req->global_reader);
+	req->global_reader = NULL;
 }
 
 void ocf_req_hash_lock_wr(struct ocf_request *req)
 {
 	ocf_cache_line_t hash;
 
-	ocf_metadata_start_shared_access(&req->cache->metadata.lock);
+	req->global_reader = ocf_metadata_start_shared_access(
+			&req->cache->metadata.lock);
 	for_each_req_hash_asc(req, hash) {
 		ocf_metadata_hash_lock(&req->cache->metadata.lock, hash,
 				OCF_METADATA_WR);
@@ -360,7 +534,77 @@ void ocf_req_hash_unlock_wr(struct ocf_request *req)
 		ocf_metadata_hash_unlock(&req->cache->metadata.lock, hash,
 				OCF_METADATA_WR);
 	}
-	ocf_metadata_end_shared_access(&req->cache->metadata.lock);
+	ocf_metadata_end_shared_access(&req->cache->metadata.lock,
+			req->global_reader);
+	req->global_reader = NULL;
+}
+
+/*
+ * Optimistic read of request hash buckets: no bucket lock is taken, instead
+ * sum of bucket versions is returned and compared by
+ * ocf_req_hash_read_retry() after reading metadata. Versions only grow, so
+ * equal sum means no bucket was write locked in between. Global metadata
+ * lock is held in shared mode for whole read, as eviction modifies
+ * mapping under exclusive access without taking bucket locks.
+ */
+uint64_t ocf_req_hash_read_begin(struct ocf_request *req)
+{
+	struct ocf_metadata_lock *metadata_lock = &req->cache->metadata.lock;
+	ocf_cache_line_t hash;
+	uint64_t version = 0;
+	long val;
+
+	req->global_reader = ocf_metadata_start_shared_access(metadata_lock);
+
+	for_each_req_hash_asc(req, hash) {
+		while ((val = env_atomic64_read(&metadata_lock->hash[hash])) &
+				OCF_HASH_LOCK_WRITER) {
+			env_cpu_relax();
+		}
+		version += (unsigned long)val >> 32;
+	}
+
+	env_smp_rmb();
+
+	return version;
+}
+
+bool ocf_req_hash_read_retry(struct ocf_request *req, uint64_t version)
+{
+	struct ocf_metadata_lock *metadata_lock = &req->cache->metadata.lock;
+	ocf_cache_line_t hash;
+	uint64_t current = 0;
+	long val;
+
+	env_smp_rmb();
+
+	for_each_req_hash_asc(req, hash) {
+		val = env_atomic64_read(&metadata_lock->hash[hash]);
+		if (val & OCF_HASH_LOCK_WRITER)
+			return true;
+		current += (unsigned long)val >> 32;
+	}
+
+	return current != version;
+}
+
+void ocf_req_hash_read_end(struct ocf_request *req)
+{
+	ocf_metadata_end_shared_access(&req->cache->metadata.lock,
+			req->global_reader);
+	req->global_reader = NULL;
+}
+
+/* Read lock request hash buckets within started optimistic read, released
+ * with ocf_req_hash_unlock_rd() */
+void ocf_req_hash_read_lock(struct ocf_request *req)
+{
+	ocf_cache_line_t hash;
+
+	for_each_req_hash_asc(req, hash) {
+		ocf_metadata_hash_lock(&req->cache->metadata.lock, hash,
+				OCF_METADATA_RD);
+	}
 }
 
 void ocf_collision_start_shared_access(struct ocf_metadata_lock *metadata_lock,
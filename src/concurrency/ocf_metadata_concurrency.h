@@ -22,15 +22,15 @@ void ocf_metadata_concurrency_attached_deinit(
 		struct ocf_metadata_lock *metadata_lock);
 
 static inline void ocf_metadata_eviction_lock(
-		struct ocf_metadata_lock *metadata_lock)
+		struct ocf_metadata_lock *metadata_lock, unsigned ev_list)
 {
-	env_spinlock_lock(&metadata_lock->eviction);
+	env_spinlock_lock(&metadata_lock->eviction[ev_list]);
 }
 
 static inline void ocf_metadata_eviction_unlock(
-		struct ocf_metadata_lock *metadata_lock)
+		struct ocf_metadata_lock *metadata_lock, unsigned ev_list)
 {
-	env_spinlock_unlock(&metadata_lock->eviction);
+	env_spinlock_unlock(&metadata_lock->eviction[ev_list]);
 }
 
 static inline void ocf_metadata_partition_lock(
@@ -47,11 +47,11 @@ static inline void ocf_metadata_partition_unlock(
 	env_spinlock_unlock(&metadata_lock->partition[part_id]);
 }
 
-#define OCF_METADATA_EVICTION_LOCK() \
-		ocf_metadata_eviction_lock(&cache->metadata.lock)
+#define OCF_METADATA_EVICTION_LOCK(ev_list) \
+		ocf_metadata_eviction_lock(&cache->metadata.lock, ev_list)
 
-#define OCF_METADATA_EVICTION_UNLOCK() \
-		ocf_metadata_eviction_unlock(&cache->metadata.lock)
+#define OCF_METADATA_EVICTION_UNLOCK(ev_list) \
+		ocf_metadata_eviction_unlock(&cache->metadata.lock, ev_list)
 
 void ocf_metadata_start_exclusive_access(
 		struct ocf_metadata_lock *metadata_lock);
@@ -62,14 +62,16 @@ int ocf_metadata_try_start_exclusive_access(
 void ocf_metadata_end_exclusive_access(
 		struct ocf_metadata_lock *metadata_lock);
 
-int ocf_metadata_try_start_shared_access(
+/* Shared access returns per CPU reader counter it was taken on, which must
+ * be passed back on release */
+env_atomic *ocf_metadata_try_start_shared_access(
 		struct ocf_metadata_lock *metadata_lock);
 
-void ocf_metadata_start_shared_access(
+env_atomic *ocf_metadata_start_shared_access(
 		struct ocf_metadata_lock *metadata_lock);
 
 void ocf_metadata_end_shared_access(
-		struct ocf_metadata_lock *metadata_lock);
+		struct ocf_metadata_lock *metadata_lock, env_atomic *reader);
 
 static inline void ocf_metadata_status_bits_lock(
 		struct ocf_metadata_lock *metadata_lock, int rw)
@@ -109,14 +111,14 @@ static inline void ocf_metadata_status_bits_unlock(
 		ocf_metadata_status_bits_unlock(&cache->metadata.lock, \
 				OCF_METADATA_WR)
 
-void ocf_metadata_hash_lock_rd(struct ocf_metadata_lock *metadata_lock,
+env_atomic *ocf_metadata_hash_lock_rd(struct ocf_metadata_lock *metadata_lock,
 		uint32_t core_id, uint64_t core_line);
 void ocf_metadata_hash_unlock_rd(struct ocf_metadata_lock *metadata_lock,
-		uint32_t core_id, uint64_t core_line);
-void ocf_metadata_hash_lock_wr(struct ocf_metadata_lock *metadata_lock,
+		uint32_t core_id, uint64_t core_line, env_atomic *reader);
+env_atomic *ocf_metadata_hash_lock_wr(struct ocf_metadata_lock *metadata_lock,
 		uint32_t core_id, uint64_t core_line);
 void ocf_metadata_hash_unlock_wr(struct ocf_metadata_lock *metadata_lock,
-		uint32_t core_id, uint64_t core_line);
+		uint32_t core_id, uint64_t core_line, env_atomic *reader);
 
 /* lock entire request in deadlock-free manner */
 void ocf_req_hash_lock_rd(struct ocf_request *req);
@@ -125,6 +127,12 @@ void ocf_req_hash_lock_wr(struct ocf_request *req);
 void ocf_req_hash_unlock_wr(struct ocf_request *req);
 void ocf_req_hash_lock_upgrade(struct ocf_request *req);
 
+/* optimistic, version validated read of request hash buckets */
+uint64_t ocf_req_hash_read_begin(struct ocf_request *req);
+bool ocf_req_hash_read_retry(struct ocf_request *req, uint64_t version);
+void ocf_req_hash_read_end(struct ocf_request *req);
+void ocf_req_hash_read_lock(struct ocf_request *req);
+
 /* collision table page lock interface */
 void ocf_collision_start_shared_access(struct ocf_metadata_lock *metadata_lock,
 		uint32_t page);
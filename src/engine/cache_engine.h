@@ -70,6 +70,13 @@ static inline bool ocf_req_cache_mode_has_lazy_write(ocf_req_cache_mode_t mode)
 					(ocf_cache_mode_t)mode);
 }
 
+static inline bool ocf_req_cache_mode_is_mf(ocf_req_cache_mode_t mode)
+{
+	return mode == ocf_req_cache_mode_mfwa ||
+			mode == ocf_req_cache_mode_mfwb ||
+			mode == ocf_req_cache_mode_mfwt;
+}
+
 bool ocf_fallback_pt_is_on(ocf_cache_t cache);
 
 struct ocf_request *ocf_engine_pop_req(struct ocf_queue *q);
@@ -54,6 +54,8 @@ static void _ocf_backfill_complete(struct ocf_request *req, int error)
 	if (env_atomic_dec_return(&req->req_remaining))
 		return;
 
+	ocf_engine_lat_end(req);
+
 	/* We must free the pages we have allocated */
 	ctx_data_secure_erase(cache->owner, req->data);
 	ctx_data_munlock(cache->owner, req->data);
@@ -84,6 +86,7 @@ static int _ocf_backfill_do(struct ocf_request *req)
 
 	req->data = req->cp_data;
 
+	ocf_engine_lat_start(req, ocf_lat_backfill);
 	ocf_submit_cache_reqs(req->cache, req, OCF_WRITE, 0, req->byte_length,
 				reqs_to_issue, _ocf_backfill_complete);
 
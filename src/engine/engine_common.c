@@ -18,6 +18,7 @@
 #include "../eviction/eviction.h"
 #include "../promotion/promotion.h"
 #include "../concurrency/ocf_concurrency.h"
+#include "../ocf_mrc.h"
 
 void ocf_engine_error(struct ocf_request *req,
 		bool stop_cache, const char *msg)
@@ -51,41 +52,28 @@ void ocf_engine_lookup_map_entry(struct ocf_cache *cache,
 	entry->status = LOOKUP_MISS;
 	entry->coll_idx = cache->device->collision_table_entries;
 	entry->core_line = core_line;
+	entry->dirty = false;
 
-	line = ocf_metadata_get_hash(cache, hash);
-
-	while (line != cache->device->collision_table_entries) {
-		ocf_core_id_t curr_core_id;
-		uint64_t curr_core_line;
-
-		ocf_metadata_get_core_info(cache, line, &curr_core_id,
-				&curr_core_line);
-
-		if (core_id == curr_core_id && curr_core_line == core_line) {
-			entry->coll_idx = line;
-			entry->status = LOOKUP_HIT;
-			break;
-		}
-
-		line = ocf_metadata_get_collision_next(cache, line);
+	line = ocf_metadata_lookup_find(cache, hash, core_id, core_line);
+	if (line != cache->device->collision_table_entries) {
+		entry->coll_idx = line;
+		entry->status = LOOKUP_HIT;
 	}
 }
 
 static inline int _ocf_engine_check_map_entry(struct ocf_cache *cache,
 		struct ocf_map_info *entry, ocf_core_id_t core_id)
 {
-	ocf_core_id_t _core_id;
-	uint64_t _core_line;
+	const struct ocf_metadata_lookup_entry *curr;
 
 	if (entry->status == LOOKUP_MISS)
 		return 0;
 
 	ENV_BUG_ON(entry->coll_idx >= cache->device->collision_table_entries);
 
-	ocf_metadata_get_core_info(cache, entry->coll_idx, &_core_id,
-			&_core_line);
+	curr = ocf_metadata_lookup_get_entry(cache, entry->coll_idx);
 
-	if (core_id == _core_id && _core_line == entry->core_line)
+	if (core_id == curr->core_id && curr->core_line == entry->core_line)
 		return 0;
 	else
 		return -1;
@@ -113,6 +101,7 @@ void ocf_engine_update_req_info(struct ocf_cache *cache,
 
 		/* Check request is dirty */
 		if (metadata_test_dirty(cache, _entry->coll_idx)) {
+			_entry->dirty = true;
 			req->info.dirty_any++;
 
 			/* Check if cache line is fully dirty */
@@ -151,7 +140,9 @@ void ocf_engine_update_req_info(struct ocf_cache *cache,
 	}
 }
 
-void ocf_engine_traverse(struct ocf_request *req)
+/* Lookup of request core lines with no side effects on LRU and access
+ * statistics, so that result not validated yet can be thrown away */
+static void _ocf_engine_lookup(struct ocf_request *req)
 {
 	uint32_t i;
 	uint64_t core_line;
@@ -159,8 +150,6 @@ void ocf_engine_traverse(struct ocf_request *req)
 	struct ocf_cache *cache = req->cache;
 	ocf_core_id_t core_id = ocf_core_get_id(req->core);
 
-	OCF_DEBUG_TRACE(req->cache);
-
 	ocf_req_clear_info(req);
 	req->info.seq_req = true;
 
@@ -184,9 +173,6 @@ void ocf_engine_traverse(struct ocf_request *req)
 		OCF_DEBUG_PARAM(cache, "Hit, cache line %u, core line = %llu",
 				entry->coll_idx, entry->core_line);
 
-		/* Update eviction (LRU) */
-		ocf_eviction_set_hot_cache_line(cache, entry->coll_idx);
-
 		ocf_engine_update_req_info(cache, req, i);
 	}
 
@@ -194,6 +180,64 @@ void ocf_engine_traverse(struct ocf_request *req)
 			"Yes" : "No");
 }
 
+/* Account request access for traverse result which is final */
+static void _ocf_engine_traverse_access(struct ocf_request *req)
+{
+	uint32_t i;
+
+	ocf_mrc_req_access(req);
+
+	for (i = 0; i < req->core_line_count; i++) {
+		/* Update eviction (LRU) */
+		if (req->map[i].status == LOOKUP_HIT) {
+			ocf_eviction_touch_cache_line(req->cache,
+					req->map[i].coll_idx);
+		}
+	}
+}
+
+void ocf_engine_traverse(struct ocf_request *req)
+{
+	OCF_DEBUG_TRACE(req->cache);
+
+	_ocf_engine_lookup(req);
+	_ocf_engine_traverse_access(req);
+}
+
+bool ocf_engine_traverse_optimistic(struct ocf_request *req,
+		bool (*need_lock)(struct ocf_request *req))
+{
+	uint64_t version;
+
+	version = ocf_req_hash_read_begin(req);
+
+	/* Result may be stale, so lookup only - access is accounted once
+	 * result is validated under hash bucket locks */
+	_ocf_engine_lookup(req);
+
+	if (!need_lock(req) && !ocf_req_hash_read_retry(req, version)) {
+		/* Caller falls back to regular traverse */
+		ocf_req_hash_read_end(req);
+		return false;
+	}
+
+	/* Result has to stay valid (or is stale) - lock and check whether
+	 * mapping changed in the meantime */
+	ocf_req_hash_read_lock(req);
+
+	if (ocf_req_hash_read_retry(req, version))
+		_ocf_engine_lookup(req);
+
+	if (!need_lock(req)) {
+		ocf_req_hash_unlock_rd(req);
+		return false;
+	}
+
+	_ocf_engine_traverse_access(req);
+
+	return true;
+}
+
 int ocf_engine_check(struct ocf_request *req)
 {
 	int result = 0;
@@ -419,6 +463,9 @@ static int lock_clines(struct ocf_request *req,
 {
 	enum ocf_engine_lock_type lock_type = engine_cbs->get_lock_type(req);
 
+	/* Accounted on resume, only if lock was not acquired immediately */
+	ocf_engine_lat_start(req, ocf_lat_lock_wait);
+
 	switch (lock_type) {
 	case ocf_engine_lock_write:
 		return ocf_req_async_lock_wr(req, engine_cbs->resume);
@@ -489,6 +536,9 @@ int ocf_engine_prepare_clines(struct ocf_request *req,
 
 			ocf_metadata_end_exclusive_access(metadata_lock);
 		}
+
+		/* Refill freelist in background for subsequent misses */
+		space_management_reclaim_kick(req->cache, req);
 	}
 
 
@@ -552,6 +602,11 @@ void ocf_engine_update_request_stats(struct ocf_request *req)
 {
 	ocf_core_stats_request_update(req->core, req->part_id, req->rw,
 			req->info.hit_no, req->core_line_count);
+
+	if (ocf_engine_is_hit(req) && req->info.dirty_any) {
+		ocf_core_stats_request_dirty_hit_update(req->core,
+				req->part_id, req->rw);
+	}
 }
 
 void ocf_engine_push_req_back(struct ocf_request *req, bool allow_sync)
@@ -688,6 +743,8 @@ void ocf_engine_on_resume(struct ocf_request *req)
 	ENV_BUG_ON(req->priv);
 	OCF_CHECK_NULL(req->io_if);
 
+	ocf_engine_lat_end(req);
+
 	/* Exchange IO interface */
 	req->priv = (void *)req->io_if;
 
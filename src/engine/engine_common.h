@@ -8,6 +8,7 @@
 
 #include "../ocf_request.h"
 #include "../utils/utils_cache_line.h"
+#include "../ocf_trace_ring.h"
 
 /**
  * @file engine_common.h
@@ -110,6 +111,38 @@ static inline uint32_t ocf_engine_io_count(struct ocf_request *req)
 	return req->info.seq_req ? 1 : req->core_line_count;
 }
 
+/**
+ * @brief Start measuring latency of given request path
+ *
+ * @param req OCF request
+ * @param path Request path
+ */
+static inline void ocf_engine_lat_start(struct ocf_request *req,
+		ocf_lat_path_t path)
+{
+	req->lat_path = path;
+	req->lat_start = env_get_time_ns();
+
+	ocf_trace_ring_push(req, ocf_trace_rec_path_start, path,
+			req->byte_position, req->byte_length, req->lat_start);
+}
+
+/**
+ * @brief Account latency of path started with ocf_engine_lat_start()
+ *
+ * @param req OCF request
+ */
+static inline void ocf_engine_lat_end(struct ocf_request *req)
+{
+	uint64_t now = env_get_time_ns();
+
+	ocf_core_stats_latency_update(req->core, req->part_id, req->lat_path,
+			now - req->lat_start);
+
+	ocf_trace_ring_push(req, ocf_trace_rec_path_end, req->lat_path,
+			now - req->lat_start, req->byte_length, now);
+}
+
 static inline
 bool ocf_engine_map_all_sec_dirty(struct ocf_request *req, uint32_t line)
 {
@@ -223,6 +256,25 @@ int ocf_engine_prepare_clines(struct ocf_request *req,
  */
 void ocf_engine_traverse(struct ocf_request *req);
 
+/**
+ * @brief Traverse OCF request without locking hash buckets, validating
+ * bucket versions instead
+ *
+ * @note Hash buckets end up read locked only if need_lock() is true for
+ * traverse result, they are released with ocf_req_hash_unlock_rd()
+ *
+ * @note LRU and access statistics are updated only when buckets end up
+ * locked, otherwise caller is expected to fall back to ocf_engine_traverse()
+ *
+ * @param req OCF request
+ * @param need_lock Check if traverse result has to be kept stable
+ *
+ * @retval true Hash buckets are read locked
+ * @retval false Hash buckets are not locked
+ */
+bool ocf_engine_traverse_optimistic(struct ocf_request *req,
+		bool (*need_lock)(struct ocf_request *req));
+
 /**
  * @brief Check if OCF request mapping is still valid
  *
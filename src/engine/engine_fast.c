@@ -40,6 +40,8 @@ static void _ocf_read_fast_complete(struct ocf_request *req, int error)
 
 	OCF_DEBUG_RQ(req, "HIT completion");
 
+	ocf_engine_lat_end(req);
+
 	if (req->error) {
 		OCF_DEBUG_RQ(req, "ERROR");
 
@@ -85,6 +87,7 @@ static int _ocf_read_fast_do(struct ocf_request *req)
 	/* Submit IO */
 	OCF_DEBUG_RQ(req, "Submit");
 	env_atomic_set(&req->req_remaining, ocf_engine_io_count(req));
+	ocf_engine_lat_start(req, ocf_lat_cache_read);
 	ocf_submit_cache_reqs(req->cache, req, OCF_READ, 0, req->byte_length,
 		ocf_engine_io_count(req), _ocf_read_fast_complete);
 
@@ -118,19 +121,17 @@ int ocf_read_fast(struct ocf_request *req)
 	/*- Metadata RD access -----------------------------------------------*/
 
 	ocf_req_hash(req);
-	ocf_req_hash_lock_rd(req);
-
-	/* Traverse request to cache if there is hit */
-	ocf_engine_traverse(req);
 
-	hit = ocf_engine_is_hit(req);
+	/* Traverse request to cache if there is hit, hash buckets stay
+	 * locked only on hit */
+	hit = ocf_engine_traverse_optimistic(req, ocf_engine_is_hit);
 	if (hit) {
 		ocf_io_start(&req->ioi.io);
+		ocf_engine_lat_start(req, ocf_lat_lock_wait);
 		lock = ocf_req_async_lock_rd(req, ocf_engine_on_resume);
+		ocf_req_hash_unlock_rd(req);
 	}
 
-	ocf_req_hash_unlock_rd(req);
-
 	if (hit) {
 		OCF_DEBUG_RQ(req, "Fast path success");
 
@@ -187,19 +188,17 @@ int ocf_write_fast(struct ocf_request *req)
 	/*- Metadata RD access -----------------------------------------------*/
 
 	ocf_req_hash(req);
-	ocf_req_hash_lock_rd(req);
 
-	/* Traverse request to cache if there is hit */
-	ocf_engine_traverse(req);
-
-	mapped = ocf_engine_is_mapped(req);
+	/* Traverse request to cache if there is hit, hash buckets stay
+	 * locked only if fully mapped */
+	mapped = ocf_engine_traverse_optimistic(req, ocf_engine_is_mapped);
 	if (mapped) {
 		ocf_io_start(&req->ioi.io);
+		ocf_engine_lat_start(req, ocf_lat_lock_wait);
 		lock = ocf_req_async_lock_wr(req, ocf_engine_on_resume);
+		ocf_req_hash_unlock_rd(req);
 	}
 
-	ocf_req_hash_unlock_rd(req);
-
 	if (mapped) {
 		if (lock >= 0) {
 			OCF_DEBUG_RQ(req, "Fast path success");
@@ -26,6 +26,7 @@
 #include "cache_engine.h"
 #include "engine_mfwa.h"
 #include "mf_monitor.h"
+#include "mf_detector.h"
 
 
 #define OCF_ENGINE_DEBUG_IO_NAME "mfwa"
@@ -35,9 +36,18 @@
  * These two switches should be controlled by a monitor, but for
  * now hardcoded into engine.
  */
-static inline bool data_admit_allow()
+static inline bool data_admit_allow(struct ocf_request *req)
 {
-    return monitor_query_data_admit();
+    double data_admit = monitor_query_data_admit();
+
+    /**
+     * Below 1.0 admission trickles, promotion policy then picks only
+     * frequently accessed lines.
+     */
+    req->data_admit_trickle = data_admit < 1.0;
+
+    return data_admit >= 1.0
+           || (((double) rand()) / RAND_MAX) < data_admit;
 }
 
 static inline bool load_admit_allow()
@@ -67,6 +77,8 @@ static void _ocf_read_mfwa_to_cache_cmpl(struct ocf_request *req, int error)
     if (env_atomic_dec_return(&req->req_remaining) == 0) {
         OCF_DEBUG_RQ(req, "TO_CACHE completion");
 
+        ocf_engine_lat_end(req);
+
         /** If error, fallback to PT. */
         if (req->error) {
             ocf_core_stats_cache_error_update(req->core, OCF_READ);
@@ -84,6 +96,7 @@ static inline void _ocf_read_mfwa_submit_to_cache(struct ocf_request *req)
 {
     env_atomic_set(&req->req_remaining, ocf_engine_io_count(req));
 
+    ocf_engine_lat_start(req, ocf_lat_cache_read);
     ocf_submit_cache_reqs(req->cache, req, OCF_READ, 0, req->byte_length,
                           ocf_engine_io_count(req),
                           _ocf_read_mfwa_to_cache_cmpl);
@@ -105,6 +118,8 @@ static void _ocf_read_mfwa_to_core_cmpl_do_promote(struct ocf_request *req,
     if (env_atomic_dec_return(&req->req_remaining) == 0) {
         OCF_DEBUG_RQ(req, "TO_CORE completion");
 
+        ocf_engine_lat_end(req);
+
         /**
          * If error, do not submit this request to backfill thread.
          * Stop it here.
@@ -151,6 +166,8 @@ static void _ocf_read_mfwa_to_core_cmpl_no_promote(struct ocf_request *req,
     if (env_atomic_dec_return(&req->req_remaining) == 0) {
         OCF_DEBUG_RQ(req, "TO_CORE completion");
 
+        ocf_engine_lat_end(req);
+
         /**
          * If error, do not submit this request to backfill thread.
          * Stop it here.
@@ -184,6 +201,10 @@ static inline void _ocf_read_mfwa_submit_to_core(struct ocf_request *req,
 
     env_atomic_set(&req->req_remaining, 1);
 
+    /** Hits end up here only when redirected by `load_admit`. */
+    ocf_engine_lat_start(req, ocf_engine_is_hit(req) ?
+            ocf_lat_core_read_offload : ocf_lat_core_read_miss);
+
     /**
      * Doing promotion. Allocate `cp_data` region for backfilling
      * purpose. Submit read request to volume and assign
@@ -328,9 +349,10 @@ static const struct ocf_engine_callbacks _read_mfwa_engine_callbacks =
  * read from core.
  *
  * When miss and reading from core, we promote core lines into cache only
- * if the `data_admit` switch is on. Promotion decision is not implemented
- * into a new promotion policy because the promotion policy interface seems
- * redundant and too complicated for our algo's logic.
+ * if the `data_admit` switch is on and the promotion policy agrees (see
+ * `ocf_promotion_req_should_promote()`). Rejected misses are not mapped
+ * and go pass-through. The `nhc` policy additionally filters one-hit
+ * wonders and bounds cache write bandwidth spent on backfills.
  */
 int ocf_read_mfwa(struct ocf_request *req)
 {
@@ -352,7 +374,7 @@ int ocf_read_mfwa(struct ocf_request *req)
      * Query the current multi-factor config and assign `load_admit` &
      * `data_admit` behavior to this request.
      */
-    req->data_admit_allowed = data_admit_allow();
+    req->data_admit_allowed = data_admit_allow(req);
     req->load_admit_allowed = load_admit_allow();
 
     /** Set resume call backs. */
@@ -360,6 +382,9 @@ int ocf_read_mfwa(struct ocf_request *req)
 
     lock = ocf_engine_prepare_clines(req, &_read_mfwa_engine_callbacks);
 
+    /** Feed workload change detector with sampled hits & misses. */
+    mf_detector_req_access(req);
+
     if (!req->info.mapping_error) {
         if (lock >= 0) {
             if (lock != OCF_LOCK_ACQUIRED) {
@@ -375,6 +400,7 @@ int ocf_read_mfwa(struct ocf_request *req)
             ocf_req_put(req);
         }
     } else {
+        mf_detector_req_rejected(req);
         ocf_req_clear(req);
         ocf_get_io_if(ocf_cache_mode_pt)->read(req);
     }
@@ -27,6 +27,7 @@
 #include "cache_engine.h"
 #include "engine_mfwb.h"
 #include "mf_monitor.h"
+#include "mf_detector.h"
 
 
 #define OCF_ENGINE_DEBUG_IO_NAME "mfwb"
@@ -36,9 +37,18 @@
  * These two switches should be controlled by a monitor, but for
  * now hardcoded into engine.
  */
-static inline bool data_admit_allow()
+static inline bool data_admit_allow(struct ocf_request *req)
 {
-    return monitor_query_data_admit();
+    double data_admit = monitor_query_data_admit();
+
+    /**
+     * Below 1.0 admission trickles, promotion policy then picks only
+     * frequently accessed lines.
+     */
+    req->data_admit_trickle = data_admit < 1.0;
+
+    return data_admit >= 1.0
+           || (((double) rand()) / RAND_MAX) < data_admit;
 }
 
 static inline bool load_admit_allow()
@@ -68,6 +78,8 @@ static void _ocf_read_mfwb_to_cache_cmpl(struct ocf_request *req, int error)
     if (env_atomic_dec_return(&req->req_remaining) == 0) {
         OCF_DEBUG_RQ(req, "TO_CACHE completion");
 
+        ocf_engine_lat_end(req);
+
         /** If error, fallback to PT. */
         if (req->error) {
             ocf_core_stats_cache_error_update(req->core, OCF_READ);
@@ -85,6 +97,7 @@ static inline void _ocf_read_mfwb_submit_to_cache(struct ocf_request *req)
 {
     env_atomic_set(&req->req_remaining, ocf_engine_io_count(req));
 
+    ocf_engine_lat_start(req, ocf_lat_cache_read);
     ocf_submit_cache_reqs(req->cache, req, OCF_READ, 0, req->byte_length,
                           ocf_engine_io_count(req),
                           _ocf_read_mfwb_to_cache_cmpl);
@@ -106,6 +119,8 @@ static void _ocf_read_mfwb_to_core_cmpl_do_promote(struct ocf_request *req,
     if (env_atomic_dec_return(&req->req_remaining) == 0) {
         OCF_DEBUG_RQ(req, "TO_CORE completion");
 
+        ocf_engine_lat_end(req);
+
         /**
          * If error, do not submit this request to backfill thread.
          * Stop it here.
@@ -152,6 +167,8 @@ static void _ocf_read_mfwb_to_core_cmpl_no_promote(struct ocf_request *req,
     if (env_atomic_dec_return(&req->req_remaining) == 0) {
         OCF_DEBUG_RQ(req, "TO_CORE completion");
 
+        ocf_engine_lat_end(req);
+
         /**
          * If error, do not submit this request to backfill thread.
          * Stop it here.
@@ -185,6 +202,10 @@ static inline void _ocf_read_mfwb_submit_to_core(struct ocf_request *req,
 
     env_atomic_set(&req->req_remaining, 1);
 
+    /** Hits end up here only when redirected by `load_admit`. */
+    ocf_engine_lat_start(req, ocf_engine_is_hit(req) ?
+            ocf_lat_core_read_offload : ocf_lat_core_read_miss);
+
     /**
      * Doing promotion. Allocate `cp_data` region for backfilling
      * purpose. Submit read request to volume and assign
@@ -238,6 +259,9 @@ static int _ocf_read_mfwb_do(struct ocf_request *req)
 
         /** Hit && there is dirty line, MUST read from cache. */
         if (req->info.dirty_any) {
+            /** Let the cleaner make hot dirty lines offloadable. */
+            ocf_cleaning_req_dirty_hit(req);
+
             OCF_DEBUG_RQ(req, "Submit");
             _ocf_read_mfwb_submit_to_cache(req);
 
@@ -336,9 +360,10 @@ static const struct ocf_engine_callbacks _read_mfwb_engine_callbacks =
  * `load_admit`, we read from cache. Otherwise, we read from core.
  *
  * When miss and reading from core, we promote core lines into cache only
- * if the `data_admit` switch is on. Promotion decision is not implemented
- * into a new promotion policy because the promotion policy interface seems
- * redundant and too complicated for our algo's logic.
+ * if the `data_admit` switch is on and the promotion policy agrees (see
+ * `ocf_promotion_req_should_promote()`). Rejected misses are not mapped
+ * and go pass-through. The `nhc` policy additionally filters one-hit
+ * wonders and bounds cache write bandwidth spent on backfills.
  */
 int ocf_read_mfwb(struct ocf_request *req)
 {
@@ -360,7 +385,7 @@ int ocf_read_mfwb(struct ocf_request *req)
      * Query the current multi-factor config and assign `load_admit` &
      * `data_admit` behavior to this request.
      */
-    req->data_admit_allowed = data_admit_allow();
+    req->data_admit_allowed = data_admit_allow(req);
     req->load_admit_allowed = load_admit_allow();
 
     /** Set resume call backs. */
@@ -368,6 +393,9 @@ int ocf_read_mfwb(struct ocf_request *req)
 
     lock = ocf_engine_prepare_clines(req, &_read_mfwb_engine_callbacks);
 
+    /** Feed workload change detector with sampled hits & misses. */
+    mf_detector_req_access(req);
+
     if (!req->info.mapping_error) {
         if (lock >= 0) {
             if (lock != OCF_LOCK_ACQUIRED) {
@@ -383,6 +411,7 @@ int ocf_read_mfwb(struct ocf_request *req)
             ocf_req_put(req);
         }
     } else {
+        mf_detector_req_rejected(req);
         ocf_req_clear(req);
         ocf_get_io_if(ocf_cache_mode_pt)->read(req);
     }
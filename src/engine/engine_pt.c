@@ -127,6 +127,7 @@ int ocf_read_pt(struct ocf_request *req)
 			/* There are mapped cache line,
 			 * lock request for READ access
 			 */
+			ocf_engine_lat_start(req, ocf_lat_lock_wait);
 			lock = ocf_req_async_lock_rd(req, ocf_engine_on_resume);
 		} else {
 			/* No mapped cache lines, no need to get lock */
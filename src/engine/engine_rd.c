@@ -37,6 +37,8 @@ static void _ocf_read_generic_hit_complete(struct ocf_request *req, int error)
 	if (env_atomic_dec_return(&req->req_remaining) == 0) {
 		OCF_DEBUG_RQ(req, "HIT completion");
 
+		ocf_engine_lat_end(req);
+
 		if (req->error) {
 			ocf_core_stats_cache_error_update(req->core, OCF_READ);
 			ocf_engine_push_req_front_pt(req);
@@ -69,6 +71,8 @@ static void _ocf_read_generic_miss_complete(struct ocf_request *req, int error)
 	if (env_atomic_dec_return(&req->req_remaining) == 0) {
 		OCF_DEBUG_RQ(req, "MISS completion");
 
+		ocf_engine_lat_end(req);
+
 		if (req->error) {
 			/*
 			 * --- Do not submit this request to write-back-thread.
@@ -105,6 +109,7 @@ void ocf_read_generic_submit_hit(struct ocf_request *req)
 {
 	env_atomic_set(&req->req_remaining, ocf_engine_io_count(req));
 
+	ocf_engine_lat_start(req, ocf_lat_cache_read);
 	ocf_submit_cache_reqs(req->cache, req, OCF_READ, 0, req->byte_length,
 		ocf_engine_io_count(req), _ocf_read_generic_hit_complete);
 }
@@ -126,6 +131,7 @@ static inline void _ocf_read_generic_submit_miss(struct ocf_request *req)
 		goto err_alloc;
 
 	/* Submit read request to core device. */
+	ocf_engine_lat_start(req, ocf_lat_core_read_miss);
 	ocf_submit_volume_req(&req->core->volume, req,
 			_ocf_read_generic_miss_complete);
 
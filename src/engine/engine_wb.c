@@ -97,6 +97,8 @@ static void _ocf_write_wb_complete(struct ocf_request *req, int error)
 
 	OCF_DEBUG_RQ(req, "Completion");
 
+	ocf_engine_lat_end(req);
+
 	if (req->error) {
 		ocf_engine_error(req, true, "Failed to write data to cache");
 
@@ -138,6 +140,7 @@ static inline void _ocf_write_wb_submit(struct ocf_request *req)
 	OCF_DEBUG_RQ(req, "Submit Data");
 
 	/* Data IO */
+	ocf_engine_lat_start(req, ocf_lat_wb_write);
 	ocf_submit_cache_reqs(cache, req, OCF_WRITE, 0, req->byte_length,
 			ocf_engine_io_count(req), _ocf_write_wb_complete);
 }
@@ -222,6 +222,7 @@ int ocf_read_wo(struct ocf_request *req)
 		/* There are mapped cache lines,
 		 * lock request for READ access
 		 */
+		ocf_engine_lat_start(req, ocf_lat_lock_wait);
 		lock = ocf_req_async_lock_rd(req, ocf_engine_on_resume);
 	}
 
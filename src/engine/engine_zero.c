@@ -152,6 +152,7 @@ void ocf_engine_zero_line(struct ocf_request *req)
 	req->io_if = &_io_if_ocf_zero_do;
 
 	/* Some cache line are mapped, lock request for WRITE access */
+	ocf_engine_lat_start(req, ocf_lat_lock_wait);
 	lock = ocf_req_async_lock_wr(req, ocf_engine_on_resume);
 
 	if (lock >= 0) {
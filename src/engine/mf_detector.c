@@ -0,0 +1,377 @@
+/**
+ * Workload change detector for the multi-factor caching monitor.
+ *
+ * Ghost cache: 1/2^GHOST_SAMPLE_SHIFT of core lines (chosen by hash) is
+ * tracked. When such a line is evicted or its promotion is rejected, its
+ * fingerprint is put into a direct mapped ghost table, newer entries
+ * overwriting older ones, which approximates a ghost LRU of about one
+ * cache worth of lines. A sampled miss that finds its line in the ghost
+ * is a "ghost hit" - a miss a re-warmed cache would likely have served.
+ *
+ * Change detection: the monitor calls `mf_detector_evaluate()` in its
+ * tuning loop. Each window with enough sampled accesses yields a miss
+ * ratio and a ghost hit ratio. After a baseline is learned, two-sided
+ * CUSUM runs on miss ratio and one-sided (upwards) CUSUM on ghost hit
+ * ratio. The latter catches hot set shifts which keep miss ratio flat.
+ * On alarm, re-probing is requested only if ghost hit ratio grew over
+ * baseline by at least MIN_REPROBE_BENEFIT, otherwise the new state
+ * becomes the baseline.
+ */
+
+/*========== [Orthus FLAG BEGIN] ==========*/
+
+#include <stdbool.h>
+#include "ocf/ocf.h"
+#include "../ocf_cache_priv.h"
+#include "../metadata/metadata.h"
+#include "../utils/utils_freq_sketch.h"
+#include "cache_engine.h"
+#include "mf_detector.h"
+
+
+/** Track 1 / 2^X of core lines. */
+#define GHOST_SAMPLE_SHIFT 6
+
+/** Ghost table never smaller than that. */
+static const uint64_t GHOST_MIN_ENTRIES = 1024;
+
+/** Evaluate a window only when it has at least X sampled accesses. */
+static const long MIN_WINDOW_ACCESSES = 256;
+
+/** Number of windows averaged into the baseline. */
+static const int BASELINE_WINDOWS = 8;
+
+/** CUSUM slack & decision limit on miss ratio. */
+static const double MISS_CUSUM_SLACK = 0.02;
+static const double MISS_CUSUM_LIMIT = 0.1;
+
+/** CUSUM slack & decision limit on ghost hit ratio. */
+static const double GHOST_CUSUM_SLACK = 0.01;
+static const double GHOST_CUSUM_LIMIT = 0.05;
+
+/** Re-probe only if ghost hit ratio grew at least by X. */
+static const double MIN_REPROBE_BENEFIT = 0.05;
+
+
+struct mf_cusum {
+    double mean;
+    double slack;
+    double limit;
+    double pos;
+    double neg;
+};
+
+struct mf_detector {
+    env_atomic64 *ghost;
+    uint64_t ghost_mask;
+
+    /** Sampled access counters of current window. */
+    env_atomic64 accesses;
+    env_atomic64 misses;
+    env_atomic64 ghost_hits;
+
+    /** Below fields are touched by the monitor thread only. */
+    struct mf_cusum miss_cusum;
+    struct mf_cusum ghost_cusum;
+
+    int baseline_windows;
+    double baseline_miss_sum;
+    double baseline_ghost_sum;
+};
+
+static struct mf_detector *detector;
+
+/** IO path hooks currently using `detector`. */
+static env_atomic detector_users;
+
+
+/**
+ * Sampling & ghost table helpers.
+ */
+static inline bool
+_sampled(uint64_t hash)
+{
+    return (hash >> (64 - GHOST_SAMPLE_SHIFT)) == 0;
+}
+
+static inline env_atomic64 *
+_ghost_slot(struct mf_detector *det, uint64_t hash)
+{
+    return &det->ghost[hash & det->ghost_mask];
+}
+
+static inline void
+_ghost_insert(struct mf_detector *det, uint64_t hash)
+{
+    env_atomic64_set(_ghost_slot(det, hash), hash | 1);
+}
+
+static inline bool
+_ghost_remove(struct mf_detector *det, uint64_t hash)
+{
+    long fp = hash | 1;
+
+    return env_atomic64_cmpxchg(_ghost_slot(det, hash), fp, 0) == fp;
+}
+
+
+/**
+ * Pin detector for an IO path hook, so that deinit does not free it
+ * underneath. Must be paired with `_detector_put()`, also on NULL.
+ */
+static inline struct mf_detector *
+_detector_get()
+{
+    env_atomic_inc(&detector_users);
+    env_smp_mb();
+
+    return detector;
+}
+
+static inline void
+_detector_put()
+{
+    env_atomic_dec(&detector_users);
+}
+
+
+/**
+ * Hooks called from the IO path.
+ */
+void
+mf_detector_req_access(struct ocf_request *req)
+{
+    struct mf_detector *det = _detector_get();
+    uint64_t hash;
+    uint32_t i;
+
+    if (!det)
+        goto out;
+
+    for (i = 0; i < req->core_line_count; i++) {
+        struct ocf_map_info *entry = &req->map[i];
+
+        hash = ocf_freq_sketch_hash(entry->core_id, entry->core_line);
+        if (!_sampled(hash))
+            continue;
+
+        env_atomic64_inc(&det->accesses);
+        if (entry->status == LOOKUP_HIT)
+            continue;
+
+        env_atomic64_inc(&det->misses);
+        if (_ghost_remove(det, hash))
+            env_atomic64_inc(&det->ghost_hits);
+    }
+
+out:
+    _detector_put();
+}
+
+void
+mf_detector_req_rejected(struct ocf_request *req)
+{
+    struct mf_detector *det = _detector_get();
+    uint64_t hash;
+    uint32_t i;
+
+    if (!det)
+        goto out;
+
+    for (i = 0; i < req->core_line_count; i++) {
+        struct ocf_map_info *entry = &req->map[i];
+
+        if (entry->status == LOOKUP_HIT)
+            continue;
+
+        hash = ocf_freq_sketch_hash(entry->core_id, entry->core_line);
+        if (_sampled(hash))
+            _ghost_insert(det, hash);
+    }
+
+out:
+    _detector_put();
+}
+
+void
+mf_detector_cline_evicted(ocf_cache_t cache, ocf_cache_line_t cline)
+{
+    struct mf_detector *det = _detector_get();
+    ocf_core_id_t core_id;
+    uint64_t core_line, hash;
+
+    if (det) {
+        ocf_metadata_get_core_info(cache, cline, &core_id, &core_line);
+
+        hash = ocf_freq_sketch_hash(core_id, core_line);
+        if (_sampled(hash))
+            _ghost_insert(det, hash);
+    }
+
+    _detector_put();
+}
+
+
+/**
+ * CUSUM change-point statistics. Returns 1 on upward change, -1 on
+ * downward change, 0 otherwise.
+ */
+static void
+_cusum_reset(struct mf_cusum *cusum, double mean, double slack,
+             double limit)
+{
+    cusum->mean = mean;
+    cusum->slack = slack;
+    cusum->limit = limit;
+    cusum->pos = 0.0;
+    cusum->neg = 0.0;
+}
+
+static int
+_cusum_update(struct mf_cusum *cusum, double x)
+{
+    cusum->pos = OCF_MAX(0.0, cusum->pos + x - cusum->mean - cusum->slack);
+    cusum->neg = OCF_MAX(0.0, cusum->neg + cusum->mean - x - cusum->slack);
+
+    if (cusum->pos > cusum->limit)
+        return 1;
+    if (cusum->neg > cusum->limit)
+        return -1;
+    return 0;
+}
+
+
+/**
+ * Monitor interface.
+ */
+void
+mf_detector_rebase()
+{
+    struct mf_detector *det = detector;
+
+    if (!det)
+        return;
+
+    det->baseline_windows = 0;
+    det->baseline_miss_sum = 0.0;
+    det->baseline_ghost_sum = 0.0;
+
+    /** Drop the window collected under old conditions. */
+    env_atomic64_set(&det->accesses, 0);
+    env_atomic64_set(&det->misses, 0);
+    env_atomic64_set(&det->ghost_hits, 0);
+}
+
+enum mf_detector_verdict
+mf_detector_evaluate()
+{
+    struct mf_detector *det = detector;
+    long accesses, misses, ghost_hits;
+    double miss_ratio, ghost_ratio;
+    int miss_change, ghost_change;
+
+    if (!det)
+        return MF_DETECTOR_NONE;
+
+    accesses = env_atomic64_read(&det->accesses);
+    if (accesses < MIN_WINDOW_ACCESSES)
+        return det->baseline_windows < BASELINE_WINDOWS ?
+               MF_DETECTOR_LEARNING : MF_DETECTOR_NONE;
+
+    /** Close the window, keeping increments which raced with us. */
+    misses = env_atomic64_read(&det->misses);
+    ghost_hits = env_atomic64_read(&det->ghost_hits);
+    env_atomic64_sub(accesses, &det->accesses);
+    env_atomic64_sub(misses, &det->misses);
+    env_atomic64_sub(ghost_hits, &det->ghost_hits);
+
+    miss_ratio = OCF_MIN(1.0, (double) misses / accesses);
+    ghost_ratio = OCF_MIN(1.0, (double) ghost_hits / accesses);
+
+    if (det->baseline_windows < BASELINE_WINDOWS) {
+        det->baseline_miss_sum += miss_ratio;
+        det->baseline_ghost_sum += ghost_ratio;
+
+        if (++det->baseline_windows < BASELINE_WINDOWS)
+            return MF_DETECTOR_LEARNING;
+
+        _cusum_reset(&det->miss_cusum,
+                     det->baseline_miss_sum / BASELINE_WINDOWS,
+                     MISS_CUSUM_SLACK, MISS_CUSUM_LIMIT);
+        _cusum_reset(&det->ghost_cusum,
+                     det->baseline_ghost_sum / BASELINE_WINDOWS,
+                     GHOST_CUSUM_SLACK, GHOST_CUSUM_LIMIT);
+        return MF_DETECTOR_NONE;
+    }
+
+    miss_change = _cusum_update(&det->miss_cusum, miss_ratio);
+    ghost_change = _cusum_update(&det->ghost_cusum, ghost_ratio);
+
+    if (miss_change > 0 || ghost_change > 0) {
+        if (ghost_ratio - det->ghost_cusum.mean >= MIN_REPROBE_BENEFIT)
+            return MF_DETECTOR_REPROBE;
+
+        mf_detector_rebase();
+        return MF_DETECTOR_REBASED;
+    }
+
+    if (miss_change < 0) {
+        mf_detector_rebase();
+        return MF_DETECTOR_IMPROVED;
+    }
+
+    return MF_DETECTOR_NONE;
+}
+
+/**
+ * Allocate ghost table sized to the sampled share of cache lines.
+ */
+int
+mf_detector_init(ocf_cache_t cache)
+{
+    struct mf_detector *det;
+    uint64_t entries = GHOST_MIN_ENTRIES;
+    uint64_t sampled_lines = ocf_metadata_get_cachelines_count(cache)
+                             >> GHOST_SAMPLE_SHIFT;
+
+    while (entries < sampled_lines)
+        entries <<= 1;
+
+    det = env_vzalloc(sizeof(*det));
+    if (!det)
+        return -OCF_ERR_NO_MEM;
+
+    det->ghost = env_vzalloc(entries * sizeof(*det->ghost));
+    if (!det->ghost) {
+        env_vfree(det);
+        return -OCF_ERR_NO_MEM;
+    }
+
+    det->ghost_mask = entries - 1;
+
+    detector = det;
+    mf_detector_rebase();
+
+    return 0;
+}
+
+void
+mf_detector_deinit()
+{
+    struct mf_detector *det = detector;
+
+    if (!det)
+        return;
+
+    /** Wait for IO path hooks which may still see the old pointer. */
+    detector = NULL;
+    env_smp_mb();
+
+    while (env_atomic_read(&detector_users))
+        env_msleep(1);
+
+    env_vfree(det->ghost);
+    env_vfree(det);
+}
+
+/*========== [Orthus FLAG END] ==========*/
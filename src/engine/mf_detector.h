@@ -0,0 +1,51 @@
+/**
+ * Workload change detector for the multi-factor caching monitor.
+ *
+ * Keeps a sampled ghost cache of core lines recently evicted from or
+ * rejected by the cache, and runs CUSUM change-point tests on windowed
+ * miss ratio and ghost hit ratio. Used by `mf_monitor.c` to decide
+ * whether re-probing the workload is worth a cache re-warm.
+ */
+
+/*========== [Orthus FLAG BEGIN] ==========*/
+
+#ifndef MF_DETECTOR_H_
+#define MF_DETECTOR_H_
+
+
+#include "ocf/ocf.h"
+#include "../ocf_request.h"
+
+
+enum mf_detector_verdict {
+    /** No change, or not enough samples in this window yet. */
+    MF_DETECTOR_NONE,
+
+    /** Still learning baseline after `mf_detector_rebase()`. */
+    MF_DETECTOR_LEARNING,
+
+    /** Workload changed for the better, baseline moved. */
+    MF_DETECTOR_IMPROVED,
+
+    /** Workload changed, but re-probing would not pay off. */
+    MF_DETECTOR_REBASED,
+
+    /** Workload changed and ghost hits promise a real benefit. */
+    MF_DETECTOR_REPROBE,
+};
+
+
+int mf_detector_init(ocf_cache_t cache);
+void mf_detector_deinit();
+
+void mf_detector_req_access(struct ocf_request *req);
+void mf_detector_req_rejected(struct ocf_request *req);
+void mf_detector_cline_evicted(ocf_cache_t cache, ocf_cache_line_t cline);
+
+void mf_detector_rebase();
+enum mf_detector_verdict mf_detector_evaluate();
+
+
+#endif /* MF_DETECTOR_H_ */
+
+/*========== [Orthus FLAG END] ==========*/
@@ -2,7 +2,9 @@
  * The multi-factor caching algorithm monitor.
  *
  * Dynamically monitors and tweaks `data_admit` & `load_admit` switches
- * on the fly.
+ * on the fly. `data_admit` is an admission probability: 1.0 while
+ * probing, a low trickle rate while tuning `load_admit`, so the cache
+ * keeps following a drifting hot set without a full re-probe.
  */
 
 /*========== [Orthus FLAG BEGIN] ==========*/
@@ -13,14 +15,17 @@
 #include "core/core-obj.h"
 #include "ocf/ocf.h"
 #include "mf_monitor.h"
+#include "mf_detector.h"
+#include "../promotion/promotion.h"
+#include "../cleaning/cleaning.h"
 
 
 /** Indicates whether the contexts stops the monitor. */
 static env_atomic should_stop;
 
 
-/** `data_admit` switch, protected by a global rwlock. */
-static bool global_data_admit = true;
+/** `data_admit` probability, protected by a global rwlock. */
+static double global_data_admit = 1.0;
 
 /** `load_admit` switch, protected by a global rwlock. */
 static double global_load_admit = 1.0;
@@ -31,16 +36,37 @@ static env_rwlock data_admit_lock;
 /** Reader-writer lock to protect `load_admit`. */
 static env_rwlock load_admit_lock;
 
+/** Cache of the monitored core, switch changes are traced there. */
+static ocf_cache_t monitor_cache;
+
+/** NHC promotion write budget configured by the user (MiB/s). */
+static uint32_t base_write_budget;
+
+/** Highest cache device throughput seen so far (KB/s). */
+static double cache_peak_tp;
+
+/** Cleaning rate limit configured by the user (MiB/s, 0 = unlimited). */
+static uint32_t base_clean_budget;
+
+/** Highest core device throughput seen so far (KB/s). */
+static double core_peak_tp;
+
+/** Cleaning rate limit integrated by the tuning loop (KiB/s). */
+static double clean_budget;
+
 
 /**
  * Set switch value with writer lock.
  */
 static void
-monitor_set_data_admit(bool data_admit)
+monitor_set_data_admit(double data_admit)
 {
     env_rwlock_write_lock(&data_admit_lock);
     global_data_admit = data_admit;
     env_rwlock_write_unlock(&data_admit_lock);
+
+    ocf_trace_ring_counter(monitor_cache, ocf_trace_counter_data_admit,
+                           (uint64_t) (data_admit * 1000000));
 }
 
 static void
@@ -49,15 +75,18 @@ monitor_set_load_admit(double load_admit)
     env_rwlock_write_lock(&load_admit_lock);
     global_load_admit = load_admit;
     env_rwlock_write_unlock(&load_admit_lock);
+
+    ocf_trace_ring_counter(monitor_cache, ocf_trace_counter_load_admit,
+                           (uint64_t) (load_admit * 1000000));
 }
 
 /**
  * For OCF mf policy to query the switch values.
  */
-bool
+double
 monitor_query_data_admit()
 {
-    bool data_admit;
+    double data_admit;
 
     env_rwlock_read_lock(&data_admit_lock);
     data_admit = global_data_admit;
@@ -87,26 +116,57 @@ static const double WAIT_STABLE_THRESHOLD = 0.0015;
 /** Sleep X microseconds when detecting cache stability. */
 static const int WAIT_STABLE_SLEEP_INTERVAL_US = 100000;
 
-/** Consider workload change when miss ratio > BASE_RATIO + X. */
-static const double WORKLOAD_CHANGE_THRESHOLD = 0.2;
-
 /** `load_admit` tuning step size. */
 static const double LOAD_ADMIT_TUNING_STEP = 0.01;
 
 /** Measure throughput for a `load_admit` value for X microseconds. */
 static const int MEASURE_THROUGHPUT_INTERVAL_US = 25000;
 
+/** `data_admit` probability while tuning `load_admit`. */
+static const double TRICKLE_DATA_ADMIT = 0.05;
+
+/** Fraction of spare cache device bandwidth given to trickle admission. */
+static const double TRICKLE_SPARE_BW_FRACTION = 0.5;
+
+/** Trickle admission never stops completely (MiB/s). */
+static const uint32_t TRICKLE_MIN_WRITE_BUDGET = 1;
+
+/** Trust the miss ratio curve only if built from at least X samples. */
+static const uint64_t MRC_MIN_SAMPLES = 1024;
+
+/** Stop trickling if MRC predicts miss ratio within X of the current. */
+static const double MRC_MIN_ADMIT_GAIN = 0.02;
+
+/** Keep core device, cleaning included, at X of its peak throughput. */
+static const double CLEAN_TARGET_CORE_UTIL = 0.9;
+
+/** Fraction of core throughput error integrated per tuning iteration. */
+static const double CLEAN_BUDGET_GAIN = 0.5;
+
+/** Cleaning never stops completely (KiB/s). */
+static const double CLEAN_MIN_BUDGET = 1024.0;
+
 /**
- * Query the stat component for read (partial + full) miss ratio info.
+ * Exit the monitor thread if the context asked it to stop.
  */
-static inline double
-_get_miss_ratio(ocf_core_t core)
+static inline void
+_check_should_stop()
 {
     if (env_atomic_read(&should_stop) != 0) {
+        mf_detector_deinit();
         env_rwlock_destroy(&data_admit_lock);
         env_rwlock_destroy(&load_admit_lock);
         pthread_exit(NULL);
     }
+}
+
+/**
+ * Query the stat component for read (partial + full) miss ratio info.
+ */
+static inline double
+_get_miss_ratio(ocf_core_t core)
+{
+    _check_should_stop();
 
     return ocf_core_get_read_miss_ratio(core);
 }
@@ -125,6 +185,134 @@ _get_throughput()
            + core_log_query_throughput(begin_time_ms, cur_time_ms);
 }
 
+/**
+ * Query the cache device log for its recent throughput (KB/s).
+ */
+static inline double
+_get_cache_throughput()
+{
+    double cur_time_ms = get_cur_time_ms();
+    double begin_time_ms = cur_time_ms
+                           - (MEASURE_THROUGHPUT_INTERVAL_US / 1000.0);
+    double tp = cache_log_query_throughput(begin_time_ms, cur_time_ms);
+
+    if (tp > cache_peak_tp)
+        cache_peak_tp = tp;
+
+    return tp;
+}
+
+/**
+ * Query the core device log for its recent throughput (KB/s). Cleaner
+ * writes go to the core as well, so this includes cleaning traffic.
+ */
+static inline double
+_get_core_throughput()
+{
+    double cur_time_ms = get_cur_time_ms();
+    double begin_time_ms = cur_time_ms
+                           - (MEASURE_THROUGHPUT_INTERVAL_US / 1000.0);
+    double tp = core_log_query_throughput(begin_time_ms, cur_time_ms);
+
+    if (tp > core_peak_tp)
+        core_peak_tp = tp;
+
+    return tp;
+}
+
+/**
+ * Rate limit parameter of the cleaning policy in use, if it has one.
+ */
+static bool
+_get_clean_budget_param(ocf_cleaning_t *type, uint32_t *param_id)
+{
+    ocf_mngt_cache_cleaning_get_policy(monitor_cache, type);
+
+    switch (*type) {
+    case ocf_cleaning_alru:
+        *param_id = ocf_alru_rate_limit;
+        return true;
+    case ocf_cleaning_acp:
+        *param_id = ocf_acp_rate_limit;
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * Set NHC promotion write budget (MiB/s, 0 = unlimited). Changes only the
+ * budget rate in place, the user configured value stays untouched.
+ */
+static void
+monitor_set_write_budget(uint32_t write_budget)
+{
+    ocf_promotion_set_write_rate(monitor_cache,
+                                 (uint64_t) write_budget * MiB);
+}
+
+/**
+ * Set cleaner pacing rate (KiB/s, 0 = unlimited). Changes only the pacing
+ * rate in place, the user configured rate limit stays untouched.
+ */
+static void
+monitor_set_clean_budget(uint64_t clean_budget)
+{
+    ocf_cleaner_set_pace_rate(monitor_cache, clean_budget * KiB);
+}
+
+/**
+ * Pace cleaning so that the core device, which serves offloaded hits,
+ * stays just below its peak throughput. Measured core throughput already
+ * contains cleaning writes, so the budget is integrated from the error
+ * against the target instead of being set to the spare bandwidth.
+ */
+static void
+monitor_update_clean_budget()
+{
+    double target_tp = core_peak_tp * CLEAN_TARGET_CORE_UTIL;
+    double core_tp = _get_core_throughput();
+
+    clean_budget += CLEAN_BUDGET_GAIN * (target_tp - core_tp);
+    if (clean_budget > target_tp)
+        clean_budget = target_tp;
+    if (base_clean_budget && clean_budget > base_clean_budget * 1024.0)
+        clean_budget = base_clean_budget * 1024.0;
+    if (clean_budget < CLEAN_MIN_BUDGET)
+        clean_budget = CLEAN_MIN_BUDGET;
+
+    monitor_set_clean_budget((uint64_t) clean_budget);
+
+    if (MONITOR_LOG_ENABLE) {
+        fprintf(fmonitor, "  (tune) cleaning budget = %.0lf KiB/s\n",
+                clean_budget);
+    }
+}
+
+/**
+ * Cap trickle admission by spare cache device bandwidth, measured
+ * against the highest throughput the device has shown.
+ */
+static void
+monitor_update_trickle_budget()
+{
+    double spare_tp = cache_peak_tp - _get_cache_throughput();
+    uint32_t write_budget;
+
+    write_budget = (uint32_t) (spare_tp * TRICKLE_SPARE_BW_FRACTION / 1024);
+    if (write_budget < TRICKLE_MIN_WRITE_BUDGET)
+        write_budget = TRICKLE_MIN_WRITE_BUDGET;
+    if (base_write_budget && write_budget > base_write_budget)
+        write_budget = base_write_budget;
+
+    monitor_set_write_budget(write_budget);
+
+    if (MONITOR_LOG_ENABLE) {
+        fprintf(fmonitor, "  (tune) trickle budget = %u MiB/s\n",
+                write_budget);
+    }
+}
+
 /**
  * Wait until cache hit rate is stable. Returns the final miss ratio.
  */
@@ -137,6 +325,8 @@ monitor_wait_stable(ocf_core_t core)
     while (miss_ratio < last_miss_ratio - WAIT_STABLE_THRESHOLD
            || miss_ratio > last_miss_ratio + WAIT_STABLE_THRESHOLD) {
         usleep(WAIT_STABLE_SLEEP_INTERVAL_US);
+        _get_cache_throughput();
+        _get_core_throughput();
         
         last_miss_ratio = miss_ratio;
         miss_ratio = _get_miss_ratio(core);
@@ -161,12 +351,39 @@ monitor_measure_throughput(double load_admit)
     return _get_throughput();
 }
 
+/**
+ * Ask the detector whether workload changed enough to re-probe.
+ */
+static bool
+monitor_should_reprobe()
+{
+    _check_should_stop();
+
+    switch (mf_detector_evaluate()) {
+    case MF_DETECTOR_REPROBE:
+        if (MONITOR_LOG_ENABLE)
+            fprintf(fmonitor, "  (tune) workload change detected, quit\n");
+        return true;
+    case MF_DETECTOR_REBASED:
+        if (MONITOR_LOG_ENABLE)
+            fprintf(fmonitor, "  (tune) workload change without ghost "
+                              "hits, rebase\n");
+        return false;
+    case MF_DETECTOR_IMPROVED:
+        if (MONITOR_LOG_ENABLE)
+            fprintf(fmonitor, "  (tune) miss ratio dropped, rebase\n");
+        return false;
+    default:
+        return false;
+    }
+}
+
 /**
  * Repeatedly tune `load_admit` ratio until a workload change is
  * considered happened.
  */
 static void
-monitor_tune_load_admit(double base_miss_ratio, ocf_core_t core)
+monitor_tune_load_admit()
 {
     double la1, la2, la3;
     double tp1, tp2, tp3;
@@ -194,18 +411,18 @@ monitor_tune_load_admit(double base_miss_ratio, ocf_core_t core)
 
         monitor_set_load_admit(la2);    /** Recover. */
 
+        monitor_update_trickle_budget();
+        monitor_update_clean_budget();
+
         /** Slope following loop. */
         while (1) {
             /**
              * Workload change check:
-             * If detected workload change, quit and re-optimize.
+             * If detected workload change worth a re-warm, quit and
+             * re-optimize.
              */
-            double miss_ratio = _get_miss_ratio(core);
-            if (miss_ratio > base_miss_ratio + WORKLOAD_CHANGE_THRESHOLD) {
-                if (MONITOR_LOG_ENABLE)
-                    fprintf(fmonitor, "  (tune) miss ratio too high, quit\n");
+            if (monitor_should_reprobe())
                 return;
-            }
 
             /**
              * Middle ratio yields best throughput, goto intensity check.
@@ -269,6 +486,36 @@ monitor_tune_load_admit(double base_miss_ratio, ocf_core_t core)
     }
 }
 
+/**
+ * Pick `data_admit` trickle rate from the core's miss ratio curve. When
+ * the curve predicts that a fully re-warmed cache of the current size
+ * would miss about as often as the cache does now, new data is not
+ * worth the cache device bandwidth and trickling stops.
+ */
+static double
+monitor_trickle_data_admit(ocf_core_t core, double miss_ratio)
+{
+    struct ocf_stats_mrc mrc;
+    double predicted;
+
+    if (ocf_stats_collect_mrc_core(core, 0, &mrc) != 0 ||
+        mrc.samples < MRC_MIN_SAMPLES)
+        return TRICKLE_DATA_ADMIT;
+
+    /** Default step puts current cache size in the middle point. */
+    predicted = mrc.miss_ratio[OCF_STATS_MRC_POINTS / 2 - 1] / 10000.0;
+
+    if (MONITOR_LOG_ENABLE) {
+        fprintf(fmonitor, "  (tune) mrc predicted miss ratio = %.5lf\n",
+                predicted);
+    }
+
+    if (miss_ratio - predicted < MRC_MIN_ADMIT_GAIN)
+        return 0.0;
+
+    return TRICKLE_DATA_ADMIT;
+}
+
 /**
  * Monitor thread logic.
  */
@@ -283,21 +530,28 @@ monitor_func(void *core_ptr)
         /** Start a new workload with classic caching. */
         if (MONITOR_LOG_ENABLE)
             fprintf(fmonitor, "  (fall) start classic caching\n");
-        monitor_set_data_admit(true);
+        monitor_set_data_admit(1.0);
         monitor_set_load_admit(1.0);
+        monitor_set_write_budget(base_write_budget);
+        monitor_set_clean_budget((uint64_t) base_clean_budget * 1024);
 
         /** Wait until cache is stable. */
         base_miss_ratio = monitor_wait_stable(core);
-        if (MONITOR_LOG_ENABLE)
-            fprintf(fmonitor, "  (wait) cache is stable\n");
+        if (MONITOR_LOG_ENABLE) {
+            fprintf(fmonitor, "  (wait) cache is stable, miss ratio = "
+                              "%.5lf\n", base_miss_ratio);
+        }
 
-        /** Turn off `data_admit` and start `load_admit` tuning. */
-        monitor_set_data_admit(false);
+        /** Let `data_admit` trickle and start `load_admit` tuning. */
+        monitor_set_data_admit(monitor_trickle_data_admit(core,
+                                                          base_miss_ratio));
         if (MONITOR_LOG_ENABLE) {
-            fprintf(fmonitor, "  (tune) turn off data_admit & start "
+            fprintf(fmonitor, "  (tune) trickle data_admit & start "
                               "tuning\n");
         }
-        monitor_tune_load_admit(base_miss_ratio, core);
+        mf_detector_rebase();
+        clean_budget = CLEAN_MIN_BUDGET;
+        monitor_tune_load_admit();
     }
 
     return NULL;
@@ -314,33 +568,64 @@ ocf_mngt_mf_monitor_init(ocf_core_t core)
 {
     pthread_t monitor_thread_id;
     pthread_attr_t monitor_thread_attr;
+    ocf_cleaning_t type;
+    uint32_t param_id;
     int ret;
 
     env_atomic_set(&should_stop, 0);
 
-    global_data_admit = true;
+    monitor_cache = ocf_core_get_cache(core);
+
+    global_data_admit = 1.0;
     global_load_admit = 1.0;
 
+    cache_peak_tp = 0.0;
+    if (ocf_mngt_cache_promotion_get_param(monitor_cache, ocf_promotion_nhc,
+                                           ocf_nhc_write_budget,
+                                           &base_write_budget))
+        base_write_budget = 0;
+
+    core_peak_tp = 0.0;
+    if (!_get_clean_budget_param(&type, &param_id) ||
+        ocf_mngt_cache_cleaning_get_param(monitor_cache, type, param_id,
+                                          &base_clean_budget))
+        base_clean_budget = 0;
+
     env_rwlock_init(&data_admit_lock);
     env_rwlock_init(&load_admit_lock);
 
+    ret = mf_detector_init(monitor_cache);
+    if (ret)
+        goto err_detector;
+
     /** Monitor runs as an infinite loop, so set to detached. */
     ret = pthread_attr_init(&monitor_thread_attr);
     if (ret)
-        return ret;
+        goto err_attr;
 
     ret = pthread_attr_setdetachstate(&monitor_thread_attr,
                                       PTHREAD_CREATE_DETACHED);
     if (ret)
-        return ret;
+        goto err_thread;
 
     /** Create the monitor thread. */
     ret = pthread_create(&monitor_thread_id, &monitor_thread_attr,
                          monitor_func, (void *) core);
     if (ret)
-        return ret;
+        goto err_thread;
+
+    pthread_attr_destroy(&monitor_thread_attr);
 
     return 0;
+
+err_thread:
+    pthread_attr_destroy(&monitor_thread_attr);
+err_attr:
+    mf_detector_deinit();
+err_detector:
+    env_rwlock_destroy(&load_admit_lock);
+    env_rwlock_destroy(&data_admit_lock);
+    return ret;
 }
 
 /**
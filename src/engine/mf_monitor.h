@@ -14,7 +14,7 @@
 #include <stdbool.h>
 
 
-bool monitor_query_data_admit();
+double monitor_query_data_admit();
 double monitor_query_load_admit();
 
 
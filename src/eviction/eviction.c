@@ -5,7 +5,9 @@
 
 #include "eviction.h"
 #include "ops.h"
+#include "s3fifo.h"
 #include "../utils/utils_part.h"
+#include "../engine/engine_common.h"
 
 struct eviction_policy_ops evict_policy_ops[ocf_eviction_max] = {
 	[ocf_eviction_lru] = {
@@ -18,6 +20,30 @@ struct eviction_policy_ops evict_policy_ops[ocf_eviction_max] = {
 		.clean_cline = evp_lru_clean_cline,
 		.name = "lru",
 	},
+	[ocf_eviction_lru_sharded] = {
+		.init_cline = evp_lru_init_cline,
+		.rm_cline = evp_lru_rm_cline,
+		.req_clines = evp_lru_req_clines,
+		.hot_cline = evp_lru_hot_cline,
+		.touch_cline = evp_lru_touch_cline,
+		.init_evp = evp_lru_init_evp,
+		.dirty_cline = evp_lru_dirty_cline,
+		.clean_cline = evp_lru_clean_cline,
+		.name = "lru-sharded",
+	},
+	[ocf_eviction_s3fifo] = {
+		.initialize = evp_s3fifo_initialize,
+		.deinitialize = evp_s3fifo_deinitialize,
+		.init_cline = evp_s3fifo_init_cline,
+		.rm_cline = evp_s3fifo_rm_cline,
+		.req_clines = evp_s3fifo_req_clines,
+		.hot_cline = evp_s3fifo_hot_cline,
+		.touch_cline = evp_lru_touch_cline,
+		.init_evp = evp_s3fifo_init_evp,
+		.dirty_cline = evp_s3fifo_dirty_cline,
+		.clean_cline = evp_s3fifo_clean_cline,
+		.name = "s3fifo",
+	},
 };
 
 static uint32_t ocf_evict_calculate(struct ocf_user_part *part,
@@ -40,6 +66,54 @@ static uint32_t ocf_evict_calculate(struct ocf_user_part *part,
 	return to_evict;
 }
 
+static uint32_t ocf_evict_calculate_excess(struct ocf_user_part *part,
+		uint32_t to_evict)
+{
+	uint32_t keep = OCF_MAX(part->runtime->target_size,
+			part->config->min_size);
+
+	if (part->runtime->curr_size <= keep)
+		return 0;
+
+	return OCF_MIN(to_evict, part->runtime->curr_size - keep);
+}
+
+/*
+ * With IO classes balancing on, evict from partitions above their target
+ * size first, still never from partitions of higher priority than target.
+ */
+static inline uint32_t ocf_evict_excess(ocf_cache_t cache,
+		ocf_queue_t io_queue, const uint32_t evict_cline_no,
+		ocf_part_id_t target_part_id)
+{
+	uint32_t to_evict, evicted = 0;
+	struct ocf_user_part *part;
+	struct ocf_user_part *target_part = &cache->user_parts[target_part_id];
+	ocf_part_id_t part_id;
+
+	for_each_part(cache, part, part_id) {
+		if (!ocf_eviction_can_evict(cache))
+			break;
+
+		if (target_part->config->priority > part->config->priority)
+			break;
+		if (!part->config->flags.eviction)
+			break;
+		if (evicted >= evict_cline_no)
+			break;
+
+		to_evict = ocf_evict_calculate_excess(part,
+				evict_cline_no - evicted);
+		if (to_evict == 0)
+			continue;
+
+		evicted += ocf_eviction_need_space(cache, io_queue,
+				part_id, to_evict);
+	}
+
+	return evicted;
+}
+
 static inline uint32_t ocf_evict_do(ocf_cache_t cache,
 		ocf_queue_t io_queue, const uint32_t evict_cline_no,
 		ocf_part_id_t target_part_id)
@@ -49,6 +123,11 @@ static inline uint32_t ocf_evict_do(ocf_cache_t cache,
 	struct ocf_user_part *target_part = &cache->user_parts[target_part_id];
 	ocf_part_id_t part_id;
 
+	if (ocf_part_is_balanced(cache)) {
+		evicted = ocf_evict_excess(cache, io_queue, evict_cline_no,
+				target_part_id);
+	}
+
 	/* For each partition from the lowest priority to highest one */
 	for_each_part(cache, part, part_id) {
 
@@ -123,3 +202,88 @@ int space_managment_evict_do(struct ocf_cache *cache,
 	req->info.mapping_error |= true;
 	return LOOKUP_MISS;
 }
+
+/*
+ * Evict at most OCF_TO_EVICTION_MIN lines per run, so that exclusive
+ * metadata access is held for bounded time, and requeue until free_high
+ * free lines are available.
+ */
+static int space_management_reclaim(struct ocf_request *req)
+{
+	ocf_cache_t cache = req->cache;
+	struct eviction_cache *evc = &cache->device->eviction;
+	uint32_t target[OCF_IO_CLASS_MAX];
+	uint32_t free, evicted;
+	bool rebalance;
+
+	free = ocf_freelist_num_free(cache->freelist);
+	if (free < evc->free_high &&
+			!ocf_refcnt_frozen(&cache->refcnt.metadata)) {
+		/* Partition targets are computed before taking exclusive
+		 * access, which only publishes them */
+		rebalance = ocf_part_rebalance_prepare(cache, target);
+
+		ocf_metadata_start_exclusive_access(&cache->metadata.lock);
+		if (rebalance)
+			ocf_part_rebalance_commit(cache, target);
+		evicted = ocf_evict_do(cache, req->io_queue,
+				OCF_MIN(evc->free_high - free,
+					OCF_TO_EVICTION_MIN),
+				req->part_id);
+		ocf_metadata_end_exclusive_access(&cache->metadata.lock);
+
+		if (evicted && free + evicted < evc->free_high) {
+			ocf_engine_push_req_back(req, false);
+			return 0;
+		}
+	}
+
+	ocf_refcnt_dec(&cache->refcnt.metadata);
+	env_atomic_set(&evc->reclaim_pending, 0);
+	ocf_req_put(req);
+
+	return 0;
+}
+
+static const struct ocf_io_if _io_if_space_management_reclaim = {
+	.read = space_management_reclaim,
+	.write = space_management_reclaim,
+};
+
+void space_management_reclaim_kick(ocf_cache_t cache,
+		struct ocf_request *req)
+{
+	struct eviction_cache *evc = &cache->device->eviction;
+	struct ocf_request *reclaim;
+
+	if (ocf_freelist_num_free(cache->freelist) >= evc->free_low)
+		return;
+
+	if (!cache->mngt_queue)
+		return;
+
+	/* Only one reclaim request in flight */
+	if (env_atomic_cmpxchg(&evc->reclaim_pending, 0, 1))
+		return;
+
+	/* Management queue requests do not hold metadata reference, take it
+	 * for whole reclaim */
+	if (!ocf_refcnt_inc(&cache->refcnt.metadata)) {
+		/* cache device is being detached */
+		env_atomic_set(&evc->reclaim_pending, 0);
+		return;
+	}
+
+	reclaim = ocf_req_new(cache->mngt_queue, NULL, 0, 0, 0);
+	if (!reclaim) {
+		ocf_refcnt_dec(&cache->refcnt.metadata);
+		env_atomic_set(&evc->reclaim_pending, 0);
+		return;
+	}
+
+	reclaim->info.internal = true;
+	reclaim->io_if = &_io_if_space_management_reclaim;
+	reclaim->part_id = req->part_id;
+
+	ocf_engine_push_req_back(reclaim, false);
+}
@@ -9,29 +9,53 @@
 #include "ocf/ocf.h"
 #include "lru.h"
 #include "lru_structs.h"
+#include "s3fifo_structs.h"
 #include "../ocf_request.h"
 
 #define OCF_TO_EVICTION_MIN 128UL
 #define OCF_PENDING_EVICTION_LIMIT 512UL
 
+/* Free cache lines watermarks kept by background reclaim, in permille of
+ * cache lines */
+#define OCF_EVICTION_FREE_LOW_PERMILLE 10
+#define OCF_EVICTION_FREE_HIGH_PERMILLE 20
+
+#define OCF_NUM_EVICTION_LISTS OCF_EVICTION_LRU_SHARDS
+
 struct eviction_policy {
 	union {
 		struct lru_eviction_policy lru;
+		struct lru_sharded_eviction_policy lru_sharded;
+		struct s3fifo_eviction_policy s3fifo;
 	} policy;
 };
 
+/* Eviction policy runtime state per cache */
+struct eviction_cache {
+	/* Reclaim is queued when number of free lines drops below free_low
+	 * and evicts until free_high free lines are available */
+	uint32_t free_low;
+	uint32_t free_high;
+	env_atomic reclaim_pending;
+
+	struct s3fifo_eviction_cache s3fifo;
+};
+
 /* Eviction policy metadata per cache line */
 union eviction_policy_meta {
 	struct lru_eviction_policy_meta lru;
 } __attribute__((packed));
 
-/* the caller must hold the metadata lock for all operations
+/* the caller must hold the metadata lock for all operations, policy takes
+ * eviction list locks on its own
  *
  * For range operations the caller can:
  * set core_id to -1 to purge the whole cache device
  * set core_id to -2 to purge the whole cache partition
  */
 struct eviction_policy_ops {
+	int (*initialize)(ocf_cache_t cache, int init_metadata);
+	void (*deinitialize)(ocf_cache_t cache);
 	void (*init_cline)(ocf_cache_t cache, ocf_cache_line_t cline);
 	void (*rm_cline)(ocf_cache_t cache,
 			ocf_cache_line_t cline);
@@ -41,6 +65,9 @@ struct eviction_policy_ops {
 			uint32_t cline_no);
 	void (*hot_cline)(ocf_cache_t cache,
 			ocf_cache_line_t cline);
+	/* Mark cache line accessed on hit, may be applied lazily */
+	void (*touch_cline)(ocf_cache_t cache,
+			ocf_cache_line_t cline);
 	void (*init_evp)(ocf_cache_t cache,
 			ocf_part_id_t part_id);
 	void (*dirty_cline)(ocf_cache_t cache,
@@ -66,4 +93,12 @@ int space_managment_evict_do(ocf_cache_t cache,
 
 int space_management_free(ocf_cache_t cache, uint32_t count);
 
+/*
+ * Queue background eviction on management queue if number of free cache
+ * lines dropped below low watermark, so that following misses can be
+ * mapped without evicting inline.
+ */
+void space_management_reclaim_kick(ocf_cache_t cache,
+		struct ocf_request *req);
+
 #endif
@@ -11,6 +11,7 @@
 #include "../concurrency/ocf_concurrency.h"
 #include "../mngt/ocf_mngt_common.h"
 #include "../engine/engine_zero.h"
+#include "../engine/mf_detector.h"
 #include "../ocf_request.h"
 
 #define OCF_EVICTION_MAX_SCAN 1024
@@ -28,51 +29,69 @@
 #define is_lru_head(x) (x == collision_table_entries)
 #define is_lru_tail(x) (x == collision_table_entries)
 
-/* Sets the given collision_index as the new _head_ of the LRU list. */
-static inline void update_lru_head(ocf_cache_t cache,
-		int partition_id, unsigned int collision_index,
-		int cline_dirty)
+/* Returns true if partitions use multiple independently locked LRU lists */
+static inline bool evp_lru_is_sharded(ocf_cache_t cache)
+{
+	return cache->conf_meta->eviction_policy_type ==
+			ocf_eviction_lru_sharded;
+}
+
+/* Index of LRU list (and its lock) the given cache line belongs to */
+static inline unsigned evp_lru_list_idx(ocf_cache_t cache,
+		ocf_cache_line_t cline)
+{
+	return evp_lru_is_sharded(cache) ?
+			cline % OCF_EVICTION_LRU_SHARDS : 0;
+}
+
+static inline struct lru_eviction_policy *evp_lru_get_list(ocf_cache_t cache,
+		ocf_part_id_t part_id, unsigned idx)
 {
-	struct ocf_user_part *part = &cache->user_parts[partition_id];
+	struct ocf_user_part *part = &cache->user_parts[part_id];
+
+	if (evp_lru_is_sharded(cache))
+		return &part->runtime->eviction.policy.lru_sharded.shards[idx];
 
+	return &part->runtime->eviction.policy.lru;
+}
 
+/* Sets the given collision_index as the new _head_ of the LRU list. */
+static inline void update_lru_head(struct lru_eviction_policy *lru,
+		unsigned int collision_index, int cline_dirty)
+{
 	if (cline_dirty)
-		part->runtime->eviction.policy.lru.dirty_head = collision_index;
+		lru->dirty_head = collision_index;
 	else
-		part->runtime->eviction.policy.lru.clean_head = collision_index;
+		lru->clean_head = collision_index;
 }
 
 /* Sets the given collision_index as the new _tail_ of the LRU list. */
-static inline void update_lru_tail(ocf_cache_t cache,
-		int partition_id, unsigned int collision_index,
-		int cline_dirty)
+static inline void update_lru_tail(struct lru_eviction_policy *lru,
+		unsigned int collision_index, int cline_dirty)
 {
-	struct ocf_user_part *part = &cache->user_parts[partition_id];
-
 	if (cline_dirty)
-		part->runtime->eviction.policy.lru.dirty_tail = collision_index;
+		lru->dirty_tail = collision_index;
 	else
-		part->runtime->eviction.policy.lru.clean_tail = collision_index;
+		lru->clean_tail = collision_index;
 }
 
 /* Sets the given collision_index as the new _head_ and _tail_ of
  * the LRU list.
  */
-static inline void update_lru_head_tail(ocf_cache_t cache,
-		int partition_id, unsigned int collision_index, int cline_dirty)
+static inline void update_lru_head_tail(struct lru_eviction_policy *lru,
+		unsigned int collision_index, int cline_dirty)
 {
-	update_lru_head(cache, partition_id, collision_index, cline_dirty);
-	update_lru_tail(cache, partition_id, collision_index, cline_dirty);
+	update_lru_head(lru, collision_index, cline_dirty);
+	update_lru_tail(lru, collision_index, cline_dirty);
 }
 
 /* Adds the given collision_index to the _head_ of the LRU list */
-static void add_lru_head(ocf_cache_t cache, int partition_id,
+static void add_lru_head(ocf_cache_t cache, struct lru_eviction_policy *lru,
 		unsigned int collision_index, int cline_dirty)
 {
 	unsigned int curr_head_index;
 	unsigned int collision_table_entries =
 			cache->device->collision_table_entries;
-	struct ocf_user_part *part = &cache->user_parts[partition_id];
 	union eviction_policy_meta eviction;
 
 	ENV_BUG_ON(!(collision_index < collision_table_entries));
@@ -80,17 +99,17 @@ static void add_lru_head(ocf_cache_t cache, int partition_id,
 	ocf_metadata_get_evicition_policy(cache, collision_index, &eviction);
 
 	/* First node to be added/ */
-	if ((cline_dirty && !part->runtime->eviction.policy.lru.has_dirty_nodes) ||
-	    (!cline_dirty && !part->runtime->eviction.policy.lru.has_clean_nodes)) {
-		update_lru_head_tail(cache, partition_id, collision_index, cline_dirty);
+	if ((cline_dirty && !lru->has_dirty_nodes) ||
+	    (!cline_dirty && !lru->has_clean_nodes)) {
+		update_lru_head_tail(lru, collision_index, cline_dirty);
 
 		eviction.lru.next = collision_table_entries;
 		eviction.lru.prev = collision_table_entries;
 
 		if (cline_dirty)
-			part->runtime->eviction.policy.lru.has_dirty_nodes = 1;
+			lru->has_dirty_nodes = 1;
 		else
-			part->runtime->eviction.policy.lru.has_clean_nodes = 1;
+			lru->has_clean_nodes = 1;
 
 		ocf_metadata_set_evicition_policy(cache, collision_index,
 				&eviction);
@@ -98,9 +117,8 @@ static void add_lru_head(ocf_cache_t cache, int partition_id,
 		union eviction_policy_meta eviction_curr;
 
 		/* Not the first node to be added. */
-		curr_head_index = cline_dirty ?
-				part->runtime->eviction.policy.lru.dirty_head :
-				part->runtime->eviction.policy.lru.clean_head;
+		curr_head_index = cline_dirty ? lru->dirty_head :
+				lru->clean_head;
 
 		ENV_BUG_ON(!(curr_head_index < collision_table_entries));
 
@@ -111,7 +129,7 @@ static void add_lru_head(ocf_cache_t cache, int partition_id,
 		eviction.lru.prev = collision_table_entries;
 		eviction_curr.lru.prev = collision_index;
 
-		update_lru_head(cache, partition_id, collision_index, cline_dirty);
+		update_lru_head(lru, collision_index, cline_dirty);
 
 		ocf_metadata_set_evicition_policy(cache, curr_head_index,
 				&eviction_curr);
@@ -121,13 +139,12 @@ static void add_lru_head(ocf_cache_t cache, int partition_id,
 }
 
 /* Deletes the node with the given collision_index from the lru list */
-static void remove_lru_list(ocf_cache_t cache, int partition_id,
+static void remove_lru_list(ocf_cache_t cache, struct lru_eviction_policy *lru,
 		unsigned int collision_index, int cline_dirty)
 {
 	int is_clean_head = 0, is_clean_tail = 0, is_dirty_head = 0, is_dirty_tail = 0;
 	uint32_t prev_lru_node, next_lru_node;
 	uint32_t collision_table_entries = cache->device->collision_table_entries;
-	struct ocf_user_part *part = &cache->user_parts[partition_id];
 	union eviction_policy_meta eviction;
 
 	ENV_BUG_ON(!(collision_index < collision_table_entries));
@@ -135,13 +152,13 @@ static void remove_lru_list(ocf_cache_t cache, int partition_id,
 	ocf_metadata_get_evicition_policy(cache, collision_index, &eviction);
 
 	/* Find out if this node is LRU _head_ or LRU _tail_ */
-	if (part->runtime->eviction.policy.lru.clean_head == collision_index)
+	if (lru->clean_head == collision_index)
 		is_clean_head = 1;
-	if (part->runtime->eviction.policy.lru.dirty_head == collision_index)
+	if (lru->dirty_head == collision_index)
 		is_dirty_head = 1;
-	if (part->runtime->eviction.policy.lru.clean_tail == collision_index)
+	if (lru->clean_tail == collision_index)
 		is_clean_tail = 1;
-	if (part->runtime->eviction.policy.lru.dirty_tail == collision_index)
+	if (lru->dirty_tail == collision_index)
 		is_dirty_tail = 1;
 	ENV_BUG_ON((is_clean_tail || is_clean_head) && (is_dirty_tail || is_dirty_head));
 
@@ -156,18 +173,17 @@ static void remove_lru_list(ocf_cache_t cache, int partition_id,
 		eviction.lru.next = collision_table_entries;
 		eviction.lru.prev = collision_table_entries;
 
-		update_lru_head_tail(cache, partition_id, collision_table_entries, cline_dirty);
+		update_lru_head_tail(lru, collision_table_entries, cline_dirty);
 
 		if (cline_dirty)
-			part->runtime->eviction.policy.lru.has_dirty_nodes = 0;
+			lru->has_dirty_nodes = 0;
 		else
-			 part->runtime->eviction.policy.lru.has_clean_nodes = 0;
+			lru->has_clean_nodes = 0;
 
 		ocf_metadata_set_evicition_policy(cache, collision_index,
 				&eviction);
 
-		update_lru_head_tail(cache, partition_id,
-				collision_table_entries, cline_dirty);
+		update_lru_head_tail(lru, collision_table_entries, cline_dirty);
 	}
 
 	/* Case 2: else if this collision_index is LRU head, but not tail,
@@ -181,7 +197,7 @@ static void remove_lru_list(ocf_cache_t cache, int partition_id,
 		ocf_metadata_get_evicition_policy(cache, next_lru_node,
 				&eviction_next);
 
-		update_lru_head(cache, partition_id, next_lru_node, cline_dirty);
+		update_lru_head(lru, next_lru_node, cline_dirty);
 
 		eviction.lru.next = collision_table_entries;
 		eviction_next.lru.prev = collision_table_entries;
@@ -201,7 +217,7 @@ static void remove_lru_list(ocf_cache_t cache, int partition_id,
 
 		ENV_BUG_ON(!(prev_lru_node < collision_table_entries));
 
-		update_lru_tail(cache, partition_id, prev_lru_node, cline_dirty);
+		update_lru_tail(lru, prev_lru_node, cline_dirty);
 
 		ocf_metadata_get_evicition_policy(cache, prev_lru_node,
 				&eviction_prev);
@@ -250,10 +266,33 @@ static void remove_lru_list(ocf_cache_t cache, int partition_id,
 
 /*-- End of LRU functions*/
 
+/* List primitives shared with policies built on top of LRU lists */
+void evp_lru_list_add(ocf_cache_t cache, struct lru_eviction_policy *lru,
+		ocf_cache_line_t cline, bool dirty)
+{
+	add_lru_head(cache, lru, cline, dirty);
+}
+
+void evp_lru_list_remove(ocf_cache_t cache, struct lru_eviction_policy *lru,
+		ocf_cache_line_t cline, bool dirty)
+{
+	remove_lru_list(cache, lru, cline, dirty);
+}
+
+static inline void evp_lru_clear_ref(ocf_cache_t cache, ocf_cache_line_t cline)
+{
+	unsigned long *ref = cache->device->concurrency.eviction_ref;
+
+	if (evp_lru_is_sharded(cache) && env_bit_test(cline, ref))
+		env_bit_clear(cline, ref);
+}
+
 void evp_lru_init_cline(ocf_cache_t cache, ocf_cache_line_t cline)
 {
 	union eviction_policy_meta eviction;
 
+	evp_lru_clear_ref(cache, cline);
+
 	ocf_metadata_get_evicition_policy(cache, cline, &eviction);
 
 	eviction.lru.prev = cache->device->collision_table_entries;
@@ -267,8 +306,27 @@ void evp_lru_init_cline(ocf_cache_t cache, ocf_cache_line_t cline)
 void evp_lru_rm_cline(ocf_cache_t cache, ocf_cache_line_t cline)
 {
 	ocf_part_id_t part_id = ocf_metadata_get_partition_id(cache, cline);
+	unsigned idx = evp_lru_list_idx(cache, cline);
+
+	OCF_METADATA_EVICTION_LOCK(idx);
+	remove_lru_list(cache, evp_lru_get_list(cache, part_id, idx), cline,
+			metadata_test_dirty(cache, cline));
+	OCF_METADATA_EVICTION_UNLOCK(idx);
+
+	evp_lru_clear_ref(cache, cline);
+}
+
+/*
+ * Lockless hit notification used by sharded LRU - hot cache lines are
+ * only marked as referenced here and moved to the list head in batch
+ * when eviction scan reaches them (CLOCK style second chance).
+ */
+void evp_lru_touch_cline(ocf_cache_t cache, ocf_cache_line_t cline)
+{
+	unsigned long *ref = cache->device->concurrency.eviction_ref;
 
-	remove_lru_list(cache, part_id, cline, metadata_test_dirty(cache, cline));
+	if (!env_bit_test(cline, ref))
+		env_bit_set(cline, ref);
 }
 
 static void evp_lru_clean_end(void *private_data, int error)
@@ -306,11 +364,11 @@ static int evp_lru_clean_getter(ocf_cache_t cache,
 	return -1;
 }
 
-static void evp_lru_clean(ocf_cache_t cache, ocf_queue_t io_queue,
-		ocf_part_id_t part_id, uint32_t count)
+void evp_lru_clean(ocf_cache_t cache, ocf_queue_t io_queue,
+		ocf_part_id_t part_id, ocf_cache_line_t dirty_tail,
+		uint32_t count)
 {
 	struct ocf_refcnt *counter = &cache->refcnt.cleaning[part_id];
-	struct ocf_user_part *part = &cache->user_parts[part_id];
 	struct ocf_cleaner_attribs attribs = {
 		.cache_line_lock = true,
 		.do_sort = true,
@@ -320,7 +378,7 @@ static void evp_lru_clean(ocf_cache_t cache, ocf_queue_t io_queue,
 
 		.getter = evp_lru_clean_getter,
 		.getter_context = &attribs,
-		.getter_item = part->runtime->eviction.policy.lru.dirty_tail,
+		.getter_item = dirty_tail,
 
 		.count = count > 32 ? 32 : count,
 
@@ -389,20 +447,48 @@ bool evp_lru_can_evict(ocf_cache_t cache)
 	return true;
 }
 
-/* the caller must hold the metadata lock */
-uint32_t evp_lru_req_clines(ocf_cache_t cache, ocf_queue_t io_queue,
-		ocf_part_id_t part_id, uint32_t cline_no)
+/*
+ * Invalidate clean cache line. Returns false if eviction has been deferred
+ * (atomic cache device requires trimming the line first).
+ */
+bool evp_lru_evict_cline(ocf_cache_t cache, ocf_queue_t io_queue,
+		ocf_cache_line_t cline)
 {
-	uint32_t i;
+	if (ocf_volume_is_atomic(&cache->device->volume)) {
+		/* atomic cache, we have to trim cache lines before
+		 * eviction
+		 */
+		evp_lru_zero_line(cache, io_queue, cline);
+		return false;
+	}
+
+	mf_detector_cline_evicted(cache, cline);
+
+	ocf_metadata_start_collision_shared_access(cache, cline);
+	set_cache_line_invalid_no_flush(cache, 0, ocf_line_end_sector(cache),
+			cline);
+	ocf_metadata_end_collision_shared_access(cache, cline);
+
+	return true;
+}
+
+/*
+ * Evict up to cline_no clean cache lines from single LRU list. With
+ * reference bits enabled, referenced lines met on the way are given
+ * second chance and moved to the list head instead of being evicted.
+ */
+static uint32_t evp_lru_evict_list(ocf_cache_t cache, ocf_queue_t io_queue,
+		ocf_part_id_t part_id, unsigned idx, uint32_t cline_no)
+{
+	struct lru_eviction_policy *lru = evp_lru_get_list(cache, part_id, idx);
+	unsigned long *ref = cache->device->concurrency.eviction_ref;
+	bool use_ref = evp_lru_is_sharded(cache);
+	uint32_t promoted = 0;
+	uint32_t i = 0;
 	ocf_cache_line_t curr_cline, prev_cline;
-	struct ocf_user_part *part = &cache->user_parts[part_id];
 	union eviction_policy_meta eviction;
 
-	if (cline_no == 0)
-		return 0;
-
-	i =  0;
-	curr_cline = part->runtime->eviction.policy.lru.clean_tail;
+	curr_cline = lru->clean_tail;
 	/* Find cachelines to be evicted. */
 	while (i < cline_no) {
 		ENV_BUG_ON(curr_cline > cache->device->collision_table_entries);
@@ -423,35 +509,71 @@ uint32_t evp_lru_req_clines(ocf_cache_t cache, ocf_queue_t io_queue,
 			continue;
 		}
 
+		if (use_ref && env_bit_test(curr_cline, ref) &&
+				promoted < OCF_EVICTION_MAX_SCAN) {
+			/* Referenced since last scan - give second chance */
+			env_bit_clear(curr_cline, ref);
+			OCF_METADATA_EVICTION_LOCK(idx);
+			remove_lru_list(cache, lru, curr_cline, 0);
+			add_lru_head(cache, lru, curr_cline, 0);
+			OCF_METADATA_EVICTION_UNLOCK(idx);
+			promoted++;
+			curr_cline = prev_cline;
+			continue;
+		}
+
 		ENV_BUG_ON(metadata_test_dirty(cache, curr_cline));
 
-		if (ocf_volume_is_atomic(&cache->device->volume)) {
-			/* atomic cache, we have to trim cache lines before
-			 * eviction
-			 */
-			evp_lru_zero_line(cache, io_queue, curr_cline);
-
-		} else {
-			ocf_metadata_start_collision_shared_access(cache,
-					curr_cline);
-			set_cache_line_invalid_no_flush(cache, 0,
-					ocf_line_end_sector(cache),
-					curr_cline);
-			ocf_metadata_end_collision_shared_access(cache,
-					curr_cline);
-
-			/* Goto next item. */
+		/* Goto next item. */
+		if (evp_lru_evict_cline(cache, io_queue, curr_cline))
 			i++;
-		}
 
 		curr_cline = prev_cline;
 	}
 
-	if (i < cline_no && part->runtime->eviction.policy.lru.dirty_tail !=
+	if (i < cline_no && lru->dirty_tail !=
 			cache->device->collision_table_entries) {
-		evp_lru_clean(cache, io_queue, part_id, cline_no - i);
+		evp_lru_clean(cache, io_queue, part_id, lru->dirty_tail,
+				cline_no - i);
 	}
 
+	return i;
+}
+
+/* the caller must hold the metadata lock */
+uint32_t evp_lru_req_clines(ocf_cache_t cache, ocf_queue_t io_queue,
+		ocf_part_id_t part_id, uint32_t cline_no)
+{
+	struct lru_sharded_eviction_policy *sharded;
+	unsigned shard, start, n;
+	uint32_t i = 0, quota;
+
+	if (cline_no == 0)
+		return 0;
+
+	if (!evp_lru_is_sharded(cache))
+		return evp_lru_evict_list(cache, io_queue, part_id, 0, cline_no);
+
+	sharded = &cache->user_parts[part_id].runtime->eviction.policy.lru_sharded;
+
+	/* Spread eviction over all lists, starting where last one stopped */
+	start = sharded->evict_shard;
+	for (n = 0; n < OCF_EVICTION_LRU_SHARDS && i < cline_no; n++) {
+		shard = (start + n) % OCF_EVICTION_LRU_SHARDS;
+		quota = OCF_DIV_ROUND_UP(cline_no - i,
+				OCF_EVICTION_LRU_SHARDS - n);
+		i += evp_lru_evict_list(cache, io_queue, part_id, shard, quota);
+	}
+
+	/* Top up from any list still having clean lines */
+	for (n = 0; n < OCF_EVICTION_LRU_SHARDS && i < cline_no; n++) {
+		shard = (start + n) % OCF_EVICTION_LRU_SHARDS;
+		i += evp_lru_evict_list(cache, io_queue, part_id, shard,
+				cline_no - i);
+	}
+
+	sharded->evict_shard = (start + 1) % OCF_EVICTION_LRU_SHARDS;
+
 	/* Return number of clines that were really evicted */
 	return i;
 }
@@ -460,7 +582,8 @@ uint32_t evp_lru_req_clines(ocf_cache_t cache, ocf_queue_t io_queue,
 void evp_lru_hot_cline(ocf_cache_t cache, ocf_cache_line_t cline)
 {
 	ocf_part_id_t part_id = ocf_metadata_get_partition_id(cache, cline);
-	struct ocf_user_part *part = &cache->user_parts[part_id];
+	unsigned idx = evp_lru_list_idx(cache, cline);
+	struct lru_eviction_policy *lru = evp_lru_get_list(cache, part_id, idx);
 
 	uint32_t prev_lru_node, next_lru_node;
 	uint32_t collision_table_entries = cache->device->collision_table_entries;
@@ -468,6 +591,8 @@ void evp_lru_hot_cline(ocf_cache_t cache, ocf_cache_line_t cline)
 
 	int cline_dirty;
 
+	OCF_METADATA_EVICTION_LOCK(idx);
+
 	ocf_metadata_get_evicition_policy(cache, cline, &eviction);
 
 	next_lru_node = eviction.lru.next;
@@ -477,15 +602,26 @@ void evp_lru_hot_cline(ocf_cache_t cache, ocf_cache_line_t cline)
 
 	if ((next_lru_node != collision_table_entries) ||
 	    (prev_lru_node != collision_table_entries) ||
-	    ((part->runtime->eviction.policy.lru.clean_head == cline) &&
-	     (part->runtime->eviction.policy.lru.clean_tail == cline)) ||
-	    ((part->runtime->eviction.policy.lru.dirty_head == cline) &&
-	     (part->runtime->eviction.policy.lru.dirty_tail == cline))) {
-		remove_lru_list(cache, part_id, cline, cline_dirty);
+	    ((lru->clean_head == cline) && (lru->clean_tail == cline)) ||
+	    ((lru->dirty_head == cline) && (lru->dirty_tail == cline))) {
+		remove_lru_list(cache, lru, cline, cline_dirty);
 	}
 
 	/* Update LRU */
-	add_lru_head(cache, part_id, cline, cline_dirty);
+	add_lru_head(cache, lru, cline, cline_dirty);
+
+	OCF_METADATA_EVICTION_UNLOCK(idx);
+}
+
+void evp_lru_list_init(struct lru_eviction_policy *lru,
+		unsigned int collision_table_entries)
+{
+	lru->has_clean_nodes = 0;
+	lru->has_dirty_nodes = 0;
+	lru->clean_head = collision_table_entries;
+	lru->clean_tail = collision_table_entries;
+	lru->dirty_head = collision_table_entries;
+	lru->dirty_tail = collision_table_entries;
 }
 
 void evp_lru_init_evp(ocf_cache_t cache, ocf_part_id_t part_id)
@@ -493,30 +629,42 @@ void evp_lru_init_evp(ocf_cache_t cache, ocf_part_id_t part_id)
 	unsigned int collision_table_entries =
 			cache->device->collision_table_entries;
 	struct ocf_user_part *part = &cache->user_parts[part_id];
+	unsigned idx;
 
-	part->runtime->eviction.policy.lru.has_clean_nodes = 0;
-	part->runtime->eviction.policy.lru.has_dirty_nodes = 0;
-	part->runtime->eviction.policy.lru.clean_head = collision_table_entries;
-	part->runtime->eviction.policy.lru.clean_tail = collision_table_entries;
-	part->runtime->eviction.policy.lru.dirty_head = collision_table_entries;
-	part->runtime->eviction.policy.lru.dirty_tail = collision_table_entries;
+	if (!evp_lru_is_sharded(cache)) {
+		evp_lru_list_init(&part->runtime->eviction.policy.lru,
+				collision_table_entries);
+		return;
+	}
+
+	for (idx = 0; idx < OCF_EVICTION_LRU_SHARDS; idx++) {
+		evp_lru_list_init(
+			&part->runtime->eviction.policy.lru_sharded.shards[idx],
+			collision_table_entries);
+	}
+	part->runtime->eviction.policy.lru_sharded.evict_shard = 0;
 }
 
 void evp_lru_clean_cline(ocf_cache_t cache, ocf_part_id_t part_id,
 		uint32_t cline)
 {
-	OCF_METADATA_EVICTION_LOCK();
-	remove_lru_list(cache, part_id, cline, 1);
-	add_lru_head(cache, part_id, cline, 0);
-	OCF_METADATA_EVICTION_UNLOCK();
+	unsigned idx = evp_lru_list_idx(cache, cline);
+	struct lru_eviction_policy *lru = evp_lru_get_list(cache, part_id, idx);
+
+	OCF_METADATA_EVICTION_LOCK(idx);
+	remove_lru_list(cache, lru, cline, 1);
+	add_lru_head(cache, lru, cline, 0);
+	OCF_METADATA_EVICTION_UNLOCK(idx);
 }
 
 void evp_lru_dirty_cline(ocf_cache_t cache, ocf_part_id_t part_id,
 		uint32_t cline)
 {
-	OCF_METADATA_EVICTION_LOCK();
-	remove_lru_list(cache, part_id, cline, 0);
-	add_lru_head(cache, part_id, cline, 1);
-	OCF_METADATA_EVICTION_UNLOCK();
-}
+	unsigned idx = evp_lru_list_idx(cache, cline);
+	struct lru_eviction_policy *lru = evp_lru_get_list(cache, part_id, idx);
 
+	OCF_METADATA_EVICTION_LOCK(idx);
+	remove_lru_list(cache, lru, cline, 0);
+	add_lru_head(cache, lru, cline, 1);
+	OCF_METADATA_EVICTION_UNLOCK(idx);
+}
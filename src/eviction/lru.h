@@ -14,8 +14,23 @@ bool evp_lru_can_evict(struct ocf_cache *cache);
 uint32_t evp_lru_req_clines(struct ocf_cache *cache, ocf_queue_t io_queue,
 		ocf_part_id_t part_id, uint32_t cline_no);
 void evp_lru_hot_cline(struct ocf_cache *cache, ocf_cache_line_t cline);
+void evp_lru_touch_cline(struct ocf_cache *cache, ocf_cache_line_t cline);
 void evp_lru_init_evp(struct ocf_cache *cache, ocf_part_id_t part_id);
 void evp_lru_dirty_cline(struct ocf_cache *cache, ocf_part_id_t part_id, uint32_t cline);
 void evp_lru_clean_cline(struct ocf_cache *cache, ocf_part_id_t part_id, uint32_t cline);
 
+/* LRU list primitives, the caller must hold the list lock */
+void evp_lru_list_init(struct lru_eviction_policy *lru,
+		unsigned int collision_table_entries);
+void evp_lru_list_add(struct ocf_cache *cache, struct lru_eviction_policy *lru,
+		ocf_cache_line_t cline, bool dirty);
+void evp_lru_list_remove(struct ocf_cache *cache,
+		struct lru_eviction_policy *lru, ocf_cache_line_t cline,
+		bool dirty);
+bool evp_lru_evict_cline(struct ocf_cache *cache, ocf_queue_t io_queue,
+		ocf_cache_line_t cline);
+void evp_lru_clean(struct ocf_cache *cache, ocf_queue_t io_queue,
+		ocf_part_id_t part_id, ocf_cache_line_t dirty_tail,
+		uint32_t count);
+
 #endif
@@ -21,4 +21,13 @@ struct lru_eviction_policy {
 	uint32_t clean_tail;
 };
 
+/* Number of independently locked LRU lists per partition */
+#define OCF_EVICTION_LRU_SHARDS 32
+
+struct lru_sharded_eviction_policy {
+	struct lru_eviction_policy shards[OCF_EVICTION_LRU_SHARDS];
+	/* Shard to start next eviction from */
+	uint32_t evict_shard;
+};
+
 #endif
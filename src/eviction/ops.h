@@ -35,11 +35,8 @@ static inline void ocf_eviction_purge_cache_line(
 
 	ENV_BUG_ON(type >= ocf_eviction_max);
 
-	if (likely(evict_policy_ops[type].rm_cline)) {
-		OCF_METADATA_EVICTION_LOCK();
+	if (likely(evict_policy_ops[type].rm_cline))
 		evict_policy_ops[type].rm_cline(cache, line);
-		OCF_METADATA_EVICTION_UNLOCK();
-	}
 }
 
 
@@ -82,10 +79,63 @@ static inline void ocf_eviction_set_hot_cache_line(
 
 	ENV_BUG_ON(type >= ocf_eviction_max);
 
-	if (likely(evict_policy_ops[type].hot_cline)) {
-		OCF_METADATA_EVICTION_LOCK();
+	if (likely(evict_policy_ops[type].hot_cline))
 		evict_policy_ops[type].hot_cline(cache, line);
-		OCF_METADATA_EVICTION_UNLOCK();
+}
+
+/**
+ * @brief Record cache hit, policy may defer actual list update
+ */
+static inline void ocf_eviction_touch_cache_line(
+		struct ocf_cache *cache, ocf_cache_line_t line)
+{
+	uint8_t type = cache->conf_meta->eviction_policy_type;
+
+	ENV_BUG_ON(type >= ocf_eviction_max);
+
+	if (evict_policy_ops[type].touch_cline)
+		evict_policy_ops[type].touch_cline(cache, line);
+	else
+		ocf_eviction_set_hot_cache_line(cache, line);
+}
+
+/**
+ * @brief Allocate per cache policy state
+ *
+ * @param init_metadata - state is rebuilt from loaded metadata if false
+ */
+static inline int ocf_eviction_init_cache(struct ocf_cache *cache,
+		int init_metadata)
+{
+	uint8_t type = cache->conf_meta->eviction_policy_type;
+	struct eviction_cache *evc = &cache->device->eviction;
+	uint64_t entries = cache->device->collision_table_entries;
+
+	ENV_BUG_ON(type >= ocf_eviction_max);
+
+	evc->free_low = OCF_MAX(entries * OCF_EVICTION_FREE_LOW_PERMILLE / 1000,
+			OCF_MIN(OCF_TO_EVICTION_MIN, entries / 8));
+	evc->free_high = OCF_MAX(
+			entries * OCF_EVICTION_FREE_HIGH_PERMILLE / 1000,
+			2 * evc->free_low);
+	env_atomic_set(&evc->reclaim_pending, 0);
+
+	if (evict_policy_ops[type].initialize)
+		return evict_policy_ops[type].initialize(cache, init_metadata);
+
+	return 0;
+}
+
+/**
+ * @brief Release per cache state of any policy that has been initialized
+ */
+static inline void ocf_eviction_deinit_cache(struct ocf_cache *cache)
+{
+	int type;
+
+	for (type = 0; type < ocf_eviction_max; type++) {
+		if (evict_policy_ops[type].deinitialize)
+			evict_policy_ops[type].deinitialize(cache);
 	}
 }
 
@@ -96,11 +146,8 @@ static inline void ocf_eviction_initialize(struct ocf_cache *cache,
 
 	ENV_BUG_ON(type >= ocf_eviction_max);
 
-	if (likely(evict_policy_ops[type].init_evp)) {
-		OCF_METADATA_EVICTION_LOCK();
+	if (likely(evict_policy_ops[type].init_evp))
 		evict_policy_ops[type].init_evp(cache, part_id);
-		OCF_METADATA_EVICTION_UNLOCK();
-	}
 }
 
 #endif /* LAYER_EVICTION_POLICY_OPS_H_ */
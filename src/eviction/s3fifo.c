@@ -0,0 +1,384 @@
+/*
+ * Copyright(c) 2012-2020 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include "eviction.h"
+#include "lru.h"
+#include "s3fifo.h"
+#include "ops.h"
+#include "../concurrency/ocf_concurrency.h"
+#include "../ocf_request.h"
+
+/*
+ * S3-FIFO eviction (Yang et al., "FIFO queues are all you need for cache
+ * eviction").
+ *
+ * New cache lines are inserted to small FIFO queue. Lines re-referenced
+ * before reaching its tail are moved to main queue, the rest is evicted
+ * and remembered in ghost table. Lines which hit in ghost table go
+ * directly to main queue. Main queue is a CLOCK with single reference
+ * bit. Hits never touch the queues - they only set per cache line
+ * reference bit - so one-hit lines brought by scans leave the cache
+ * after short stay in small queue without flushing out the hot set.
+ */
+
+/* Percentage of partition occupancy kept in small queue */
+#define S3FIFO_SMALL_PERCENT 10
+
+static inline unsigned evp_s3fifo_lock_idx(ocf_part_id_t part_id)
+{
+	return part_id % OCF_NUM_EVICTION_LISTS;
+}
+
+static inline struct s3fifo_eviction_policy *evp_s3fifo_get(ocf_cache_t cache,
+		ocf_part_id_t part_id)
+{
+	return &cache->user_parts[part_id].runtime->eviction.policy.s3fifo;
+}
+
+static inline bool evp_s3fifo_in_main(ocf_cache_t cache,
+		ocf_cache_line_t cline)
+{
+	return env_bit_test(cline, cache->device->eviction.s3fifo.main);
+}
+
+static inline bool evp_s3fifo_test_clear_ref(ocf_cache_t cache,
+		ocf_cache_line_t cline)
+{
+	unsigned long *ref = cache->device->concurrency.eviction_ref;
+
+	if (!env_bit_test(cline, ref))
+		return false;
+
+	env_bit_clear(cline, ref);
+	return true;
+}
+
+/*
+ * Ghost table keeps fingerprints of core lines, direct mapped. Entries are
+ * added under exclusive metadata access on eviction, but tested and cleared
+ * on insertion holding only hash bucket lock, so insertions of lines
+ * mapping to the same entry race. Entries are single aligned 32 bit words,
+ * so a fingerprint is never torn; a lost update only makes one line start
+ * in small queue instead of main one or lets a stale entry promote a line
+ * once more, which affects hit ratio slightly, not correctness. Hence the
+ * table is not locked.
+ */
+static inline uint64_t evp_s3fifo_ghost_hash(ocf_cache_t cache,
+		ocf_cache_line_t cline)
+{
+	ocf_core_id_t core_id;
+	uint64_t core_line;
+	uint64_t h;
+
+	ocf_metadata_get_core_info(cache, cline, &core_id, &core_line);
+
+	h = core_line ^ ((uint64_t)core_id << 56);
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+
+	return h;
+}
+
+static void evp_s3fifo_ghost_add(ocf_cache_t cache, ocf_cache_line_t cline)
+{
+	struct s3fifo_eviction_cache *s3 = &cache->device->eviction.s3fifo;
+	uint64_t h = evp_s3fifo_ghost_hash(cache, cline);
+
+	/* Zero is reserved for empty entry */
+	s3->ghost[h % s3->ghost_entries] = (uint32_t)(h >> 32) | 1;
+}
+
+/* Returns true and forgets entry if cache line was recently evicted */
+static bool evp_s3fifo_ghost_test_clear(ocf_cache_t cache,
+		ocf_cache_line_t cline)
+{
+	struct s3fifo_eviction_cache *s3 = &cache->device->eviction.s3fifo;
+	uint64_t h = evp_s3fifo_ghost_hash(cache, cline);
+	uint32_t *entry = &s3->ghost[h % s3->ghost_entries];
+
+	if (*entry != ((uint32_t)(h >> 32) | 1))
+		return false;
+
+	*entry = 0;
+	return true;
+}
+
+/* the caller must hold the eviction list lock */
+static void evp_s3fifo_add(ocf_cache_t cache,
+		struct s3fifo_eviction_policy *s3, ocf_cache_line_t cline,
+		bool main)
+{
+	bool dirty = metadata_test_dirty(cache, cline);
+
+	if (main) {
+		env_bit_set(cline, cache->device->eviction.s3fifo.main);
+		evp_lru_list_add(cache, &s3->main, cline, dirty);
+		s3->main_size++;
+	} else {
+		evp_lru_list_add(cache, &s3->small, cline, dirty);
+		s3->small_size++;
+	}
+}
+
+/* the caller must hold the eviction list lock */
+static void evp_s3fifo_remove(ocf_cache_t cache,
+		struct s3fifo_eviction_policy *s3, ocf_cache_line_t cline)
+{
+	bool dirty = metadata_test_dirty(cache, cline);
+
+	if (evp_s3fifo_in_main(cache, cline)) {
+		evp_lru_list_remove(cache, &s3->main, cline, dirty);
+		env_bit_clear(cline, cache->device->eviction.s3fifo.main);
+		s3->main_size--;
+	} else {
+		evp_lru_list_remove(cache, &s3->small, cline, dirty);
+		s3->small_size--;
+	}
+}
+
+/* Cache line is linked in any of partition queues */
+static bool evp_s3fifo_is_linked(ocf_cache_t cache,
+		struct s3fifo_eviction_policy *s3, ocf_cache_line_t cline)
+{
+	uint32_t collision_table_entries =
+			cache->device->collision_table_entries;
+	union eviction_policy_meta eviction;
+
+	ocf_metadata_get_evicition_policy(cache, cline, &eviction);
+
+	if (eviction.lru.next != collision_table_entries ||
+			eviction.lru.prev != collision_table_entries) {
+		return true;
+	}
+
+	return s3->small.clean_head == cline || s3->small.dirty_head == cline ||
+			s3->main.clean_head == cline ||
+			s3->main.dirty_head == cline;
+}
+
+static void evp_s3fifo_rebuild_main(ocf_cache_t cache,
+		struct lru_eviction_policy *lru, bool dirty)
+{
+	uint32_t collision_table_entries =
+			cache->device->collision_table_entries;
+	union eviction_policy_meta eviction;
+	ocf_cache_line_t cline;
+
+	if (dirty ? !lru->has_dirty_nodes : !lru->has_clean_nodes)
+		return;
+
+	cline = dirty ? lru->dirty_head : lru->clean_head;
+	while (cline < collision_table_entries) {
+		env_bit_set(cline, cache->device->eviction.s3fifo.main);
+		ocf_metadata_get_evicition_policy(cache, cline, &eviction);
+		cline = eviction.lru.next;
+	}
+}
+
+int evp_s3fifo_initialize(ocf_cache_t cache, int init_metadata)
+{
+	struct s3fifo_eviction_cache *s3 = &cache->device->eviction.s3fifo;
+	uint64_t entries = cache->device->collision_table_entries;
+	ocf_part_id_t part_id;
+
+	s3->main = env_vzalloc(OCF_DIV_ROUND_UP(entries,
+			8 * sizeof(unsigned long)) * sizeof(unsigned long));
+	if (!s3->main)
+		return -OCF_ERR_NO_MEM;
+
+	s3->ghost_entries = entries;
+	s3->ghost = env_vzalloc(sizeof(*s3->ghost) * entries);
+	if (!s3->ghost) {
+		env_vfree(s3->main);
+		s3->main = NULL;
+		return -OCF_ERR_NO_MEM;
+	}
+
+	if (init_metadata)
+		return 0;
+
+	/* Queue membership is not persisted - restore it from loaded lists */
+	for (part_id = 0; part_id < OCF_IO_CLASS_MAX; part_id++) {
+		evp_s3fifo_rebuild_main(cache,
+				&evp_s3fifo_get(cache, part_id)->main, false);
+		evp_s3fifo_rebuild_main(cache,
+				&evp_s3fifo_get(cache, part_id)->main, true);
+	}
+
+	return 0;
+}
+
+void evp_s3fifo_deinitialize(ocf_cache_t cache)
+{
+	struct s3fifo_eviction_cache *s3 = &cache->device->eviction.s3fifo;
+
+	env_vfree(s3->ghost);
+	s3->ghost = NULL;
+	env_vfree(s3->main);
+	s3->main = NULL;
+}
+
+void evp_s3fifo_init_evp(ocf_cache_t cache, ocf_part_id_t part_id)
+{
+	struct s3fifo_eviction_policy *s3 = evp_s3fifo_get(cache, part_id);
+	unsigned int collision_table_entries =
+			cache->device->collision_table_entries;
+
+	evp_lru_list_init(&s3->small, collision_table_entries);
+	evp_lru_list_init(&s3->main, collision_table_entries);
+	s3->small_size = 0;
+	s3->main_size = 0;
+}
+
+void evp_s3fifo_init_cline(ocf_cache_t cache, ocf_cache_line_t cline)
+{
+	env_bit_clear(cline, cache->device->eviction.s3fifo.main);
+	evp_s3fifo_test_clear_ref(cache, cline);
+	evp_lru_init_cline(cache, cline);
+}
+
+void evp_s3fifo_rm_cline(ocf_cache_t cache, ocf_cache_line_t cline)
+{
+	ocf_part_id_t part_id = ocf_metadata_get_partition_id(cache, cline);
+	unsigned idx = evp_s3fifo_lock_idx(part_id);
+
+	OCF_METADATA_EVICTION_LOCK(idx);
+	evp_s3fifo_remove(cache, evp_s3fifo_get(cache, part_id), cline);
+	OCF_METADATA_EVICTION_UNLOCK(idx);
+
+	evp_s3fifo_test_clear_ref(cache, cline);
+}
+
+/* Called on cache line insertion - hits go through touch_cline */
+void evp_s3fifo_hot_cline(ocf_cache_t cache, ocf_cache_line_t cline)
+{
+	ocf_part_id_t part_id = ocf_metadata_get_partition_id(cache, cline);
+	struct s3fifo_eviction_policy *s3 = evp_s3fifo_get(cache, part_id);
+	unsigned idx = evp_s3fifo_lock_idx(part_id);
+	bool main;
+
+	main = evp_s3fifo_ghost_test_clear(cache, cline);
+
+	OCF_METADATA_EVICTION_LOCK(idx);
+	if (evp_s3fifo_is_linked(cache, s3, cline))
+		evp_lru_touch_cline(cache, cline);
+	else
+		evp_s3fifo_add(cache, s3, cline, main);
+	OCF_METADATA_EVICTION_UNLOCK(idx);
+}
+
+void evp_s3fifo_clean_cline(ocf_cache_t cache, ocf_part_id_t part_id,
+		uint32_t cline)
+{
+	struct s3fifo_eviction_policy *s3 = evp_s3fifo_get(cache, part_id);
+	unsigned idx = evp_s3fifo_lock_idx(part_id);
+	struct lru_eviction_policy *lru;
+
+	OCF_METADATA_EVICTION_LOCK(idx);
+	lru = evp_s3fifo_in_main(cache, cline) ? &s3->main : &s3->small;
+	evp_lru_list_remove(cache, lru, cline, true);
+	evp_lru_list_add(cache, lru, cline, false);
+	OCF_METADATA_EVICTION_UNLOCK(idx);
+}
+
+void evp_s3fifo_dirty_cline(ocf_cache_t cache, ocf_part_id_t part_id,
+		uint32_t cline)
+{
+	struct s3fifo_eviction_policy *s3 = evp_s3fifo_get(cache, part_id);
+	unsigned idx = evp_s3fifo_lock_idx(part_id);
+	struct lru_eviction_policy *lru;
+
+	OCF_METADATA_EVICTION_LOCK(idx);
+	lru = evp_s3fifo_in_main(cache, cline) ? &s3->main : &s3->small;
+	evp_lru_list_remove(cache, lru, cline, false);
+	evp_lru_list_add(cache, lru, cline, true);
+	OCF_METADATA_EVICTION_UNLOCK(idx);
+}
+
+/* the caller must hold the metadata lock */
+uint32_t evp_s3fifo_req_clines(ocf_cache_t cache, ocf_queue_t io_queue,
+		ocf_part_id_t part_id, uint32_t cline_no)
+{
+	struct s3fifo_eviction_policy *s3 = evp_s3fifo_get(cache, part_id);
+	uint32_t collision_table_entries =
+			cache->device->collision_table_entries;
+	unsigned idx = evp_s3fifo_lock_idx(part_id);
+	ocf_cache_line_t small_cline, main_cline, curr_cline;
+	union eviction_policy_meta eviction;
+	uint32_t small_target, scan_limit;
+	uint32_t i = 0;
+	bool from_small;
+
+	if (cline_no == 0)
+		return 0;
+
+	small_target = (s3->small_size + s3->main_size) *
+			S3FIFO_SMALL_PERCENT / 100 ?: 1;
+	/* Every line may be skipped once and re-queued once at most */
+	scan_limit = 2 * (s3->small_size + s3->main_size) + cline_no;
+
+	small_cline = s3->small.clean_tail;
+	main_cline = s3->main.clean_tail;
+
+	while (i < cline_no && scan_limit--) {
+		if (!evp_lru_can_evict(cache))
+			break;
+
+		/* Lines promoted from small queue may refill main queue */
+		if (main_cline == collision_table_entries)
+			main_cline = s3->main.clean_tail;
+
+		from_small = small_cline != collision_table_entries &&
+				(s3->small_size > small_target ||
+				 main_cline == collision_table_entries);
+
+		curr_cline = from_small ? small_cline : main_cline;
+		if (curr_cline == collision_table_entries)
+			break;
+
+		ocf_metadata_get_evicition_policy(cache, curr_cline,
+				&eviction);
+		if (from_small)
+			small_cline = eviction.lru.prev;
+		else
+			main_cline = eviction.lru.prev;
+
+		/* Prevent evicting already locked items */
+		if (ocf_cache_line_is_used(cache, curr_cline))
+			continue;
+
+		ENV_BUG_ON(metadata_test_dirty(cache, curr_cline));
+
+		if (evp_s3fifo_test_clear_ref(cache, curr_cline)) {
+			/* Referenced - promote to (or reinsert in) main */
+			OCF_METADATA_EVICTION_LOCK(idx);
+			evp_s3fifo_remove(cache, s3, curr_cline);
+			evp_s3fifo_add(cache, s3, curr_cline, true);
+			OCF_METADATA_EVICTION_UNLOCK(idx);
+			continue;
+		}
+
+		if (from_small)
+			evp_s3fifo_ghost_add(cache, curr_cline);
+
+		if (evp_lru_evict_cline(cache, io_queue, curr_cline))
+			i++;
+	}
+
+	if (i < cline_no) {
+		curr_cline = s3->small.has_dirty_nodes ?
+				s3->small.dirty_tail : s3->main.dirty_tail;
+		if (curr_cline != collision_table_entries) {
+			evp_lru_clean(cache, io_queue, part_id, curr_cline,
+					cline_no - i);
+		}
+	}
+
+	/* Return number of clines that were really evicted */
+	return i;
+}
@@ -0,0 +1,24 @@
+/*
+ * Copyright(c) 2012-2020 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+#ifndef __EVICTION_S3FIFO_H__
+#define __EVICTION_S3FIFO_H__
+
+#include "eviction.h"
+#include "s3fifo_structs.h"
+
+int evp_s3fifo_initialize(struct ocf_cache *cache, int init_metadata);
+void evp_s3fifo_deinitialize(struct ocf_cache *cache);
+void evp_s3fifo_init_cline(struct ocf_cache *cache, ocf_cache_line_t cline);
+void evp_s3fifo_rm_cline(struct ocf_cache *cache, ocf_cache_line_t cline);
+uint32_t evp_s3fifo_req_clines(struct ocf_cache *cache, ocf_queue_t io_queue,
+		ocf_part_id_t part_id, uint32_t cline_no);
+void evp_s3fifo_hot_cline(struct ocf_cache *cache, ocf_cache_line_t cline);
+void evp_s3fifo_init_evp(struct ocf_cache *cache, ocf_part_id_t part_id);
+void evp_s3fifo_dirty_cline(struct ocf_cache *cache, ocf_part_id_t part_id,
+		uint32_t cline);
+void evp_s3fifo_clean_cline(struct ocf_cache *cache, ocf_part_id_t part_id,
+		uint32_t cline);
+
+#endif
@@ -0,0 +1,33 @@
+/*
+ * Copyright(c) 2012-2020 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+#ifndef __EVICTION_S3FIFO_STRUCTS_H__
+
+#define __EVICTION_S3FIFO_STRUCTS_H__
+
+#include "lru_structs.h"
+
+/*
+ * S3-FIFO keeps per cache line list pointers in lru_eviction_policy_meta,
+ * small and main queues are regular clean/dirty LRU lists used as FIFOs.
+ */
+struct s3fifo_eviction_policy {
+	/* Probationary queue for newly inserted cache lines */
+	struct lru_eviction_policy small;
+	/* Cache lines re-referenced while in small queue or ghost hits */
+	struct lru_eviction_policy main;
+	uint32_t small_size;
+	uint32_t main_size;
+};
+
+/* Per cache S3-FIFO state, not persisted */
+struct s3fifo_eviction_cache {
+	/* Cache line is in main queue */
+	unsigned long *main;
+	/* Fingerprints of core lines recently evicted from small queue */
+	uint32_t *ghost;
+	uint32_t ghost_entries;
+};
+
+#endif
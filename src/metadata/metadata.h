@@ -221,4 +221,6 @@ static inline ocf_cache_line_t ocf_metadata_collision_table_entries(
 	return cache->device->collision_table_entries;
 }
 
+#include "metadata_lookup.h"
+
 #endif /* METADATA_H_ */
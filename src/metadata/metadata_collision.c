@@ -42,6 +42,9 @@ void ocf_metadata_add_to_collision(struct ocf_cache *cache,
 	 * collision table so it contains indexes in collision table
 	 */
 	ocf_metadata_set_hash(cache, hash, cache_line);
+
+	ocf_metadata_lookup_group_add(cache, hash, cache_line, core_id,
+			core_line);
 }
 
 /*
@@ -80,6 +83,9 @@ void ocf_metadata_remove_from_collision(struct ocf_cache *cache,
 	if (ocf_metadata_get_hash(cache, hash_father) == line)
 		ocf_metadata_set_hash(cache, hash_father, next_line);
 
+	ocf_metadata_lookup_group_remove(cache, hash_father, line, core_id,
+			core_sector);
+
 	ocf_metadata_set_collision_info(cache, line,
 			line_entries, line_entries);
 
@@ -400,6 +400,116 @@ static void ocf_metadata_hash_raw_info(struct ocf_cache *cache,
 #define ocf_metadata_hash_raw_info(cache, ctrl)
 #endif
 
+/*
+ * Lookup index
+ */
+static void ocf_metadata_hash_lookup_reset_groups(struct ocf_cache *cache)
+{
+	struct ocf_metadata_lookup *lookup = &cache->metadata.lookup;
+	ocf_cache_line_t hash;
+	uint32_t step = 0;
+
+	if (!lookup->groups)
+		return;
+
+	for (hash = 0; hash < cache->device->hash_table_entries; hash++) {
+		ocf_metadata_lookup_group_reset(&lookup->groups[hash]);
+		OCF_COND_RESCHED(step, 1024);
+	}
+}
+
+static int ocf_metadata_hash_lookup_init(struct ocf_cache *cache,
+		struct ocf_metadata_hash_ctrl *ctrl)
+{
+	struct ocf_metadata_lookup *lookup = &cache->metadata.lookup;
+	struct ocf_metadata_raw *hash_raw =
+			&ctrl->raw_desc[metadata_segment_hash];
+	unsigned long addr;
+
+	lookup->entries_mem = env_vzalloc(sizeof(*lookup->entries) *
+			ctrl->cachelines + 64);
+	if (!lookup->entries_mem)
+		return -OCF_ERR_NO_MEM;
+
+	/* Align to CPU cache line, entry never crosses cache line boundary */
+	addr = (unsigned long)lookup->entries_mem;
+	addr = OCF_DIV_ROUND_UP(addr, 64) * 64;
+	lookup->entries = (struct ocf_metadata_lookup_entry *)addr;
+
+	/* Hash table may be read directly for RAM backed containers */
+	if (hash_raw->raw_type == metadata_raw_type_ram ||
+			hash_raw->raw_type == metadata_raw_type_volatile) {
+		lookup->hash = hash_raw->mem_pool;
+	}
+
+	if (!cache->use_lookup_tags)
+		return 0;
+
+	lookup->groups_mem = env_vzalloc(sizeof(*lookup->groups) *
+			hash_raw->entries + 64);
+	if (!lookup->groups_mem)
+		return -OCF_ERR_NO_MEM;
+
+	addr = (unsigned long)lookup->groups_mem;
+	addr = OCF_DIV_ROUND_UP(addr, 64) * 64;
+	lookup->groups = (struct ocf_metadata_lookup_group *)addr;
+
+	ocf_metadata_hash_lookup_reset_groups(cache);
+
+	return 0;
+}
+
+static void ocf_metadata_hash_lookup_deinit(struct ocf_cache *cache)
+{
+	struct ocf_metadata_lookup *lookup = &cache->metadata.lookup;
+
+	env_vfree(lookup->groups_mem);
+	lookup->groups_mem = NULL;
+	lookup->groups = NULL;
+
+	env_vfree(lookup->entries_mem);
+	lookup->entries_mem = NULL;
+	lookup->entries = NULL;
+	lookup->hash = NULL;
+}
+
+/* Refill lookup index from RAW containers, e.g. after loading metadata */
+static void ocf_metadata_hash_lookup_rebuild(struct ocf_cache *cache)
+{
+	const struct ocf_metadata_lookup_entry *entry;
+	ocf_cache_line_t line, next, hash;
+	ocf_core_id_t core_id;
+	uint64_t core_line;
+	uint32_t step = 0;
+
+	for (line = 0; line < cache->device->collision_table_entries; line++) {
+		ocf_metadata_get_core_info(cache, line, &core_id, &core_line);
+		ocf_metadata_get_collision_info(cache, line, &next, NULL);
+
+		ocf_metadata_lookup_set_core(cache, line, core_id, core_line);
+		ocf_metadata_lookup_set_next(cache, line, next);
+
+		OCF_COND_RESCHED(step, 128);
+	}
+
+	if (!cache->metadata.lookup.groups)
+		return;
+
+	ocf_metadata_hash_lookup_reset_groups(cache);
+
+	for (hash = 0; hash < cache->device->hash_table_entries; hash++) {
+		line = ocf_metadata_lookup_get_hash(cache, hash);
+		while (line != cache->device->collision_table_entries) {
+			entry = ocf_metadata_lookup_get_entry(cache, line);
+			ocf_metadata_lookup_group_add(cache, hash, line,
+					entry->core_id, entry->core_line);
+			line = entry->next;
+		}
+
+		OCF_COND_RESCHED(step, 128);
+	}
+}
+
 /*
  * Deinitialize hash metadata interface
  */
@@ -416,6 +526,8 @@ static void ocf_metadata_hash_deinit_variable_size(struct ocf_cache *cache)
 
 	ocf_metadata_concurrency_attached_deinit(&cache->metadata.lock);
 
+	ocf_metadata_hash_lookup_deinit(cache);
+
 	/*
 	 * De initialize RAW types
 	 */
@@ -1082,6 +1194,14 @@ finalize:
 		return  result;
 	}
 
+	result = ocf_metadata_hash_lookup_init(cache, ctrl);
+	if (result) {
+		ocf_cache_log(cache, log_err, "Failed to allocate metadata "
+				"lookup index\n");
+		ocf_metadata_hash_deinit_variable_size(cache);
+		return result;
+	}
+
 	return 0;
 }
 
@@ -1128,6 +1248,7 @@ static void ocf_metadata_hash_init_hash_table(struct ocf_cache *cache)
 		ocf_metadata_set_hash(cache, i, invalid_idx);
 	}
 
+	ocf_metadata_hash_lookup_reset_groups(cache);
 }
 
 /*
@@ -1824,6 +1945,8 @@ static void ocf_metadata_hash_load_all_finish(ocf_pipeline_t pipeline,
 		goto out;
 	}
 
+	ocf_metadata_hash_lookup_rebuild(cache);
+
 	ocf_cache_log(cache, log_info, "Done loading cache state\n");
 
 out:
@@ -1996,6 +2119,8 @@ static void ocf_metadata_hash_load_recovery_legacy_finish(
 		goto out;
 	}
 
+	ocf_metadata_hash_lookup_rebuild(cache);
+
 	ocf_cache_log(cache, log_info, "Done loading cache state\n");
 
 out:
@@ -2139,6 +2264,8 @@ static void ocf_metadata_hash_load_recovery_atomic_finish(
 		ocf_cache_log(cache, log_err,
 				"Metadata read for recovery FAILURE\n");
 		ocf_metadata_error(cache);
+	} else {
+		ocf_metadata_hash_lookup_rebuild(cache);
 	}
 
 	context->cmpl(context->priv, error);
@@ -2239,6 +2366,8 @@ static void ocf_metadata_hash_set_core_info(struct ocf_cache *cache,
 	if (collision) {
 		collision->core_id = core_id;
 		collision->core_line = core_sector;
+		ocf_metadata_lookup_set_core(cache, line, core_id,
+				core_sector);
 	} else {
 		ocf_metadata_error(cache);
 	}
@@ -2522,6 +2651,7 @@ static void ocf_metadata_hash_set_collision_info(
 	if (info) {
 		info->next_col = next;
 		info->prev_col = prev;
+		ocf_metadata_lookup_set_next(cache, line, next);
 	} else {
 		ocf_metadata_error(cache);
 	}
@@ -2538,10 +2668,12 @@ static void ocf_metadata_hash_set_collision_next(
 	info = ocf_metadata_raw_wr_access(cache,
 			&(ctrl->raw_desc[metadata_segment_list_info]), line);
 
-	if (info)
+	if (info) {
 		info->next_col = next;
-	else
+		ocf_metadata_lookup_set_next(cache, line, next);
+	} else {
 		ocf_metadata_error(cache);
+	}
 }
 
 static void ocf_metadata_hash_set_collision_prev(
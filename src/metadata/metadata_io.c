@@ -210,14 +210,16 @@ static int metadata_io_restart_req(struct ocf_request *req)
 {
 	struct metadata_io_request *m_req = req->priv;
 	ocf_cache_t cache = req->cache;
+	env_atomic *reader;
 	struct ocf_io *io;
 	int ret;
 
 	/* Fill with the latest metadata. */
 	if (m_req->req.rw == OCF_WRITE) {
-		ocf_metadata_start_shared_access(&cache->metadata.lock);
+		reader = ocf_metadata_start_shared_access(
+				&cache->metadata.lock);
 		metadata_io_req_fill(m_req);
-		ocf_metadata_end_shared_access(&cache->metadata.lock);
+		ocf_metadata_end_shared_access(&cache->metadata.lock, reader);
 	}
 
 	io = ocf_new_cache_io(cache, req->io_queue,
@@ -0,0 +1,177 @@
+/*
+ * Copyright(c) 2012-2020 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __METADATA_LOOKUP_H__
+#define __METADATA_LOOKUP_H__
+
+/*
+ * Lookup index is a DRAM only copy of core info and collision next pointer
+ * of every cache line, packed into one 16 byte entry, so walking collision
+ * chain takes single memory access per step and no metadata interface
+ * calls. It is maintained by metadata core info and collision setters and
+ * rebuilt after metadata load.
+ *
+ * Optionally every hash bucket has also group of 7 bit tags of lines mapped
+ * to it, compared 16 at a time, so lookup touches only entries with
+ * matching tag and miss is detected without walking collision chain.
+ * Groups are modified under hash bucket write lock, same as the chain.
+ */
+
+static inline ocf_cache_line_t ocf_metadata_lookup_get_hash(
+		struct ocf_cache *cache, ocf_cache_line_t index)
+{
+	const ocf_cache_line_t *hash = cache->metadata.lookup.hash;
+
+	if (likely(hash))
+		return hash[index];
+
+	return ocf_metadata_get_hash(cache, index);
+}
+
+static inline const struct ocf_metadata_lookup_entry *
+ocf_metadata_lookup_get_entry(struct ocf_cache *cache, ocf_cache_line_t line)
+{
+	return &cache->metadata.lookup.entries[line];
+}
+
+static inline void ocf_metadata_lookup_set_core(struct ocf_cache *cache,
+		ocf_cache_line_t line, ocf_core_id_t core_id,
+		uint64_t core_line)
+{
+	struct ocf_metadata_lookup_entry *entry =
+			&cache->metadata.lookup.entries[line];
+
+	entry->core_id = core_id;
+	entry->core_line = core_line;
+}
+
+static inline void ocf_metadata_lookup_set_next(struct ocf_cache *cache,
+		ocf_cache_line_t line, ocf_cache_line_t next)
+{
+	cache->metadata.lookup.entries[line].next = next;
+}
+
+static inline uint8_t ocf_metadata_lookup_tag(ocf_core_id_t core_id,
+		uint64_t core_line)
+{
+	uint64_t h = (core_line ^ ((uint64_t)core_id << 48)) *
+			0x9E3779B97F4A7C15ULL;
+
+	/* Top bits, hash bucket index is taken from low bits of core line */
+	return h >> 57;
+}
+
+static inline void ocf_metadata_lookup_group_reset(
+		struct ocf_metadata_lookup_group *group)
+{
+	unsigned int i;
+
+	for (i = 0; i < sizeof(group->tags); i++) {
+		group->tags[i] = i < OCF_METADATA_LOOKUP_GROUP_LINES ?
+				OCF_METADATA_LOOKUP_TAG_EMPTY :
+				OCF_METADATA_LOOKUP_TAG_UNUSED;
+	}
+	group->overflow = 0;
+}
+
+static inline void ocf_metadata_lookup_group_add(struct ocf_cache *cache,
+		ocf_cache_line_t hash, ocf_cache_line_t line,
+		ocf_core_id_t core_id, uint64_t core_line)
+{
+	struct ocf_metadata_lookup_group *group;
+	uint32_t empty;
+	unsigned int i;
+
+	if (!cache->metadata.lookup.groups)
+		return;
+
+	group = &cache->metadata.lookup.groups[hash];
+	empty = env_bytes_match16(group->tags, OCF_METADATA_LOOKUP_TAG_EMPTY);
+	if (!empty) {
+		group->overflow++;
+		return;
+	}
+
+	i = env_bit_ffs(empty);
+	group->lines[i] = line;
+	group->tags[i] = ocf_metadata_lookup_tag(core_id, core_line);
+}
+
+static inline void ocf_metadata_lookup_group_remove(struct ocf_cache *cache,
+		ocf_cache_line_t hash, ocf_cache_line_t line,
+		ocf_core_id_t core_id, uint64_t core_line)
+{
+	struct ocf_metadata_lookup_group *group;
+	uint32_t match;
+	unsigned int i;
+
+	if (!cache->metadata.lookup.groups)
+		return;
+
+	group = &cache->metadata.lookup.groups[hash];
+	match = env_bytes_match16(group->tags,
+			ocf_metadata_lookup_tag(core_id, core_line));
+
+	for (; match; match &= match - 1) {
+		i = env_bit_ffs(match);
+		if (group->lines[i] == line) {
+			group->tags[i] = OCF_METADATA_LOOKUP_TAG_EMPTY;
+			return;
+		}
+	}
+
+	ENV_BUG_ON(!group->overflow);
+	group->overflow--;
+}
+
+/*
+ * Find cache line mapping given core line in hash bucket, returns number
+ * of collision table entries on miss
+ */
+static inline ocf_cache_line_t ocf_metadata_lookup_find(
+		struct ocf_cache *cache, ocf_cache_line_t hash,
+		ocf_core_id_t core_id, uint64_t core_line)
+{
+	struct ocf_metadata_lookup *lookup = &cache->metadata.lookup;
+	ocf_cache_line_t line_entries = cache->device->collision_table_entries;
+	const struct ocf_metadata_lookup_entry *curr;
+	ocf_cache_line_t line, steps;
+
+	if (lookup->groups) {
+		const struct ocf_metadata_lookup_group *group =
+				&lookup->groups[hash];
+		uint32_t match = env_bytes_match16(group->tags,
+				ocf_metadata_lookup_tag(core_id, core_line));
+
+		for (; match; match &= match - 1) {
+			line = group->lines[env_bit_ffs(match)];
+			curr = &lookup->entries[line];
+			if (curr->core_id == core_id &&
+					curr->core_line == core_line) {
+				return line;
+			}
+		}
+
+		if (!group->overflow)
+			return line_entries;
+	}
+
+	line = ocf_metadata_lookup_get_hash(cache, hash);
+
+	/* Chain length bound keeps optimistic (unlocked) walk finite while
+	 * chain is modified, such walk is validated afterwards */
+	for (steps = 0; line != line_entries && steps < line_entries; steps++) {
+		curr = &lookup->entries[line];
+
+		if (curr->core_id == core_id && curr->core_line == core_line)
+			return line;
+
+		line = curr->next;
+	}
+
+	return line_entries;
+}
+
+#endif /* __METADATA_LOOKUP_H__ */
@@ -28,6 +28,8 @@ struct ocf_user_part_config {
 
 struct ocf_user_part_runtime {
         uint32_t curr_size;
+        /* Size set by partition balancing, lines above it go first */
+        uint32_t target_size;
         uint32_t head;
         struct eviction_policy eviction;
         struct cleaning_policy cleaning;
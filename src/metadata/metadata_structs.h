@@ -434,12 +434,28 @@ struct ocf_cache_line_settings {
 	uint64_t sector_end;
 };
 
+/**
+ * @brief Per CPU reader count of global metadata lock
+ */
+struct ocf_metadata_global_readers {
+	env_atomic count;
+		/*!< Readers which locked on given CPU minus readers which
+		 * unlocked on it, only sum over all CPUs is meaningful */
+} __attribute__((aligned(64)));
+
 struct ocf_metadata_lock
 {
 	env_rwsem global; /*!< global metadata lock (GML) */
+	struct ocf_metadata_global_readers *global_readers;
+		/*!< Per CPU shared access counters of GML */
+	void *global_readers_mem; /*!< Memory backing per CPU counters */
+	unsigned global_readers_no; /*!< Number of per CPU counters */
+	env_atomic global_block;
+		/*!< Set while exclusive access is taken or requested */
 	env_rwlock status; /*!< Fast lock for status bits */
-	env_spinlock eviction; /*!< Fast lock for eviction policy */
-	env_rwsem *hash; /*!< Hash bucket locks */
+	env_spinlock eviction[OCF_NUM_EVICTION_LISTS];
+		/*!< Fast locks for eviction policy lists */
+	env_atomic64 *hash; /*!< Hash bucket rw spinlocks with version */
 	env_rwsem *collision_pages; /*!< Collision table page locks */
 	env_spinlock partition[OCF_IO_CLASS_MAX]; /* partition lock */
 	uint32_t num_hash_entries;  /*!< Hash bucket count */
@@ -447,6 +463,53 @@ struct ocf_metadata_lock
 	ocf_cache_t cache;  /*!< Parent cache object */
 };
 
+/**
+ * @brief Lookup index entry, one per cache line
+ */
+struct ocf_metadata_lookup_entry {
+	uint64_t core_line;
+	ocf_cache_line_t next;
+		/*!< Next cache line in collision list */
+	uint16_t core_id;
+} __attribute__((aligned(16)));
+
+#define OCF_METADATA_LOOKUP_GROUP_LINES 11
+#define OCF_METADATA_LOOKUP_TAG_EMPTY 0x80
+#define OCF_METADATA_LOOKUP_TAG_UNUSED 0xff
+
+/**
+ * @brief Tags of lines mapped to one hash bucket, one CPU cache line each.
+ *
+ * All 16 tag bytes are compared at once, tags past the last slot are
+ * UNUSED so they never match. Lines which did not fit are counted in
+ * overflow and found by walking collision chain.
+ */
+struct ocf_metadata_lookup_group {
+	uint8_t tags[16];
+	ocf_cache_line_t lines[OCF_METADATA_LOOKUP_GROUP_LINES];
+	uint32_t overflow;
+} __attribute__((aligned(64)));
+
+/**
+ * @brief Lookup optimized copy of collision mapping
+ */
+struct ocf_metadata_lookup {
+	struct ocf_metadata_lookup_entry *entries;
+		/*!< Cache line aligned entries array */
+
+	void *entries_mem;
+		/*!< Allocated memory backing entries */
+
+	const ocf_cache_line_t *hash;
+		/*!< Hash table memory if directly addressable, NULL otherwise */
+
+	struct ocf_metadata_lookup_group *groups;
+		/*!< Tag group per hash bucket, NULL if disabled */
+
+	void *groups_mem;
+		/*!< Allocated memory backing groups */
+};
+
 /**
  * @brief Metadata control structure
  */
@@ -464,6 +527,9 @@ struct ocf_metadata {
 		/*!< true if metadata used in volatile mode (RAM only) */
 
 	struct ocf_metadata_lock lock;
+
+	struct ocf_metadata_lookup lookup;
+		/*!< Lookup index used on request traverse */
 };
 
 #endif /* __METADATA_STRUCTS_H__ */
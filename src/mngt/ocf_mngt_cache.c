@@ -18,6 +18,7 @@
 #include "../utils/utils_pipeline.h"
 #include "../utils/utils_refcnt.h"
 #include "../utils/utils_async_lock.h"
+#include "../utils/utils_dirty_index.h"
 #include "../concurrency/ocf_concurrency.h"
 #include "../eviction/ops.h"
 #include "../ocf_ctx_priv.h"
@@ -128,6 +129,8 @@ struct ocf_cache_attach_context {
 		bool freelist_inited : 1;
 
 		bool concurrency_inited : 1;
+
+		bool dirty_index_inited : 1;
 	} flags;
 
 	struct {
@@ -305,6 +308,15 @@ static ocf_error_t init_attached_data_structures(ocf_cache_t cache,
 
 	/* Lock to ensure consistency */
 
+	/* Eviction policy has to be known before partition lists init */
+	__init_eviction_policy(cache, eviction_policy);
+	result = ocf_eviction_init_cache(cache, 1);
+	if (result) {
+		ocf_cache_log(cache, log_err,
+				"Cannot initialize eviction policy\n");
+		return result;
+	}
+
 	ocf_metadata_init_hash_table(cache);
 	ocf_metadata_init_collision(cache);
 	__init_partitions_attached(cache);
@@ -317,19 +329,29 @@ static ocf_error_t init_attached_data_structures(ocf_cache_t cache,
 		return result;
 	}
 
-	__init_eviction_policy(cache, eviction_policy);
 	__setup_promotion_policy(cache);
 
 	return 0;
 }
 
-static void init_attached_data_structures_recovery(ocf_cache_t cache)
+static ocf_error_t init_attached_data_structures_recovery(ocf_cache_t cache)
 {
+	ocf_error_t result;
+
+	result = ocf_eviction_init_cache(cache, 1);
+	if (result) {
+		ocf_cache_log(cache, log_err,
+				"Cannot initialize eviction policy\n");
+		return result;
+	}
+
 	ocf_metadata_init_hash_table(cache);
 	ocf_metadata_init_collision(cache);
 	__init_partitions_attached(cache);
 	__reset_stats(cache);
 	__init_metadata_version(cache);
+
+	return 0;
 }
 
 /****************************************************************
@@ -352,7 +374,7 @@ static void _ocf_mngt_close_all_uninitialized_cores(
 
 		--j;
 
-		env_free(cache->core[i].counters);
+		env_vfree(cache->core[i].counters);
 		cache->core[i].counters = NULL;
 
 		env_bit_clear(i, cache->conf_meta->valid_core_bitmap);
@@ -423,7 +445,7 @@ static int _ocf_mngt_init_instance_add_cores(
 			goto err;
 
 		core->counters =
-			env_zalloc(sizeof(*core->counters), ENV_MEM_NORMAL);
+			env_vzalloc(sizeof(*core->counters));
 		if (!core->counters)
 			goto err;
 
@@ -472,6 +494,16 @@ void _ocf_mngt_init_instance_load_complete(void *priv, int error)
 
 	__init_freelist(cache);
 
+	if (context->metadata.shutdown_status == ocf_metadata_clean_shutdown) {
+		/* Recovery initialized eviction before rebuilding lists */
+		result = ocf_eviction_init_cache(cache, 0);
+		if (result) {
+			ocf_cache_log(cache, log_err,
+					"Cannot initialize eviction policy\n");
+			OCF_PL_FINISH_RET(context->pipeline, result);
+		}
+	}
+
 	cleaning_policy = cache->conf_meta->cleaning_policy_type;
 	if (!cleaning_policy_ops[cleaning_policy].initialize)
 		goto out;
@@ -510,8 +542,11 @@ static void _ocf_mngt_init_instance_recovery(
 		struct ocf_cache_attach_context *context)
 {
 	ocf_cache_t cache = context->cache;
+	ocf_error_t result;
 
-	init_attached_data_structures_recovery(cache);
+	result = init_attached_data_structures_recovery(cache);
+	if (result)
+		OCF_PL_FINISH_RET(context->pipeline, result);
 
 	ocf_cache_log(cache, log_warn,
 			"ERROR: Cache device did not shut down properly!\n");
@@ -565,6 +600,13 @@ static int _ocf_mngt_init_new_cache(struct ocf_cache_mngt_init_params *params)
 		goto lock_err;
 	}
 
+	if (env_spinlock_init(&cache->io_queues_lock)) {
+		result = -OCF_ERR_NO_MEM;
+		goto flush_mutex_err;
+	}
+
+	cache->flush_streams = OCF_MNGT_FLUSH_STREAMS_DEFAULT;
+
 	ENV_BUG_ON(!ocf_refcnt_inc(&cache->refcnt.cache));
 
 	/* start with freezed metadata ref counter to indicate detached device*/
@@ -580,6 +622,8 @@ static int _ocf_mngt_init_new_cache(struct ocf_cache_mngt_init_params *params)
 
 	return 0;
 
+flush_mutex_err:
+	env_mutex_destroy(&cache->flush_mutex);
 lock_err:
 	ocf_mngt_cache_lock_deinit(cache);
 alloc_err:
@@ -678,6 +722,7 @@ static int _ocf_mngt_init_prepare_cache(struct ocf_cache_mngt_init_params *param
 
 	cache->pt_unaligned_io = cfg->pt_unaligned_io;
 	cache->use_submit_io_fast = cfg->use_submit_io_fast;
+	cache->use_lookup_tags = cfg->use_lookup_tags;
 
 	cache->eviction_policy_init = cfg->eviction_policy;
 	cache->metadata.is_volatile = cfg->metadata_volatile;
@@ -992,6 +1037,12 @@ static void _ocf_mngt_attach_prepare_metadata(ocf_pipeline_t pipeline,
 
 	context->flags.concurrency_inited = 1;
 
+	ret = ocf_dirty_index_init(cache);
+	if (ret)
+		OCF_PL_FINISH_RET(context->pipeline, ret);
+
+	context->flags.dirty_index_inited = 1;
+
 	ocf_pipeline_next(context->pipeline);
 }
 
@@ -1144,9 +1195,15 @@ static void _ocf_mngt_attach_handle_error(
 	if (context->flags.device_opened)
 		ocf_volume_close(&cache->device->volume);
 
+	if (context->flags.dirty_index_inited)
+		ocf_dirty_index_deinit(cache);
+
 	if (context->flags.concurrency_inited)
 		ocf_concurrency_deinit(cache);
 
+	if (context->flags.device_alloc)
+		ocf_eviction_deinit_cache(cache);
+
 	if (context->flags.freelist_inited)
 		ocf_freelist_deinit(cache->freelist);
 
@@ -1500,6 +1557,12 @@ static void _ocf_mngt_attach_post_init(ocf_pipeline_t pipeline,
 	struct ocf_cache_attach_context *context = priv;
 	ocf_cache_t cache = context->cache;
 
+	ocf_part_reset_targets(cache);
+
+	/* Loaded metadata may contain dirty lines */
+	if (context->init_mode == ocf_init_mode_load)
+		ocf_dirty_index_rebuild(cache);
+
 	ocf_cleaner_refcnt_unfreeze(cache);
 	ocf_refcnt_unfreeze(&cache->refcnt.metadata);
 
@@ -1669,6 +1732,7 @@ static void ocf_mngt_cache_remove(ocf_ctx_t ctx, ocf_cache_t cache)
 	/* Deinitialize locks */
 	ocf_mngt_cache_lock_deinit(cache);
 	env_mutex_destroy(&cache->flush_mutex);
+	env_spinlock_destroy(&cache->io_queues_lock);
 
 	/* Remove cache from the list */
 	env_rmutex_lock(&ctx->lock);
@@ -1959,7 +2023,9 @@ static void _ocf_mngt_cache_unplug_complete(void *priv, int error)
 	ocf_volume_close(&cache->device->volume);
 
 	ocf_metadata_deinit_variable_size(cache);
+	ocf_dirty_index_deinit(cache);
 	ocf_concurrency_deinit(cache);
+	ocf_eviction_deinit_cache(cache);
 	ocf_freelist_deinit(cache->freelist);
 
 	ocf_volume_deinit(&cache->device->volume);
@@ -2294,12 +2360,13 @@ int ocf_mngt_cache_promotion_set_policy(ocf_cache_t cache, ocf_promotion_t type)
 ocf_promotion_t ocf_mngt_cache_promotion_get_policy(ocf_cache_t cache)
 {
 	ocf_promotion_t result;
+	env_atomic *reader;
 
-	ocf_metadata_start_shared_access(&cache->metadata.lock);
+	reader = ocf_metadata_start_shared_access(&cache->metadata.lock);
 
 	result = cache->conf_meta->promotion_policy_type;
 
-	ocf_metadata_end_shared_access(&cache->metadata.lock);
+	ocf_metadata_end_shared_access(&cache->metadata.lock, reader);
 
 	return result;
 }
@@ -2307,13 +2374,14 @@ ocf_promotion_t ocf_mngt_cache_promotion_get_policy(ocf_cache_t cache)
 int ocf_mngt_cache_promotion_get_param(ocf_cache_t cache, ocf_promotion_t type,
 		uint8_t param_id, uint32_t *param_value)
 {
+	env_atomic *reader;
 	int result;
 
-	ocf_metadata_start_shared_access(&cache->metadata.lock);
+	reader = ocf_metadata_start_shared_access(&cache->metadata.lock);
 
 	result = ocf_promotion_get_param(cache, type, param_id, param_value);
 
-	ocf_metadata_end_shared_access(&cache->metadata.lock);
+	ocf_metadata_end_shared_access(&cache->metadata.lock, reader);
 
 	return result;
 }
@@ -15,6 +15,7 @@
 #include "../ocf_logger_priv.h"
 #include "../ocf_queue_priv.h"
 #include "../engine/engine_common.h"
+#include "../ocf_mrc.h"
 
 /* Close if opened */
 int cache_mngt_core_close(ocf_core_t core)
@@ -115,8 +116,10 @@ void cache_mngt_core_remove_from_cache(ocf_core_t core)
 	ocf_cache_t cache = ocf_core_get_cache(core);
 	ocf_core_id_t core_id = ocf_core_get_id(core);
 
-	env_free(core->counters);
+	env_vfree(core->counters);
 	core->counters = NULL;
+	ocf_core_seq_cutoff_deinit(core);
+	ocf_core_mrc_deinit(core);
 	core->added = false;
 	env_bit_clear(core_id, cache->conf_meta->valid_core_bitmap);
 
@@ -135,6 +138,7 @@ void ocf_mngt_cache_put(ocf_cache_t cache)
 	if (ocf_refcnt_dec(&cache->refcnt.cache) == 0) {
 		ctx = cache->owner;
 		ocf_metadata_deinit(cache);
+		ocf_cache_mrc_deinit(cache);
 		env_vfree(cache);
 		ocf_ctx_put(ctx);
 	}
@@ -12,6 +12,7 @@
 #include "../utils/utils_pipeline.h"
 #include "../ocf_stats_priv.h"
 #include "../ocf_def_priv.h"
+#include "../ocf_mrc.h"
 
 static ocf_seq_no_t _ocf_mngt_get_core_seq_no(ocf_cache_t cache)
 {
@@ -119,8 +120,10 @@ static void _ocf_mngt_cache_add_core_handle_error(
 		core->added = false;
 		core->opened = false;
 
-		env_free(core->counters);
+		env_vfree(core->counters);
 		core->counters = NULL;
+		ocf_core_seq_cutoff_deinit(core);
+		ocf_core_mrc_deinit(core);
 	}
 
 	if (context->flags.clean_pol_added) {
@@ -412,7 +415,7 @@ static void ocf_mngt_cache_add_core_insert(ocf_pipeline_t pipeline,
 
 	/* When adding new core to cache, allocate stat counters */
 	core->counters =
-		env_zalloc(sizeof(*core->counters), ENV_MEM_NORMAL);
+		env_vzalloc(sizeof(*core->counters));
 	if (!core->counters)
 		OCF_PL_FINISH_RET(context->pipeline, -OCF_ERR_NO_MEM);
 
@@ -12,6 +12,7 @@
 #include "../engine/engine_common.h"
 #include "../utils/utils_cleaner.h"
 #include "../utils/utils_cache_line.h"
+#include "../utils/utils_dirty_index.h"
 #include "../utils/utils_part.h"
 #include "../utils/utils_pipeline.h"
 #include "../utils/utils_refcnt.h"
@@ -27,6 +28,10 @@ struct flush_containers_context
 	struct flush_container *fctbl;
 	/* fctbl array size */
 	uint32_t fcnum;
+	/* flushed ranges of containers, fctbl if not split */
+	struct flush_container *streams;
+	/* streams array size */
+	uint32_t streams_num;
 	/* shared error for all concurrent container flushes */
 	env_atomic error;
 	/* number of outstanding container flushes */
@@ -144,7 +149,7 @@ static int _ocf_mngt_get_sectors(ocf_cache_t cache, ocf_core_id_t core_id,
 	uint64_t core_line;
 	ocf_core_id_t i_core_id;
 	struct flush_data *elem;
-	uint32_t line, dirty_found = 0, dirty_total = 0;
+	uint32_t line, visited = 0, dirty_found = 0, dirty_total = 0;
 	unsigned ret = 0;
 
 	ocf_metadata_start_exclusive_access(&cache->metadata.lock);
@@ -162,15 +167,17 @@ static int _ocf_mngt_get_sectors(ocf_cache_t cache, ocf_core_id_t core_id,
 		goto unlock;
 	}
 
-	for (line = 0, elem = *tbl;
+	for (line = ocf_dirty_index_next(cache, 0), elem = *tbl;
 			line < cache->device->collision_table_entries;
-			line++) {
+			line = ocf_dirty_index_next(cache, line + 1)) {
 		ocf_metadata_get_core_info(cache, line, &i_core_id,
 				&core_line);
 
-		if (i_core_id == core_id &&
-				metadata_test_valid_any(cache, line) &&
-				metadata_test_dirty(cache, line)) {
+		if (!metadata_test_dirty(cache, line)) {
+			/* Stale index entry */
+			ocf_dirty_index_unmark(cache, line);
+		} else if (i_core_id == core_id &&
+				metadata_test_valid_any(cache, line)) {
 			/* It's valid and dirty target core cacheline */
 			elem->cache_line = line;
 			elem->core_line = core_line;
@@ -183,7 +190,7 @@ static int _ocf_mngt_get_sectors(ocf_cache_t cache, ocf_core_id_t core_id,
 				break;
 		}
 
-		if ((line + 1) % 131072 == 0) {
+		if (++visited % 131072 == 0) {
 			ocf_metadata_end_exclusive_access(
 					&cache->metadata.lock);
 			env_cond_resched();
@@ -214,7 +221,7 @@ static int _ocf_mngt_get_flush_containers(ocf_cache_t cache,
 	uint64_t core_line;
 	ocf_core_id_t core_id;
 	ocf_core_t core;
-	uint32_t i, j = 0, line;
+	uint32_t i, j = 0, line, visited = 0;
 	uint32_t dirty_found = 0, dirty_total = 0;
 	int ret = 0;
 
@@ -267,11 +274,15 @@ static int _ocf_mngt_get_flush_containers(ocf_cache_t cache,
 		goto unlock;
 	}
 
-	for (line = 0; line < cache->device->collision_table_entries; line++) {
+	for (line = ocf_dirty_index_next(cache, 0);
+			line < cache->device->collision_table_entries;
+			line = ocf_dirty_index_next(cache, line + 1)) {
 		ocf_metadata_get_core_info(cache, line, &core_id, &core_line);
 
-		if (metadata_test_valid_any(cache, line) &&
-				metadata_test_dirty(cache, line)) {
+		if (!metadata_test_dirty(cache, line)) {
+			/* Stale index entry */
+			ocf_dirty_index_unmark(cache, line);
+		} else if (metadata_test_valid_any(cache, line)) {
 			curr = &fc[core_revmap[core_id]];
 
 			ENV_BUG_ON(curr->iter >= curr->count);
@@ -288,7 +299,7 @@ static int _ocf_mngt_get_flush_containers(ocf_cache_t cache,
 				break;
 		}
 
-		if ((line + 1) % 131072 == 0) {
+		if (++visited % 131072 == 0) {
 			ocf_metadata_end_exclusive_access(
 					&cache->metadata.lock);
 			env_cond_resched();
@@ -352,6 +363,7 @@ static void _ocf_mngt_flush_portion(struct flush_container *fc)
 	fc->flush_portion = OCF_MAX(fc->flush_portion, OCF_MNG_FLUSH_MIN);
 
 	curr_count = OCF_MIN(fc->count - fc->iter, fc->flush_portion);
+	fc->portion_count = curr_count;
 
 	ocf_cleaner_do_flush_data_async(fc->cache,
 			&fc->flush_data[fc->iter],
@@ -369,7 +381,7 @@ static void _ocf_mngt_flush_portion_end(void *private_data, int error)
 	ocf_core_t core = &cache->core[fc->core_id];
 	bool first_interrupt;
 
-	env_atomic_set(&core->flushed, fc->iter);
+	env_atomic_add(fc->portion_count, &core->flushed);
 
 	fc->ticks2 = env_get_tick_count();
 
@@ -463,6 +475,9 @@ void _ocf_flush_container_complete(void *ctx)
 		return;
 	}
 
+	if (context->fcs.streams != context->fcs.fctbl)
+		env_vfree(context->fcs.streams);
+
 	_ocf_mngt_free_flush_containers(context->fcs.fctbl,
 			context->fcs.fcnum);
 
@@ -470,11 +485,54 @@ void _ocf_flush_container_complete(void *ctx)
 			env_atomic_read(&context->fcs.error));
 }
 
+/*
+ * Split sorted containers into contiguous core address ranges, flushed
+ * concurrently. Ranges below OCF_MNG_FLUSH_MIN lines are not worth a
+ * separate stream. Returns NULL if there is nothing to split or no memory.
+ */
+static struct flush_container *_ocf_mngt_split_flush_containers(
+		ocf_cache_t cache, struct flush_container *fctbl,
+		uint32_t fcnum, uint32_t *streams_num)
+{
+	struct flush_container *streams;
+	uint32_t i, j, n, num = 0, offset, len;
+
+	for (i = 0; i < fcnum; i++) {
+		num += OCF_MIN(OCF_MAX(fctbl[i].count / OCF_MNG_FLUSH_MIN, 1),
+				cache->flush_streams);
+	}
+
+	if (num == fcnum)
+		return NULL;
+
+	streams = env_vzalloc(sizeof(*streams) * num);
+	if (!streams)
+		return NULL;
+
+	for (i = 0, j = 0; i < fcnum; i++) {
+		n = OCF_MIN(OCF_MAX(fctbl[i].count / OCF_MNG_FLUSH_MIN, 1),
+				cache->flush_streams);
+
+		for (offset = 0; n; n--, j++, offset += len) {
+			len = (fctbl[i].count - offset) / n;
+
+			streams[j].core_id = fctbl[i].core_id;
+			streams[j].flush_data = &fctbl[i].flush_data[offset];
+			streams[j].count = len;
+		}
+	}
+
+	*streams_num = num;
+
+	return streams;
+}
+
 static void _ocf_mngt_flush_containers(
 		struct ocf_mngt_cache_flush_context *context,
 		struct flush_container *fctbl,
 		uint32_t fcnum, ocf_flush_complete_t complete)
 {
+	ocf_cache_t cache = context->cache;
 	int i;
 
 	if (fcnum == 0) {
@@ -491,9 +549,18 @@ static void _ocf_mngt_flush_containers(
 	context->fcs.fctbl = fctbl;
 	context->fcs.fcnum = fcnum;
 
-	for (i = 0; i < fcnum; i++) {
+	context->fcs.streams = _ocf_mngt_split_flush_containers(cache,
+			fctbl, fcnum, &context->fcs.streams_num);
+	if (!context->fcs.streams) {
+		context->fcs.streams = fctbl;
+		context->fcs.streams_num = fcnum;
+	}
+
+	/* Streams of the same core run concurrently, so cache reads of
+	 * one overlap core writes of another */
+	for (i = 0; i < context->fcs.streams_num; i++) {
 		env_atomic_inc(&context->fcs.count);
-		_ocf_mngt_flush_container(context, &fctbl[i],
+		_ocf_mngt_flush_container(context, &context->fcs.streams[i],
 			_ocf_flush_container_complete);
 	}
 
@@ -900,6 +967,28 @@ void ocf_mngt_cache_flush_interrupt(ocf_cache_t cache)
 	cache->flushing_interrupted = 1;
 }
 
+int ocf_mngt_cache_set_flush_streams(ocf_cache_t cache, uint32_t streams)
+{
+	OCF_CHECK_NULL(cache);
+
+	if (streams < 1 || streams > OCF_MNGT_FLUSH_STREAMS_MAX)
+		return -OCF_ERR_INVAL;
+
+	cache->flush_streams = streams;
+
+	return 0;
+}
+
+int ocf_mngt_cache_get_flush_streams(ocf_cache_t cache, uint32_t *streams)
+{
+	OCF_CHECK_NULL(cache);
+	OCF_CHECK_NULL(streams);
+
+	*streams = cache->flush_streams;
+
+	return 0;
+}
+
 int ocf_mngt_cache_cleaning_set_policy(ocf_cache_t cache, ocf_cleaning_t type)
 {
 	ocf_cleaning_t old_type;
@@ -297,3 +297,37 @@ out_cpy:
 
 	return result;
 }
+
+int ocf_mngt_cache_set_io_classes_balance(ocf_cache_t cache,
+		uint32_t interval_ms)
+{
+	OCF_CHECK_NULL(cache);
+
+	if (!ocf_cache_is_device_attached(cache))
+		return -OCF_ERR_INVAL;
+
+	ocf_metadata_start_exclusive_access(&cache->metadata.lock);
+
+	/* Start over from unconstrained targets, rebalance on next reclaim */
+	ocf_part_reset_targets(cache);
+	cache->part_balance.interval_ms = interval_ms;
+	cache->part_balance.last_ns = 0;
+
+	ocf_metadata_end_exclusive_access(&cache->metadata.lock);
+
+	ocf_cache_log(cache, log_info, "IO classes balancing %s\n",
+			interval_ms ? "enabled" : "disabled");
+
+	return 0;
+}
+
+int ocf_mngt_cache_get_io_classes_balance(ocf_cache_t cache,
+		uint32_t *interval_ms)
+{
+	OCF_CHECK_NULL(cache);
+	OCF_CHECK_NULL(interval_ms);
+
+	*interval_ms = cache->part_balance.interval_ms;
+
+	return 0;
+}
@@ -38,6 +38,9 @@ struct ocf_trace {
 	void *trace_ctx;
 
 	env_atomic64 trace_seq_ref;
+
+	/* Records per queue of built-in trace ring, 0 if not started */
+	uint32_t ring_entries;
 };
 
 /**
@@ -86,8 +89,16 @@ struct ocf_cache_device {
 
 	struct {
 		struct ocf_cache_line_concurrency *cache_line;
+		/* Per cache line reference bits, set without any lock on
+		 * cache hit and consumed by eviction */
+		unsigned long *eviction_ref;
 	} concurrency;
 
+	struct eviction_cache eviction;
+
+	/* Hints of dirty cache lines, see utils_dirty_index.h */
+	struct ocf_dirty_index *dirty_index;
+
 	enum ocf_mngt_cache_init_mode init_mode;
 
 	struct ocf_superblock_runtime *runtime_meta;
@@ -137,7 +148,10 @@ struct ocf_cache {
 	env_atomic pending_eviction_clines;
 
 	struct list_head io_queues;
+	/* Protects io_queues list against concurrent queue create/put */
+	env_spinlock io_queues_lock;
 	ocf_queue_t mngt_queue;
+	env_atomic queue_id_seq;
 
 	uint16_t ocf_core_inactive_count;
 	struct ocf_core core[OCF_CORE_MAX];
@@ -148,6 +162,15 @@ struct ocf_cache {
 	struct ocf_metadata_updater metadata_updater;
 	ocf_promotion_policy_t promotion_policy;
 
+	/* Miss ratio curve estimators per IO class, allocated on first IO */
+	struct ocf_mrc *part_mrc[OCF_IO_CLASS_MAX];
+
+	/* Partition target sizes rebalancing, disabled when interval is 0 */
+	struct {
+		uint32_t interval_ms;
+		uint64_t last_ns;
+	} part_balance;
+
 	struct ocf_async_lock lock;
 
 	/*
@@ -157,6 +180,9 @@ struct ocf_cache {
 	int flushing_interrupted;
 	env_mutex flush_mutex;
 
+	/* Flush streams in flight per core */
+	uint32_t flush_streams;
+
 	struct {
 		uint32_t max_queue_size;
 		uint32_t queue_unblock_size;
@@ -166,6 +192,8 @@ struct ocf_cache {
 
 	bool use_submit_io_fast;
 
+	bool use_lookup_tags;
+
 	struct ocf_trace trace;
 
 	ocf_pipeline_t stop_pipeline;
@@ -88,6 +88,9 @@ struct ocf_core {
 
 	struct ocf_counters_core *counters;
 
+	/* Miss ratio curve estimator, allocated on first IO */
+	struct ocf_mrc *mrc;
+
 	void *priv;
 };
 
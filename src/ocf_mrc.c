@@ -0,0 +1,499 @@
+/*
+ * Copyright(c) 2020 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include "ocf_mrc.h"
+#include "ocf_priv.h"
+#include "ocf_cache_priv.h"
+#include "ocf_core_priv.h"
+#include "metadata/metadata.h"
+#include "utils/utils_stats.h"
+#include "utils/utils_freq_sketch.h"
+
+/* Weight of single sampled access in histogram */
+#define MRC_ONE (1ULL << 16)
+
+/* Sample 1/8 of core lines until key limit forces lower rate */
+#define MRC_INITIAL_THRESHOLD (~0ULL >> 3)
+
+static void ocf_mrc_init(struct ocf_mrc *mrc)
+{
+	uint32_t i;
+
+	for (i = 0; i < OCF_MRC_SHARDS; i++)
+		env_spinlock_init(&mrc->shards[i].lock);
+
+	env_spinlock_init(&mrc->lock);
+	mrc->threshold = MRC_INITIAL_THRESHOLD;
+	mrc->free_key = OCF_MRC_INVALID;
+
+	for (i = 0; i < OCF_MRC_HASH_BUCKETS; i++)
+		mrc->buckets[i] = OCF_MRC_INVALID;
+
+	for (i = 0; i < OCF_MRC_TIME_SLOTS; i++)
+		mrc->slot_key[i] = OCF_MRC_INVALID;
+}
+
+static void ocf_mrc_destroy(struct ocf_mrc *mrc)
+{
+	uint32_t i;
+
+	for (i = 0; i < OCF_MRC_SHARDS; i++)
+		env_spinlock_destroy(&mrc->shards[i].lock);
+
+	env_spinlock_destroy(&mrc->lock);
+	env_vfree(mrc);
+}
+
+static struct ocf_mrc *ocf_mrc_get(struct ocf_mrc **ptr)
+{
+	struct ocf_mrc *mrc, *old;
+
+	mrc = *ptr;
+	if (likely(mrc))
+		return mrc;
+
+	mrc = env_vzalloc_flags(sizeof(*mrc), ENV_MEM_NOIO);
+	if (!mrc)
+		return NULL;
+
+	ocf_mrc_init(mrc);
+
+	old = __sync_val_compare_and_swap(ptr, NULL, mrc);
+	if (old) {
+		ocf_mrc_destroy(mrc);
+		return old;
+	}
+
+	return mrc;
+}
+
+static void ocf_mrc_put(struct ocf_mrc **ptr)
+{
+	struct ocf_mrc *mrc = *ptr;
+
+	if (!mrc)
+		return;
+
+	ocf_mrc_destroy(mrc);
+	*ptr = NULL;
+}
+
+/* Fenwick tree over time slots, counts keys last accessed at slot */
+static void ocf_mrc_fenwick_add(struct ocf_mrc *mrc, uint32_t slot,
+		int32_t value)
+{
+	uint32_t i;
+
+	for (i = slot + 1; i <= OCF_MRC_TIME_SLOTS; i += i & -i)
+		mrc->fenwick[i] += value;
+}
+
+/* Number of keys last accessed at slots [0, slot] */
+static uint32_t ocf_mrc_fenwick_sum(struct ocf_mrc *mrc, uint32_t slot)
+{
+	uint32_t i, sum = 0;
+
+	for (i = slot + 1; i > 0; i -= i & -i)
+		sum += mrc->fenwick[i];
+
+	return sum;
+}
+
+static uint32_t ocf_mrc_lookup(struct ocf_mrc *mrc, uint64_t hash)
+{
+	uint32_t k = mrc->buckets[hash & (OCF_MRC_HASH_BUCKETS - 1)];
+
+	while (k != OCF_MRC_INVALID && mrc->keys[k].hash != hash)
+		k = mrc->keys[k].next;
+
+	return k;
+}
+
+static void ocf_mrc_link(struct ocf_mrc *mrc, uint32_t k)
+{
+	uint32_t *head = &mrc->buckets[mrc->keys[k].hash &
+			(OCF_MRC_HASH_BUCKETS - 1)];
+
+	mrc->keys[k].next = *head;
+	*head = k;
+}
+
+static void ocf_mrc_unlink(struct ocf_mrc *mrc, uint32_t k)
+{
+	uint32_t *curr = &mrc->buckets[mrc->keys[k].hash &
+			(OCF_MRC_HASH_BUCKETS - 1)];
+
+	while (*curr != k)
+		curr = &mrc->keys[*curr].next;
+
+	*curr = mrc->keys[k].next;
+}
+
+static inline bool ocf_mrc_heap_less(struct ocf_mrc *mrc, uint32_t a,
+		uint32_t b)
+{
+	return mrc->keys[mrc->heap[a]].hash < mrc->keys[mrc->heap[b]].hash;
+}
+
+static inline void ocf_mrc_heap_swap(struct ocf_mrc *mrc, uint32_t a,
+		uint32_t b)
+{
+	uint32_t tmp = mrc->heap[a];
+
+	mrc->heap[a] = mrc->heap[b];
+	mrc->heap[b] = tmp;
+}
+
+/* Key k is already counted in nkeys */
+static void ocf_mrc_heap_push(struct ocf_mrc *mrc, uint32_t k)
+{
+	uint32_t i = mrc->nkeys - 1;
+
+	mrc->heap[i] = k;
+
+	while (i && ocf_mrc_heap_less(mrc, (i - 1) / 2, i)) {
+		ocf_mrc_heap_swap(mrc, (i - 1) / 2, i);
+		i = (i - 1) / 2;
+	}
+}
+
+static uint32_t ocf_mrc_heap_pop(struct ocf_mrc *mrc)
+{
+	uint32_t top = mrc->heap[0];
+	uint32_t i = 0, child;
+
+	mrc->heap[0] = mrc->heap[--mrc->nkeys];
+
+	while ((child = 2 * i + 1) < mrc->nkeys) {
+		if (child + 1 < mrc->nkeys &&
+				ocf_mrc_heap_less(mrc, child, child + 1)) {
+			child++;
+		}
+		if (!ocf_mrc_heap_less(mrc, i, child))
+			break;
+		ocf_mrc_heap_swap(mrc, i, child);
+		i = child;
+	}
+
+	return top;
+}
+
+static inline uint64_t ocf_mrc_scale(uint64_t value, uint64_t num,
+		uint64_t den)
+{
+	return value / den * num + value % den * num / den;
+}
+
+/*
+ * Lower sampling threshold to the highest sampled hash and forget that
+ * key. Histogram is rescaled to the new sampling rate. Returns index of
+ * freed key.
+ */
+static uint32_t ocf_mrc_drop_max(struct ocf_mrc *mrc)
+{
+	uint64_t old = mrc->threshold >> 32;
+	uint64_t new;
+	uint32_t k, i;
+
+	k = ocf_mrc_heap_pop(mrc);
+	mrc->threshold = mrc->keys[k].hash;
+
+	ocf_mrc_unlink(mrc, k);
+	ocf_mrc_fenwick_add(mrc, mrc->keys[k].time, -1);
+	mrc->slot_key[mrc->keys[k].time] = OCF_MRC_INVALID;
+
+	new = mrc->threshold >> 32;
+	if (!old || new == old)
+		return k;
+
+	for (i = 0; i < OCF_STATS_LAT_BUCKETS; i++)
+		mrc->hist[i] = ocf_mrc_scale(mrc->hist[i], new, old);
+	mrc->cold = ocf_mrc_scale(mrc->cold, new, old);
+
+	return k;
+}
+
+/* Renumber time slots of tracked keys to 0..nkeys-1, keeping order */
+static void ocf_mrc_compact(struct ocf_mrc *mrc)
+{
+	uint32_t s, t = 0, k;
+
+	for (s = 0; s < mrc->now; s++) {
+		k = mrc->slot_key[s];
+		if (k == OCF_MRC_INVALID)
+			continue;
+
+		mrc->slot_key[s] = OCF_MRC_INVALID;
+		mrc->slot_key[t] = k;
+		mrc->keys[k].time = t++;
+	}
+
+	ENV_BUG_ON(env_memset(mrc->fenwick, sizeof(mrc->fenwick), 0));
+	for (s = 0; s < t; s++)
+		ocf_mrc_fenwick_add(mrc, s, 1);
+
+	mrc->now = t;
+}
+
+/* Apply sampled access, caller holds estimator lock */
+static void ocf_mrc_apply(struct ocf_mrc *mrc, uint64_t hash)
+{
+	uint64_t distance, rate;
+	uint32_t k, t;
+
+	/* Threshold might have been lowered since access was buffered */
+	if (hash >= mrc->threshold)
+		return;
+
+	k = ocf_mrc_lookup(mrc, hash);
+	if (k != OCF_MRC_INVALID) {
+		t = mrc->keys[k].time;
+		distance = ocf_mrc_fenwick_sum(mrc, mrc->now - 1) -
+				ocf_mrc_fenwick_sum(mrc, t);
+
+		/* Scale sampled distance to core lines */
+		rate = OCF_MAX(mrc->threshold >> 32, 1);
+		distance = (distance << 32) / rate;
+		mrc->hist[_log_bucket(distance)] += MRC_ONE;
+
+		ocf_mrc_fenwick_add(mrc, t, -1);
+		mrc->slot_key[t] = OCF_MRC_INVALID;
+	} else {
+		if (mrc->nkeys == OCF_MRC_MAX_KEYS) {
+			k = ocf_mrc_drop_max(mrc);
+			if (hash >= mrc->threshold) {
+				mrc->free_key = k;
+				return;
+			}
+		} else if (mrc->free_key != OCF_MRC_INVALID) {
+			k = mrc->free_key;
+			mrc->free_key = OCF_MRC_INVALID;
+		} else {
+			k = mrc->nkeys;
+		}
+
+		mrc->cold += MRC_ONE;
+
+		mrc->keys[k].hash = hash;
+		ocf_mrc_link(mrc, k);
+		mrc->nkeys++;
+		ocf_mrc_heap_push(mrc, k);
+	}
+
+	if (mrc->now == OCF_MRC_TIME_SLOTS)
+		ocf_mrc_compact(mrc);
+
+	mrc->keys[k].time = mrc->now;
+	mrc->slot_key[mrc->now] = k;
+	ocf_mrc_fenwick_add(mrc, mrc->now, 1);
+	mrc->now++;
+}
+
+static void ocf_mrc_apply_batch(struct ocf_mrc *mrc, const uint64_t *hash,
+		uint32_t count)
+{
+	uint32_t i;
+
+	if (!count)
+		return;
+
+	env_spinlock_lock(&mrc->lock);
+	for (i = 0; i < count; i++)
+		ocf_mrc_apply(mrc, hash[i]);
+	env_spinlock_unlock(&mrc->lock);
+}
+
+/* Take accesses buffered in shard, returns their number */
+static uint32_t ocf_mrc_shard_take(struct ocf_mrc_shard *shard,
+		uint64_t hash[OCF_MRC_BATCH])
+{
+	uint32_t count = shard->count;
+
+	if (!count)
+		return 0;
+
+	ENV_BUG_ON(env_memcpy(hash, sizeof(shard->hash), shard->hash,
+			sizeof(shard->hash[0]) * count));
+	shard->count = 0;
+
+	return count;
+}
+
+static void ocf_mrc_access(struct ocf_mrc *mrc, uint64_t hash)
+{
+	struct ocf_mrc_shard *shard;
+	uint64_t batch[OCF_MRC_BATCH];
+	uint32_t count = 0;
+
+	if (hash >= mrc->threshold)
+		return;
+
+	shard = &mrc->shards[env_get_current_cpu() % OCF_MRC_SHARDS];
+
+	env_spinlock_lock(&shard->lock);
+	shard->hash[shard->count++] = hash;
+	if (shard->count == OCF_MRC_BATCH)
+		count = ocf_mrc_shard_take(shard, batch);
+	env_spinlock_unlock(&shard->lock);
+
+	ocf_mrc_apply_batch(mrc, batch, count);
+}
+
+/* Apply accesses buffered in all shards */
+static void ocf_mrc_flush(struct ocf_mrc *mrc)
+{
+	uint64_t batch[OCF_MRC_BATCH];
+	uint32_t i, count;
+
+	for (i = 0; i < OCF_MRC_SHARDS; i++) {
+		env_spinlock_lock(&mrc->shards[i].lock);
+		count = ocf_mrc_shard_take(&mrc->shards[i], batch);
+		env_spinlock_unlock(&mrc->shards[i].lock);
+
+		ocf_mrc_apply_batch(mrc, batch, count);
+	}
+}
+
+void ocf_mrc_req_access(struct ocf_request *req)
+{
+	struct ocf_mrc *core_mrc, *part_mrc;
+	ocf_core_id_t core_id;
+	uint64_t core_line, hash;
+
+	/* Traverse may be repeated for the same request */
+	if (req->mrc_accounted || req->info.internal)
+		return;
+	req->mrc_accounted = 1;
+
+	core_mrc = ocf_mrc_get(&req->core->mrc);
+	part_mrc = ocf_mrc_get(&req->cache->part_mrc[req->part_id]);
+	core_id = ocf_core_get_id(req->core);
+
+	for (core_line = req->core_line_first;
+			core_line <= req->core_line_last; core_line++) {
+		hash = ocf_freq_sketch_hash(core_id, core_line);
+
+		if (core_mrc)
+			ocf_mrc_access(core_mrc, hash);
+		if (part_mrc)
+			ocf_mrc_access(part_mrc, hash);
+	}
+}
+
+void ocf_core_mrc_deinit(ocf_core_t core)
+{
+	ocf_mrc_put(&core->mrc);
+}
+
+void ocf_cache_mrc_deinit(ocf_cache_t cache)
+{
+	int i;
+
+	for (i = 0; i < OCF_IO_CLASS_MAX; i++)
+		ocf_mrc_put(&cache->part_mrc[i]);
+}
+
+static void ocf_mrc_get_curve(struct ocf_mrc *mrc, uint64_t step,
+		struct ocf_stats_mrc *curve)
+{
+	uint64_t hist[OCF_STATS_LAT_BUCKETS];
+	uint64_t cold, threshold, total, misses;
+	uint64_t lo, hi, size, part;
+	uint32_t i, b;
+
+	ENV_BUG_ON(env_memset(curve, sizeof(*curve), 0));
+	curve->step = step;
+
+	if (!mrc)
+		return;
+
+	ocf_mrc_flush(mrc);
+
+	env_spinlock_lock(&mrc->lock);
+	ENV_BUG_ON(env_memcpy(hist, sizeof(hist), mrc->hist, sizeof(hist)));
+	cold = mrc->cold;
+	threshold = mrc->threshold;
+	env_spinlock_unlock(&mrc->lock);
+
+	total = cold;
+	for (b = 0; b < OCF_STATS_LAT_BUCKETS; b++)
+		total += hist[b];
+
+	curve->samples = total / MRC_ONE;
+	curve->sample_rate = ((threshold >> 32) * 1000000) >> 32;
+
+	if (!total)
+		return;
+
+	for (i = 0; i < OCF_STATS_MRC_POINTS; i++) {
+		size = (i + 1) * step;
+		misses = cold;
+
+		/* Accesses with reuse distance >= size miss, bucket
+		 * straddling size is interpolated linearly */
+		for (b = 0; b < OCF_STATS_LAT_BUCKETS; b++) {
+			lo = _log_bucket_value(b);
+			hi = b + 1 < OCF_STATS_LAT_BUCKETS ?
+					_log_bucket_value(b + 1) : lo + 1;
+
+			if (lo >= size) {
+				misses += hist[b];
+			} else if (hi > size) {
+				part = ((hi - size) << 10) / (hi - lo);
+				misses += ocf_mrc_scale(hist[b], part, 1024);
+			}
+		}
+
+		curve->miss_ratio[i] = _fraction(misses, total);
+	}
+}
+
+static uint64_t ocf_mrc_default_step(ocf_cache_t cache)
+{
+	uint64_t lines = ocf_metadata_get_cachelines_count(cache);
+
+	return OCF_MAX(2 * lines / OCF_STATS_MRC_POINTS, 1);
+}
+
+int ocf_stats_collect_mrc_core(ocf_core_t core, uint64_t step,
+		struct ocf_stats_mrc *mrc)
+{
+	ocf_cache_t cache;
+
+	OCF_CHECK_NULL(core);
+	OCF_CHECK_NULL(mrc);
+
+	cache = ocf_core_get_cache(core);
+
+	if (!step) {
+		if (!ocf_cache_is_device_attached(cache))
+			return -OCF_ERR_INVAL;
+		step = ocf_mrc_default_step(cache);
+	}
+
+	ocf_mrc_get_curve(core->mrc, step, mrc);
+
+	return 0;
+}
+
+int ocf_stats_collect_mrc_part(ocf_cache_t cache, ocf_part_id_t part_id,
+		uint64_t step, struct ocf_stats_mrc *mrc)
+{
+	OCF_CHECK_NULL(cache);
+	OCF_CHECK_NULL(mrc);
+
+	if (part_id >= OCF_IO_CLASS_MAX)
+		return -OCF_ERR_INVAL;
+
+	if (!step) {
+		if (!ocf_cache_is_device_attached(cache))
+			return -OCF_ERR_INVAL;
+		step = ocf_mrc_default_step(cache);
+	}
+
+	ocf_mrc_get_curve(cache->part_mrc[part_id], step, mrc);
+
+	return 0;
+}
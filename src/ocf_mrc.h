@@ -0,0 +1,89 @@
+/*
+ * Copyright(c) 2020 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __OCF_MRC_H__
+#define __OCF_MRC_H__
+
+#include "ocf/ocf.h"
+#include "ocf_request.h"
+
+/* Sampled core lines tracked at once by single estimator */
+#define OCF_MRC_MAX_KEYS 2048
+
+#define OCF_MRC_HASH_BUCKETS OCF_MRC_MAX_KEYS
+
+/* Reuse time slots, compacted when exhausted */
+#define OCF_MRC_TIME_SLOTS (2 * OCF_MRC_MAX_KEYS)
+
+#define OCF_MRC_INVALID ((uint32_t)~0)
+
+/* Shards of sampled access buffers, CPUs are mapped onto them */
+#define OCF_MRC_SHARDS 16
+
+/* Sampled accesses buffered in shard before applying to estimator */
+#define OCF_MRC_BATCH 64
+
+struct ocf_mrc_key {
+	uint64_t hash;
+	uint32_t time;
+	/* Next key in the hash bucket */
+	uint32_t next;
+};
+
+/*
+ * Sampled accesses from CPUs mapped to the shard, waiting to be applied
+ * to the estimator
+ */
+struct ocf_mrc_shard {
+	env_spinlock lock;
+	uint32_t count;
+	uint64_t hash[OCF_MRC_BATCH];
+};
+
+/*
+ * SHARDS miss ratio curve estimator with fixed memory. Core lines with
+ * hash below threshold are sampled; when more than OCF_MRC_MAX_KEYS are
+ * sampled, threshold is lowered to drop the key with highest hash.
+ * Reuse distance of sampled access is number of distinct sampled keys
+ * accessed since previous access to the same key, counted with Fenwick
+ * tree over last access times, and scaled by sampling rate. Sampled
+ * accesses are buffered per CPU shard and applied in batches under the
+ * estimator lock, reordering accesses within a batch only.
+ */
+struct ocf_mrc {
+	struct ocf_mrc_shard shards[OCF_MRC_SHARDS];
+
+	env_spinlock lock;
+
+	uint64_t threshold;
+	uint32_t nkeys;
+	uint32_t now;
+
+	/* Key freed by threshold change and not reused yet */
+	uint32_t free_key;
+
+	uint32_t buckets[OCF_MRC_HASH_BUCKETS];
+	struct ocf_mrc_key keys[OCF_MRC_MAX_KEYS];
+
+	/* Max heap of key indexes by hash */
+	uint32_t heap[OCF_MRC_MAX_KEYS];
+
+	/* Key last accessed at given time slot */
+	uint32_t slot_key[OCF_MRC_TIME_SLOTS];
+	int32_t fenwick[OCF_MRC_TIME_SLOTS + 1];
+
+	/* Reuse distance histogram (in cache lines) and cold misses,
+	 * in fixed point, rescaled whenever threshold goes down */
+	uint64_t hist[OCF_STATS_LAT_BUCKETS];
+	uint64_t cold;
+};
+
+void ocf_mrc_req_access(struct ocf_request *req);
+
+void ocf_core_mrc_deinit(ocf_core_t core);
+
+void ocf_cache_mrc_deinit(ocf_cache_t cache);
+
+#endif /* __OCF_MRC_H__ */
@@ -12,6 +12,7 @@
 #include "mngt/ocf_mngt_common.h"
 #include "engine/cache_engine.h"
 #include "ocf_def_priv.h"
+#include "ocf_trace_ring.h"
 
 int ocf_queue_create(ocf_cache_t cache, ocf_queue_t *queue,
 		const struct ocf_queue_ops *ops)
@@ -43,8 +44,22 @@ int ocf_queue_create(ocf_cache_t cache, ocf_queue_t *queue,
 	env_atomic_set(&tmp_queue->ref_count, 1);
 	tmp_queue->cache = cache;
 	tmp_queue->ops = ops;
+	tmp_queue->id = env_atomic_inc_return(&cache->queue_id_seq) - 1;
+
+	if (cache->trace.ring_entries) {
+		result = ocf_trace_ring_init(tmp_queue,
+				cache->trace.ring_entries);
+		if (result) {
+			ocf_mngt_cache_put(cache);
+			env_spinlock_destroy(&tmp_queue->io_list_lock);
+			env_free(tmp_queue);
+			return result;
+		}
+	}
 
+	env_spinlock_lock(&cache->io_queues_lock);
 	list_add(&tmp_queue->list, &cache->io_queues);
+	env_spinlock_unlock(&cache->io_queues_lock);
 
 	*queue = tmp_queue;
 
@@ -63,10 +78,13 @@ void ocf_queue_put(ocf_queue_t queue)
 	OCF_CHECK_NULL(queue);
 
 	if (env_atomic_dec_return(&queue->ref_count) == 0) {
+		env_spinlock_lock(&queue->cache->io_queues_lock);
 		list_del(&queue->list);
+		env_spinlock_unlock(&queue->cache->io_queues_lock);
 		queue->ops->stop(queue);
 		ocf_mngt_cache_put(queue->cache);
 		env_spinlock_destroy(&queue->io_list_lock);
+		ocf_trace_ring_deinit(queue);
 		env_free(queue);
 	}
 }
@@ -94,6 +112,10 @@ void ocf_queue_run_single(ocf_queue_t q)
 	if (!io_req)
 		return;
 
+	ocf_trace_ring_push(io_req, ocf_trace_rec_engine, io_req->rw,
+			io_req->byte_position, io_req->byte_length,
+			env_get_time_ns());
+
 	if (io_req->ioi.io.handle)
 		io_req->ioi.io.handle(&io_req->ioi.io, io_req);
 	else
@@ -11,6 +11,9 @@
 struct ocf_queue {
 	ocf_cache_t cache;
 
+	/* Index of the queue within its cache, used to pick per-queue shards */
+	uint32_t id;
+
 	env_atomic io_no;
 
 	env_atomic ref_count;
@@ -24,6 +27,12 @@ struct ocf_queue {
 	/* Tracing stop request */
 	env_atomic trace_stop;
 
+	/* Built-in trace ring */
+	struct ocf_trace_ring *trace_ring;
+
+	/* Trace ring producers reference counter */
+	env_atomic trace_ring_ref;
+
 	struct list_head list;
 
 	const struct ocf_queue_ops *ops;
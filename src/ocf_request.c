@@ -40,19 +40,29 @@ struct ocf_req_allocator {
 	size_t size[ocf_req_size_max];
 };
 
+/* Map entries are followed by the same number of cache line lock waiters */
 static inline size_t ocf_req_sizeof_map(struct ocf_request *req)
 {
 	uint32_t lines = req->core_line_count;
-	size_t size = (lines * sizeof(struct ocf_map_info));
+	size_t size = lines * (sizeof(struct ocf_map_info) +
+			sizeof(struct ocf_map_waiter));
 
 	ENV_BUG_ON(lines == 0);
 	return size;
 }
 
+static inline void ocf_req_set_map(struct ocf_request *req,
+		struct ocf_map_info *map)
+{
+	req->map = map;
+	req->waiters = (struct ocf_map_waiter *)(map + req->core_line_count);
+}
+
 static inline size_t ocf_req_sizeof(uint32_t lines)
 {
 	size_t size = sizeof(struct ocf_request) +
-			(lines * sizeof(struct ocf_map_info));
+			lines * (sizeof(struct ocf_map_info) +
+			sizeof(struct ocf_map_waiter));
 
 	ENV_BUG_ON(lines == 0);
 	return size;
@@ -176,8 +186,10 @@ struct ocf_request *ocf_req_new(ocf_queue_t queue, ocf_core_t core,
 	if (unlikely(!req))
 		return NULL;
 
-	if (allocator)
-		req->map = req->__map;
+	if (allocator) {
+		req->core_line_count = core_line_count;
+		ocf_req_set_map(req, req->__map);
+	}
 
 	OCF_DEBUG_TRACE(cache);
 
@@ -210,15 +222,19 @@ struct ocf_request *ocf_req_new(ocf_queue_t queue, ocf_core_t core,
 
 int ocf_req_alloc_map(struct ocf_request *req)
 {
+	struct ocf_map_info *map;
+
 	if (req->map)
 		return 0;
 
-	req->map = env_zalloc(ocf_req_sizeof_map(req), ENV_MEM_NOIO);
-	if (!req->map) {
+	map = env_zalloc(ocf_req_sizeof_map(req), ENV_MEM_NOIO);
+	if (!map) {
 		req->error = -OCF_ERR_NO_MEM;
 		return -OCF_ERR_NO_MEM;
 	}
 
+	ocf_req_set_map(req, map);
+
 	return 0;
 }
 
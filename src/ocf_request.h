@@ -47,6 +47,21 @@ struct ocf_req_info {
 	/**!< this is an internal request */
 };
 
+/**
+ * @brief Cache line lock waiter, one per map entry, allocated together
+ * with request map so waiting for cache line lock never allocates memory
+ */
+struct ocf_map_waiter {
+	struct list_head item;
+	/*!< Entry on cache line lock waiters list */
+
+	struct ocf_request *req;
+	/*!< Waiting request */
+
+	ocf_cache_line_t line;
+	/*!< Cache line waited for */
+};
+
 struct ocf_map_info {
 	ocf_cache_line_t hash;
 	/*!< target LBA & core id hash */
@@ -79,6 +94,9 @@ struct ocf_map_info {
 	uint16_t flush : 1;
 	/*!< This bit indicates if cache line need to be flushed */
 
+	uint16_t dirty : 1;
+	/*!< This bit indicates that cache line was dirty at lookup */
+
 	uint8_t start_flush;
 	/*!< If req need flush, contain first sector of range to flush */
 
@@ -118,6 +136,17 @@ struct ocf_request {
 	 * map left to be locked
 	 */
 
+	void (*lock_cb)(struct ocf_request *req);
+	/*!< Called once all cache lines request waits for are locked */
+
+	int lock_rw;
+	/*!< Access type of cache line locks request waits for */
+
+	env_atomic *global_reader;
+	/*!< Per CPU counter of global metadata lock the request took shared
+	 * access on, released on the same counter
+	 */
+
 	env_atomic req_remaining;
 	/*!< In case of IO this field indicates how many IO left to
 	 * accomplish IO
@@ -188,6 +217,9 @@ struct ocf_request {
 	uint8_t seq_cutoff : 1;
 	/*!< Sequential cut off set for this request */
 
+	uint8_t mrc_accounted : 1;
+	/*!< Request accounted in miss ratio curve estimators */
+
 	/*========== [Orthus FLAG BEGIN] ==========*/
 
 	/**
@@ -195,6 +227,12 @@ struct ocf_request {
 	 */
 	bool data_admit_allowed;
 
+	/**
+	 * @brief Multi-factor data_admit is in trickle (partial) mode,
+	 * only frequently accessed lines should be promoted
+	 */
+	bool data_admit_trickle;
+
 	/**
 	 * @brief Multi-factor load_admit allowed flag
 	 */
@@ -208,6 +246,12 @@ struct ocf_request {
 	uint64_t timestamp;
 	/*!< Tracing timestamp */
 
+	uint64_t lat_start;
+	/*!< Start time (ns) of currently measured latency path */
+
+	uint8_t lat_path;
+	/*!< Currently measured latency path (ocf_lat_path_t) */
+
 	ocf_queue_t io_queue;
 	/*!< I/O queue handle for which request should be submitted */
 
@@ -224,6 +268,9 @@ struct ocf_request {
 
 	struct ocf_map_info *map;
 
+	struct ocf_map_waiter *waiters;
+	/*!< Cache line lock waiters, placed right after map entries */
+
 	struct ocf_map_info __map[];
 };
 
@@ -5,6 +5,7 @@
 
 #include "ocf_seq_cutoff.h"
 #include "ocf_cache_priv.h"
+#include "ocf_queue_priv.h"
 #include "ocf_priv.h"
 #include "ocf/ocf_debug.h"
 #include "utils/utils_cache_line.h"
@@ -22,70 +23,233 @@ static inline bool ocf_seq_cutoff_is_on(ocf_cache_t cache,
 				SEQ_CUTOFF_FULL_MARGIN + req->core_line_count);
 }
 
-static int ocf_seq_cutoff_stream_cmp(struct ocf_rb_node *n1,
-		struct ocf_rb_node *n2)
+static inline uint32_t ocf_seq_cutoff_hash(uint64_t last, int rw)
 {
-	struct ocf_seq_cutoff_stream *stream1 = container_of(n1,
-			struct ocf_seq_cutoff_stream, node);
-	struct ocf_seq_cutoff_stream *stream2 = container_of(n2,
-			struct ocf_seq_cutoff_stream, node);
+	uint64_t key = (last >> ENV_SECTOR_SHIFT) ^ ((uint64_t)rw << 63);
 
-	if (stream1->rw < stream2->rw)
-		return -1;
+	return (key * 0x9E3779B97F4A7C15ULL) >> (64 - OCF_SEQ_CUTOFF_HASH_BITS);
+}
 
-	if (stream1->rw > stream2->rw)
-		return 1;
+static inline uint16_t ocf_seq_cutoff_stream_idx(
+		struct ocf_seq_cutoff_shard *shard,
+		struct ocf_seq_cutoff_stream *stream)
+{
+	return stream - shard->streams;
+}
 
-	if (stream1->last < stream2->last)
-		return -1;
+static struct ocf_seq_cutoff_stream *ocf_seq_cutoff_shard_find(
+		struct ocf_seq_cutoff_shard *shard, uint64_t last, int rw)
+{
+	struct ocf_seq_cutoff_stream *stream;
+	uint16_t idx = shard->buckets[ocf_seq_cutoff_hash(last, rw)];
+	int i;
 
-	if (stream1->last > stream2->last)
-		return 1;
+	/* Bounded walk - shard may be peeked at without holding its lock */
+	for (i = 0; i < OCF_SEQ_CUTOFF_MAX_STREAMS; i++) {
+		if (idx >= OCF_SEQ_CUTOFF_MAX_STREAMS)
+			return NULL;
+
+		stream = &shard->streams[idx];
+		if (stream->last == last && stream->rw == rw)
+			return stream;
 
-	return 0;
+		idx = stream->next;
+	}
+
+	return NULL;
 }
 
-void ocf_core_seq_cutoff_init(ocf_core_t core)
+static void ocf_seq_cutoff_shard_unlink(struct ocf_seq_cutoff_shard *shard,
+		struct ocf_seq_cutoff_stream *stream)
+{
+	uint16_t *idx = &shard->buckets[ocf_seq_cutoff_hash(stream->last,
+			stream->rw)];
+	uint16_t stream_idx = ocf_seq_cutoff_stream_idx(shard, stream);
+
+	if (!stream->valid)
+		return;
+
+	while (*idx != OCF_SEQ_CUTOFF_STREAM_INVALID) {
+		if (*idx == stream_idx) {
+			*idx = stream->next;
+			break;
+		}
+		idx = &shard->streams[*idx].next;
+	}
+
+	stream->next = OCF_SEQ_CUTOFF_STREAM_INVALID;
+	stream->valid = false;
+}
+
+static void ocf_seq_cutoff_shard_link(struct ocf_seq_cutoff_shard *shard,
+		struct ocf_seq_cutoff_stream *stream)
+{
+	uint16_t *head = &shard->buckets[ocf_seq_cutoff_hash(stream->last,
+			stream->rw)];
+
+	stream->next = *head;
+	*head = ocf_seq_cutoff_stream_idx(shard, stream);
+	stream->valid = true;
+}
+
+static void ocf_seq_cutoff_shard_init(struct ocf_seq_cutoff_shard *shard)
 {
 	struct ocf_seq_cutoff_stream *stream;
 	int i;
 
-	ocf_core_log(core, log_info, "Seqential cutoff init\n");
-	env_rwlock_init(&core->seq_cutoff.lock);
-	ocf_rb_tree_init(&core->seq_cutoff.tree, ocf_seq_cutoff_stream_cmp);
-	INIT_LIST_HEAD(&core->seq_cutoff.lru);
+	env_rwlock_init(&shard->lock);
+	INIT_LIST_HEAD(&shard->lru);
+
+	for (i = 0; i < OCF_SEQ_CUTOFF_HASH_BUCKETS; i++)
+		shard->buckets[i] = OCF_SEQ_CUTOFF_STREAM_INVALID;
 
 	for (i = 0; i < OCF_SEQ_CUTOFF_MAX_STREAMS; i++) {
-		stream = &core->seq_cutoff.streams[i];
+		stream = &shard->streams[i];
 		stream->last = 0;
 		stream->bytes = 0;
 		stream->rw = 0;
-		ocf_rb_tree_insert(&core->seq_cutoff.tree, &stream->node);
-		list_add_tail(&stream->list, &core->seq_cutoff.lru);
+		stream->valid = false;
+		stream->next = OCF_SEQ_CUTOFF_STREAM_INVALID;
+		list_add_tail(&stream->list, &shard->lru);
+	}
+}
+
+static inline unsigned ocf_seq_cutoff_shard_id(struct ocf_request *req)
+{
+	return req->io_queue->id % OCF_SEQ_CUTOFF_SHARDS;
+}
+
+static struct ocf_seq_cutoff_shard *ocf_seq_cutoff_get_shard(ocf_core_t core,
+		unsigned id)
+{
+	struct ocf_seq_cutoff_shard *shard, *old;
+
+	shard = core->seq_cutoff.shards[id];
+	if (likely(shard))
+		return shard;
+
+	shard = env_vmalloc_flags(sizeof(*shard), ENV_MEM_NOIO);
+	if (!shard)
+		return NULL;
+
+	ocf_seq_cutoff_shard_init(shard);
+
+	old = __sync_val_compare_and_swap(&core->seq_cutoff.shards[id],
+			NULL, shard);
+	if (old) {
+		env_rwlock_destroy(&shard->lock);
+		env_vfree(shard);
+		return old;
+	}
+
+	return shard;
+}
+
+void ocf_core_seq_cutoff_init(ocf_core_t core)
+{
+	ocf_core_log(core, log_info, "Seqential cutoff init\n");
+
+	ocf_core_seq_cutoff_deinit(core);
+	core->seq_cutoff.core = core;
+}
+
+void ocf_core_seq_cutoff_deinit(ocf_core_t core)
+{
+	struct ocf_seq_cutoff_shard *shard;
+	int i;
+
+	for (i = 0; i < OCF_SEQ_CUTOFF_SHARDS; i++) {
+		shard = core->seq_cutoff.shards[i];
+		if (!shard)
+			continue;
+
+		env_rwlock_destroy(&shard->lock);
+		env_vfree(shard);
+		core->seq_cutoff.shards[i] = NULL;
 	}
 }
 
 void ocf_dbg_get_seq_cutoff_status(ocf_core_t core,
 		struct ocf_dbg_seq_cutoff_status *status)
 {
+	struct ocf_seq_cutoff_shard *shard;
 	struct ocf_seq_cutoff_stream *stream;
 	uint32_t threshold;
-	int i = 0;
+	int i = 0, j;
 
 	OCF_CHECK_NULL(core);
 	OCF_CHECK_NULL(status);
 
 	threshold = ocf_core_get_seq_cutoff_threshold(core);
 
-	env_rwlock_read_lock(&core->seq_cutoff.lock);
-	list_for_each_entry(stream, &core->seq_cutoff.lru, list) {
-		status->streams[i].last = stream->last;
-		status->streams[i].bytes = stream->bytes;
-		status->streams[i].rw = stream->rw;
-		status->streams[i].active = (stream->bytes >= threshold);
-		i++;
+	ENV_BUG_ON(env_memset(status, sizeof(*status), 0));
+
+	for (j = 0; j < OCF_SEQ_CUTOFF_SHARDS; j++) {
+		shard = core->seq_cutoff.shards[j];
+		if (!shard)
+			continue;
+
+		env_rwlock_read_lock(&shard->lock);
+		list_for_each_entry(stream, &shard->lru, list) {
+			if (!stream->valid)
+				continue;
+			if (i == OCF_SEQ_CUTOFF_MAX_STREAMS)
+				break;
+			status->streams[i].last = stream->last;
+			status->streams[i].bytes = stream->bytes;
+			status->streams[i].rw = stream->rw;
+			status->streams[i].active = (stream->bytes >= threshold);
+			i++;
+		}
+		env_rwlock_read_unlock(&shard->lock);
 	}
-	env_rwlock_read_unlock(&core->seq_cutoff.lock);
+}
+
+/*
+ * Look for a stream which started in a shard of another IO queue. Shards are
+ * peeked at without lock first, so that IO not continuing any stream doesn't
+ * touch locks of other queues. If take is set, the stream is removed from
+ * the foreign shard so that it can be continued in the shard of the caller.
+ */
+static bool ocf_seq_cutoff_find_foreign(ocf_core_t core, unsigned own_id,
+		uint64_t last, int rw, bool take, uint64_t *bytes)
+{
+	struct ocf_seq_cutoff_shard *shard;
+	struct ocf_seq_cutoff_stream *stream;
+	int i;
+
+	for (i = 0; i < OCF_SEQ_CUTOFF_SHARDS; i++) {
+		shard = core->seq_cutoff.shards[i];
+		if (i == own_id || !shard)
+			continue;
+
+		if (!ocf_seq_cutoff_shard_find(shard, last, rw))
+			continue;
+
+		if (take)
+			env_rwlock_write_lock(&shard->lock);
+		else
+			env_rwlock_read_lock(&shard->lock);
+
+		stream = ocf_seq_cutoff_shard_find(shard, last, rw);
+		if (stream) {
+			*bytes = stream->bytes;
+			if (take) {
+				ocf_seq_cutoff_shard_unlink(shard, stream);
+				list_move(&stream->list, &shard->lru);
+			}
+		}
+
+		if (take)
+			env_rwlock_write_unlock(&shard->lock);
+		else
+			env_rwlock_read_unlock(&shard->lock);
+
+		if (stream)
+			return true;
+	}
+
+	return false;
 }
 
 bool ocf_core_seq_cutoff_check(ocf_core_t core, struct ocf_request *req)
@@ -93,12 +257,11 @@ bool ocf_core_seq_cutoff_check(ocf_core_t core, struct ocf_request *req)
 	ocf_seq_cutoff_policy policy = ocf_core_get_seq_cutoff_policy(core);
 	uint32_t threshold = ocf_core_get_seq_cutoff_threshold(core);
 	ocf_cache_t cache = ocf_core_get_cache(core);
-	struct ocf_seq_cutoff_stream item = {
-		.last = req->byte_position, .rw = req->rw
-	};
+	unsigned id = ocf_seq_cutoff_shard_id(req);
+	struct ocf_seq_cutoff_shard *shard;
 	struct ocf_seq_cutoff_stream *stream;
-	struct ocf_rb_node *node;
-	bool result = false;
+	uint64_t bytes = 0;
+	bool found = false;
 
 	switch (policy) {
 		case ocf_seq_cutoff_policy_always:
@@ -115,55 +278,67 @@ bool ocf_core_seq_cutoff_check(ocf_core_t core, struct ocf_request *req)
 			return false;
 	}
 
-	env_rwlock_read_lock(&core->seq_cutoff.lock);
-	node = ocf_rb_tree_find(&core->seq_cutoff.tree, &item.node);
-	if (node) {
-		stream = container_of(node, struct ocf_seq_cutoff_stream, node);
-		if (stream->bytes + req->byte_length >= threshold)
-			result = true;
+	shard = core->seq_cutoff.shards[id];
+	if (shard) {
+		env_rwlock_read_lock(&shard->lock);
+		stream = ocf_seq_cutoff_shard_find(shard, req->byte_position,
+				req->rw);
+		if (stream) {
+			bytes = stream->bytes;
+			found = true;
+		}
+		env_rwlock_read_unlock(&shard->lock);
+	}
+
+	if (!found) {
+		found = ocf_seq_cutoff_find_foreign(core, id,
+				req->byte_position, req->rw, false, &bytes);
 	}
-	env_rwlock_read_unlock(&core->seq_cutoff.lock);
 
-	return result;
+	return found && (bytes + req->byte_length >= threshold);
 }
 
 void ocf_core_seq_cutoff_update(ocf_core_t core, struct ocf_request *req)
 {
 	ocf_seq_cutoff_policy policy = ocf_core_get_seq_cutoff_policy(core);
-	struct ocf_seq_cutoff_stream item = {
-		.last = req->byte_position, .rw = req->rw
-	};
+	unsigned id = ocf_seq_cutoff_shard_id(req);
+	struct ocf_seq_cutoff_shard *shard;
 	struct ocf_seq_cutoff_stream *stream;
-	struct ocf_rb_node *node;
-	bool can_update;
+	uint64_t bytes = 0;
 
 	if (policy == ocf_seq_cutoff_policy_never)
 		return;
 
+	shard = ocf_seq_cutoff_get_shard(core, id);
+	if (unlikely(!shard))
+		return;
+
 	/* Update last accessed position and bytes counter */
-	env_rwlock_write_lock(&core->seq_cutoff.lock);
-	node = ocf_rb_tree_find(&core->seq_cutoff.tree, &item.node);
-	if (node) {
-		stream = container_of(node, struct ocf_seq_cutoff_stream, node);
-		item.last = req->byte_position + req->byte_length;
-		can_update = ocf_rb_tree_can_update(&core->seq_cutoff.tree,
-				node, &item.node);
+	env_rwlock_write_lock(&shard->lock);
+	stream = ocf_seq_cutoff_shard_find(shard, req->byte_position, req->rw);
+	if (stream) {
+		ocf_seq_cutoff_shard_unlink(shard, stream);
 		stream->last = req->byte_position + req->byte_length;
 		stream->bytes += req->byte_length;
-		if (!can_update) {
-			ocf_rb_tree_remove(&core->seq_cutoff.tree, node);
-			ocf_rb_tree_insert(&core->seq_cutoff.tree, node);
-		}
-		list_move_tail(&stream->list, &core->seq_cutoff.lru);
-	} else {
-		stream = list_first_entry(&core->seq_cutoff.lru,
-				struct ocf_seq_cutoff_stream, list);
-		ocf_rb_tree_remove(&core->seq_cutoff.tree, &stream->node);
-		stream->rw = req->rw;
-		stream->last = req->byte_position + req->byte_length;
-		stream->bytes = req->byte_length;
-		ocf_rb_tree_insert(&core->seq_cutoff.tree, &stream->node);
-		list_move_tail(&stream->list, &core->seq_cutoff.lru);
+		ocf_seq_cutoff_shard_link(shard, stream);
+		list_move_tail(&stream->list, &shard->lru);
+		env_rwlock_write_unlock(&shard->lock);
+		return;
 	}
-	env_rwlock_write_unlock(&core->seq_cutoff.lock);
+	env_rwlock_write_unlock(&shard->lock);
+
+	/* Stream might have been started by IO from another queue */
+	ocf_seq_cutoff_find_foreign(core, id, req->byte_position, req->rw,
+			true, &bytes);
+
+	env_rwlock_write_lock(&shard->lock);
+	stream = list_first_entry(&shard->lru, struct ocf_seq_cutoff_stream,
+			list);
+	ocf_seq_cutoff_shard_unlink(shard, stream);
+	stream->rw = req->rw;
+	stream->last = req->byte_position + req->byte_length;
+	stream->bytes = bytes + req->byte_length;
+	ocf_seq_cutoff_shard_link(shard, stream);
+	list_move_tail(&stream->list, &shard->lru);
+	env_rwlock_write_unlock(&shard->lock);
 }
@@ -8,26 +8,46 @@
 
 #include "ocf/ocf.h"
 #include "ocf_request.h"
-#include "utils/utils_rbtree.h"
+
+/* Number of stream tables per core, IO queues are mapped onto them */
+#define OCF_SEQ_CUTOFF_SHARDS 16
+
+#define OCF_SEQ_CUTOFF_HASH_BITS 9
+#define OCF_SEQ_CUTOFF_HASH_BUCKETS (1 << OCF_SEQ_CUTOFF_HASH_BITS)
+
+#define OCF_SEQ_CUTOFF_STREAM_INVALID ((uint16_t)~0)
 
 struct ocf_seq_cutoff_stream {
 	uint64_t last;
 	uint64_t bytes;
 	uint32_t rw : 1;
-	struct ocf_rb_node node;
+	uint32_t valid : 1;
+	/* Next stream in the hash bucket */
+	uint16_t next;
 	struct list_head list;
 };
 
-struct ocf_seq_cutoff {
-	ocf_core_t core;
+/*
+ * Stream table owned (written) mostly by a single IO queue. Streams are
+ * looked up by their next expected position in a small hash table.
+ */
+struct ocf_seq_cutoff_shard {
 	env_rwlock lock;
+	uint16_t buckets[OCF_SEQ_CUTOFF_HASH_BUCKETS];
 	struct ocf_seq_cutoff_stream streams[OCF_SEQ_CUTOFF_MAX_STREAMS];
-	struct ocf_rb_tree tree;
 	struct list_head lru;
 };
 
+struct ocf_seq_cutoff {
+	ocf_core_t core;
+	/* Allocated on first IO from the queue mapped onto given shard */
+	struct ocf_seq_cutoff_shard *shards[OCF_SEQ_CUTOFF_SHARDS];
+};
+
 void ocf_core_seq_cutoff_init(ocf_core_t core);
 
+void ocf_core_seq_cutoff_deinit(ocf_core_t core);
+
 bool ocf_core_seq_cutoff_check(ocf_core_t core, struct ocf_request *req);
 
 void ocf_core_seq_cutoff_update(ocf_core_t core, struct ocf_request *req);
@@ -9,6 +9,23 @@
 #include "engine/cache_engine.h"
 #include "utils/utils_part.h"
 #include "utils/utils_cache_line.h"
+#include "utils/utils_stats.h"
+
+/* Shard of core counters updated from current CPU */
+static inline struct ocf_counters_core_shard *ocf_core_stats_shard(
+		ocf_core_t core)
+{
+	return &core->counters->shards[env_get_current_cpu() %
+			OCF_STATS_SHARDS];
+}
+
+static void ocf_stats_latency_init(struct ocf_counters_latency *counters)
+{
+	int i;
+
+	for (i = 0; i < OCF_STATS_LAT_BUCKETS; i++)
+		env_atomic64_set(&counters->buckets[i], 0);
+}
 
 #ifdef OCF_DEBUG_STATS
 static void ocf_stats_debug_init(struct ocf_counters_debug *stats)
@@ -33,6 +50,7 @@ static void ocf_stats_req_init(struct ocf_counters_req *stats)
 	env_atomic64_set(&stats->partial_miss, 0);
 	env_atomic64_set(&stats->total, 0);
 	env_atomic64_set(&stats->pass_through, 0);
+	env_atomic64_set(&stats->dirty_hit, 0);
 }
 
 static void ocf_stats_block_init(struct ocf_counters_block *stats)
@@ -76,7 +94,7 @@ void ocf_core_stats_vol_block_update(ocf_core_t core, ocf_part_id_t part_id,
 		int dir, uint64_t bytes)
 {
 	struct ocf_counters_block *counters =
-		&core->counters->part_counters[part_id].blocks;
+		&ocf_core_stats_shard(core)->part_counters[part_id].blocks;
 
 	_ocf_stats_block_update(counters, dir, bytes);
 }
@@ -85,7 +103,7 @@ void ocf_core_stats_cache_block_update(ocf_core_t core, ocf_part_id_t part_id,
 		int dir, uint64_t bytes)
 {
 	struct ocf_counters_block *counters =
-		&core->counters->part_counters[part_id].cache_blocks;
+		&ocf_core_stats_shard(core)->part_counters[part_id].cache_blocks;
 
 	_ocf_stats_block_update(counters, dir, bytes);
 }
@@ -94,7 +112,7 @@ void ocf_core_stats_core_block_update(ocf_core_t core, ocf_part_id_t part_id,
 		int dir, uint64_t bytes)
 {
 	struct ocf_counters_block *counters =
-		&core->counters->part_counters[part_id].core_blocks;
+		&ocf_core_stats_shard(core)->part_counters[part_id].core_blocks;
 
 	_ocf_stats_block_update(counters, dir, bytes);
 }
@@ -102,14 +120,16 @@ void ocf_core_stats_core_block_update(ocf_core_t core, ocf_part_id_t part_id,
 void ocf_core_stats_request_update(ocf_core_t core, ocf_part_id_t part_id,
 		uint8_t dir, uint64_t hit_no, uint64_t core_line_count)
 {
+	struct ocf_counters_part *part =
+			&ocf_core_stats_shard(core)->part_counters[part_id];
 	struct ocf_counters_req *counters;
 
 	switch (dir) {
 		case OCF_READ:
-			counters = &core->counters->part_counters[part_id].read_reqs;
+			counters = &part->read_reqs;
 			break;
 		case OCF_WRITE:
-			counters = &core->counters->part_counters[part_id].write_reqs;
+			counters = &part->write_reqs;
 			break;
 		default:
 			ENV_BUG();
@@ -126,14 +146,16 @@ void ocf_core_stats_request_update(ocf_core_t core, ocf_part_id_t part_id,
 void ocf_core_stats_request_pt_update(ocf_core_t core, ocf_part_id_t part_id,
 		uint8_t dir, uint64_t hit_no, uint64_t core_line_count)
 {
+	struct ocf_counters_part *part =
+			&ocf_core_stats_shard(core)->part_counters[part_id];
 	struct ocf_counters_req *counters;
 
 	switch (dir) {
 		case OCF_READ:
-			counters = &core->counters->part_counters[part_id].read_reqs;
+			counters = &part->read_reqs;
 			break;
 		case OCF_WRITE:
-			counters = &core->counters->part_counters[part_id].write_reqs;
+			counters = &part->write_reqs;
 			break;
 		default:
 			ENV_BUG();
@@ -142,6 +164,24 @@ void ocf_core_stats_request_pt_update(ocf_core_t core, ocf_part_id_t part_id,
 	env_atomic64_inc(&counters->pass_through);
 }
 
+void ocf_core_stats_request_dirty_hit_update(ocf_core_t core,
+		ocf_part_id_t part_id, uint8_t dir)
+{
+	struct ocf_counters_part *part =
+			&ocf_core_stats_shard(core)->part_counters[part_id];
+
+	switch (dir) {
+		case OCF_READ:
+			env_atomic64_inc(&part->read_reqs.dirty_hit);
+			break;
+		case OCF_WRITE:
+			env_atomic64_inc(&part->write_reqs.dirty_hit);
+			break;
+		default:
+			ENV_BUG();
+	}
+}
+
 static void _ocf_core_stats_error_update(struct ocf_counters_error *counters,
 		uint8_t dir)
 {
@@ -157,16 +197,34 @@ static void _ocf_core_stats_error_update(struct ocf_counters_error *counters,
 	}
 }
 
+static uint32_t ocf_stats_latency_bucket(uint64_t ns)
+{
+	return _log_bucket(ns);
+}
+
+void ocf_core_stats_latency_update(ocf_core_t core, ocf_part_id_t part_id,
+		ocf_lat_path_t path, uint64_t ns)
+{
+	struct ocf_counters_latency *counters;
+
+	ENV_BUG_ON(path >= ocf_lat_path_max);
+
+	counters = &core->counters->latency[part_id][path];
+	env_atomic64_inc(&counters->buckets[ocf_stats_latency_bucket(ns)]);
+}
+
 void ocf_core_stats_core_error_update(ocf_core_t core, uint8_t dir)
 {
-	struct ocf_counters_error *counters = &core->counters->core_errors;
+	struct ocf_counters_error *counters =
+			&ocf_core_stats_shard(core)->core_errors;
 
 	_ocf_core_stats_error_update(counters, dir);
 }
 
 void ocf_core_stats_cache_error_update(ocf_core_t core, uint8_t dir)
 {
-	struct ocf_counters_error *counters = &core->counters->cache_errors;
+	struct ocf_counters_error *counters =
+			&ocf_core_stats_shard(core)->cache_errors;
 
 	_ocf_core_stats_error_update(counters, dir);
 }
@@ -185,22 +243,29 @@ void ocf_core_stats_cache_error_update(ocf_core_t core, uint8_t dir)
  *********************************************************************/
 void ocf_core_stats_initialize(ocf_core_t core)
 {
-	struct ocf_counters_core *exp_obj_stats;
-	int i;
+	struct ocf_counters_core_shard *exp_obj_stats;
+	int i, j;
 
 	OCF_CHECK_NULL(core);
 
-	exp_obj_stats = core->counters;
+	for (j = 0; j < OCF_STATS_SHARDS; j++) {
+		exp_obj_stats = &core->counters->shards[j];
 
-	ocf_stats_error_init(&exp_obj_stats->cache_errors);
-	ocf_stats_error_init(&exp_obj_stats->core_errors);
+		ocf_stats_error_init(&exp_obj_stats->cache_errors);
+		ocf_stats_error_init(&exp_obj_stats->core_errors);
 
-	for (i = 0; i != OCF_IO_CLASS_MAX; i++)
-		ocf_stats_part_init(&exp_obj_stats->part_counters[i]);
+		for (i = 0; i != OCF_IO_CLASS_MAX; i++)
+			ocf_stats_part_init(&exp_obj_stats->part_counters[i]);
 
 #ifdef OCF_DEBUG_STATS
-	ocf_stats_debug_init(&exp_obj_stats->debug_stats);
+		ocf_stats_debug_init(&exp_obj_stats->debug_stats);
 #endif
+	}
+
+	for (i = 0; i != OCF_IO_CLASS_MAX; i++) {
+		for (j = 0; j < ocf_lat_path_max; j++)
+			ocf_stats_latency_init(&core->counters->latency[i][j]);
+	}
 }
 
 void ocf_core_stats_initialize_all(ocf_cache_t cache)
@@ -215,15 +280,6 @@ void ocf_core_stats_initialize_all(ocf_cache_t cache)
 	}
 }
 
-static void copy_req_stats(struct ocf_stats_req *dest,
-		const struct ocf_counters_req *from)
-{
-	dest->partial_miss = env_atomic64_read(&from->partial_miss);
-	dest->full_miss = env_atomic64_read(&from->full_miss);
-	dest->total = env_atomic64_read(&from->total);
-	dest->pass_through = env_atomic64_read(&from->pass_through);
-}
-
 static void accum_req_stats(struct ocf_stats_req *dest,
 		const struct ocf_counters_req *from)
 {
@@ -231,13 +287,7 @@ static void accum_req_stats(struct ocf_stats_req *dest,
 	dest->full_miss += env_atomic64_read(&from->full_miss);
 	dest->total += env_atomic64_read(&from->total);
 	dest->pass_through += env_atomic64_read(&from->pass_through);
-}
-
-static void copy_block_stats(struct ocf_stats_block *dest,
-		const struct ocf_counters_block *from)
-{
-	dest->read = env_atomic64_read(&from->read_bytes);
-	dest->write = env_atomic64_read(&from->write_bytes);
+	dest->dirty_hit += env_atomic64_read(&from->dirty_hit);
 }
 
 static void accum_block_stats(struct ocf_stats_block *dest,
@@ -247,27 +297,27 @@ static void accum_block_stats(struct ocf_stats_block *dest,
 	dest->write += env_atomic64_read(&from->write_bytes);
 }
 
-static void copy_error_stats(struct ocf_stats_error *dest,
+static void accum_error_stats(struct ocf_stats_error *dest,
 		const struct ocf_counters_error *from)
 {
-	dest->read = env_atomic_read(&from->read);
-	dest->write = env_atomic_read(&from->write);
+	dest->read += env_atomic_read(&from->read);
+	dest->write += env_atomic_read(&from->write);
 }
 
 #ifdef OCF_DEBUG_STATS
-static void copy_debug_stats(struct ocf_stats_core_debug *dest,
+static void accum_debug_stats(struct ocf_stats_core_debug *dest,
 		const struct ocf_counters_debug *from)
 {
 	int i;
 
 	for (i = 0; i < IO_PACKET_NO; i++) {
-		dest->read_size[i] = env_atomic64_read(&from->read_size[i]);
-		dest->write_size[i] = env_atomic64_read(&from->write_size[i]);
+		dest->read_size[i] += env_atomic64_read(&from->read_size[i]);
+		dest->write_size[i] += env_atomic64_read(&from->write_size[i]);
 	}
 
 	for (i = 0; i < IO_ALIGN_NO; i++) {
-		dest->read_align[i] = env_atomic64_read(&from->read_align[i]);
-		dest->write_align[i] = env_atomic64_read(&from->write_align[i]);
+		dest->read_align[i] += env_atomic64_read(&from->read_align[i]);
+		dest->write_align[i] += env_atomic64_read(&from->write_align[i]);
 	}
 }
 #endif
@@ -280,6 +330,7 @@ int ocf_core_io_class_get_stats(ocf_core_t core, ocf_part_id_t part_id,
 	struct ocf_counters_part *part_stat;
 	ocf_core_t i_core;
 	ocf_core_id_t i_core_id;
+	int i;
 
 	OCF_CHECK_NULL(core);
 	OCF_CHECK_NULL(stats);
@@ -297,8 +348,6 @@ int ocf_core_io_class_get_stats(ocf_core_t core, ocf_part_id_t part_id,
 				&i_core->runtime_meta->cached_clines);
 	}
 
-	part_stat = &core->counters->part_counters[part_id];
-
 	stats->occupancy_clines = env_atomic_read(&core->runtime_meta->
 			part_counters[part_id].cached_clines);
 	stats->dirty_clines = env_atomic_read(&core->runtime_meta->
@@ -307,20 +356,34 @@ int ocf_core_io_class_get_stats(ocf_core_t core, ocf_part_id_t part_id,
 	stats->free_clines = cache->conf_meta->cachelines -
 			cache_occupancy_total;
 
-	copy_req_stats(&stats->read_reqs, &part_stat->read_reqs);
-	copy_req_stats(&stats->write_reqs, &part_stat->write_reqs);
-
-	copy_block_stats(&stats->blocks, &part_stat->blocks);
-	copy_block_stats(&stats->cache_blocks, &part_stat->cache_blocks);
-	copy_block_stats(&stats->core_blocks, &part_stat->core_blocks);
+	ENV_BUG_ON(env_memset(&stats->read_reqs, sizeof(stats->read_reqs), 0));
+	ENV_BUG_ON(env_memset(&stats->write_reqs, sizeof(stats->write_reqs), 0));
+	ENV_BUG_ON(env_memset(&stats->blocks, sizeof(stats->blocks), 0));
+	ENV_BUG_ON(env_memset(&stats->cache_blocks,
+			sizeof(stats->cache_blocks), 0));
+	ENV_BUG_ON(env_memset(&stats->core_blocks,
+			sizeof(stats->core_blocks), 0));
+
+	for (i = 0; i < OCF_STATS_SHARDS; i++) {
+		part_stat = &core->counters->shards[i].part_counters[part_id];
+
+		accum_req_stats(&stats->read_reqs, &part_stat->read_reqs);
+		accum_req_stats(&stats->write_reqs, &part_stat->write_reqs);
+
+		accum_block_stats(&stats->blocks, &part_stat->blocks);
+		accum_block_stats(&stats->cache_blocks,
+				&part_stat->cache_blocks);
+		accum_block_stats(&stats->core_blocks,
+				&part_stat->core_blocks);
+	}
 
 	return 0;
 }
 
 int ocf_core_get_stats(ocf_core_t core, struct ocf_stats_core *stats)
 {
-	uint32_t i;
-	struct ocf_counters_core *core_stats = NULL;
+	uint32_t i, j;
+	struct ocf_counters_core_shard *core_stats = NULL;
 	struct ocf_counters_part *curr = NULL;
 
 	OCF_CHECK_NULL(core);
@@ -328,32 +391,38 @@ int ocf_core_get_stats(ocf_core_t core, struct ocf_stats_core *stats)
 	if (!stats)
 		return -OCF_ERR_INVAL;
 
-	core_stats = core->counters;
-
 	ENV_BUG_ON(env_memset(stats, sizeof(*stats), 0));
 
-	copy_error_stats(&stats->core_errors,
-			&core_stats->core_errors);
-	copy_error_stats(&stats->cache_errors,
-			&core_stats->cache_errors);
+	for (j = 0; j < OCF_STATS_SHARDS; j++) {
+		core_stats = &core->counters->shards[j];
+
+		accum_error_stats(&stats->core_errors,
+				&core_stats->core_errors);
+		accum_error_stats(&stats->cache_errors,
+				&core_stats->cache_errors);
 
 #ifdef OCF_DEBUG_STATS
-	copy_debug_stats(&stats->debug_stat,
-			&core_stats->debug_stats);
+		accum_debug_stats(&stats->debug_stat,
+				&core_stats->debug_stats);
 #endif
 
-	for (i = 0; i != OCF_IO_CLASS_MAX; i++) {
-		curr = &core_stats->part_counters[i];
+		for (i = 0; i != OCF_IO_CLASS_MAX; i++) {
+			curr = &core_stats->part_counters[i];
 
-		accum_req_stats(&stats->read_reqs,
-				&curr->read_reqs);
-		accum_req_stats(&stats->write_reqs,
-				&curr->write_reqs);
+			accum_req_stats(&stats->read_reqs,
+					&curr->read_reqs);
+			accum_req_stats(&stats->write_reqs,
+					&curr->write_reqs);
 
-		accum_block_stats(&stats->core, &curr->blocks);
-		accum_block_stats(&stats->core_volume, &curr->core_blocks);
-		accum_block_stats(&stats->cache_volume, &curr->cache_blocks);
+			accum_block_stats(&stats->core, &curr->blocks);
+			accum_block_stats(&stats->core_volume,
+					&curr->core_blocks);
+			accum_block_stats(&stats->cache_volume,
+					&curr->cache_blocks);
+		}
+	}
 
+	for (i = 0; i != OCF_IO_CLASS_MAX; i++) {
 		stats->cache_occupancy += env_atomic_read(&core->runtime_meta->
 				part_counters[i].cached_clines);
 		stats->dirty += env_atomic_read(&core->runtime_meta->
@@ -373,15 +442,18 @@ double ocf_core_get_read_miss_ratio(ocf_core_t core)
 {
 	struct ocf_counters_req *curr;
 	uint64_t misses = 0, total = 0;
-	uint32_t i;
+	uint32_t i, j;
 
-	for (i = 0; i != OCF_IO_CLASS_MAX; ++i) {
-		curr = &core->counters->part_counters[i].read_reqs;
+	for (j = 0; j < OCF_STATS_SHARDS; j++) {
+		for (i = 0; i != OCF_IO_CLASS_MAX; ++i) {
+			curr = &core->counters->shards[j].part_counters[i].
+					read_reqs;
 
-		misses += env_atomic64_read(&curr->partial_miss);
-		misses += env_atomic64_read(&curr->full_miss);
+			misses += env_atomic64_read(&curr->partial_miss);
+			misses += env_atomic64_read(&curr->full_miss);
 
-		total += env_atomic64_read(&curr->total);
+			total += env_atomic64_read(&curr->total);
+		}
 	}
 
 	if (total <= 0)
@@ -440,10 +512,7 @@ void ocf_core_update_stats(ocf_core_t core, struct ocf_io *io)
 	OCF_CHECK_NULL(core);
 	OCF_CHECK_NULL(io);
 
-	core_id = ocf_core_get_id(core);
-	cache = ocf_core_get_cache(core);
-
-	stats = &core->counters->debug_stats;
+	stats = &ocf_core_stats_shard(core)->debug_stats;
 
 	idx = to_packet_idx(io->bytes);
 	if (io->dir == OCF_WRITE)
@@ -463,3 +532,83 @@ void ocf_core_update_stats(ocf_core_t core, struct ocf_io *io)
 void ocf_core_update_stats(ocf_core_t core, struct ocf_io *io) {}
 
 #endif
+
+static void accum_latency_stats(struct ocf_stats_latency *dest,
+		const struct ocf_counters_latency *from)
+{
+	uint64_t value;
+	int i;
+
+	for (i = 0; i < OCF_STATS_LAT_BUCKETS; i++) {
+		value = env_atomic64_read(&from->buckets[i]);
+		dest->buckets[i] += value;
+		dest->count += value;
+	}
+}
+
+int ocf_stats_collect_latency_part_core(ocf_core_t core,
+		ocf_part_id_t part_id, ocf_lat_path_t path,
+		struct ocf_stats_latency *lat)
+{
+	OCF_CHECK_NULL(core);
+
+	if (!lat || part_id > OCF_IO_CLASS_ID_MAX ||
+			path >= ocf_lat_path_max) {
+		return -OCF_ERR_INVAL;
+	}
+
+	ENV_BUG_ON(env_memset(lat, sizeof(*lat), 0));
+	accum_latency_stats(lat, &core->counters->latency[part_id][path]);
+
+	return 0;
+}
+
+int ocf_stats_collect_latency_core(ocf_core_t core, ocf_lat_path_t path,
+		struct ocf_stats_latency *lat)
+{
+	ocf_part_id_t i;
+
+	OCF_CHECK_NULL(core);
+
+	if (!lat || path >= ocf_lat_path_max)
+		return -OCF_ERR_INVAL;
+
+	ENV_BUG_ON(env_memset(lat, sizeof(*lat), 0));
+
+	for (i = 0; i != OCF_IO_CLASS_MAX; i++)
+		accum_latency_stats(lat, &core->counters->latency[i][path]);
+
+	return 0;
+}
+
+uint64_t ocf_stats_latency_bucket_ns(uint32_t bucket)
+{
+	return _log_bucket_value(bucket);
+}
+
+uint64_t ocf_stats_latency_percentile(const struct ocf_stats_latency *lat,
+		uint32_t permille)
+{
+	uint64_t rank, seen = 0;
+	uint32_t i;
+
+	OCF_CHECK_NULL(lat);
+
+	if (!lat->count)
+		return 0;
+
+	if (permille > 1000)
+		permille = 1000;
+
+	rank = OCF_DIV_ROUND_UP(lat->count * permille, 1000);
+	if (!rank)
+		rank = 1;
+
+	for (i = 0; i < OCF_STATS_LAT_BUCKETS - 1; i++) {
+		seen += lat->buckets[i];
+		if (seen >= rank)
+			return ocf_stats_latency_bucket_ns(i + 1) - 1;
+	}
+
+	return ocf_stats_latency_bucket_ns(OCF_STATS_LAT_BUCKETS - 1);
+}
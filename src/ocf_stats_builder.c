@@ -22,6 +22,8 @@ static void _fill_req(struct ocf_stats_requests *req, struct ocf_stats_core *s)
 	hit = s->read_reqs.total - (s->read_reqs.full_miss +
 			s->read_reqs.partial_miss);
 	_set(&req->rd_hits, hit, total);
+	_set(&req->rd_offloadable_hits,
+			hit - OCF_MIN(hit, s->read_reqs.dirty_hit), hit);
 	_set(&req->rd_partial_misses, s->read_reqs.partial_miss, total);
 	_set(&req->rd_full_misses, s->read_reqs.full_miss, total);
 	_set(&req->rd_total, s->read_reqs.total, total);
@@ -55,6 +57,8 @@ static void _fill_req_part(struct ocf_stats_requests *req,
 	hit = s->read_reqs.total - (s->read_reqs.full_miss +
 			s->read_reqs.partial_miss);
 	_set(&req->rd_hits, hit, total);
+	_set(&req->rd_offloadable_hits,
+			hit - OCF_MIN(hit, s->read_reqs.dirty_hit), hit);
 	_set(&req->rd_partial_misses, s->read_reqs.partial_miss, total);
 	_set(&req->rd_full_misses, s->read_reqs.full_miss, total);
 	_set(&req->rd_total, s->read_reqs.total, total);
@@ -175,6 +179,7 @@ static void _accumulate_reqs(struct ocf_stats_req *to,
 	to->partial_miss += from->partial_miss;
 	to->total += from->total;
 	to->pass_through += from->pass_through;
+	to->dirty_hit += from->dirty_hit;
 }
 
 static void _accumulate_errors(struct ocf_stats_error *to,
@@ -389,6 +394,9 @@ static int _accumulate_stats(ocf_core_t core, void *cntx)
 	_accumulate_errors(&total->cache_errors, &stats.cache_errors);
 	_accumulate_errors(&total->core_errors, &stats.core_errors);
 
+	total->cache_occupancy += stats.cache_occupancy;
+	total->dirty += stats.dirty;
+
 	return 0;
 }
 
@@ -449,3 +457,187 @@ int ocf_stats_collect_cache(ocf_cache_t cache,
 
 	return 0;
 }
+
+struct ocf_stats_snapshot {
+	/** Tick count at which snapshot was taken */
+	uint64_t ticks;
+	/** Cumulative counters */
+	struct ocf_stats_core s;
+	/** Cache size in cache lines */
+	uint64_t size;
+	ocf_cache_line_size_t line_size;
+};
+
+int ocf_stats_snapshot_alloc(ocf_stats_snapshot_t *snapshot)
+{
+	OCF_CHECK_NULL(snapshot);
+
+	*snapshot = env_zalloc(sizeof(**snapshot), ENV_MEM_NORMAL);
+	if (!*snapshot)
+		return -OCF_ERR_NO_MEM;
+
+	return 0;
+}
+
+void ocf_stats_snapshot_free(ocf_stats_snapshot_t snapshot)
+{
+	env_free(snapshot);
+}
+
+int ocf_stats_snapshot_core(ocf_core_t core, ocf_stats_snapshot_t snapshot)
+{
+	ocf_cache_t cache;
+	int result;
+
+	OCF_CHECK_NULL(core);
+	OCF_CHECK_NULL(snapshot);
+
+	cache = ocf_core_get_cache(core);
+
+	result = ocf_core_get_stats(core, &snapshot->s);
+	if (result)
+		return result;
+
+	snapshot->ticks = env_get_tick_count();
+	snapshot->size = cache->conf_meta->cachelines;
+	snapshot->line_size = ocf_cache_get_line_size(cache);
+
+	return 0;
+}
+
+int ocf_stats_snapshot_cache(ocf_cache_t cache, ocf_stats_snapshot_t snapshot)
+{
+	int result;
+
+	OCF_CHECK_NULL(cache);
+	OCF_CHECK_NULL(snapshot);
+
+	ENV_BUG_ON(env_memset(&snapshot->s, sizeof(snapshot->s), 0));
+
+	result = ocf_core_visit(cache, _accumulate_stats, &snapshot->s, true);
+	if (result)
+		return result;
+
+	snapshot->ticks = env_get_tick_count();
+	snapshot->size = cache->conf_meta->cachelines;
+	snapshot->line_size = ocf_cache_get_line_size(cache);
+
+	return 0;
+}
+
+static inline uint64_t _delta(uint64_t from, uint64_t to)
+{
+	return to >= from ? to - from : to;
+}
+
+static void _delta_block(struct ocf_stats_block *d,
+		const struct ocf_stats_block *from,
+		const struct ocf_stats_block *to)
+{
+	d->read = _delta(from->read, to->read);
+	d->write = _delta(from->write, to->write);
+}
+
+static void _delta_reqs(struct ocf_stats_req *d,
+		const struct ocf_stats_req *from,
+		const struct ocf_stats_req *to)
+{
+	d->full_miss = _delta(from->full_miss, to->full_miss);
+	d->partial_miss = _delta(from->partial_miss, to->partial_miss);
+	d->total = _delta(from->total, to->total);
+	d->pass_through = _delta(from->pass_through, to->pass_through);
+	d->dirty_hit = _delta(from->dirty_hit, to->dirty_hit);
+}
+
+static void _delta_errors(struct ocf_stats_error *d,
+		const struct ocf_stats_error *from,
+		const struct ocf_stats_error *to)
+{
+	d->read = _delta(from->read, to->read);
+	d->write = _delta(from->write, to->write);
+}
+
+static inline uint64_t _rate(uint64_t value, uint64_t duration_us)
+{
+	return duration_us ? value * 1000000 / duration_us : 0;
+}
+
+static inline int64_t _rate_signed(uint64_t from, uint64_t to,
+		uint64_t duration_us)
+{
+	if (to >= from)
+		return _rate(to - from, duration_us);
+
+	return -(int64_t)_rate(from - to, duration_us);
+}
+
+int ocf_stats_snapshot_delta(ocf_stats_snapshot_t from,
+		ocf_stats_snapshot_t to, struct ocf_stats_interval *interval)
+{
+	struct ocf_stats_rates *rates;
+	struct ocf_stats_core d;
+	uint64_t size, occupancy, dirty, us;
+
+	OCF_CHECK_NULL(from);
+	OCF_CHECK_NULL(to);
+	OCF_CHECK_NULL(interval);
+
+	if (to->ticks < from->ticks || from->line_size != to->line_size)
+		return -OCF_ERR_INVAL;
+
+	ENV_BUG_ON(env_memset(interval, sizeof(*interval), 0));
+	ENV_BUG_ON(env_memset(&d, sizeof(d), 0));
+
+	_delta_reqs(&d.read_reqs, &from->s.read_reqs, &to->s.read_reqs);
+	_delta_reqs(&d.write_reqs, &from->s.write_reqs, &to->s.write_reqs);
+	_delta_block(&d.cache_volume, &from->s.cache_volume,
+			&to->s.cache_volume);
+	_delta_block(&d.core_volume, &from->s.core_volume,
+			&to->s.core_volume);
+	_delta_block(&d.core, &from->s.core, &to->s.core);
+	_delta_errors(&d.cache_errors, &from->s.cache_errors,
+			&to->s.cache_errors);
+	_delta_errors(&d.core_errors, &from->s.core_errors,
+			&to->s.core_errors);
+
+	us = env_ticks_to_nsecs(to->ticks - from->ticks) / 1000;
+	interval->duration_us = us;
+
+	size = _lines4k(to->size, to->line_size);
+	occupancy = _lines4k(to->s.cache_occupancy, to->line_size);
+	dirty = _lines4k(to->s.dirty, to->line_size);
+
+	_set(&interval->usage.occupancy, occupancy, size);
+	_set(&interval->usage.free, size - occupancy, size);
+	_set(&interval->usage.clean, occupancy - dirty, occupancy);
+	_set(&interval->usage.dirty, dirty, occupancy);
+
+	_fill_req(&interval->req, &d);
+	_fill_blocks(&interval->blocks, &d);
+	_fill_errors(&interval->errors, &d);
+
+	rates = &interval->rates;
+	rates->rd_reqs = _rate(interval->req.rd_total.value, us);
+	rates->rd_hits = _rate(interval->req.rd_hits.value, us);
+	rates->wr_reqs = _rate(interval->req.wr_total.value, us);
+	rates->wr_hits = _rate(interval->req.wr_hits.value, us);
+	rates->pt_reqs = _rate(interval->req.rd_pt.value +
+			interval->req.wr_pt.value, us);
+	rates->total_reqs = _rate(interval->req.total.value, us);
+	rates->core_volume_rd = _rate(interval->blocks.core_volume_rd.value, us);
+	rates->core_volume_wr = _rate(interval->blocks.core_volume_wr.value, us);
+	rates->cache_volume_rd = _rate(interval->blocks.cache_volume_rd.value,
+			us);
+	rates->cache_volume_wr = _rate(interval->blocks.cache_volume_wr.value,
+			us);
+	rates->volume_rd = _rate(interval->blocks.volume_rd.value, us);
+	rates->volume_wr = _rate(interval->blocks.volume_wr.value, us);
+	rates->errors = _rate(interval->errors.total.value, us);
+	rates->occupancy = _rate_signed(
+			_lines4k(from->s.cache_occupancy, from->line_size),
+			occupancy, us);
+	rates->dirty = _rate_signed(_lines4k(from->s.dirty, from->line_size),
+			dirty, us);
+
+	return 0;
+}
@@ -21,6 +21,7 @@ struct ocf_counters_req {
 	env_atomic64 full_miss;
 	env_atomic64 total;
 	env_atomic64 pass_through;
+	env_atomic64 dirty_hit;
 };
 
 /**
@@ -41,6 +42,9 @@ struct ocf_stats_req {
 
 	/** Pass-through requests */
 	uint64_t pass_through;
+
+	/** Hits with dirty data, which can't be serviced from core */
+	uint64_t dirty_hit;
 };
 
 /**
@@ -172,7 +176,21 @@ struct ocf_counters_debug {
 };
 #endif
 
-struct ocf_counters_core {
+/**
+ * Latency histogram, see struct ocf_stats_latency for bucket layout
+ */
+struct ocf_counters_latency {
+	env_atomic64 buckets[OCF_STATS_LAT_BUCKETS];
+};
+
+/* Number of counter shards per core, CPUs are mapped onto them */
+#define OCF_STATS_SHARDS 16
+
+/*
+ * Counters updated from CPUs mapped to given shard. Values of single shard
+ * are meaningless, statistics are sums over all shards.
+ */
+struct ocf_counters_core_shard {
 	struct ocf_counters_error core_errors;
 	struct ocf_counters_error cache_errors;
 
@@ -182,6 +200,14 @@ struct ocf_counters_core {
 #endif
 };
 
+struct ocf_counters_core {
+	struct ocf_counters_core_shard shards[OCF_STATS_SHARDS];
+
+	/* Not sharded, histograms of all IO classes and paths are already
+	 * hundreds of KiB per core */
+	struct ocf_counters_latency latency[OCF_IO_CLASS_MAX][ocf_lat_path_max];
+};
+
 void ocf_core_stats_core_block_update(ocf_core_t core, ocf_part_id_t part_id,
 		int dir, uint64_t bytes);
 void ocf_core_stats_cache_block_update(ocf_core_t core, ocf_part_id_t part_id,
@@ -193,10 +219,15 @@ void ocf_core_stats_request_update(ocf_core_t core, ocf_part_id_t part_id,
 		uint8_t dir, uint64_t hit_no, uint64_t core_line_count);
 void ocf_core_stats_request_pt_update(ocf_core_t core, ocf_part_id_t part_id,
 		uint8_t dir, uint64_t hit_no, uint64_t core_line_count);
+void ocf_core_stats_request_dirty_hit_update(ocf_core_t core,
+		ocf_part_id_t part_id, uint8_t dir);
 
 void ocf_core_stats_core_error_update(ocf_core_t core, uint8_t dir);
 void ocf_core_stats_cache_error_update(ocf_core_t core, uint8_t dir);
 
+void ocf_core_stats_latency_update(ocf_core_t core, ocf_part_id_t part_id,
+		ocf_lat_path_t path, uint64_t ns);
+
 /**
  * @brief ocf_core_io_class_get_stats retrieve io class statistics
  *			for given core
@@ -10,6 +10,7 @@
 #include "ocf_core_priv.h"
 #include "ocf_cache_priv.h"
 #include "ocf_trace_priv.h"
+#include "ocf_trace_ring.h"
 
 struct core_trace_visitor_ctx {
 	ocf_cache_t cache;
@@ -135,3 +136,273 @@ int ocf_mngt_stop_trace(ocf_cache_t cache)
 
 	return 0;
 }
+
+int ocf_trace_ring_init(ocf_queue_t queue, uint32_t entries)
+{
+	struct ocf_trace_ring *ring;
+
+	if (queue->trace_ring)
+		return 0;
+
+	ring = env_vzalloc(sizeof(*ring) + entries * sizeof(ring->slots[0]));
+	if (!ring)
+		return -OCF_ERR_NO_MEM;
+
+	ring->mask = entries - 1;
+	env_atomic_set(&ring->enabled, 1);
+	env_smp_wmb();
+	queue->trace_ring = ring;
+
+	return 0;
+}
+
+void ocf_trace_ring_deinit(ocf_queue_t queue)
+{
+	struct ocf_trace_ring *ring = queue->trace_ring;
+
+	if (!ring)
+		return;
+
+	/* Unpublish ring and wait for producers which might still use it */
+	queue->trace_ring = NULL;
+	env_smp_mb();
+
+	while (env_atomic_read(&queue->trace_ring_ref))
+		env_msleep(1);
+
+	env_vfree(ring);
+}
+
+/*
+ * Returns next io queue with reference taken and drops reference
+ * of the previous one, so that list walk may sleep between steps
+ */
+static ocf_queue_t _ocf_trace_ring_next_queue(ocf_cache_t cache,
+		ocf_queue_t queue)
+{
+	struct list_head *pos;
+	ocf_queue_t next = NULL;
+
+	env_spinlock_lock(&cache->io_queues_lock);
+
+	pos = queue ? queue->list.next : cache->io_queues.next;
+	for (; pos != &cache->io_queues; pos = pos->next) {
+		next = list_entry(pos, struct ocf_queue, list);
+		/* Skip queue which is being destroyed */
+		if (env_atomic_add_unless(&next->ref_count, 1, 0))
+			break;
+		next = NULL;
+	}
+
+	env_spinlock_unlock(&cache->io_queues_lock);
+
+	if (queue)
+		ocf_queue_put(queue);
+
+	return next;
+}
+
+static void _ocf_trace_ring_disable_all(ocf_cache_t cache)
+{
+	ocf_queue_t queue;
+
+	env_spinlock_lock(&cache->io_queues_lock);
+	list_for_each_entry(queue, &cache->io_queues, list) {
+		if (queue->trace_ring)
+			env_atomic_set(&queue->trace_ring->enabled, 0);
+	}
+	env_spinlock_unlock(&cache->io_queues_lock);
+}
+
+int ocf_mngt_start_trace_ring(ocf_cache_t cache, uint32_t entries)
+{
+	ocf_queue_t queue = NULL;
+	int result = 0;
+
+	OCF_CHECK_NULL(cache);
+
+	if (!entries || (entries & (entries - 1)))
+		return -OCF_ERR_INVAL;
+
+	if (cache->trace.ring_entries) {
+		ocf_cache_log(cache, log_err, "Trace ring already started\n");
+		return -OCF_ERR_INVAL;
+	}
+
+	/* Queues created from now on get their ring in ocf_queue_create() */
+	cache->trace.ring_entries = entries;
+	env_smp_mb();
+
+	while ((queue = _ocf_trace_ring_next_queue(cache, queue))) {
+		if (queue == cache->mngt_queue)
+			continue;
+
+		/* Ring left from previous run may have different size */
+		if (queue->trace_ring &&
+				queue->trace_ring->mask != entries - 1) {
+			ocf_trace_ring_deinit(queue);
+		}
+
+		result = ocf_trace_ring_init(queue, entries);
+		if (result) {
+			ocf_queue_put(queue);
+			break;
+		}
+
+		env_atomic_set(&queue->trace_ring->enabled, 1);
+	}
+
+	if (result) {
+		/* Roll back rings already enabled by this call */
+		cache->trace.ring_entries = 0;
+		_ocf_trace_ring_disable_all(cache);
+		ocf_cache_log(cache, log_err, "Cannot start trace ring\n");
+		return result;
+	}
+
+	ocf_cache_log(cache, log_info, "Trace ring started\n");
+
+	return 0;
+}
+
+void ocf_mngt_stop_trace_ring(ocf_cache_t cache)
+{
+	OCF_CHECK_NULL(cache);
+
+	cache->trace.ring_entries = 0;
+
+	_ocf_trace_ring_disable_all(cache);
+}
+
+static uint32_t _ocf_trace_ring_drain_ring(ocf_queue_t queue,
+		struct ocf_trace_ring *ring, struct ocf_trace_rec *recs,
+		uint32_t max)
+{
+	struct ocf_trace_ring_slot *slot;
+	uint64_t head, seq, lost = 0;
+	uint32_t count = 0;
+
+	head = env_atomic64_read(&ring->head);
+	if (head - ring->tail > ring->mask + 1) {
+		lost += head - ring->tail - (ring->mask + 1);
+		ring->tail = head - (ring->mask + 1);
+	}
+
+	/* Leave space for lost records report */
+	while (ring->tail != head && count + 1 < max) {
+		slot = &ring->slots[ring->tail & ring->mask];
+
+		seq = env_atomic64_read(&slot->seq);
+		env_smp_rmb();
+		if (seq < ring->tail + 1) {
+			/* Record not written yet, try on next drain */
+			break;
+		}
+
+		if (seq == ring->tail + 1) {
+			recs[count] = slot->rec;
+			env_smp_rmb();
+			if (env_atomic64_read(&slot->seq) == seq)
+				count++;
+			else
+				lost++;
+		} else {
+			lost++;
+		}
+
+		ring->tail++;
+	}
+
+	if (lost) {
+		ENV_BUG_ON(env_memset(&recs[count], sizeof(recs[count]), 0));
+		recs[count].timestamp = env_get_time_ns();
+		recs[count].value = lost;
+		recs[count].queue_id = queue->id;
+		recs[count].type = ocf_trace_rec_lost;
+		count++;
+	}
+
+	return count;
+}
+
+static uint32_t _ocf_trace_ring_drain_queue(ocf_queue_t queue,
+		struct ocf_trace_rec *recs, uint32_t max)
+{
+	struct ocf_trace_ring *ring;
+	uint32_t count = 0;
+
+	/* Keep ring from being freed by concurrent restart with new size */
+	env_atomic_inc(&queue->trace_ring_ref);
+	env_smp_mb();
+
+	ring = queue->trace_ring;
+	if (ring)
+		count = _ocf_trace_ring_drain_ring(queue, ring, recs, max);
+
+	env_atomic_dec(&queue->trace_ring_ref);
+
+	return count;
+}
+
+uint32_t ocf_trace_ring_drain(ocf_cache_t cache, struct ocf_trace_rec *recs,
+		uint32_t max)
+{
+	ocf_queue_t queue;
+	uint32_t count = 0;
+
+	OCF_CHECK_NULL(cache);
+	OCF_CHECK_NULL(recs);
+
+	env_spinlock_lock(&cache->io_queues_lock);
+	list_for_each_entry(queue, &cache->io_queues, list) {
+		if (!queue->trace_ring)
+			continue;
+
+		if (max - count < 2)
+			break;
+
+		count += _ocf_trace_ring_drain_queue(queue, recs + count,
+				max - count);
+	}
+	env_spinlock_unlock(&cache->io_queues_lock);
+
+	return count;
+}
+
+void ocf_trace_ring_dev_io(struct ocf_io *io, uint8_t dev,
+		uint64_t submit_ns)
+{
+	uint64_t now;
+
+	if (!io->io_queue)
+		return;
+
+	now = env_get_time_ns();
+
+	ocf_trace_ring_push_rec(io->io_queue, ocf_trace_rec_dev_io,
+			dev | (io->dir << 1), io->addr, now - submit_ns,
+			io->bytes, now);
+}
+
+void ocf_trace_ring_counter(ocf_cache_t cache, ocf_trace_counter_t counter,
+		uint64_t value)
+{
+	ocf_queue_t queue;
+
+	OCF_CHECK_NULL(cache);
+
+	if (!cache->trace.ring_entries)
+		return;
+
+	/* Counters are not bound to any queue, use first traced one */
+	env_spinlock_lock(&cache->io_queues_lock);
+	list_for_each_entry(queue, &cache->io_queues, list) {
+		if (!queue->trace_ring)
+			continue;
+
+		ocf_trace_ring_push_rec(queue, ocf_trace_rec_counter, counter,
+				0, value, 0, env_get_time_ns());
+		break;
+	}
+	env_spinlock_unlock(&cache->io_queues_lock);
+}
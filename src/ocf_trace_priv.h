@@ -13,6 +13,7 @@
 #include "ocf_request.h"
 #include "ocf_core_priv.h"
 #include "ocf_queue_priv.h"
+#include "ocf_trace_ring.h"
 
 static inline bool ocf_is_trace_ongoing(ocf_cache_t cache)
 {
@@ -106,6 +107,10 @@ static inline void ocf_trace_io(struct ocf_request *req,
 {
 	struct ocf_event_io ev;
 
+	ocf_trace_ring_push(req, ocf_trace_rec_submit, dir,
+			req->byte_position, req->byte_length,
+			env_get_time_ns());
+
 	if (!req->cache->trace.trace_callback)
 		return;
 
@@ -118,6 +123,10 @@ static inline void ocf_trace_io_cmpl(struct ocf_request *req)
 {
 	struct ocf_event_io_cmpl ev;
 
+	ocf_trace_ring_push(req, ocf_trace_rec_complete,
+			ocf_engine_is_hit(req), req->byte_position,
+			req->byte_length, env_get_time_ns());
+
 	if (!req->cache->trace.trace_callback)
 		return;
 
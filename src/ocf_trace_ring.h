@@ -0,0 +1,91 @@
+/*
+ * Copyright(c) 2012-2020 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __OCF_TRACE_RING_H__
+#define __OCF_TRACE_RING_H__
+
+#include "ocf/ocf.h"
+#include "ocf_env.h"
+#include "ocf_request.h"
+#include "ocf_queue_priv.h"
+
+struct ocf_trace_ring_slot {
+	/* Index of stored record + 1, 0 while record is being written */
+	env_atomic64 seq;
+
+	struct ocf_trace_rec rec;
+};
+
+/*
+ * Overwriting ring of fixed size records. Producers only reserve a slot
+ * with single atomic add on their own queue ring, consumer detects
+ * records overwritten while copying by slot sequence numbers.
+ */
+struct ocf_trace_ring {
+	env_atomic64 head __attribute__((aligned(64)));
+
+	env_atomic enabled __attribute__((aligned(64)));
+
+	/* Consumer position, accessed only by ocf_trace_ring_drain() */
+	uint64_t tail;
+
+	uint64_t mask;
+
+	struct ocf_trace_ring_slot slots[];
+};
+
+int ocf_trace_ring_init(ocf_queue_t queue, uint32_t entries);
+
+void ocf_trace_ring_deinit(ocf_queue_t queue);
+
+static inline void ocf_trace_ring_push_rec(ocf_queue_t queue,
+		ocf_trace_rec_type_t type, uint8_t arg, log_sid_t sid,
+		uint64_t value, uint32_t len, uint64_t timestamp)
+{
+	struct ocf_trace_ring *ring;
+	struct ocf_trace_ring_slot *slot;
+	uint64_t idx;
+
+	if (likely(!queue->trace_ring))
+		return;
+
+	/* Pin ring, ocf_trace_ring_deinit() waits for reference drop */
+	env_atomic_inc(&queue->trace_ring_ref);
+	env_smp_mb();
+
+	ring = queue->trace_ring;
+	if (!ring || !env_atomic_read(&ring->enabled))
+		goto out;
+
+	idx = env_atomic64_inc_return(&ring->head) - 1;
+	slot = &ring->slots[idx & ring->mask];
+
+	env_atomic64_set(&slot->seq, 0);
+	env_smp_wmb();
+
+	slot->rec.timestamp = timestamp;
+	slot->rec.sid = sid;
+	slot->rec.value = value;
+	slot->rec.len = len;
+	slot->rec.queue_id = queue->id;
+	slot->rec.type = type;
+	slot->rec.arg = arg;
+
+	env_smp_wmb();
+	env_atomic64_set(&slot->seq, idx + 1);
+
+out:
+	env_atomic_dec(&queue->trace_ring_ref);
+}
+
+static inline void ocf_trace_ring_push(struct ocf_request *req,
+		ocf_trace_rec_type_t type, uint8_t arg, uint64_t value,
+		uint32_t len, uint64_t timestamp)
+{
+	ocf_trace_ring_push_rec(req->io_queue, type, arg, req->sid, value,
+			len, timestamp);
+}
+
+#endif /* __OCF_TRACE_RING_H__ */
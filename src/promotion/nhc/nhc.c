@@ -0,0 +1,285 @@
+/*
+ * Copyright(c) 2019-2020 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include "../../metadata/metadata.h"
+#include "../../ocf_priv.h"
+#include "../../engine/engine_common.h"
+#include "../../utils/utils_token_bucket.h"
+#include "../../utils/utils_freq_sketch.h"
+
+#include "nhc.h"
+#include "../ops.h"
+
+/*
+ * Promotion policy for multi-factor cache modes. Whether MF read may
+ * promote at all is decided by monitor's data_admit switch, checked in
+ * ocf_promotion_req_should_promote() for every policy. Every miss is
+ * recorded in frequency sketch before that check. On top of that
+ * this policy:
+ *  - rejects the first access to a core line (doorkeeper), so one-hit
+ *    wonders seen while probing do not get backfilled,
+ *  - while data_admit trickles, promotes only lines with estimated
+ *    access frequency of at least trickle threshold,
+ *  - limits cache write bandwidth spent on promotions, so backfills do
+ *    not skew throughput measured by the monitor.
+ */
+
+/* Sketch counters per cache line */
+#define NHC_SKETCH_RATIO 1
+
+/* Write budget burst, in milliseconds of budget rate */
+#define NHC_BURST_MS 100
+
+#define NHC_MIN_BURST MiB
+
+struct nhc_policy_context {
+	struct ocf_freq_sketch *sketch;
+
+	struct ocf_token_bucket budget;
+};
+
+static inline uint64_t nhc_budget_burst(uint64_t rate)
+{
+	return OCF_MAX(rate * NHC_BURST_MS / 1000, NHC_MIN_BURST);
+}
+
+static void nhc_budget_init(struct nhc_policy_context *ctx,
+		uint32_t write_budget)
+{
+	uint64_t rate = (uint64_t)write_budget * MiB;
+
+	ocf_token_bucket_init(&ctx->budget, rate, nhc_budget_burst(rate));
+}
+
+void nhc_setup(ocf_cache_t cache)
+{
+	struct nhc_promotion_policy_config *cfg;
+
+	cfg = (void *) &cache->conf_meta->promotion[ocf_promotion_nhc].data;
+
+	cfg->doorkeeper = OCF_NHC_DOORKEEPER_DEFAULT;
+	cfg->write_budget = OCF_NHC_WRITE_BUDGET_DEFAULT;
+	cfg->trickle_threshold = OCF_NHC_TRICKLE_THRESHOLD_DEFAULT;
+}
+
+ocf_error_t nhc_init(ocf_cache_t cache)
+{
+	struct nhc_promotion_policy_config *cfg;
+	struct nhc_policy_context *ctx;
+	uint64_t available, size, entries;
+	int result = 0;
+
+	cfg = (void *) &cache->conf_meta->promotion[ocf_promotion_nhc].data;
+
+	entries = ocf_metadata_get_cachelines_count(cache) * NHC_SKETCH_RATIO;
+	size = sizeof(*ctx) + ocf_freq_sketch_sizeof(entries);
+	available = env_get_free_memory();
+
+	if (size >= available) {
+		ocf_cache_log(cache, log_err, "Not enough memory to "
+				"initialize 'nhc' promotion policy! "
+				"Required %lu, available %lu\n",
+				(long unsigned)size,
+				(long unsigned)available);
+
+		return -OCF_ERR_NO_FREE_RAM;
+	}
+
+	ctx = env_vzalloc(sizeof(*ctx));
+	if (!ctx) {
+		result = -OCF_ERR_NO_MEM;
+		goto exit;
+	}
+
+	ctx->sketch = ocf_freq_sketch_create(entries);
+	if (!ctx->sketch) {
+		result = -OCF_ERR_NO_MEM;
+		goto dealloc_ctx;
+	}
+
+	nhc_budget_init(ctx, cfg->write_budget);
+
+	cache->promotion_policy->ctx = ctx;
+	cache->promotion_policy->config = cfg;
+
+	return 0;
+
+dealloc_ctx:
+	env_vfree(ctx);
+exit:
+	ocf_cache_log(cache, log_err, "Error initializing nhc "
+			"promotion policy\n");
+	return result;
+}
+
+void nhc_deinit(ocf_promotion_policy_t policy)
+{
+	struct nhc_policy_context *ctx = policy->ctx;
+
+	ocf_freq_sketch_destroy(ctx->sketch);
+
+	env_vfree(ctx);
+	policy->ctx = NULL;
+}
+
+ocf_error_t nhc_set_param(ocf_cache_t cache, uint8_t param_id,
+		uint32_t param_value)
+{
+	struct nhc_promotion_policy_config *cfg;
+	ocf_promotion_policy_t policy = cache->promotion_policy;
+	ocf_error_t result = 0;
+
+	cfg = (void *) &cache->conf_meta->promotion[ocf_promotion_nhc].data;
+
+	switch (param_id) {
+	case ocf_nhc_doorkeeper:
+		if (param_value <= 1) {
+			cfg->doorkeeper = param_value;
+			ocf_cache_log(cache, log_info,
+					"NHC PP doorkeeper %s\n",
+					param_value ? "enabled" : "disabled");
+		} else {
+			ocf_cache_log(cache, log_err, "Invalid nhc "
+					"promotion policy doorkeeper value!\n");
+			result = -OCF_ERR_INVAL;
+		}
+		break;
+
+	case ocf_nhc_write_budget:
+		if (param_value >= OCF_NHC_MIN_WRITE_BUDGET &&
+				param_value <= OCF_NHC_MAX_WRITE_BUDGET) {
+			cfg->write_budget = param_value;
+			if (policy && policy->type == ocf_promotion_nhc &&
+					policy->ctx) {
+				nhc_budget_init(policy->ctx, param_value);
+			}
+			ocf_cache_log(cache, log_info,
+					"NHC PP write budget set to %u MiB/s\n",
+					param_value);
+		} else {
+			ocf_cache_log(cache, log_err, "Invalid nhc "
+					"promotion policy write budget!\n");
+			result = -OCF_ERR_INVAL;
+		}
+		break;
+
+	case ocf_nhc_trickle_threshold:
+		if (param_value >= OCF_NHC_MIN_TRICKLE_THRESHOLD &&
+				param_value <= OCF_NHC_MAX_TRICKLE_THRESHOLD) {
+			cfg->trickle_threshold = param_value;
+			ocf_cache_log(cache, log_info,
+					"NHC PP trickle threshold set to %u\n",
+					param_value);
+		} else {
+			ocf_cache_log(cache, log_err, "Invalid nhc "
+					"promotion policy trickle threshold!\n");
+			result = -OCF_ERR_INVAL;
+		}
+		break;
+
+	default:
+		ocf_cache_log(cache, log_err, "Invalid nhc "
+				"promotion policy parameter (%u)!\n",
+				param_id);
+		result = -OCF_ERR_INVAL;
+
+		break;
+	}
+
+	return result;
+}
+
+ocf_error_t nhc_get_param(ocf_cache_t cache, uint8_t param_id,
+		uint32_t *param_value)
+{
+	struct nhc_promotion_policy_config *cfg;
+	ocf_error_t result = 0;
+
+	cfg = (void *) &cache->conf_meta->promotion[ocf_promotion_nhc].data;
+
+	OCF_CHECK_NULL(param_value);
+
+	switch (param_id) {
+	case ocf_nhc_doorkeeper:
+		*param_value = cfg->doorkeeper;
+		break;
+	case ocf_nhc_write_budget:
+		*param_value = cfg->write_budget;
+		break;
+	case ocf_nhc_trickle_threshold:
+		*param_value = cfg->trickle_threshold;
+		break;
+	default:
+		ocf_cache_log(cache, log_err, "Invalid nhc "
+				"promotion policy parameter (%u)!\n",
+				param_id);
+		result = -OCF_ERR_INVAL;
+
+		break;
+	}
+
+	return result;
+}
+
+void nhc_set_write_rate(ocf_promotion_policy_t policy, uint64_t rate)
+{
+	struct nhc_policy_context *ctx = policy->ctx;
+
+	ocf_token_bucket_set_rate(&ctx->budget, rate, nhc_budget_burst(rate));
+}
+
+void nhc_req_access(ocf_promotion_policy_t policy, struct ocf_request *req)
+{
+	struct nhc_policy_context *ctx = policy->ctx;
+	uint32_t i;
+
+	for (i = 0; i < req->core_line_count; i++) {
+		struct ocf_map_info *entry = &(req->map[i]);
+
+		ocf_freq_sketch_record(ctx->sketch, ocf_freq_sketch_hash(
+				entry->core_id, entry->core_line));
+	}
+}
+
+bool nhc_req_should_promote(ocf_promotion_policy_t policy,
+		struct ocf_request *req)
+{
+	struct nhc_promotion_policy_config *cfg;
+	struct nhc_policy_context *ctx;
+	uint32_t threshold, unmapped;
+	bool result = true;
+	uint32_t i;
+
+	cfg = (struct nhc_promotion_policy_config*)policy->config;
+	ctx = policy->ctx;
+
+	if (req->data_admit_trickle)
+		threshold = cfg->trickle_threshold;
+	else if (cfg->doorkeeper)
+		threshold = 2;
+	else
+		threshold = 0;
+
+	for (i = 0; i < req->core_line_count; i++) {
+		struct ocf_map_info *entry = &(req->map[i]);
+		uint64_t hash = ocf_freq_sketch_hash(entry->core_id,
+				entry->core_line);
+
+		if (ocf_freq_sketch_estimate(ctx->sketch, hash) < threshold)
+			result = false;
+	}
+
+	/* Same as nhit - do not reject partially hit requests */
+	if (!result && !ocf_engine_mapped_count(req))
+		return false;
+
+	unmapped = ocf_engine_unmapped_count(req);
+
+	/* Request larger than burst would never fit in the bucket, charge
+	 * it full burst instead */
+	return ocf_token_bucket_take(&ctx->budget,
+			OCF_MIN((uint64_t)unmapped * ocf_line_size(req->cache),
+				ocf_token_bucket_burst(&ctx->budget)));
+}
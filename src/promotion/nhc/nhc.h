@@ -0,0 +1,33 @@
+/*
+ * Copyright(c) 2019-2020 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef NHC_PROMOTION_POLICY_H_
+#define NHC_PROMOTION_POLICY_H_
+
+#include "ocf/ocf.h"
+#include "../../ocf_request.h"
+#include "../promotion.h"
+#include "nhc_structs.h"
+
+void nhc_setup(ocf_cache_t cache);
+
+ocf_error_t nhc_init(ocf_cache_t cache);
+
+void nhc_deinit(ocf_promotion_policy_t policy);
+
+ocf_error_t nhc_set_param(ocf_cache_t cache, uint8_t param_id,
+		uint32_t param_value);
+
+ocf_error_t nhc_get_param(ocf_cache_t cache, uint8_t param_id,
+		uint32_t *param_value);
+
+void nhc_set_write_rate(ocf_promotion_policy_t policy, uint64_t rate);
+
+void nhc_req_access(ocf_promotion_policy_t policy, struct ocf_request *req);
+
+bool nhc_req_should_promote(ocf_promotion_policy_t policy,
+		struct ocf_request *req);
+
+#endif /* NHC_PROMOTION_POLICY_H_ */
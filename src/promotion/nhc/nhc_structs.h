@@ -0,0 +1,19 @@
+/*
+ * Copyright(c) 2012-2020 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+#ifndef __PROMOTION_NHC_STRUCTS_H_
+#define __PROMOTION_NHC_STRUCTS_H_
+
+struct nhc_promotion_policy_config {
+	uint32_t doorkeeper;
+	/*!< Reject first access to core line */
+
+	uint32_t write_budget;
+	/*!< Cache write bandwidth for promotions (MiB/s) */
+
+	uint32_t trickle_threshold;
+	/*!< Estimated accesses required while data_admit trickles */
+};
+
+#endif
@@ -41,11 +41,19 @@ struct promotion_policy_ops {
 			uint32_t *param_value);
 		/*!< Get promotion policy parameter */
 
+	void (*set_write_rate)(ocf_promotion_policy_t policy, uint64_t rate);
+		/*!< Change promotion write budget without resetting it */
+
 	void (*req_purge)(ocf_promotion_policy_t policy,
 			struct ocf_request *req);
 		/*!< Call when request core lines have been inserted or it is
 		 * a discard request */
 
+	void (*req_access)(ocf_promotion_policy_t policy,
+			struct ocf_request *req);
+		/*!< Record access to request core lines, called for every
+		 * request asked about promotion before any admission check */
+
 	bool (*req_should_promote)(ocf_promotion_policy_t policy,
 			struct ocf_request *req);
 		/*!< Should request lines be inserted into cache */
@@ -8,6 +8,9 @@
 #include "promotion.h"
 #include "ops.h"
 #include "nhit/nhit.h"
+#include "tinylfu/tinylfu.h"
+#include "nhc/nhc.h"
+#include "../engine/cache_engine.h"
 
 struct promotion_policy_ops ocf_promotion_policies[ocf_promotion_max] = {
 	[ocf_promotion_always] = {
@@ -23,6 +26,26 @@ struct promotion_policy_ops ocf_promotion_policies[ocf_promotion_max] = {
 		.req_purge = nhit_req_purge,
 		.req_should_promote = nhit_req_should_promote,
 	},
+	[ocf_promotion_tinylfu] = {
+		.name = "tinylfu",
+		.setup = tinylfu_setup,
+		.init = tinylfu_init,
+		.deinit = tinylfu_deinit,
+		.set_param = tinylfu_set_param,
+		.get_param = tinylfu_get_param,
+		.req_should_promote = tinylfu_req_should_promote,
+	},
+	[ocf_promotion_nhc] = {
+		.name = "nhc",
+		.setup = nhc_setup,
+		.init = nhc_init,
+		.deinit = nhc_deinit,
+		.set_param = nhc_set_param,
+		.get_param = nhc_get_param,
+		.set_write_rate = nhc_set_write_rate,
+		.req_access = nhc_req_access,
+		.req_should_promote = nhc_req_should_promote,
+	},
 };
 
 ocf_error_t ocf_promotion_init(ocf_cache_t cache, ocf_promotion_t type)
@@ -145,6 +168,25 @@ ocf_error_t ocf_promotion_get_param(ocf_cache_t cache, ocf_promotion_t type,
 	return result;
 }
 
+void ocf_promotion_set_write_rate(ocf_cache_t cache, uint64_t rate)
+{
+	ocf_promotion_policy_t policy = cache->promotion_policy;
+	ocf_promotion_t type;
+	env_atomic *reader;
+
+	/* Policy switch takes exclusive access, so shared one is enough
+	 * to keep policy context alive */
+	reader = ocf_metadata_start_shared_access(&cache->metadata.lock);
+
+	type = policy->type;
+	ENV_BUG_ON(type >= ocf_promotion_max);
+
+	if (ocf_promotion_policies[type].set_write_rate)
+		ocf_promotion_policies[type].set_write_rate(policy, rate);
+
+	ocf_metadata_end_shared_access(&cache->metadata.lock, reader);
+}
+
 void ocf_promotion_req_purge(ocf_promotion_policy_t policy,
 		struct ocf_request *req)
 {
@@ -164,6 +206,17 @@ bool ocf_promotion_req_should_promote(ocf_promotion_policy_t policy,
 
 	ENV_BUG_ON(type >= ocf_promotion_max);
 
+	/* Access is recorded also for requests rejected by data_admit, so
+	 * that frequency is known once admission trickles */
+	if (ocf_promotion_policies[type].req_access)
+		ocf_promotion_policies[type].req_access(policy, req);
+
+	/* Multi-factor reads promote only while monitor allows it */
+	if (req->rw == OCF_READ && ocf_req_cache_mode_is_mf(req->cache_mode) &&
+			!req->data_admit_allowed) {
+		return false;
+	}
+
 	if (ocf_promotion_policies[type].req_should_promote) {
 		result = ocf_promotion_policies[type].req_should_promote(policy,
 				req);
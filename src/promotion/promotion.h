@@ -10,7 +10,7 @@
 #include "../ocf_request.h"
 
 #define PROMOTION_POLICY_CONFIG_BYTES 256
-#define PROMOTION_POLICY_TYPE_MAX 2
+#define PROMOTION_POLICY_TYPE_MAX 4
 
 
 struct promotion_policy_config {
@@ -85,6 +85,17 @@ ocf_error_t ocf_promotion_set_param(ocf_cache_t cache, ocf_promotion_t type,
 ocf_error_t ocf_promotion_get_param(ocf_cache_t cache, ocf_promotion_t type,
 		uint8_t param_id, uint32_t *param_value);
 
+/**
+ * @brief Change promotion write budget of policy in use, for internal
+ * tuning. Unlike ocf_promotion_set_param() it neither requires exclusive
+ * metadata access nor refills the budget, and configuration is left as set
+ * by the user.
+ *
+ * @param[in] cache cache handle
+ * @param[in] rate write budget in bytes per second, 0 means unlimited
+ */
+void ocf_promotion_set_write_rate(ocf_cache_t cache, uint64_t rate);
+
 /**
  * @brief Update promotion policy after cache lines have been promoted to cache
  * or discarded from core device
@@ -0,0 +1,224 @@
+/*
+ * Copyright(c) 2019-2020 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include "../../metadata/metadata.h"
+#include "../../ocf_priv.h"
+#include "../../engine/engine_common.h"
+#include "../../utils/utils_freq_sketch.h"
+
+#include "tinylfu.h"
+#include "../ops.h"
+
+/*
+ * TinyLFU admission filter: line is promoted once its access frequency,
+ * estimated by count-min sketch (see utils_freq_sketch.c), reaches the
+ * insertion threshold.
+ */
+
+/* Sketch counters per tracked cache line, in each row */
+#define TINYLFU_WIDTH_RATIO 1
+
+struct tinylfu_policy_context {
+	struct ocf_freq_sketch *sketch;
+};
+
+static uint64_t tinylfu_entries(ocf_cache_t cache)
+{
+	return ocf_metadata_get_cachelines_count(cache) * TINYLFU_WIDTH_RATIO;
+}
+
+void tinylfu_setup(ocf_cache_t cache)
+{
+	struct tinylfu_promotion_policy_config *cfg;
+
+	cfg = (void *) &cache->conf_meta->promotion[ocf_promotion_tinylfu].data;
+
+	cfg->insertion_threshold = OCF_TINYLFU_THRESHOLD_DEFAULT;
+	cfg->trigger_threshold = OCF_TINYLFU_TRIGGER_DEFAULT;
+}
+
+ocf_error_t tinylfu_init(ocf_cache_t cache)
+{
+	struct tinylfu_policy_context *ctx;
+	uint64_t available, size;
+	int result = 0;
+
+	size = sizeof(*ctx) + ocf_freq_sketch_sizeof(tinylfu_entries(cache));
+	available = env_get_free_memory();
+
+	if (size >= available) {
+		ocf_cache_log(cache, log_err, "Not enough memory to "
+				"initialize 'tinylfu' promotion policy! "
+				"Required %lu, available %lu\n",
+				(long unsigned)size,
+				(long unsigned)available);
+
+		return -OCF_ERR_NO_FREE_RAM;
+	}
+
+	ctx = env_vzalloc(sizeof(*ctx));
+	if (!ctx) {
+		result = -OCF_ERR_NO_MEM;
+		goto exit;
+	}
+
+	ctx->sketch = ocf_freq_sketch_create(tinylfu_entries(cache));
+	if (!ctx->sketch) {
+		result = -OCF_ERR_NO_MEM;
+		goto dealloc_ctx;
+	}
+
+	cache->promotion_policy->ctx = ctx;
+	cache->promotion_policy->config =
+		(void *) &cache->conf_meta->promotion[ocf_promotion_tinylfu].data;
+
+	return 0;
+
+dealloc_ctx:
+	env_vfree(ctx);
+exit:
+	ocf_cache_log(cache, log_err, "Error initializing tinylfu "
+			"promotion policy\n");
+	return result;
+}
+
+void tinylfu_deinit(ocf_promotion_policy_t policy)
+{
+	struct tinylfu_policy_context *ctx = policy->ctx;
+
+	ocf_freq_sketch_destroy(ctx->sketch);
+
+	env_vfree(ctx);
+	policy->ctx = NULL;
+}
+
+ocf_error_t tinylfu_set_param(ocf_cache_t cache, uint8_t param_id,
+		uint32_t param_value)
+{
+	struct tinylfu_promotion_policy_config *cfg;
+	ocf_error_t result = 0;
+
+	cfg = (void *) &cache->conf_meta->promotion[ocf_promotion_tinylfu].data;
+
+	switch (param_id) {
+	case ocf_tinylfu_insertion_threshold:
+		if (param_value >= OCF_TINYLFU_MIN_THRESHOLD &&
+				param_value <= OCF_TINYLFU_MAX_THRESHOLD) {
+			cfg->insertion_threshold = param_value;
+			ocf_cache_log(cache, log_info,
+					"TinyLFU PP insertion threshold value set to %u",
+					param_value);
+		} else {
+			ocf_cache_log(cache, log_err, "Invalid tinylfu "
+					"promotion policy insertion threshold!\n");
+			result = -OCF_ERR_INVAL;
+		}
+		break;
+
+	case ocf_tinylfu_trigger_threshold:
+		if (param_value >= OCF_TINYLFU_MIN_TRIGGER &&
+				param_value <= OCF_TINYLFU_MAX_TRIGGER) {
+			cfg->trigger_threshold = param_value;
+			ocf_cache_log(cache, log_info,
+					"TinyLFU PP trigger threshold value set to %u%%\n",
+					param_value);
+		} else {
+			ocf_cache_log(cache, log_err, "Invalid tinylfu "
+					"promotion policy insertion trigger "
+					"threshold!\n");
+			result = -OCF_ERR_INVAL;
+		}
+		break;
+
+	default:
+		ocf_cache_log(cache, log_err, "Invalid tinylfu "
+				"promotion policy parameter (%u)!\n",
+				param_id);
+		result = -OCF_ERR_INVAL;
+
+		break;
+	}
+
+	return result;
+}
+
+ocf_error_t tinylfu_get_param(ocf_cache_t cache, uint8_t param_id,
+		uint32_t *param_value)
+{
+	struct tinylfu_promotion_policy_config *cfg;
+	ocf_error_t result = 0;
+
+	cfg = (void *) &cache->conf_meta->promotion[ocf_promotion_tinylfu].data;
+
+	OCF_CHECK_NULL(param_value);
+
+	switch (param_id) {
+	case ocf_tinylfu_insertion_threshold:
+		*param_value = cfg->insertion_threshold;
+		break;
+	case ocf_tinylfu_trigger_threshold:
+		*param_value = cfg->trigger_threshold;
+		break;
+	default:
+		ocf_cache_log(cache, log_err, "Invalid tinylfu "
+				"promotion policy parameter (%u)!\n",
+				param_id);
+		result = -OCF_ERR_INVAL;
+
+		break;
+	}
+
+	return result;
+}
+
+static bool core_line_should_promote(ocf_promotion_policy_t policy,
+		ocf_core_id_t core_id, uint64_t core_lba)
+{
+	struct tinylfu_promotion_policy_config *cfg;
+	struct tinylfu_policy_context *ctx;
+	uint64_t hash;
+
+	cfg = (struct tinylfu_promotion_policy_config*)policy->config;
+	ctx = policy->ctx;
+
+	hash = ocf_freq_sketch_hash(core_id, core_lba);
+	ocf_freq_sketch_record(ctx->sketch, hash);
+
+	return ocf_freq_sketch_estimate(ctx->sketch, hash) >=
+			cfg->insertion_threshold;
+}
+
+bool tinylfu_req_should_promote(ocf_promotion_policy_t policy,
+		struct ocf_request *req)
+{
+	struct tinylfu_promotion_policy_config *cfg;
+	bool result = true;
+	uint32_t i;
+	uint64_t core_line;
+	uint64_t occupied_cachelines =
+		ocf_metadata_collision_table_entries(policy->owner) -
+		ocf_freelist_num_free(policy->owner->freelist);
+
+	cfg = (struct tinylfu_promotion_policy_config*)policy->config;
+
+	if (occupied_cachelines < OCF_DIV_ROUND_UP(
+			((uint64_t)cfg->trigger_threshold *
+			ocf_metadata_get_cachelines_count(policy->owner)), 100)) {
+		return true;
+	}
+
+	for (i = 0, core_line = req->core_line_first;
+			core_line <= req->core_line_last; core_line++, i++) {
+		struct ocf_map_info *entry = &(req->map[i]);
+
+		if (!core_line_should_promote(policy, entry->core_id,
+					entry->core_line)) {
+			result = false;
+		}
+	}
+
+	/* Same as nhit - do not reject partially hit requests */
+	return result || ocf_engine_mapped_count(req);
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright(c) 2019-2020 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef TINYLFU_PROMOTION_POLICY_H_
+#define TINYLFU_PROMOTION_POLICY_H_
+
+#include "ocf/ocf.h"
+#include "../../ocf_request.h"
+#include "../promotion.h"
+#include "tinylfu_structs.h"
+
+void tinylfu_setup(ocf_cache_t cache);
+
+ocf_error_t tinylfu_init(ocf_cache_t cache);
+
+void tinylfu_deinit(ocf_promotion_policy_t policy);
+
+ocf_error_t tinylfu_set_param(ocf_cache_t cache, uint8_t param_id,
+		uint32_t param_value);
+
+ocf_error_t tinylfu_get_param(ocf_cache_t cache, uint8_t param_id,
+		uint32_t *param_value);
+
+bool tinylfu_req_should_promote(ocf_promotion_policy_t policy,
+		struct ocf_request *req);
+
+#endif /* TINYLFU_PROMOTION_POLICY_H_ */
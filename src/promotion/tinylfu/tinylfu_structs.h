@@ -0,0 +1,16 @@
+/*
+ * Copyright(c) 2012-2020 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+#ifndef __PROMOTION_TINYLFU_STRUCTS_H_
+#define __PROMOTION_TINYLFU_STRUCTS_H_
+
+struct tinylfu_promotion_policy_config {
+	uint32_t insertion_threshold;
+	/*!< Estimated number of accesses */
+
+	uint32_t trigger_threshold;
+	/*!< Cache occupancy (percentage value) */
+};
+
+#endif
@@ -4,6 +4,7 @@
  */
 
 #include "utils_cache_line.h"
+#include "utils_dirty_index.h"
 #include "../promotion/promotion.h"
 
 static inline void ocf_cleaning_set_hot_cache_line(struct ocf_cache *cache,
@@ -129,6 +130,8 @@ void set_cache_line_clean(struct ocf_cache *cache, uint8_t start_bit,
 			env_atomic_dec(&req->core->runtime_meta->
 					part_counters[part_id].dirty_clines);
 
+			ocf_dirty_index_unmark(cache, line);
+
 			if (likely(evict_policy_ops[evp_type].clean_cline))
 				evict_policy_ops[evp_type].clean_cline(cache, part_id, line);
 
@@ -169,6 +172,8 @@ void set_cache_line_dirty(struct ocf_cache *cache, uint8_t start_bit,
 			env_atomic_inc(&req->core->runtime_meta->
 					part_counters[part_id].dirty_clines);
 
+			ocf_dirty_index_mark(cache, line);
+
 			if (likely(evict_policy_ops[evp_type].dirty_cline))
 				evict_policy_ops[evp_type].dirty_cline(cache, part_id, line);
 		}
@@ -528,6 +528,99 @@ error:
 	_ocf_cleaner_set_error(req);
 }
 
+static void _ocf_cleaner_core_run_io_cmpl(struct ocf_io *io, int error)
+{
+	struct ocf_map_info *map = io->priv1;
+	struct ocf_request *req = io->priv2;
+	ocf_core_t core = ocf_cache_get_core(req->cache, map->core_id);
+	uint32_t i;
+
+	if (error) {
+		/* Run length is not known here, keep all lines of the core
+		 * dirty, same as on core flush error */
+		for (i = 0; i < req->core_line_count; i++) {
+			if (req->map[i].core_id == map->core_id)
+				req->map[i].invalid = true;
+		}
+
+		_ocf_cleaner_set_error(req);
+		ocf_core_stats_core_error_update(core, OCF_WRITE);
+	}
+
+	_ocf_cleaner_core_io_end(req);
+
+	ocf_io_put(io);
+}
+
+/*
+ * Single core write for run of fully dirty lines, consecutive both on core
+ * and in request data buffer
+ */
+static void _ocf_cleaner_core_io_for_run(struct ocf_request *req,
+		struct ocf_map_info *iter, uint32_t count)
+{
+	ocf_cache_t cache = req->cache;
+	ocf_core_t core = ocf_cache_get_core(cache, iter->core_id);
+	ocf_part_id_t part_id = ocf_metadata_get_partition_id(cache,
+			iter->coll_idx);
+	uint64_t addr, offset, bytes;
+	struct ocf_io *io;
+	uint32_t i;
+	int err;
+
+	addr = ocf_line_size(cache) * iter->core_line;
+	offset = ocf_line_size(cache) * iter->hash;
+	bytes = (uint64_t)ocf_line_size(cache) * count;
+
+	io = ocf_new_core_io(core, req->io_queue, addr, bytes, OCF_WRITE,
+			part_id, 0);
+	if (!io)
+		goto error;
+
+	err = ocf_io_set_data(io, req->data, offset);
+	if (err) {
+		ocf_io_put(io);
+		goto error;
+	}
+
+	ocf_io_set_cmpl(io, iter, req, _ocf_cleaner_core_run_io_cmpl);
+
+	ocf_core_stats_core_block_update(core, part_id, OCF_WRITE, bytes);
+
+	OCF_DEBUG_PARAM(req->cache, "Core write, line = %llu, count = %u",
+			iter->core_line, count);
+
+	env_atomic_inc(&req->req_remaining);
+
+	ocf_volume_submit_io(io);
+
+	return;
+error:
+	for (i = 0; i < count; i++)
+		iter[i].invalid = true;
+	_ocf_cleaner_set_error(req);
+}
+
+static inline bool _ocf_cleaner_line_is_dirty_whole(ocf_cache_t cache,
+		struct ocf_map_info *iter)
+{
+	return metadata_test_valid(cache, iter->coll_idx) &&
+			metadata_test_dirty(cache, iter->coll_idx);
+}
+
+/* Can entry following run of given length be appended to the run */
+static inline bool _ocf_cleaner_run_extends(struct ocf_request *req,
+		struct ocf_map_info *first, uint32_t length)
+{
+	struct ocf_map_info *next = first + length;
+
+	return !next->invalid && next->status != LOOKUP_MISS &&
+			next->core_id == first->core_id &&
+			next->core_line == first->core_line + length &&
+			next->hash == first->hash + length &&
+			_ocf_cleaner_line_is_dirty_whole(req->cache, next);
+}
+
 static void _ocf_cleaner_core_submit_io(struct ocf_request *req,
 		struct ocf_map_info *iter)
 {
@@ -536,8 +629,7 @@ static void _ocf_cleaner_core_submit_io(struct ocf_request *req,
 	bool counting_dirty = false;
 
 	/* Check integrity of entry to be cleaned */
-	if (metadata_test_valid(cache, iter->coll_idx)
-		&& metadata_test_dirty(cache, iter->coll_idx)) {
+	if (_ocf_cleaner_line_is_dirty_whole(cache, iter)) {
 
 		_ocf_cleaner_core_io_for_dirty_range(req, iter, 0,
 				ocf_line_sectors(cache));
@@ -570,7 +662,7 @@ static void _ocf_cleaner_core_submit_io(struct ocf_request *req,
 
 static int _ocf_cleaner_fire_core(struct ocf_request *req)
 {
-	uint32_t i;
+	uint32_t i, run;
 	struct ocf_map_info *iter;
 
 	OCF_DEBUG_TRACE(req->cache);
@@ -579,8 +671,9 @@ static int _ocf_cleaner_fire_core(struct ocf_request *req)
 	env_atomic_set(&req->req_remaining, 1);
 
 	/* Submits writes to the core */
-	for (i = 0; i < req->core_line_count; i++) {
+	for (i = 0; i < req->core_line_count; i += run) {
 		iter = &(req->map[i]);
+		run = 1;
 
 		if (iter->invalid) {
 			/* IO read error on cache, skip this item */
@@ -590,7 +683,21 @@ static int _ocf_cleaner_fire_core(struct ocf_request *req)
 		if (iter->status == LOOKUP_MISS)
 			continue;
 
-		_ocf_cleaner_core_submit_io(req, iter);
+		if (!_ocf_cleaner_line_is_dirty_whole(req->cache, iter)) {
+			_ocf_cleaner_core_submit_io(req, iter);
+			continue;
+		}
+
+		/* Merge adjacent fully dirty lines into single core write */
+		while (i + run < req->core_line_count &&
+				_ocf_cleaner_run_extends(req, iter, run)) {
+			run++;
+		}
+
+		if (run == 1)
+			_ocf_cleaner_core_submit_io(req, iter);
+		else
+			_ocf_cleaner_core_io_for_run(req, iter, run);
 	}
 
 	/* Protect IO completion race */
@@ -994,8 +1101,91 @@ static void _ocf_cleaner_swap(void *a, void *b, int size)
 	*_b = t;
 }
 
+#define OCF_CLEANER_RADIX_BITS 8
+#define OCF_CLEANER_RADIX_SIZE (1 << OCF_CLEANER_RADIX_BITS)
+
+/* Core line digits first, core id digits last */
+#define OCF_CLEANER_RADIX_LINE_PASSES (sizeof(uint64_t) * 8 / \
+		OCF_CLEANER_RADIX_BITS)
+#define OCF_CLEANER_RADIX_PASSES (OCF_CLEANER_RADIX_LINE_PASSES + \
+		sizeof(ocf_core_id_t) * 8 / OCF_CLEANER_RADIX_BITS)
+
+static inline uint32_t _ocf_cleaner_radix_digit(const struct flush_data *d,
+		uint32_t pass)
+{
+	uint64_t key = d->core_line;
+
+	if (pass >= OCF_CLEANER_RADIX_LINE_PASSES) {
+		key = d->core_id;
+		pass -= OCF_CLEANER_RADIX_LINE_PASSES;
+	}
+
+	return (key >> (pass * OCF_CLEANER_RADIX_BITS)) &
+			(OCF_CLEANER_RADIX_SIZE - 1);
+}
+
+/*
+ * LSD radix sort by core id and core line. Passes in which all entries
+ * share the digit are skipped, so small core address ranges take few
+ * passes. Returns false if there is no memory for scratch table.
+ */
+static bool _ocf_cleaner_radix_sort(struct flush_data *tbl, uint32_t num)
+{
+	uint32_t count[OCF_CLEANER_RADIX_SIZE];
+	struct flush_data *src = tbl, *dst, *tmp;
+	uint32_t pass, i, digit, sum, c;
+
+	if (num < 2)
+		return true;
+
+	tmp = env_vmalloc(sizeof(*tbl) * num);
+	if (!tmp)
+		return false;
+
+	dst = tmp;
+
+	for (pass = 0; pass < OCF_CLEANER_RADIX_PASSES; pass++) {
+		ENV_BUG_ON(env_memset(count, sizeof(count), 0));
+
+		for (i = 0; i < num; i++)
+			count[_ocf_cleaner_radix_digit(&src[i], pass)]++;
+
+		if (count[_ocf_cleaner_radix_digit(&src[0], pass)] == num)
+			continue;
+
+		for (digit = 0, sum = 0; digit < OCF_CLEANER_RADIX_SIZE;
+				digit++) {
+			c = count[digit];
+			count[digit] = sum;
+			sum += c;
+		}
+
+		for (i = 0; i < num; i++) {
+			digit = _ocf_cleaner_radix_digit(&src[i], pass);
+			dst[count[digit]++] = src[i];
+		}
+
+		dst = src;
+		src = (src == tbl) ? tmp : tbl;
+
+		env_cond_resched();
+	}
+
+	if (src != tbl) {
+		ENV_BUG_ON(env_memcpy(tbl, sizeof(*tbl) * num, src,
+				sizeof(*tbl) * num));
+	}
+
+	env_vfree(tmp);
+
+	return true;
+}
+
 void ocf_cleaner_sort_sectors(struct flush_data *tbl, uint32_t num)
 {
+	if (_ocf_cleaner_radix_sort(tbl, num))
+		return;
+
 	env_sort(tbl, num, sizeof(*tbl), _ocf_cleaner_cmp, _ocf_cleaner_swap);
 }
 
@@ -1004,11 +1194,8 @@ void ocf_cleaner_sort_flush_containers(struct flush_container *fctbl,
 {
 	int i;
 
-	for (i = 0; i < num; i++) {
-		env_sort(fctbl[i].flush_data, fctbl[i].count,
-				sizeof(*fctbl[i].flush_data), _ocf_cleaner_cmp,
-				_ocf_cleaner_swap);
-	}
+	for (i = 0; i < num; i++)
+		ocf_cleaner_sort_sectors(fctbl[i].flush_data, fctbl[i].count);
 }
 
 void ocf_cleaner_refcnt_freeze(ocf_cache_t cache)
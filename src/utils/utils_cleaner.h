@@ -72,6 +72,7 @@ struct flush_container {
 	struct ocf_request *req;
 
 	uint64_t flush_portion;
+	uint32_t portion_count;
 	uint64_t ticks1;
 	uint64_t ticks2;
 
@@ -0,0 +1,123 @@
+/*
+ * Copyright(c) 2020 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include "ocf/ocf.h"
+#include "../ocf_cache_priv.h"
+#include "../metadata/metadata.h"
+#include "utils_dirty_index.h"
+
+#define DIRTY_INDEX_WORD_BITS (8 * sizeof(unsigned long))
+
+int ocf_dirty_index_init(struct ocf_cache *cache)
+{
+	struct ocf_dirty_index *index;
+	uint64_t summary_words;
+
+	index = env_vzalloc(sizeof(*index));
+	if (!index)
+		return -OCF_ERR_NO_MEM;
+
+	index->entries = cache->device->collision_table_entries;
+	index->words = OCF_DIV_ROUND_UP((uint64_t)index->entries,
+			DIRTY_INDEX_WORD_BITS);
+	summary_words = OCF_DIV_ROUND_UP(index->words, DIRTY_INDEX_WORD_BITS);
+
+	index->lines = env_vzalloc(index->words * sizeof(unsigned long));
+	if (!index->lines)
+		goto err_lines;
+
+	index->summary = env_vzalloc(summary_words * sizeof(unsigned long));
+	if (!index->summary)
+		goto err_summary;
+
+	cache->device->dirty_index = index;
+
+	return 0;
+
+err_summary:
+	env_vfree(index->lines);
+err_lines:
+	env_vfree(index);
+	return -OCF_ERR_NO_MEM;
+}
+
+void ocf_dirty_index_deinit(struct ocf_cache *cache)
+{
+	struct ocf_dirty_index *index = cache->device->dirty_index;
+
+	if (!index)
+		return;
+
+	env_vfree(index->summary);
+	env_vfree(index->lines);
+	env_vfree(index);
+	cache->device->dirty_index = NULL;
+}
+
+void ocf_dirty_index_rebuild(struct ocf_cache *cache)
+{
+	struct ocf_dirty_index *index = cache->device->dirty_index;
+	uint64_t summary_words = OCF_DIV_ROUND_UP(index->words,
+			DIRTY_INDEX_WORD_BITS);
+	ocf_cache_line_t line;
+
+	ENV_BUG_ON(env_memset(index->lines,
+			index->words * sizeof(unsigned long), 0));
+	ENV_BUG_ON(env_memset(index->summary,
+			summary_words * sizeof(unsigned long), 0));
+
+	for (line = 0; line < index->entries; line++) {
+		if (metadata_test_dirty(cache, line))
+			ocf_dirty_index_mark(cache, line);
+	}
+}
+
+/* First summary bit not lower than given word, index->words if none */
+static uint64_t ocf_dirty_index_next_word(struct ocf_dirty_index *index,
+		uint64_t word)
+{
+	uint64_t s = word / DIRTY_INDEX_WORD_BITS;
+	unsigned long bits;
+
+	if (word >= index->words)
+		return index->words;
+
+	bits = index->summary[s] & (~0UL << (word % DIRTY_INDEX_WORD_BITS));
+
+	while (!bits) {
+		if (++s * DIRTY_INDEX_WORD_BITS >= index->words)
+			return index->words;
+		bits = index->summary[s];
+	}
+
+	return s * DIRTY_INDEX_WORD_BITS + env_bit_ffs64(bits);
+}
+
+ocf_cache_line_t ocf_dirty_index_next(struct ocf_cache *cache,
+		ocf_cache_line_t line)
+{
+	struct ocf_dirty_index *index = cache->device->dirty_index;
+	uint64_t word = line / DIRTY_INDEX_WORD_BITS;
+	unsigned long bits;
+
+	if (line >= index->entries)
+		return index->entries;
+
+	bits = index->lines[word] & (~0UL << (line % DIRTY_INDEX_WORD_BITS));
+	if (bits)
+		return word * DIRTY_INDEX_WORD_BITS + env_bit_ffs64(bits);
+
+	while ((word = ocf_dirty_index_next_word(index, word + 1)) <
+			index->words) {
+		bits = index->lines[word];
+		if (bits)
+			return word * DIRTY_INDEX_WORD_BITS + env_bit_ffs64(bits);
+
+		/* All lines of the word were cleaned, drop summary bit */
+		env_bit_clear(word, index->summary);
+	}
+
+	return index->entries;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright(c) 2020 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __UTILS_DIRTY_INDEX_H__
+#define __UTILS_DIRTY_INDEX_H__
+
+#include "../ocf_cache_priv.h"
+
+/*
+ * Dirty line index - bit per cache line, set whenever line becomes dirty,
+ * plus summary bit per word of line bits. Bits are hints: line bit may
+ * stay set for line which is no longer dirty or belongs to another core,
+ * so users have to check metadata of every line they get. Summary bits
+ * are cleared only lazily by ocf_dirty_index_next(), which lets flush
+ * enumerate dirty lines in time proportional to their number.
+ */
+struct ocf_dirty_index {
+	ocf_cache_line_t entries;
+	uint64_t words;
+	unsigned long *lines;
+	unsigned long *summary;
+};
+
+int ocf_dirty_index_init(struct ocf_cache *cache);
+
+void ocf_dirty_index_deinit(struct ocf_cache *cache);
+
+/* Rebuild index from metadata, e.g. after metadata load */
+void ocf_dirty_index_rebuild(struct ocf_cache *cache);
+
+/*
+ * First marked line not lower than given one, collision_table_entries
+ * if there is none. Caller has to hold exclusive metadata access.
+ */
+ocf_cache_line_t ocf_dirty_index_next(struct ocf_cache *cache,
+		ocf_cache_line_t line);
+
+static inline void ocf_dirty_index_mark(struct ocf_cache *cache,
+		ocf_cache_line_t line)
+{
+	struct ocf_dirty_index *index = cache->device->dirty_index;
+
+	env_bit_set(line, index->lines);
+
+	if (!env_bit_test(line / (8 * sizeof(unsigned long)), index->summary))
+		env_bit_set(line / (8 * sizeof(unsigned long)), index->summary);
+}
+
+static inline void ocf_dirty_index_unmark(struct ocf_cache *cache,
+		ocf_cache_line_t line)
+{
+	env_bit_clear(line, cache->device->dirty_index->lines);
+}
+
+#endif /* __UTILS_DIRTY_INDEX_H__ */
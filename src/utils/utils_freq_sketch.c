@@ -0,0 +1,241 @@
+/*
+ * Copyright(c) 2019-2020 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include "utils_freq_sketch.h"
+
+/*
+ * Counters are halved after every FREQ_SKETCH_SAMPLE_RATIO * width
+ * recorded accesses, so that estimate is biased towards recent history.
+ * First access of a key is only recorded in doorkeeper (cleared on
+ * halving), which keeps one-hit wonders out of the sketch.
+ *
+ * Races between updates may only make estimate less precise.
+ */
+
+#define FREQ_SKETCH_DEPTH 4
+#define FREQ_SKETCH_COUNTER_BITS 4
+#define FREQ_SKETCH_COUNTER_MAX ((1 << FREQ_SKETCH_COUNTER_BITS) - 1)
+#define FREQ_SKETCH_COUNTERS_PER_WORD (64 / FREQ_SKETCH_COUNTER_BITS)
+#define FREQ_SKETCH_HALVE_MASK 0x7777777777777777ULL
+
+/* Doorkeeper bits per sketch counter */
+#define FREQ_SKETCH_DOORKEEPER_RATIO 4
+
+/* Accesses between halvings, per sketch counter */
+#define FREQ_SKETCH_SAMPLE_RATIO 10
+
+#define FREQ_SKETCH_DOORKEEPER_HASHES 2
+
+struct ocf_freq_sketch {
+	env_atomic64 *rows[FREQ_SKETCH_DEPTH];
+	env_atomic64 *counters;
+
+	unsigned long *doorkeeper;
+	uint64_t doorkeeper_mask;
+
+	/* Counters in each row - 1, row width is power of 2 */
+	uint64_t width_mask;
+
+	uint64_t sample_size;
+
+	env_atomic64 additions;
+};
+
+static uint64_t freq_sketch_width(uint64_t entries)
+{
+	uint64_t width = FREQ_SKETCH_COUNTERS_PER_WORD;
+
+	while (width < entries)
+		width <<= 1;
+
+	return width;
+}
+
+uint64_t ocf_freq_sketch_sizeof(uint64_t entries)
+{
+	uint64_t width = freq_sketch_width(entries);
+	uint64_t size = sizeof(struct ocf_freq_sketch);
+
+	size += FREQ_SKETCH_DEPTH * width / FREQ_SKETCH_COUNTERS_PER_WORD *
+			sizeof(env_atomic64);
+	size += width * FREQ_SKETCH_DOORKEEPER_RATIO / 8;
+
+	return size;
+}
+
+struct ocf_freq_sketch *ocf_freq_sketch_create(uint64_t entries)
+{
+	struct ocf_freq_sketch *sketch;
+	uint64_t width, words;
+	int i;
+
+	width = freq_sketch_width(entries);
+	words = width / FREQ_SKETCH_COUNTERS_PER_WORD;
+
+	sketch = env_vzalloc(sizeof(*sketch));
+	if (!sketch)
+		return NULL;
+
+	sketch->counters = env_vzalloc(FREQ_SKETCH_DEPTH * words *
+			sizeof(*sketch->counters));
+	if (!sketch->counters)
+		goto dealloc_sketch;
+
+	sketch->doorkeeper = env_vzalloc(width *
+			FREQ_SKETCH_DOORKEEPER_RATIO / 8);
+	if (!sketch->doorkeeper)
+		goto dealloc_counters;
+
+	for (i = 0; i < FREQ_SKETCH_DEPTH; i++)
+		sketch->rows[i] = sketch->counters + i * words;
+
+	sketch->width_mask = width - 1;
+	sketch->doorkeeper_mask = width * FREQ_SKETCH_DOORKEEPER_RATIO - 1;
+	sketch->sample_size = width * FREQ_SKETCH_SAMPLE_RATIO;
+	env_atomic64_set(&sketch->additions, 0);
+
+	return sketch;
+
+dealloc_counters:
+	env_vfree(sketch->counters);
+dealloc_sketch:
+	env_vfree(sketch);
+	return NULL;
+}
+
+void ocf_freq_sketch_destroy(struct ocf_freq_sketch *sketch)
+{
+	env_vfree(sketch->doorkeeper);
+	env_vfree(sketch->counters);
+	env_vfree(sketch);
+}
+
+/* Index of counter in given row, derived from two halves of hash */
+static inline uint64_t freq_sketch_index(struct ocf_freq_sketch *sketch,
+		uint64_t hash, int row)
+{
+	uint32_t a = hash, b = (hash >> 32) | 1;
+
+	return (a + (uint64_t)row * b) & sketch->width_mask;
+}
+
+static inline uint32_t freq_sketch_counter_get(env_atomic64 *row,
+		uint64_t idx)
+{
+	uint64_t word = env_atomic64_read(
+			&row[idx / FREQ_SKETCH_COUNTERS_PER_WORD]);
+	uint32_t shift = (idx % FREQ_SKETCH_COUNTERS_PER_WORD) *
+			FREQ_SKETCH_COUNTER_BITS;
+
+	return (word >> shift) & FREQ_SKETCH_COUNTER_MAX;
+}
+
+static inline void freq_sketch_counter_inc(env_atomic64 *row, uint64_t idx)
+{
+	env_atomic64 *word = &row[idx / FREQ_SKETCH_COUNTERS_PER_WORD];
+	uint32_t shift = (idx % FREQ_SKETCH_COUNTERS_PER_WORD) *
+			FREQ_SKETCH_COUNTER_BITS;
+	long old, new;
+
+	do {
+		old = env_atomic64_read(word);
+		if (((old >> shift) & FREQ_SKETCH_COUNTER_MAX) ==
+				FREQ_SKETCH_COUNTER_MAX) {
+			return;
+		}
+		new = old + (1L << shift);
+	} while (env_atomic64_cmpxchg(word, old, new) != old);
+}
+
+static inline uint64_t freq_sketch_doorkeeper_bit(
+		struct ocf_freq_sketch *sketch, uint64_t hash, int i)
+{
+	return ((hash >> (i * 21)) ^ (hash >> 42)) & sketch->doorkeeper_mask;
+}
+
+static bool freq_sketch_doorkeeper_test(struct ocf_freq_sketch *sketch,
+		uint64_t hash)
+{
+	int i;
+
+	for (i = 0; i < FREQ_SKETCH_DOORKEEPER_HASHES; i++) {
+		if (!env_bit_test(freq_sketch_doorkeeper_bit(sketch, hash, i),
+				sketch->doorkeeper)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void freq_sketch_doorkeeper_set(struct ocf_freq_sketch *sketch,
+		uint64_t hash)
+{
+	int i;
+
+	for (i = 0; i < FREQ_SKETCH_DOORKEEPER_HASHES; i++)
+		env_bit_set(freq_sketch_doorkeeper_bit(sketch, hash, i),
+				sketch->doorkeeper);
+}
+
+/* Halve all counters and clear doorkeeper */
+static void freq_sketch_reset(struct ocf_freq_sketch *sketch)
+{
+	uint64_t words = FREQ_SKETCH_DEPTH * (sketch->width_mask + 1) /
+			FREQ_SKETCH_COUNTERS_PER_WORD;
+	env_atomic64 *word;
+	uint64_t i;
+	long old;
+
+	for (i = 0; i < words; i++) {
+		word = &sketch->counters[i];
+		do {
+			old = env_atomic64_read(word);
+		} while (env_atomic64_cmpxchg(word, old,
+				(old >> 1) & FREQ_SKETCH_HALVE_MASK) != old);
+	}
+
+	ENV_BUG_ON(env_memset(sketch->doorkeeper,
+			(sketch->doorkeeper_mask + 1) / 8, 0));
+}
+
+void ocf_freq_sketch_record(struct ocf_freq_sketch *sketch, uint64_t hash)
+{
+	long additions;
+	int i;
+
+	if (!freq_sketch_doorkeeper_test(sketch, hash)) {
+		freq_sketch_doorkeeper_set(sketch, hash);
+	} else {
+		for (i = 0; i < FREQ_SKETCH_DEPTH; i++) {
+			freq_sketch_counter_inc(sketch->rows[i],
+					freq_sketch_index(sketch, hash, i));
+		}
+	}
+
+	additions = env_atomic64_inc_return(&sketch->additions);
+	if (additions != sketch->sample_size)
+		return;
+
+	/* Only the thread which hit sample size halves the sketch */
+	freq_sketch_reset(sketch);
+	env_atomic64_sub(additions, &sketch->additions);
+}
+
+uint32_t ocf_freq_sketch_estimate(struct ocf_freq_sketch *sketch,
+		uint64_t hash)
+{
+	uint32_t freq = FREQ_SKETCH_COUNTER_MAX, counter;
+	int i;
+
+	for (i = 0; i < FREQ_SKETCH_DEPTH; i++) {
+		counter = freq_sketch_counter_get(sketch->rows[i],
+				freq_sketch_index(sketch, hash, i));
+		if (counter < freq)
+			freq = counter;
+	}
+
+	return freq + freq_sketch_doorkeeper_test(sketch, hash);
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright(c) 2019-2020 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef UTILS_FREQ_SKETCH_H_
+#define UTILS_FREQ_SKETCH_H_
+
+#include "ocf/ocf.h"
+#include "ocf_env.h"
+
+/*
+ * Access frequency estimator: 4 bit count-min sketch with doorkeeper
+ * bloom filter and periodic halving (TinyLFU). Lock free.
+ */
+struct ocf_freq_sketch;
+
+/* Maximum value returned by ocf_freq_sketch_estimate() */
+#define OCF_FREQ_SKETCH_MAX 16
+
+uint64_t ocf_freq_sketch_sizeof(uint64_t entries);
+
+struct ocf_freq_sketch *ocf_freq_sketch_create(uint64_t entries);
+
+void ocf_freq_sketch_destroy(struct ocf_freq_sketch *sketch);
+
+static inline uint64_t ocf_freq_sketch_hash(ocf_core_id_t core_id,
+		uint64_t core_line)
+{
+	uint64_t h = core_line ^ ((uint64_t)core_id << 56);
+
+	/* 64 bit finalizer of MurmurHash3 */
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+
+	return h;
+}
+
+void ocf_freq_sketch_record(struct ocf_freq_sketch *sketch, uint64_t hash);
+
+uint32_t ocf_freq_sketch_estimate(struct ocf_freq_sketch *sketch,
+		uint64_t hash);
+
+#endif /* UTILS_FREQ_SKETCH_H_ */
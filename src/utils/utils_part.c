@@ -190,3 +190,160 @@ void ocf_part_set_valid(struct ocf_cache *cache, ocf_part_id_t id,
 		}
 	}
 }
+
+void ocf_part_reset_targets(struct ocf_cache *cache)
+{
+	ocf_part_id_t part_id;
+
+	for (part_id = 0; part_id < OCF_IO_CLASS_MAX; part_id++) {
+		cache->user_parts[part_id].runtime->target_size =
+				PARTITION_SIZE_MAX;
+	}
+}
+
+/* Miss ratio (x 10000) of partition given number of curve steps */
+static inline uint32_t ocf_part_miss_ratio(struct ocf_stats_mrc *mrc,
+		uint32_t chunks)
+{
+	return chunks ? mrc->miss_ratio[chunks - 1] : 10000;
+}
+
+/*
+ * Compute partition target sizes minimizing total number of misses, using
+ * miss ratio curves of partitions weighted by their estimated number
+ * of accesses. Cache is divided in curve steps, each partition starts
+ * at its min size and steps are handed out greedily with lookahead:
+ * the partition gaining most misses per step over any extension within
+ * its max size gets the whole extension, so partitions with a cliff in
+ * their curve are not starved.
+ *
+ * Runs without exclusive metadata access, the targets are published by
+ * ocf_part_rebalance_commit(). Returns false if rebalance is not due.
+ */
+bool ocf_part_rebalance_prepare(struct ocf_cache *cache,
+		uint32_t target[OCF_IO_CLASS_MAX])
+{
+	uint32_t alloc[OCF_IO_CLASS_MAX] = { 0 };
+	uint32_t limit[OCF_IO_CLASS_MAX] = { 0 };
+	uint64_t weight[OCF_IO_CLASS_MAX] = { 0 };
+	struct ocf_stats_mrc *mrc;
+	struct ocf_user_part *part;
+	ocf_part_id_t part_id, best_id = 0;
+	uint64_t now, lines, step, chunks, used = 0;
+	uint64_t gain, best_gain;
+	uint32_t mr, j, best_chunks = 0;
+	env_atomic *reader;
+
+	if (!ocf_part_is_balanced(cache))
+		return false;
+
+	now = env_get_time_ns();
+	if (cache->part_balance.last_ns && now - cache->part_balance.last_ns <
+			cache->part_balance.interval_ms * 1000000ULL) {
+		return false;
+	}
+	cache->part_balance.last_ns = now;
+
+	mrc = env_vzalloc_flags(sizeof(*mrc) * OCF_IO_CLASS_MAX, ENV_MEM_NOIO);
+	if (!mrc)
+		return false;
+
+	lines = ocf_metadata_get_cachelines_count(cache);
+	step = OCF_MAX(lines / OCF_STATS_MRC_POINTS, 1);
+	chunks = lines / step;
+
+	/* Partition configuration changes under exclusive access */
+	reader = ocf_metadata_start_shared_access(&cache->metadata.lock);
+
+	for_each_part(cache, part, part_id) {
+		if (!ocf_part_is_valid(part))
+			continue;
+
+		if (!part->config->flags.eviction) {
+			/* Pinned, keeps whatever it has */
+			used += OCF_DIV_ROUND_UP(part->runtime->curr_size, step);
+			continue;
+		}
+
+		/* Curve has OCF_STATS_MRC_POINTS steps, min size beyond it is
+		 * accounted for, but not indexed in the curve */
+		used += OCF_DIV_ROUND_UP(part->config->min_size, step);
+		alloc[part_id] = OCF_MIN(OCF_DIV_ROUND_UP(
+				part->config->min_size, step),
+				OCF_STATS_MRC_POINTS);
+		limit[part_id] = OCF_MIN(part->config->max_size / step,
+				OCF_STATS_MRC_POINTS);
+
+		ocf_stats_collect_mrc_part(cache, part_id, step, &mrc[part_id]);
+		if (mrc[part_id].sample_rate) {
+			weight[part_id] = mrc[part_id].samples * 1000000 /
+					mrc[part_id].sample_rate;
+		}
+	}
+
+	ocf_metadata_end_shared_access(&cache->metadata.lock, reader);
+
+	while (used < chunks) {
+		best_gain = 0;
+
+		for (part_id = 0; part_id < OCF_IO_CLASS_MAX; part_id++) {
+			if (!weight[part_id])
+				continue;
+
+			mr = ocf_part_miss_ratio(&mrc[part_id], alloc[part_id]);
+
+			for (j = alloc[part_id] + 1; j <= limit[part_id] &&
+					used + j - alloc[part_id] <= chunks; j++) {
+				if (ocf_part_miss_ratio(&mrc[part_id], j) >= mr)
+					continue;
+
+				gain = weight[part_id] * (mr -
+					ocf_part_miss_ratio(&mrc[part_id], j)) /
+					(j - alloc[part_id]);
+				if (gain > best_gain) {
+					best_gain = gain;
+					best_id = part_id;
+					best_chunks = j - alloc[part_id];
+				}
+			}
+		}
+
+		if (!best_gain)
+			break;
+
+		alloc[best_id] += best_chunks;
+		used += best_chunks;
+	}
+
+	for (part_id = 0; part_id < OCF_IO_CLASS_MAX; part_id++)
+		target[part_id] = alloc[part_id] * step;
+
+	env_vfree(mrc);
+
+	return true;
+}
+
+/*
+ * Publish partition target sizes computed by ocf_part_rebalance_prepare().
+ * Caller holds exclusive metadata access, configuration of partitions is
+ * checked again as it might have changed in between.
+ */
+void ocf_part_rebalance_commit(struct ocf_cache *cache,
+		const uint32_t target[OCF_IO_CLASS_MAX])
+{
+	struct ocf_user_part *part;
+	ocf_part_id_t part_id;
+
+	for_each_part(cache, part, part_id) {
+		if (!ocf_part_is_valid(part)) {
+			/* Leftovers of removed IO class go first */
+			part->runtime->target_size = 0;
+		} else if (!part->config->flags.eviction) {
+			/* Pinned, keeps whatever it has */
+			part->runtime->target_size = PARTITION_SIZE_MAX;
+		} else {
+			part->runtime->target_size = OCF_MAX(target[part_id],
+					part->config->min_size);
+		}
+	}
+}
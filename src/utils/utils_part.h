@@ -52,6 +52,19 @@ static inline ocf_part_id_t ocf_part_class2id(ocf_cache_t cache, uint64_t class)
 
 void ocf_part_move(struct ocf_request *req);
 
+void ocf_part_reset_targets(struct ocf_cache *cache);
+
+bool ocf_part_rebalance_prepare(struct ocf_cache *cache,
+		uint32_t target[OCF_IO_CLASS_MAX]);
+
+void ocf_part_rebalance_commit(struct ocf_cache *cache,
+		const uint32_t target[OCF_IO_CLASS_MAX]);
+
+static inline bool ocf_part_is_balanced(struct ocf_cache *cache)
+{
+	return !!cache->part_balance.interval_ms;
+}
+
 #define for_each_part(cache, part, id) \
 	for_each_lst_entry(&cache->lst_part, part, id, \
 		struct ocf_user_part, lst_valid)
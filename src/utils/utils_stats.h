@@ -47,4 +47,45 @@ static inline void _set(struct ocf_stat *stat, uint64_t value,
     stat->fraction = _fraction(value, denominator);
 }
 
+/*
+ * Log-linear histogram with OCF_STATS_LAT_BUCKETS buckets: each power of
+ * two is split into 2^OCF_STATS_LAT_SUB_BITS equal buckets.
+ */
+static inline uint32_t _log_bucket(uint64_t value)
+{
+    const uint64_t linear = 1ULL << (OCF_STATS_LAT_SUB_BITS + 1);
+    const uint64_t max = (1ULL << (OCF_STATS_LAT_MAX_EXP + 1)) - 1;
+    uint32_t exp, sub;
+
+    if (value < linear)
+        return value;
+
+    if (value > max)
+        value = max;
+
+    exp = env_bit_fls64(value);
+    sub = (value >> (exp - OCF_STATS_LAT_SUB_BITS)) &
+            ((1 << OCF_STATS_LAT_SUB_BITS) - 1);
+
+    return ((exp - OCF_STATS_LAT_SUB_BITS + 1) << OCF_STATS_LAT_SUB_BITS) +
+            sub;
+}
+
+/* Lower bound of values falling into given bucket */
+static inline uint64_t _log_bucket_value(uint32_t bucket)
+{
+    uint32_t exp, sub;
+
+    if (bucket < (1 << (OCF_STATS_LAT_SUB_BITS + 1)))
+        return bucket;
+
+    if (bucket >= OCF_STATS_LAT_BUCKETS)
+        bucket = OCF_STATS_LAT_BUCKETS - 1;
+
+    exp = (bucket >> OCF_STATS_LAT_SUB_BITS) + OCF_STATS_LAT_SUB_BITS - 1;
+    sub = bucket & ((1 << OCF_STATS_LAT_SUB_BITS) - 1);
+
+    return (1ULL << exp) + ((uint64_t)sub << (exp - OCF_STATS_LAT_SUB_BITS));
+}
+
 #endif
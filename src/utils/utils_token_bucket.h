@@ -0,0 +1,114 @@
+/*
+ * Copyright(c) 2012-2020 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef UTILS_TOKEN_BUCKET_H_
+#define UTILS_TOKEN_BUCKET_H_
+
+#include "ocf_env.h"
+#include "../ocf_def_priv.h"
+
+/*
+ * Lock free token bucket. Tokens are refilled lazily by the caller which
+ * manages to advance refill timestamp, rate of 0 means unlimited.
+ */
+struct ocf_token_bucket {
+	env_atomic64 tokens;
+	env_atomic64 last_ns;
+	env_atomic64 rate;
+	/*!< Tokens per second */
+	env_atomic64 burst;
+	/*!< Bucket capacity */
+};
+
+static inline void ocf_token_bucket_init(struct ocf_token_bucket *tb,
+		uint64_t rate, uint64_t burst)
+{
+	env_atomic64_set(&tb->rate, rate);
+	env_atomic64_set(&tb->burst, burst);
+	env_atomic64_set(&tb->tokens, burst);
+	env_atomic64_set(&tb->last_ns, env_get_time_ns());
+}
+
+static inline uint64_t ocf_token_bucket_rate(struct ocf_token_bucket *tb)
+{
+	return env_atomic64_read(&tb->rate);
+}
+
+static inline uint64_t ocf_token_bucket_burst(struct ocf_token_bucket *tb)
+{
+	return env_atomic64_read(&tb->burst);
+}
+
+static inline void ocf_token_bucket_refill(struct ocf_token_bucket *tb)
+{
+	uint64_t now = env_get_time_ns();
+	uint64_t last = env_atomic64_read(&tb->last_ns);
+	uint64_t delta, add, burst;
+	long old, new;
+
+	if (now <= last)
+		return;
+
+	/* Cap at 1s, bucket is full anyway by then for any sane burst */
+	delta = OCF_MIN(now - last, 1000000000ULL);
+	add = delta * ocf_token_bucket_rate(tb) / 1000000000ULL;
+	if (!add)
+		return;
+
+	if (env_atomic64_cmpxchg(&tb->last_ns, last, now) != last)
+		return;
+
+	burst = env_atomic64_read(&tb->burst);
+	do {
+		old = env_atomic64_read(&tb->tokens);
+		new = OCF_MIN((uint64_t)old + add, burst);
+	} while (env_atomic64_cmpxchg(&tb->tokens, old, new) != old);
+}
+
+/*
+ * Change rate and capacity of bucket in use. Tokens already in the bucket
+ * are kept (up to new capacity), so frequent updates do not refill it.
+ */
+static inline void ocf_token_bucket_set_rate(struct ocf_token_bucket *tb,
+		uint64_t rate, uint64_t burst)
+{
+	long old, new;
+
+	/* Credit time passed so far at the old rate */
+	if (ocf_token_bucket_rate(tb))
+		ocf_token_bucket_refill(tb);
+	else
+		env_atomic64_set(&tb->last_ns, env_get_time_ns());
+
+	env_atomic64_set(&tb->burst, burst);
+	env_atomic64_set(&tb->rate, rate);
+
+	do {
+		old = env_atomic64_read(&tb->tokens);
+		new = OCF_MIN((uint64_t)old, burst);
+	} while (env_atomic64_cmpxchg(&tb->tokens, old, new) != old);
+}
+
+/* Take given amount of tokens, all or nothing */
+static inline bool ocf_token_bucket_take(struct ocf_token_bucket *tb,
+		uint64_t amount)
+{
+	long old;
+
+	if (!ocf_token_bucket_rate(tb))
+		return true;
+
+	ocf_token_bucket_refill(tb);
+
+	do {
+		old = env_atomic64_read(&tb->tokens);
+		if ((uint64_t)old < amount)
+			return false;
+	} while (env_atomic64_cmpxchg(&tb->tokens, old, old - amount) != old);
+
+	return true;
+}
+
+#endif /* UTILS_TOKEN_BUCKET_H_ */
@@ -59,6 +59,7 @@ class RequestsStats(Structure):
         ("wr_pt", _Stat),
         ("serviced", _Stat),
         ("total", _Stat),
+        ("rd_offloadable_hits", _Stat),
     ]
 
 
@@ -0,0 +1,119 @@
+/*
+ * <tested_file_path>src/cleaning/cleaning.c</tested_file_path>
+ * <tested_function>ocf_cleaner_set_pace_rate</tested_function>
+ * <functions_to_leave>
+ *	_ocf_cleaner_pace_burst
+ *	ocf_cleaner_set_rate_limit
+ *	ocf_cleaner_is_paced
+ *	ocf_cleaner_pace
+ *	ocf_cleaner_pace_consume
+ *	ocf_cleaner_pace_delay
+ *	ocf_token_bucket_init
+ *	ocf_token_bucket_rate
+ *	ocf_token_bucket_refill
+ *	ocf_token_bucket_set_rate
+ *	ocf_token_bucket_take
+ * </functions_to_leave>
+ */
+
+#undef static
+
+#undef inline
+
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include "print_desc.h"
+
+#include "cleaning.h"
+#include "../ocf_cache_priv.h"
+#include "../metadata/metadata.h"
+#include "../utils/utils_token_bucket.h"
+
+#include "cleaning/cleaning.c/ocf_cleaner_set_pace_rate_generated_wraps.c"
+
+#define LINE_SIZE 4096
+#define MIB_LINES (MiB / LINE_SIZE)
+
+ocf_cache_line_size_t __wrap_ocf_line_size(struct ocf_cache *cache)
+{
+	return LINE_SIZE;
+}
+
+static void ocf_cleaner_set_pace_rate_test01(void **state)
+{
+	ocf_cache_t cache = test_calloc(1, sizeof(*cache));
+
+	print_test_description("Zero rate does not pace cleaning, nonzero "
+			"rate does\n");
+
+	ocf_cleaner_set_rate_limit(cache, 0);
+	assert_false(ocf_cleaner_is_paced(cache));
+	assert_int_equal(ocf_cleaner_pace(cache, 10000), 10000);
+	assert_int_equal(ocf_cleaner_pace_delay(cache), 0);
+
+	/* 1 MiB/s cleans one 4 KiB line every 4 ms */
+	ocf_cleaner_set_pace_rate(cache, MiB);
+	assert_true(ocf_cleaner_is_paced(cache));
+	assert_int_equal(ocf_cleaner_pace_delay(cache), 4);
+
+	ocf_cleaner_set_pace_rate(cache, 0);
+	assert_false(ocf_cleaner_is_paced(cache));
+
+	test_free(cache);
+}
+
+static void ocf_cleaner_set_pace_rate_test02(void **state)
+{
+	ocf_cache_t cache = test_calloc(1, sizeof(*cache));
+
+	print_test_description("Changing pace rate keeps spent tokens, "
+			"bucket is not refilled\n");
+
+	/* 1 MiB/s limit bursts 1 MiB */
+	ocf_cleaner_set_rate_limit(cache, 1);
+	assert_int_equal(ocf_cleaner_pace(cache, 10000), MIB_LINES);
+	ocf_cleaner_pace_consume(cache, MIB_LINES);
+	assert_int_equal(ocf_cleaner_pace(cache, 10000), 0);
+
+	ocf_cleaner_set_pace_rate(cache, 2 * MiB);
+	assert_int_equal(ocf_cleaner_pace(cache, 10000), 0);
+
+	ocf_cleaner_set_pace_rate(cache, MiB);
+	assert_int_equal(ocf_cleaner_pace(cache, 10000), 0);
+
+	test_free(cache);
+}
+
+static void ocf_cleaner_set_pace_rate_test03(void **state)
+{
+	ocf_cache_t cache = test_calloc(1, sizeof(*cache));
+
+	print_test_description("Lowering pace rate clamps tokens to new "
+			"burst\n");
+
+	/* Full bucket of 64 MiB/s limit holds 6.4 MiB */
+	ocf_cleaner_set_rate_limit(cache, 64);
+	assert_true(ocf_cleaner_pace(cache, 10000) > MIB_LINES);
+
+	/* 1 MiB/s bursts 1 MiB */
+	ocf_cleaner_set_pace_rate(cache, MiB);
+	assert_int_equal(ocf_cleaner_pace(cache, 10000), MIB_LINES);
+
+	test_free(cache);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(ocf_cleaner_set_pace_rate_test01),
+		cmocka_unit_test(ocf_cleaner_set_pace_rate_test02),
+		cmocka_unit_test(ocf_cleaner_set_pace_rate_test03)
+	};
+
+	print_message("Unit test for ocf_cleaner_set_pace_rate\n");
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,123 @@
+/*
+ * <tested_file_path>src/concurrency/ocf_metadata_concurrency.c</tested_file_path>
+ * <tested_function>ocf_metadata_end_shared_access</tested_function>
+ * <functions_to_leave>
+ *	_ocf_metadata_global_readers
+ *	_ocf_metadata_global_reader
+ *	_ocf_metadata_try_lock_global_rd
+ *	ocf_metadata_start_shared_access
+ *	ocf_metadata_try_start_shared_access
+ *	ocf_metadata_try_start_exclusive_access
+ *	ocf_metadata_end_exclusive_access
+ * </functions_to_leave>
+ */
+
+#undef static
+
+#undef inline
+
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include "print_desc.h"
+
+#include "ocf_metadata_concurrency.h"
+#include "../metadata/metadata_misc.h"
+
+#include "concurrency/ocf_metadata_concurrency.c/ocf_metadata_end_shared_access_generated_wraps.c"
+
+#define READERS_NO 2
+
+static struct ocf_metadata_global_readers readers[READERS_NO];
+static struct ocf_metadata_global_readers other_cpu_readers[READERS_NO];
+
+static void init_lock(struct ocf_metadata_lock *metadata_lock)
+{
+	unsigned i;
+
+	metadata_lock->global_readers = readers;
+	metadata_lock->global_readers_no = READERS_NO;
+	env_atomic_set(&metadata_lock->global_block, 0);
+	env_rwsem_init(&metadata_lock->global);
+
+	for (i = 0; i < READERS_NO; i++) {
+		env_atomic_set(&readers[i].count, 0);
+		env_atomic_set(&other_cpu_readers[i].count, 0);
+	}
+}
+
+static void ocf_metadata_end_shared_access_test01(void **state)
+{
+	struct ocf_metadata_lock metadata_lock;
+	env_atomic *reader;
+	unsigned slot;
+
+	print_test_description("Shared access released on other CPU than "
+			"taken keeps per CPU counters balanced\n");
+
+	init_lock(&metadata_lock);
+
+	reader = ocf_metadata_start_shared_access(&metadata_lock);
+	slot = env_get_current_cpu() % READERS_NO;
+	assert_ptr_equal(reader, &readers[slot].count);
+	assert_int_equal(env_atomic_read(&readers[slot].count), 1);
+
+	/* Emulate migration: current CPU now resolves to other counter */
+	metadata_lock.global_readers = other_cpu_readers;
+
+	ocf_metadata_end_shared_access(&metadata_lock, reader);
+
+	metadata_lock.global_readers = readers;
+
+	assert_int_equal(env_atomic_read(&readers[slot].count), 0);
+	assert_int_equal(env_atomic_read(&other_cpu_readers[slot].count), 0);
+
+	/* Exclusive access must not see stale reader left on any CPU */
+	assert_int_equal(ocf_metadata_try_start_exclusive_access(
+			&metadata_lock), 0);
+	ocf_metadata_end_exclusive_access(&metadata_lock);
+
+	env_rwsem_destroy(&metadata_lock.global);
+}
+
+static void ocf_metadata_end_shared_access_test02(void **state)
+{
+	struct ocf_metadata_lock metadata_lock;
+	env_atomic *reader;
+
+	print_test_description("Shared access is refused while exclusive "
+			"access is held and counter is left untouched\n");
+
+	init_lock(&metadata_lock);
+
+	assert_int_equal(ocf_metadata_try_start_exclusive_access(
+			&metadata_lock), 0);
+
+	reader = ocf_metadata_try_start_shared_access(&metadata_lock);
+	assert_null(reader);
+	assert_int_equal(env_atomic_read(&readers[0].count), 0);
+	assert_int_equal(env_atomic_read(&readers[1].count), 0);
+
+	ocf_metadata_end_exclusive_access(&metadata_lock);
+
+	reader = ocf_metadata_try_start_shared_access(&metadata_lock);
+	assert_non_null(reader);
+	ocf_metadata_end_shared_access(&metadata_lock, reader);
+	assert_int_equal(env_atomic_read(reader), 0);
+
+	env_rwsem_destroy(&metadata_lock.global);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(ocf_metadata_end_shared_access_test01),
+		cmocka_unit_test(ocf_metadata_end_shared_access_test02)
+	};
+
+	print_message("Unit test for ocf_metadata_end_shared_access\n");
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,213 @@
+/*
+ * <tested_file_path>src/concurrency/ocf_metadata_concurrency.c</tested_file_path>
+ * <tested_function>ocf_req_hash_read_retry</tested_function>
+ * <functions_to_leave>
+ *	_ocf_metadata_lock_wait
+ *	_ocf_hash_set_wr_pending
+ *	_ocf_hash_try_lock_rd
+ *	_ocf_hash_try_lock_wr
+ *	ocf_metadata_hash_lock
+ *	ocf_metadata_hash_unlock
+ *	ocf_metadata_hash_try_lock
+ *	ocf_req_hash_read_begin
+ *	ocf_req_hash_read_end
+ *	ocf_req_hash_read_lock
+ *	ocf_req_hash_unlock_rd
+ * </functions_to_leave>
+ */
+
+#undef static
+
+#undef inline
+
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include "print_desc.h"
+
+#include "ocf_metadata_concurrency.h"
+#include "../metadata/metadata_misc.h"
+
+#include "concurrency/ocf_metadata_concurrency.c/ocf_req_hash_read_retry_generated_wraps.c"
+
+static env_atomic global_reader;
+
+env_atomic *__wrap_ocf_metadata_start_shared_access(
+		struct ocf_metadata_lock *metadata_lock)
+{
+	env_atomic_inc(&global_reader);
+	return &global_reader;
+}
+
+void __wrap_ocf_metadata_end_shared_access(
+		struct ocf_metadata_lock *metadata_lock, env_atomic *reader)
+{
+	assert_ptr_equal(reader, &global_reader);
+	env_atomic_dec(reader);
+}
+
+#define MAP_SIZE 4
+#define HASH_ENTRIES 8
+
+static struct ocf_request *alloc_req(void)
+{
+	struct ocf_request *req;
+	struct ocf_cache *cache = test_calloc(1, sizeof(*cache));
+	unsigned i;
+
+	req = test_calloc(1, sizeof(*req) + MAP_SIZE * sizeof(req->map[0]));
+	req->map = req->__map;
+	req->cache = cache;
+
+	cache->metadata.lock.num_hash_entries = HASH_ENTRIES;
+	cache->metadata.lock.hash = test_calloc(HASH_ENTRIES,
+			sizeof(env_atomic64));
+
+	/* Request maps to buckets 2 and 3 */
+	req->core_line_count = MAP_SIZE;
+	for (i = 0; i < MAP_SIZE; i++)
+		req->map[i].hash = 2 + i / 2;
+
+	return req;
+}
+
+static void free_req(struct ocf_request *req)
+{
+	test_free(req->cache->metadata.lock.hash);
+	test_free(req->cache);
+	test_free(req);
+}
+
+static void ocf_req_hash_read_retry_test01(void **state)
+{
+	struct ocf_request *req = alloc_req();
+	struct ocf_metadata_lock *lock = &req->cache->metadata.lock;
+	uint64_t version;
+
+	print_test_description("Read is valid if buckets were only read "
+			"locked or other buckets were written meanwhile\n");
+
+	version = ocf_req_hash_read_begin(req);
+
+	ocf_metadata_hash_lock(lock, 2, OCF_METADATA_RD);
+	ocf_metadata_hash_unlock(lock, 2, OCF_METADATA_RD);
+
+	ocf_metadata_hash_lock(lock, 5, OCF_METADATA_WR);
+	ocf_metadata_hash_unlock(lock, 5, OCF_METADATA_WR);
+
+	assert_false(ocf_req_hash_read_retry(req, version));
+
+	ocf_req_hash_read_end(req);
+	assert_int_equal(env_atomic_read(&global_reader), 0);
+
+	free_req(req);
+}
+
+static void ocf_req_hash_read_retry_test02(void **state)
+{
+	struct ocf_request *req = alloc_req();
+	struct ocf_metadata_lock *lock = &req->cache->metadata.lock;
+	uint64_t version;
+
+	print_test_description("Read has to be retried if request bucket "
+			"was write locked meanwhile\n");
+
+	version = ocf_req_hash_read_begin(req);
+
+	ocf_metadata_hash_lock(lock, 3, OCF_METADATA_WR);
+
+	/* Writer still holds the bucket */
+	assert_true(ocf_req_hash_read_retry(req, version));
+
+	ocf_metadata_hash_unlock(lock, 3, OCF_METADATA_WR);
+
+	/* Writer released the bucket, but version has changed */
+	assert_true(ocf_req_hash_read_retry(req, version));
+
+	ocf_req_hash_read_end(req);
+
+	/* New read started after write is valid again */
+	version = ocf_req_hash_read_begin(req);
+	assert_false(ocf_req_hash_read_retry(req, version));
+	ocf_req_hash_read_end(req);
+
+	free_req(req);
+}
+
+static void ocf_req_hash_read_retry_test03(void **state)
+{
+	struct ocf_request *req = alloc_req();
+	struct ocf_metadata_lock *lock = &req->cache->metadata.lock;
+	uint64_t version;
+
+	print_test_description("Read locked buckets keep read valid and "
+			"are released with ocf_req_hash_unlock_rd()\n");
+
+	version = ocf_req_hash_read_begin(req);
+
+	ocf_req_hash_read_lock(req);
+	assert_false(ocf_req_hash_read_retry(req, version));
+
+	/* Writer cannot get in while read is locked */
+	assert_int_not_equal(ocf_metadata_hash_try_lock(lock, 2,
+			OCF_METADATA_WR), 0);
+
+	ocf_req_hash_unlock_rd(req);
+	assert_int_equal(env_atomic_read(&global_reader), 0);
+
+	assert_int_equal(env_atomic64_read(&lock->hash[2]), 0);
+	assert_int_equal(env_atomic64_read(&lock->hash[3]), 0);
+
+	free_req(req);
+}
+
+static void ocf_req_hash_read_retry_test04(void **state)
+{
+	struct ocf_request *req = alloc_req();
+	struct ocf_metadata_lock *lock = &req->cache->metadata.lock;
+	uint64_t version;
+
+	print_test_description("Waiting writer keeps new readers out and "
+			"does not invalidate optimistic read\n");
+
+	ocf_metadata_hash_lock(lock, 2, OCF_METADATA_RD);
+	version = ocf_req_hash_read_begin(req);
+
+	/* Writer waiting for reader to drain */
+	_ocf_hash_set_wr_pending(&lock->hash[2]);
+	assert_int_not_equal(ocf_metadata_hash_try_lock(lock, 2,
+			OCF_METADATA_RD), 0);
+	assert_int_equal(ocf_metadata_hash_try_lock(lock, 3,
+			OCF_METADATA_RD), 0);
+	ocf_metadata_hash_unlock(lock, 3, OCF_METADATA_RD);
+
+	assert_false(ocf_req_hash_read_retry(req, version));
+	ocf_req_hash_read_end(req);
+
+	/* Writer gets the lock once reader is gone and clears pending bit */
+	ocf_metadata_hash_unlock(lock, 2, OCF_METADATA_RD);
+	ocf_metadata_hash_lock(lock, 2, OCF_METADATA_WR);
+	ocf_metadata_hash_unlock(lock, 2, OCF_METADATA_WR);
+
+	assert_int_equal(ocf_metadata_hash_try_lock(lock, 2,
+			OCF_METADATA_RD), 0);
+	ocf_metadata_hash_unlock(lock, 2, OCF_METADATA_RD);
+
+	free_req(req);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(ocf_req_hash_read_retry_test01),
+		cmocka_unit_test(ocf_req_hash_read_retry_test02),
+		cmocka_unit_test(ocf_req_hash_read_retry_test03),
+		cmocka_unit_test(ocf_req_hash_read_retry_test04)
+	};
+
+	print_message("Unit test for ocf_req_hash_read_retry\n");
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
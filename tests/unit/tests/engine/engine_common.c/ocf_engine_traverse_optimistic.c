@@ -0,0 +1,235 @@
+/*
+ * <tested_file_path>src/engine/engine_common.c</tested_file_path>
+ * <tested_function>ocf_engine_traverse_optimistic</tested_function>
+ * <functions_to_leave>
+ *	_ocf_engine_lookup
+ *	_ocf_engine_traverse_access
+ * </functions_to_leave>
+ */
+
+#undef static
+
+#undef inline
+
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include "print_desc.h"
+
+#include "ocf/ocf.h"
+#include "../ocf_priv.h"
+#include "../ocf_cache_priv.h"
+#include "../ocf_queue_priv.h"
+#include "../ocf_request.h"
+#include "engine_common.h"
+
+#include "engine/engine_common.c/ocf_engine_traverse_optimistic_generated_wraps.c"
+
+#define MAP_SIZE 4
+
+static int lookup_status;
+
+uint64_t __wrap_ocf_req_hash_read_begin(struct ocf_request *req)
+{
+	function_called();
+	return 1;
+}
+
+bool __wrap_ocf_req_hash_read_retry(struct ocf_request *req,
+		uint64_t version)
+{
+	function_called();
+	return mock();
+}
+
+void __wrap_ocf_req_hash_read_end(struct ocf_request *req)
+{
+	function_called();
+}
+
+void __wrap_ocf_req_hash_read_lock(struct ocf_request *req)
+{
+	function_called();
+}
+
+void __wrap_ocf_req_hash_unlock_rd(struct ocf_request *req)
+{
+	function_called();
+}
+
+void __wrap_ocf_engine_lookup_map_entry(struct ocf_cache *cache,
+		struct ocf_map_info *entry, ocf_core_id_t core_id,
+		uint64_t core_line)
+{
+	function_called();
+	entry->status = lookup_status;
+	entry->core_line = core_line;
+}
+
+void __wrap_ocf_engine_update_req_info(struct ocf_cache *cache,
+		struct ocf_request *req, uint32_t entry)
+{
+	req->info.hit_no++;
+}
+
+void __wrap_ocf_req_clear_info(struct ocf_request *req)
+{
+	req->info.hit_no = 0;
+}
+
+void __wrap_ocf_eviction_touch_cache_line(struct ocf_cache *cache,
+		ocf_cache_line_t line)
+{
+	function_called();
+}
+
+void __wrap_ocf_mrc_req_access(struct ocf_request *req)
+{
+	function_called();
+}
+
+static bool need_lock(struct ocf_request *req)
+{
+	return req->info.hit_no == req->core_line_count;
+}
+
+static struct ocf_request *alloc_req(void)
+{
+	struct ocf_request *req;
+
+	req = test_calloc(1, sizeof(*req) + MAP_SIZE * sizeof(req->map[0]));
+	req->map = req->__map;
+	req->cache = test_calloc(1, sizeof(*req->cache));
+	req->core_line_first = 0;
+	req->core_line_last = MAP_SIZE - 1;
+	req->core_line_count = MAP_SIZE;
+
+	return req;
+}
+
+static void free_req(struct ocf_request *req)
+{
+	test_free(req->cache);
+	test_free(req);
+}
+
+static void expect_lookup(void)
+{
+	unsigned i;
+
+	for (i = 0; i < MAP_SIZE; i++)
+		expect_function_call(__wrap_ocf_engine_lookup_map_entry);
+}
+
+static void expect_access(void)
+{
+	unsigned i;
+
+	expect_function_call(__wrap_ocf_mrc_req_access);
+	for (i = 0; i < MAP_SIZE; i++)
+		expect_function_call(__wrap_ocf_eviction_touch_cache_line);
+}
+
+static void ocf_engine_traverse_optimistic_test01(void **state)
+{
+	struct ocf_request *req = alloc_req();
+
+	print_test_description("Valid miss is returned unlocked without "
+			"touching LRU or access statistics\n");
+
+	lookup_status = LOOKUP_MISS;
+
+	expect_function_call(__wrap_ocf_req_hash_read_begin);
+	expect_lookup();
+	expect_function_call(__wrap_ocf_req_hash_read_retry);
+	will_return(__wrap_ocf_req_hash_read_retry, false);
+	expect_function_call(__wrap_ocf_req_hash_read_end);
+
+	assert_false(ocf_engine_traverse_optimistic(req, need_lock));
+
+	free_req(req);
+}
+
+static void ocf_engine_traverse_optimistic_test02(void **state)
+{
+	struct ocf_request *req = alloc_req();
+
+	print_test_description("Hit is locked and accounted only after "
+			"version check under lock\n");
+
+	lookup_status = LOOKUP_HIT;
+
+	expect_function_call(__wrap_ocf_req_hash_read_begin);
+	expect_lookup();
+	expect_function_call(__wrap_ocf_req_hash_read_lock);
+	expect_function_call(__wrap_ocf_req_hash_read_retry);
+	will_return(__wrap_ocf_req_hash_read_retry, false);
+	expect_access();
+
+	assert_true(ocf_engine_traverse_optimistic(req, need_lock));
+
+	free_req(req);
+}
+
+static void ocf_engine_traverse_optimistic_test03(void **state)
+{
+	struct ocf_request *req = alloc_req();
+
+	print_test_description("Stale hit is looked up again under lock and "
+			"accounted once\n");
+
+	lookup_status = LOOKUP_HIT;
+
+	expect_function_call(__wrap_ocf_req_hash_read_begin);
+	expect_lookup();
+	expect_function_call(__wrap_ocf_req_hash_read_lock);
+	expect_function_call(__wrap_ocf_req_hash_read_retry);
+	will_return(__wrap_ocf_req_hash_read_retry, true);
+	expect_lookup();
+	expect_access();
+
+	assert_true(ocf_engine_traverse_optimistic(req, need_lock));
+	assert_int_equal(req->info.hit_no, MAP_SIZE);
+
+	free_req(req);
+}
+
+static void ocf_engine_traverse_optimistic_test04(void **state)
+{
+	struct ocf_request *req = alloc_req();
+
+	print_test_description("Stale miss turning into other miss under lock "
+			"is unlocked without accounting\n");
+
+	lookup_status = LOOKUP_MISS;
+
+	expect_function_call(__wrap_ocf_req_hash_read_begin);
+	expect_lookup();
+	expect_function_call(__wrap_ocf_req_hash_read_retry);
+	will_return(__wrap_ocf_req_hash_read_retry, true);
+	expect_function_call(__wrap_ocf_req_hash_read_lock);
+	expect_function_call(__wrap_ocf_req_hash_read_retry);
+	will_return(__wrap_ocf_req_hash_read_retry, true);
+	expect_lookup();
+	expect_function_call(__wrap_ocf_req_hash_unlock_rd);
+
+	assert_false(ocf_engine_traverse_optimistic(req, need_lock));
+
+	free_req(req);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(ocf_engine_traverse_optimistic_test01),
+		cmocka_unit_test(ocf_engine_traverse_optimistic_test02),
+		cmocka_unit_test(ocf_engine_traverse_optimistic_test03),
+		cmocka_unit_test(ocf_engine_traverse_optimistic_test04)
+	};
+
+	print_message("Unit test for ocf_engine_traverse_optimistic\n");
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,342 @@
+/*
+ * <tested_file_path>src/eviction/s3fifo.c</tested_file_path>
+ * <tested_function>evp_s3fifo_req_clines</tested_function>
+ * <functions_to_leave>
+ *	evp_s3fifo_lock_idx
+ *	evp_s3fifo_get
+ *	evp_s3fifo_in_main
+ *	evp_s3fifo_test_clear_ref
+ *	evp_s3fifo_ghost_hash
+ *	evp_s3fifo_ghost_add
+ *	evp_s3fifo_ghost_test_clear
+ *	evp_s3fifo_add
+ *	evp_s3fifo_remove
+ *	evp_s3fifo_is_linked
+ *	evp_s3fifo_initialize
+ *	evp_s3fifo_deinitialize
+ *	evp_s3fifo_init_evp
+ *	evp_s3fifo_init_cline
+ *	evp_s3fifo_rm_cline
+ *	evp_s3fifo_hot_cline
+ * </functions_to_leave>
+ */
+
+#undef static
+
+#undef inline
+
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include "print_desc.h"
+
+#include "eviction.h"
+#include "lru.h"
+#include "s3fifo.h"
+#include "ops.h"
+#include "../concurrency/ocf_concurrency.h"
+#include "../ocf_request.h"
+
+#include "eviction/s3fifo.c/evp_s3fifo_req_clines_generated_wraps.c"
+
+#define LINES 16
+#define END LINES
+
+static union eviction_policy_meta meta[LINES];
+static uint64_t core_lines[LINES];
+
+static ocf_cache_line_t evicted[LINES];
+static unsigned evicted_no;
+
+static void get_eviction_policy(struct ocf_cache *cache,
+		ocf_cache_line_t line, union eviction_policy_meta *eviction)
+{
+	*eviction = meta[line];
+}
+
+static void set_eviction_policy(struct ocf_cache *cache,
+		ocf_cache_line_t line, union eviction_policy_meta *eviction)
+{
+	meta[line] = *eviction;
+}
+
+static void get_core_info(struct ocf_cache *cache, ocf_cache_line_t line,
+		ocf_core_id_t *core_id, uint64_t *core_line)
+{
+	if (core_id)
+		*core_id = 0;
+	if (core_line)
+		*core_line = core_lines[line];
+}
+
+static void get_partition_info(struct ocf_cache *cache,
+		ocf_cache_line_t line, ocf_part_id_t *part_id,
+		ocf_cache_line_t *next_line, ocf_cache_line_t *prev_line)
+{
+	if (part_id)
+		*part_id = 0;
+}
+
+static bool test_dirty(struct ocf_cache *cache, ocf_cache_line_t line,
+		uint8_t start, uint8_t stop, bool all)
+{
+	return false;
+}
+
+/* Clean list only, new lines at head, tail is the oldest */
+void __wrap_evp_lru_list_add(ocf_cache_t cache,
+		struct lru_eviction_policy *lru, ocf_cache_line_t cline,
+		bool dirty)
+{
+	meta[cline].lru.prev = END;
+	meta[cline].lru.next = lru->clean_head;
+
+	if (lru->clean_head != END)
+		meta[lru->clean_head].lru.prev = cline;
+	else
+		lru->clean_tail = cline;
+
+	lru->clean_head = cline;
+	lru->has_clean_nodes = 1;
+}
+
+void __wrap_evp_lru_list_remove(ocf_cache_t cache,
+		struct lru_eviction_policy *lru, ocf_cache_line_t cline,
+		bool dirty)
+{
+	ocf_cache_line_t prev = meta[cline].lru.prev;
+	ocf_cache_line_t next = meta[cline].lru.next;
+
+	if (prev != END)
+		meta[prev].lru.next = next;
+	else
+		lru->clean_head = next;
+
+	if (next != END)
+		meta[next].lru.prev = prev;
+	else
+		lru->clean_tail = prev;
+
+	meta[cline].lru.prev = END;
+	meta[cline].lru.next = END;
+	lru->has_clean_nodes = lru->clean_head != END;
+}
+
+void __wrap_evp_lru_list_init(struct lru_eviction_policy *lru,
+		unsigned int collision_table_entries)
+{
+	lru->has_clean_nodes = 0;
+	lru->has_dirty_nodes = 0;
+	lru->clean_head = lru->clean_tail = collision_table_entries;
+	lru->dirty_head = lru->dirty_tail = collision_table_entries;
+}
+
+void __wrap_evp_lru_init_cline(ocf_cache_t cache, ocf_cache_line_t cline)
+{
+	meta[cline].lru.prev = END;
+	meta[cline].lru.next = END;
+}
+
+void __wrap_evp_lru_touch_cline(ocf_cache_t cache, ocf_cache_line_t cline)
+{
+}
+
+bool __wrap_evp_lru_can_evict(ocf_cache_t cache)
+{
+	return true;
+}
+
+bool __wrap_ocf_cache_line_is_used(struct ocf_cache *cache,
+		ocf_cache_line_t line)
+{
+	return false;
+}
+
+bool __wrap_evp_lru_evict_cline(ocf_cache_t cache, ocf_queue_t io_queue,
+		ocf_cache_line_t cline)
+{
+	evicted[evicted_no++] = cline;
+	evp_s3fifo_rm_cline(cache, cline);
+	return true;
+}
+
+void __wrap_evp_lru_clean(ocf_cache_t cache, ocf_queue_t io_queue,
+		ocf_part_id_t part_id, ocf_cache_line_t start_cline,
+		uint32_t count)
+{
+}
+
+static const struct ocf_metadata_iface iface = {
+	.get_eviction_policy = get_eviction_policy,
+	.set_eviction_policy = set_eviction_policy,
+	.get_core_info = get_core_info,
+	.get_partition_info = get_partition_info,
+	.test_dirty = test_dirty,
+};
+
+static ocf_cache_t alloc_cache(void)
+{
+	ocf_cache_t cache = test_calloc(1, sizeof(*cache));
+	unsigned i;
+
+	cache->device = test_calloc(1, sizeof(*cache->device));
+	cache->device->collision_table_entries = LINES;
+	cache->device->concurrency.eviction_ref = test_calloc(1,
+			sizeof(unsigned long));
+	cache->user_parts[0].runtime = test_calloc(1,
+			sizeof(*cache->user_parts[0].runtime));
+
+	memcpy((void *)&cache->metadata.iface, &iface, sizeof(iface));
+
+	for (i = 0; i < OCF_NUM_EVICTION_LISTS; i++)
+		env_spinlock_init(&cache->metadata.lock.eviction[i]);
+
+	assert_int_equal(evp_s3fifo_initialize(cache, 1), 0);
+	evp_s3fifo_init_evp(cache, 0);
+
+	evicted_no = 0;
+
+	return cache;
+}
+
+static void free_cache(ocf_cache_t cache)
+{
+	evp_s3fifo_deinitialize(cache);
+	test_free(cache->user_parts[0].runtime);
+	test_free(cache->device->concurrency.eviction_ref);
+	test_free(cache->device);
+	test_free(cache);
+}
+
+/* Map cache line to core line and insert it */
+static void insert(ocf_cache_t cache, ocf_cache_line_t cline,
+		uint64_t core_line)
+{
+	core_lines[cline] = core_line;
+	evp_s3fifo_init_cline(cache, cline);
+	evp_s3fifo_hot_cline(cache, cline);
+}
+
+static void reference(ocf_cache_t cache, ocf_cache_line_t cline)
+{
+	env_bit_set(cline, cache->device->concurrency.eviction_ref);
+}
+
+static void evp_s3fifo_req_clines_test01(void **state)
+{
+	ocf_cache_t cache = alloc_cache();
+	struct s3fifo_eviction_policy *s3 = evp_s3fifo_get(cache, 0);
+	unsigned i;
+
+	print_test_description("Lines referenced in small queue are promoted "
+			"to main, unreferenced ones are evicted oldest first\n");
+
+	for (i = 0; i < 10; i++)
+		insert(cache, i, 100 + i);
+
+	assert_int_equal(s3->small_size, 10);
+	assert_int_equal(s3->main_size, 0);
+
+	reference(cache, 0);
+	reference(cache, 1);
+
+	assert_int_equal(evp_s3fifo_req_clines(cache, NULL, 0, 2), 2);
+
+	assert_int_equal(evicted_no, 2);
+	assert_int_equal(evicted[0], 2);
+	assert_int_equal(evicted[1], 3);
+
+	assert_true(evp_s3fifo_in_main(cache, 0));
+	assert_true(evp_s3fifo_in_main(cache, 1));
+	assert_int_equal(s3->main_size, 2);
+	assert_int_equal(s3->small_size, 6);
+
+	/* Reference bit is consumed by promotion */
+	assert_false(env_bit_test(0, cache->device->concurrency.eviction_ref));
+
+	free_cache(cache);
+}
+
+static void evp_s3fifo_req_clines_test02(void **state)
+{
+	ocf_cache_t cache = alloc_cache();
+	struct s3fifo_eviction_policy *s3 = evp_s3fifo_get(cache, 0);
+	unsigned i;
+
+	print_test_description("Core line evicted from small queue goes "
+			"directly to main queue when inserted again\n");
+
+	for (i = 0; i < 4; i++)
+		insert(cache, i, 100 + i);
+
+	assert_int_equal(evp_s3fifo_req_clines(cache, NULL, 0, 1), 1);
+	assert_int_equal(evicted[0], 0);
+
+	/* Same core line brought back into another cache line */
+	insert(cache, 5, 100);
+	assert_true(evp_s3fifo_in_main(cache, 5));
+	assert_int_equal(s3->main_size, 1);
+
+	/* Ghost entry is used up by the hit */
+	core_lines[0] = 100;
+	assert_false(evp_s3fifo_ghost_test_clear(cache, 0));
+
+	/* Core line never evicted starts in small queue */
+	insert(cache, 6, 200);
+	assert_false(evp_s3fifo_in_main(cache, 6));
+	assert_int_equal(s3->small_size, 4);
+
+	free_cache(cache);
+}
+
+static void evp_s3fifo_req_clines_test03(void **state)
+{
+	ocf_cache_t cache = alloc_cache();
+	struct s3fifo_eviction_policy *s3 = evp_s3fifo_get(cache, 0);
+	unsigned i;
+
+	print_test_description("Small queue is drained down to its target "
+			"first, then main queue is evicted in CLOCK order\n");
+
+	for (i = 0; i < 4; i++) {
+		insert(cache, i, 100 + i);
+		reference(cache, i);
+	}
+
+	/* Three oldest lines promoted, small queue keeps its target of one
+	 * line, oldest main line goes out */
+	assert_int_equal(evp_s3fifo_req_clines(cache, NULL, 0, 1), 1);
+	assert_int_equal(evicted[0], 0);
+	assert_int_equal(s3->small_size, 1);
+	assert_int_equal(s3->main_size, 2);
+	assert_false(evp_s3fifo_in_main(cache, 3));
+
+	/* Referenced main line gets second chance */
+	reference(cache, 1);
+	assert_int_equal(evp_s3fifo_req_clines(cache, NULL, 0, 1), 1);
+	assert_int_equal(evicted[1], 2);
+	assert_true(evp_s3fifo_in_main(cache, 1));
+
+	/* Lines evicted from main queue are not remembered */
+	core_lines[0] = 100;
+	assert_false(evp_s3fifo_ghost_test_clear(cache, 0));
+	core_lines[2] = 102;
+	assert_false(evp_s3fifo_ghost_test_clear(cache, 2));
+
+	free_cache(cache);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(evp_s3fifo_req_clines_test01),
+		cmocka_unit_test(evp_s3fifo_req_clines_test02),
+		cmocka_unit_test(evp_s3fifo_req_clines_test03)
+	};
+
+	print_message("Unit test for evp_s3fifo_req_clines\n");
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,235 @@
+/*
+ * <tested_file_path>src/promotion/nhc/nhc.c</tested_file_path>
+ * <tested_function>nhc_set_write_rate</tested_function>
+ * <functions_to_leave>
+ *	nhc_budget_burst
+ *	nhc_budget_init
+ *	nhc_setup
+ *	nhc_init
+ *	nhc_deinit
+ *	nhc_req_should_promote
+ *	ocf_token_bucket_burst
+ *	ocf_token_bucket_init
+ *	ocf_token_bucket_rate
+ *	ocf_token_bucket_refill
+ *	ocf_token_bucket_set_rate
+ *	ocf_token_bucket_take
+ *	ocf_engine_mapped_count
+ *	ocf_engine_unmapped_count
+ *	ocf_freq_sketch_hash
+ * </functions_to_leave>
+ */
+
+#undef static
+
+#undef inline
+
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include "print_desc.h"
+
+#include "../../metadata/metadata.h"
+#include "../../ocf_cache_priv.h"
+#include "../../engine/engine_common.h"
+#include "../../utils/utils_cache_line.h"
+#include "nhc.h"
+#include "../ops.h"
+
+#include "promotion/nhc.c/nhc_set_write_rate_generated_wraps.c"
+
+#define LINE_SIZE 4096
+#define REQ_LINES 64
+#define REQ_BYTES (REQ_LINES * LINE_SIZE)
+
+ocf_cache_line_size_t __wrap_ocf_line_size(struct ocf_cache *cache)
+{
+	return LINE_SIZE;
+}
+
+ocf_cache_line_t __wrap_ocf_metadata_get_cachelines_count(ocf_cache_t cache)
+{
+	return 1024;
+}
+
+uint64_t __wrap_ocf_freq_sketch_sizeof(uint64_t entries)
+{
+	return 0;
+}
+
+struct ocf_freq_sketch *__wrap_ocf_freq_sketch_create(uint64_t entries)
+{
+	return (struct ocf_freq_sketch *)test_malloc(1);
+}
+
+void __wrap_ocf_freq_sketch_destroy(struct ocf_freq_sketch *sketch)
+{
+	test_free(sketch);
+}
+
+void __wrap_ocf_freq_sketch_record(struct ocf_freq_sketch *sketch,
+		uint64_t hash)
+{
+}
+
+uint32_t __wrap_ocf_freq_sketch_estimate(struct ocf_freq_sketch *sketch,
+		uint64_t hash)
+{
+	return 0;
+}
+
+static ocf_cache_t alloc_cache(uint32_t write_budget)
+{
+	struct nhc_promotion_policy_config *cfg;
+	ocf_cache_t cache;
+
+	cache = test_calloc(1, sizeof(*cache));
+	cache->conf_meta = test_calloc(1, sizeof(*cache->conf_meta));
+
+	cache->promotion_policy = test_calloc(1,
+			sizeof(*cache->promotion_policy));
+	cache->promotion_policy->owner = cache;
+	cache->promotion_policy->type = ocf_promotion_nhc;
+
+	nhc_setup(cache);
+	cfg = (void *)&cache->conf_meta->promotion[ocf_promotion_nhc].data;
+	cfg->doorkeeper = 0;
+	cfg->write_budget = write_budget;
+
+	assert_int_equal(nhc_init(cache), 0);
+
+	return cache;
+}
+
+static void free_cache(ocf_cache_t cache)
+{
+	nhc_deinit(cache->promotion_policy);
+	test_free(cache->promotion_policy);
+	test_free(cache->conf_meta);
+	test_free(cache);
+}
+
+static struct ocf_request *alloc_req_lines(ocf_cache_t cache, uint32_t lines)
+{
+	struct ocf_request *req;
+
+	req = test_calloc(1, sizeof(*req) + lines * sizeof(req->map[0]));
+	req->map = req->__map;
+	req->cache = cache;
+	req->core_line_count = lines;
+
+	return req;
+}
+
+static struct ocf_request *alloc_req(ocf_cache_t cache)
+{
+	return alloc_req_lines(cache, REQ_LINES);
+}
+
+/* Promote misses until budget runs out, returns number of promoted */
+static unsigned promote_all(ocf_cache_t cache, struct ocf_request *req,
+		unsigned max)
+{
+	unsigned i;
+
+	for (i = 0; i < max; i++) {
+		if (!nhc_req_should_promote(cache->promotion_policy, req))
+			break;
+	}
+
+	return i;
+}
+
+static void nhc_set_write_rate_test01(void **state)
+{
+	ocf_cache_t cache = alloc_cache(1);
+	struct ocf_request *req = alloc_req(cache);
+
+	print_test_description("Promotions are admitted up to write budget "
+			"burst, then rejected\n");
+
+	/* 1 MiB/s budget bursts 1 MiB */
+	assert_int_equal(promote_all(cache, req, 100), MiB / REQ_BYTES);
+	assert_false(nhc_req_should_promote(cache->promotion_policy, req));
+
+	test_free(req);
+	free_cache(cache);
+}
+
+static void nhc_set_write_rate_test02(void **state)
+{
+	ocf_cache_t cache = alloc_cache(1);
+	struct ocf_request *req = alloc_req(cache);
+
+	print_test_description("Changing write rate keeps spent budget, "
+			"bucket is not refilled\n");
+
+	assert_int_equal(promote_all(cache, req, 100), MiB / REQ_BYTES);
+
+	nhc_set_write_rate(cache->promotion_policy, 4 * MiB);
+	assert_false(nhc_req_should_promote(cache->promotion_policy, req));
+
+	nhc_set_write_rate(cache->promotion_policy, 2 * MiB);
+	assert_false(nhc_req_should_promote(cache->promotion_policy, req));
+
+	/* Zero rate lifts the limit */
+	nhc_set_write_rate(cache->promotion_policy, 0);
+	assert_int_equal(promote_all(cache, req, 100), 100);
+
+	test_free(req);
+	free_cache(cache);
+}
+
+static void nhc_set_write_rate_test03(void **state)
+{
+	ocf_cache_t cache = alloc_cache(64);
+	struct ocf_request *req = alloc_req(cache);
+
+	print_test_description("Lowering write rate clamps tokens to new "
+			"burst\n");
+
+	/* Full bucket of 64 MiB/s budget holds 6.4 MiB */
+	nhc_set_write_rate(cache->promotion_policy, MiB);
+
+	/* 1 MiB/s bursts 1 MiB */
+	assert_int_equal(promote_all(cache, req, 100), MiB / REQ_BYTES);
+	assert_false(nhc_req_should_promote(cache->promotion_policy, req));
+
+	test_free(req);
+	free_cache(cache);
+}
+
+static void nhc_set_write_rate_test04(void **state)
+{
+	ocf_cache_t cache = alloc_cache(1);
+	/* 2 MiB request, burst of 1 MiB/s budget is 1 MiB */
+	struct ocf_request *big = alloc_req_lines(cache, 2 * MiB / LINE_SIZE);
+	struct ocf_request *req = alloc_req(cache);
+
+	print_test_description("Request larger than burst is promoted with "
+			"full bucket, charging whole burst\n");
+
+	assert_true(nhc_req_should_promote(cache->promotion_policy, big));
+	assert_false(nhc_req_should_promote(cache->promotion_policy, req));
+	assert_false(nhc_req_should_promote(cache->promotion_policy, big));
+
+	test_free(req);
+	test_free(big);
+	free_cache(cache);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(nhc_set_write_rate_test01),
+		cmocka_unit_test(nhc_set_write_rate_test02),
+		cmocka_unit_test(nhc_set_write_rate_test03),
+		cmocka_unit_test(nhc_set_write_rate_test04)
+	};
+
+	print_message("Unit test for nhc_set_write_rate\n");
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,93 @@
+/*
+ * <tested_file_path>src/promotion/promotion.c</tested_file_path>
+ * <tested_function>ocf_promotion_req_should_promote</tested_function>
+ * <functions_to_leave>
+ *	ocf_req_cache_mode_is_mf
+ * </functions_to_leave>
+ */
+
+#undef static
+
+#undef inline
+
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include "print_desc.h"
+
+#include "../metadata/metadata.h"
+#include "promotion.h"
+#include "ops.h"
+#include "nhc/nhc.h"
+#include "../engine/cache_engine.h"
+
+#include "promotion/promotion.c/ocf_promotion_req_should_promote_generated_wraps.c"
+
+void __wrap_nhc_req_access(ocf_promotion_policy_t policy,
+		struct ocf_request *req)
+{
+	function_called();
+}
+
+bool __wrap_nhc_req_should_promote(ocf_promotion_policy_t policy,
+		struct ocf_request *req)
+{
+	function_called();
+	return mock();
+}
+
+static void ocf_promotion_req_should_promote_test01(void **state)
+{
+	struct ocf_promotion_policy policy = { .type = ocf_promotion_nhc };
+	struct ocf_request req = {
+		.rw = OCF_READ,
+		.cache_mode = ocf_req_cache_mode_mfwb,
+		.data_admit_allowed = false,
+	};
+
+	print_test_description("MF read miss rejected by data_admit is "
+			"still recorded by the policy\n");
+
+	expect_function_call(__wrap_nhc_req_access);
+
+	assert_false(ocf_promotion_req_should_promote(&policy, &req));
+}
+
+static void ocf_promotion_req_should_promote_test02(void **state)
+{
+	struct ocf_promotion_policy policy = { .type = ocf_promotion_nhc };
+	struct ocf_request req = {
+		.rw = OCF_READ,
+		.cache_mode = ocf_req_cache_mode_mfwa,
+		.data_admit_allowed = true,
+	};
+
+	print_test_description("MF read miss admitted by data_admit is "
+			"recorded before policy decides\n");
+
+	expect_function_call(__wrap_nhc_req_access);
+	expect_function_call(__wrap_nhc_req_should_promote);
+	will_return(__wrap_nhc_req_should_promote, true);
+
+	assert_true(ocf_promotion_req_should_promote(&policy, &req));
+
+	expect_function_call(__wrap_nhc_req_access);
+	expect_function_call(__wrap_nhc_req_should_promote);
+	will_return(__wrap_nhc_req_should_promote, false);
+
+	assert_false(ocf_promotion_req_should_promote(&policy, &req));
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(ocf_promotion_req_should_promote_test01),
+		cmocka_unit_test(ocf_promotion_req_should_promote_test02)
+	};
+
+	print_message("Unit test for ocf_promotion_req_should_promote\n");
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
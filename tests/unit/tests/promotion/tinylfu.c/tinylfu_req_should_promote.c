@@ -0,0 +1,278 @@
+/*
+ * <tested_file_path>src/promotion/tinylfu/tinylfu.c</tested_file_path>
+ * <tested_function>tinylfu_req_should_promote</tested_function>
+ * <functions_to_leave>
+ *	tinylfu_entries
+ *	tinylfu_setup
+ *	tinylfu_init
+ *	tinylfu_deinit
+ *	tinylfu_set_param
+ *	tinylfu_get_param
+ *	core_line_should_promote
+ *	ocf_engine_mapped_count
+ *	ocf_freq_sketch_hash
+ *	ocf_metadata_collision_table_entries
+ * </functions_to_leave>
+ */
+
+#undef static
+
+#undef inline
+
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include "print_desc.h"
+
+#include "../../metadata/metadata.h"
+#include "../../ocf_cache_priv.h"
+#include "../../engine/engine_common.h"
+#include "../../utils/utils_freq_sketch.h"
+#include "tinylfu.h"
+#include "../ops.h"
+
+#include "promotion/tinylfu.c/tinylfu_req_should_promote_generated_wraps.c"
+
+#define CACHE_LINES 1000
+#define SKETCH_KEYS 16
+
+static ocf_cache_line_t free_lines;
+
+/* Exact access counts standing in for the sketch */
+static struct {
+	uint64_t hash;
+	uint32_t count;
+} sketch_keys[SKETCH_KEYS];
+static uint32_t sketch_keys_count;
+static uint32_t sketch_records;
+
+ocf_cache_line_t __wrap_ocf_metadata_get_cachelines_count(ocf_cache_t cache)
+{
+	return CACHE_LINES;
+}
+
+ocf_cache_line_t __wrap_ocf_freelist_num_free(ocf_freelist_t freelist)
+{
+	return free_lines;
+}
+
+uint64_t __wrap_ocf_freq_sketch_sizeof(uint64_t entries)
+{
+	return 0;
+}
+
+struct ocf_freq_sketch *__wrap_ocf_freq_sketch_create(uint64_t entries)
+{
+	sketch_keys_count = 0;
+	sketch_records = 0;
+
+	return (struct ocf_freq_sketch *)test_malloc(1);
+}
+
+void __wrap_ocf_freq_sketch_destroy(struct ocf_freq_sketch *sketch)
+{
+	test_free(sketch);
+}
+
+static uint32_t *sketch_count(uint64_t hash)
+{
+	uint32_t i;
+
+	for (i = 0; i < sketch_keys_count; i++) {
+		if (sketch_keys[i].hash == hash)
+			return &sketch_keys[i].count;
+	}
+
+	assert_true(sketch_keys_count < SKETCH_KEYS);
+	sketch_keys[sketch_keys_count].hash = hash;
+	sketch_keys[sketch_keys_count].count = 0;
+
+	return &sketch_keys[sketch_keys_count++].count;
+}
+
+void __wrap_ocf_freq_sketch_record(struct ocf_freq_sketch *sketch,
+		uint64_t hash)
+{
+	(*sketch_count(hash))++;
+	sketch_records++;
+}
+
+uint32_t __wrap_ocf_freq_sketch_estimate(struct ocf_freq_sketch *sketch,
+		uint64_t hash)
+{
+	return *sketch_count(hash);
+}
+
+static ocf_cache_t alloc_cache(void)
+{
+	ocf_cache_t cache;
+
+	cache = test_calloc(1, sizeof(*cache));
+	cache->conf_meta = test_calloc(1, sizeof(*cache->conf_meta));
+	cache->device = test_calloc(1, sizeof(*cache->device));
+	cache->device->collision_table_entries = CACHE_LINES;
+
+	cache->promotion_policy = test_calloc(1,
+			sizeof(*cache->promotion_policy));
+	cache->promotion_policy->owner = cache;
+	cache->promotion_policy->type = ocf_promotion_tinylfu;
+
+	tinylfu_setup(cache);
+	assert_int_equal(tinylfu_init(cache), 0);
+
+	/* Cache full, policy active */
+	free_lines = 0;
+
+	return cache;
+}
+
+static void free_cache(ocf_cache_t cache)
+{
+	tinylfu_deinit(cache->promotion_policy);
+	test_free(cache->promotion_policy);
+	test_free(cache->device);
+	test_free(cache->conf_meta);
+	test_free(cache);
+}
+
+static struct ocf_request *alloc_req(ocf_cache_t cache, uint64_t core_line,
+		uint32_t lines)
+{
+	struct ocf_request *req;
+	uint32_t i;
+
+	req = test_calloc(1, sizeof(*req) + lines * sizeof(req->map[0]));
+	req->map = req->__map;
+	req->cache = cache;
+	req->core_line_first = core_line;
+	req->core_line_last = core_line + lines - 1;
+	req->core_line_count = lines;
+
+	for (i = 0; i < lines; i++)
+		req->map[i].core_line = core_line + i;
+
+	return req;
+}
+
+static void tinylfu_req_should_promote_test01(void **state)
+{
+	ocf_cache_t cache = alloc_cache();
+	struct ocf_request *req = alloc_req(cache, 100, 1);
+	struct ocf_request *other = alloc_req(cache, 200, 1);
+	uint32_t i;
+
+	print_test_description("Line is promoted once its access count "
+			"reaches insertion threshold\n");
+
+	for (i = 1; i < OCF_TINYLFU_THRESHOLD_DEFAULT; i++) {
+		assert_false(tinylfu_req_should_promote(
+				cache->promotion_policy, req));
+	}
+	assert_true(tinylfu_req_should_promote(cache->promotion_policy, req));
+	assert_true(tinylfu_req_should_promote(cache->promotion_policy, req));
+
+	/* Counts are kept per core line */
+	assert_false(tinylfu_req_should_promote(cache->promotion_policy,
+			other));
+
+	test_free(other);
+	test_free(req);
+	free_cache(cache);
+}
+
+static void tinylfu_req_should_promote_test02(void **state)
+{
+	ocf_cache_t cache = alloc_cache();
+	struct ocf_request *req = alloc_req(cache, 100, 1);
+	uint32_t threshold;
+	int result;
+
+	print_test_description("Insertion threshold is configurable within "
+			"limits\n");
+
+	assert_int_equal(tinylfu_set_param(cache,
+			ocf_tinylfu_insertion_threshold, 1), 0);
+	assert_true(tinylfu_req_should_promote(cache->promotion_policy, req));
+
+	assert_int_equal(tinylfu_set_param(cache,
+			ocf_tinylfu_insertion_threshold, 5), 0);
+	assert_int_equal(tinylfu_get_param(cache,
+			ocf_tinylfu_insertion_threshold, &threshold), 0);
+	assert_int_equal(threshold, 5);
+
+	/* Second to fourth access */
+	assert_false(tinylfu_req_should_promote(cache->promotion_policy, req));
+	assert_false(tinylfu_req_should_promote(cache->promotion_policy, req));
+	assert_false(tinylfu_req_should_promote(cache->promotion_policy, req));
+	assert_true(tinylfu_req_should_promote(cache->promotion_policy, req));
+
+	result = tinylfu_set_param(cache, ocf_tinylfu_insertion_threshold,
+			OCF_TINYLFU_MIN_THRESHOLD - 1);
+	assert_int_equal(result, -OCF_ERR_INVAL);
+	result = tinylfu_set_param(cache, ocf_tinylfu_insertion_threshold,
+			OCF_TINYLFU_MAX_THRESHOLD + 1);
+	assert_int_equal(result, -OCF_ERR_INVAL);
+	assert_int_equal(tinylfu_get_param(cache,
+			ocf_tinylfu_insertion_threshold, &threshold), 0);
+	assert_int_equal(threshold, 5);
+
+	test_free(req);
+	free_cache(cache);
+}
+
+static void tinylfu_req_should_promote_test03(void **state)
+{
+	ocf_cache_t cache = alloc_cache();
+	struct ocf_request *req = alloc_req(cache, 100, 1);
+
+	print_test_description("Everything is promoted without recording "
+			"until occupancy reaches trigger threshold\n");
+
+	/* 80% trigger of 1000 lines */
+	free_lines = CACHE_LINES - 799;
+	assert_true(tinylfu_req_should_promote(cache->promotion_policy, req));
+	assert_int_equal(sketch_records, 0);
+
+	free_lines = CACHE_LINES - 800;
+	assert_false(tinylfu_req_should_promote(cache->promotion_policy, req));
+	assert_int_equal(sketch_records, 1);
+
+	test_free(req);
+	free_cache(cache);
+}
+
+static void tinylfu_req_should_promote_test04(void **state)
+{
+	ocf_cache_t cache = alloc_cache();
+	struct ocf_request *req = alloc_req(cache, 100, 4);
+
+	print_test_description("Every line of request is recorded, partially "
+			"hit request is not rejected\n");
+
+	assert_false(tinylfu_req_should_promote(cache->promotion_policy, req));
+	assert_int_equal(sketch_records, 4);
+	assert_int_equal(sketch_keys_count, 4);
+
+	req->info.hit_no = 1;
+	assert_true(tinylfu_req_should_promote(cache->promotion_policy, req));
+	assert_int_equal(sketch_records, 8);
+
+	test_free(req);
+	free_cache(cache);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(tinylfu_req_should_promote_test01),
+		cmocka_unit_test(tinylfu_req_should_promote_test02),
+		cmocka_unit_test(tinylfu_req_should_promote_test03),
+		cmocka_unit_test(tinylfu_req_should_promote_test04)
+	};
+
+	print_message("Unit test for tinylfu_req_should_promote\n");
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
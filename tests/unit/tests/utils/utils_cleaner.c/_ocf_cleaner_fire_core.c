@@ -0,0 +1,264 @@
+/*
+ * <tested_file_path>src/utils/utils_cleaner.c</tested_file_path>
+ * <tested_function>_ocf_cleaner_fire_core</tested_function>
+ * <functions_to_leave>
+ *	_ocf_cleaner_line_is_dirty_whole
+ *	_ocf_cleaner_run_extends
+ * </functions_to_leave>
+ */
+
+#undef static
+
+#undef inline
+
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include "print_desc.h"
+
+#include "ocf/ocf.h"
+#include "../metadata/metadata.h"
+#include "../ocf_cache_priv.h"
+#include "../ocf_request.h"
+#include "utils_cleaner.h"
+
+#include "utils/utils_cleaner.c/_ocf_cleaner_fire_core_generated_wraps.c"
+
+#define LINES 16
+
+static bool line_valid[LINES];
+static bool line_dirty[LINES];
+
+/* Core writes issued, one entry per write: first map index and length */
+static struct {
+	uint32_t first;
+	uint32_t length;
+} writes[LINES];
+static uint32_t writes_count;
+
+static bool test_valid(struct ocf_cache *cache, ocf_cache_line_t line,
+		uint8_t start, uint8_t stop, bool all)
+{
+	return line_valid[line];
+}
+
+static bool test_dirty(struct ocf_cache *cache, ocf_cache_line_t line,
+		uint8_t start, uint8_t stop, bool all)
+{
+	return line_dirty[line];
+}
+
+static const struct ocf_metadata_iface iface = {
+	.test_valid = test_valid,
+	.test_dirty = test_dirty,
+};
+
+void __wrap__ocf_cleaner_core_submit_io(struct ocf_request *req,
+		struct ocf_map_info *iter)
+{
+	writes[writes_count].first = iter - req->map;
+	writes[writes_count].length = 1;
+	writes_count++;
+}
+
+void __wrap__ocf_cleaner_core_io_for_run(struct ocf_request *req,
+		struct ocf_map_info *first, uint32_t length)
+{
+	writes[writes_count].first = first - req->map;
+	writes[writes_count].length = length;
+	writes_count++;
+}
+
+void __wrap__ocf_cleaner_core_io_end(struct ocf_request *req)
+{
+	function_called();
+}
+
+/* Set up map of count lines, all valid, dirty, hit and contiguous */
+static struct ocf_request *setup_req(uint32_t count)
+{
+	struct ocf_cache *cache = test_calloc(1, sizeof(*cache));
+	struct ocf_request *req = test_calloc(1, sizeof(*req) +
+			sizeof(struct ocf_map_info) * count);
+	uint32_t i;
+
+	memcpy((void *)&cache->metadata.iface, &iface, sizeof(iface));
+
+	req->cache = cache;
+	req->map = (struct ocf_map_info *)(req + 1);
+	req->core_line_count = count;
+
+	for (i = 0; i < count; i++) {
+		req->map[i].core_id = 0;
+		req->map[i].core_line = 100 + i;
+		req->map[i].hash = 10 + i;
+		req->map[i].coll_idx = i;
+		req->map[i].status = LOOKUP_HIT;
+		line_valid[i] = true;
+		line_dirty[i] = true;
+	}
+
+	writes_count = 0;
+
+	return req;
+}
+
+static void teardown_req(struct ocf_request *req)
+{
+	test_free(req->cache);
+	test_free(req);
+}
+
+static void check_write(uint32_t idx, uint32_t first, uint32_t length)
+{
+	assert_true(idx < writes_count);
+	assert_int_equal(writes[idx].first, first);
+	assert_int_equal(writes[idx].length, length);
+}
+
+static void _ocf_cleaner_fire_core_test01(void **state)
+{
+	struct ocf_request *req = setup_req(8);
+
+	print_test_description("Adjacent fully dirty lines are merged into "
+			"single core write\n");
+
+	expect_function_call(__wrap__ocf_cleaner_core_io_end);
+
+	_ocf_cleaner_fire_core(req);
+
+	assert_int_equal(writes_count, 1);
+	check_write(0, 0, 8);
+
+	teardown_req(req);
+}
+
+static void _ocf_cleaner_fire_core_test02(void **state)
+{
+	struct ocf_request *req = setup_req(8);
+
+	print_test_description("Partially dirty line breaks run and is "
+			"written on its own\n");
+
+	/* Not all sectors valid, line needs per sector writes */
+	line_valid[3] = false;
+
+	expect_function_call(__wrap__ocf_cleaner_core_io_end);
+
+	_ocf_cleaner_fire_core(req);
+
+	assert_int_equal(writes_count, 3);
+	check_write(0, 0, 3);
+	check_write(1, 3, 1);
+	check_write(2, 4, 4);
+
+	teardown_req(req);
+}
+
+static void _ocf_cleaner_fire_core_test03(void **state)
+{
+	struct ocf_request *req = setup_req(8);
+
+	print_test_description("Gap in core lines, other core or non "
+			"contiguous cache lines break run\n");
+
+	/* Core line gap after map[1] */
+	req->map[2].core_line += 10;
+	req->map[3].core_line += 10;
+	req->map[4].core_line += 10;
+	req->map[5].core_line += 10;
+	req->map[6].core_line += 10;
+	req->map[7].core_line += 10;
+	/* Cache lines not contiguous after map[3] */
+	req->map[4].hash += 5;
+	req->map[5].hash += 5;
+	req->map[6].hash += 5;
+	req->map[7].hash += 5;
+	/* Last line belongs to other core */
+	req->map[7].core_id = 1;
+
+	expect_function_call(__wrap__ocf_cleaner_core_io_end);
+
+	_ocf_cleaner_fire_core(req);
+
+	assert_int_equal(writes_count, 4);
+	check_write(0, 0, 2);
+	check_write(1, 2, 2);
+	check_write(2, 4, 3);
+	check_write(3, 7, 1);
+
+	teardown_req(req);
+}
+
+static void _ocf_cleaner_fire_core_test04(void **state)
+{
+	struct ocf_request *req = setup_req(8);
+
+	print_test_description("Invalid and missed entries are skipped and "
+			"break run\n");
+
+	/* Cache read error */
+	req->map[2].invalid = true;
+	req->map[5].status = LOOKUP_MISS;
+
+	expect_function_call(__wrap__ocf_cleaner_core_io_end);
+
+	_ocf_cleaner_fire_core(req);
+
+	assert_int_equal(writes_count, 3);
+	check_write(0, 0, 2);
+	check_write(1, 3, 2);
+	check_write(2, 6, 2);
+
+	teardown_req(req);
+}
+
+static void _ocf_cleaner_fire_core_test05(void **state)
+{
+	struct ocf_request *req = setup_req(1);
+
+	print_test_description("Single line is submitted without run\n");
+
+	expect_function_call(__wrap__ocf_cleaner_core_io_end);
+
+	_ocf_cleaner_fire_core(req);
+
+	assert_int_equal(writes_count, 1);
+	check_write(0, 0, 1);
+
+	teardown_req(req);
+
+	req = setup_req(3);
+
+	/* Not fully dirty line in between is left to per sector writes */
+	line_dirty[1] = false;
+	line_valid[1] = false;
+
+	expect_function_call(__wrap__ocf_cleaner_core_io_end);
+
+	_ocf_cleaner_fire_core(req);
+
+	assert_int_equal(writes_count, 3);
+	check_write(0, 0, 1);
+	check_write(1, 1, 1);
+	check_write(2, 2, 1);
+
+	teardown_req(req);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(_ocf_cleaner_fire_core_test01),
+		cmocka_unit_test(_ocf_cleaner_fire_core_test02),
+		cmocka_unit_test(_ocf_cleaner_fire_core_test03),
+		cmocka_unit_test(_ocf_cleaner_fire_core_test04),
+		cmocka_unit_test(_ocf_cleaner_fire_core_test05)
+	};
+
+	print_message("Unit test for _ocf_cleaner_fire_core\n");
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,150 @@
+/*
+ * <tested_file_path>src/utils/utils_cleaner.c</tested_file_path>
+ * <tested_function>ocf_cleaner_sort_sectors</tested_function>
+ * <functions_to_leave>
+ *	_ocf_cleaner_cmp
+ *	_ocf_cleaner_swap
+ *	_ocf_cleaner_radix_digit
+ *	_ocf_cleaner_radix_sort
+ * </functions_to_leave>
+ */
+
+#undef static
+
+#undef inline
+
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include "print_desc.h"
+
+#include "ocf/ocf.h"
+#include "../ocf_cache_priv.h"
+#include "utils_cleaner.h"
+
+#include "utils/utils_cleaner.c/ocf_cleaner_sort_sectors_generated_wraps.c"
+
+#define ENTRIES 1000
+
+static uint64_t seed;
+
+static uint64_t next_random(void)
+{
+	seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+	return seed >> 16;
+}
+
+static void check_sorted_as_env_sort(struct flush_data *tbl, uint32_t num)
+{
+	struct flush_data *ref = test_malloc(sizeof(*tbl) * num);
+	uint32_t i;
+
+	memcpy(ref, tbl, sizeof(*tbl) * num);
+
+	ocf_cleaner_sort_sectors(tbl, num);
+	env_sort(ref, num, sizeof(*ref), _ocf_cleaner_cmp, _ocf_cleaner_swap);
+
+	for (i = 0; i < num; i++) {
+		assert_int_equal(tbl[i].core_id, ref[i].core_id);
+		assert_int_equal(tbl[i].core_line, ref[i].core_line);
+	}
+
+	test_free(ref);
+}
+
+static void ocf_cleaner_sort_sectors_test01(void **state)
+{
+	struct flush_data *tbl = test_malloc(sizeof(*tbl) * ENTRIES);
+	uint32_t i;
+
+	print_test_description("Radix sort orders entries by core id and "
+			"core line like env_sort\n");
+
+	seed = 1;
+	for (i = 0; i < ENTRIES; i++) {
+		tbl[i].core_id = next_random() % 4;
+		tbl[i].core_line = next_random();
+		tbl[i].cache_line = i;
+	}
+
+	check_sorted_as_env_sort(tbl, ENTRIES);
+
+	/* Small range of lines with duplicates across cores */
+	for (i = 0; i < ENTRIES; i++) {
+		tbl[i].core_id = next_random() % 3;
+		tbl[i].core_line = next_random() % 300;
+		tbl[i].cache_line = i;
+	}
+
+	check_sorted_as_env_sort(tbl, ENTRIES);
+
+	test_free(tbl);
+}
+
+static void ocf_cleaner_sort_sectors_test02(void **state)
+{
+	struct flush_data *tbl = test_malloc(sizeof(*tbl) * ENTRIES);
+	uint32_t i, shift;
+
+	print_test_description("Passes with single digit value are skipped "
+			"without breaking order or stability\n");
+
+	/* Keys differ in single byte only, all other passes are skipped */
+	for (shift = 0; shift < 64; shift += 8) {
+		for (i = 0; i < ENTRIES; i++) {
+			tbl[i].core_id = 1;
+			tbl[i].core_line = 0x5a5a5a5a5a5a5a5aULL ^
+					((uint64_t)(ENTRIES - i) % 7 << shift);
+			tbl[i].cache_line = i;
+		}
+
+		check_sorted_as_env_sort(tbl, ENTRIES);
+
+		/* Radix sort is stable, equal keys keep insertion order */
+		for (i = 1; i < ENTRIES; i++) {
+			if (tbl[i].core_line == tbl[i - 1].core_line) {
+				assert_true(tbl[i].cache_line >
+						tbl[i - 1].cache_line);
+			}
+		}
+	}
+
+	/* Only core id differs */
+	for (i = 0; i < ENTRIES; i++) {
+		tbl[i].core_id = (ENTRIES - i) % 5;
+		tbl[i].core_line = 42;
+		tbl[i].cache_line = i;
+	}
+
+	check_sorted_as_env_sort(tbl, ENTRIES);
+
+	/* Single and already sorted tables */
+	ocf_cleaner_sort_sectors(tbl, 1);
+	assert_int_equal(tbl[0].core_id, 0);
+
+	for (i = 0; i < ENTRIES; i++) {
+		tbl[i].core_id = 0;
+		tbl[i].core_line = i;
+		tbl[i].cache_line = i;
+	}
+
+	ocf_cleaner_sort_sectors(tbl, ENTRIES);
+	for (i = 0; i < ENTRIES; i++)
+		assert_int_equal(tbl[i].cache_line, i);
+
+	test_free(tbl);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(ocf_cleaner_sort_sectors_test01),
+		cmocka_unit_test(ocf_cleaner_sort_sectors_test02)
+	};
+
+	print_message("Unit test for ocf_cleaner_sort_sectors\n");
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,155 @@
+/*
+ * <tested_file_path>src/utils/utils_dirty_index.c</tested_file_path>
+ * <tested_function>ocf_dirty_index_next</tested_function>
+ * <functions_to_leave>
+ *	ocf_dirty_index_init
+ *	ocf_dirty_index_deinit
+ *	ocf_dirty_index_next_word
+ * </functions_to_leave>
+ */
+
+#undef static
+
+#undef inline
+
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include "print_desc.h"
+
+#include "ocf/ocf.h"
+#include "../ocf_cache_priv.h"
+#include "../metadata/metadata.h"
+#include "utils_dirty_index.h"
+
+#include "utils/utils_dirty_index.c/ocf_dirty_index_next_generated_wraps.c"
+
+#define WORD_BITS (8 * sizeof(unsigned long))
+
+/* Three summary words, last one partially used */
+#define ENTRIES (2 * WORD_BITS * WORD_BITS + 100)
+
+static ocf_cache_t setup_cache(void)
+{
+	ocf_cache_t cache = test_calloc(1, sizeof(*cache));
+
+	cache->device = test_calloc(1, sizeof(*cache->device));
+	cache->device->collision_table_entries = ENTRIES;
+
+	assert_int_equal(ocf_dirty_index_init(cache), 0);
+
+	return cache;
+}
+
+static void teardown_cache(ocf_cache_t cache)
+{
+	ocf_dirty_index_deinit(cache);
+	test_free(cache->device);
+	test_free(cache);
+}
+
+static void ocf_dirty_index_next_test01(void **state)
+{
+	ocf_cache_t cache = setup_cache();
+	ocf_cache_line_t lines[] = { 0, 1, WORD_BITS - 1, WORD_BITS,
+			5 * WORD_BITS + 3, WORD_BITS * WORD_BITS - 1,
+			WORD_BITS * WORD_BITS, 2 * WORD_BITS * WORD_BITS + 1,
+			ENTRIES - 1 };
+	ocf_cache_line_t line;
+	unsigned i;
+
+	print_test_description("Marked lines are enumerated in order across "
+			"summary words\n");
+
+	assert_int_equal(ocf_dirty_index_next(cache, 0), ENTRIES);
+
+	for (i = ARRAY_SIZE(lines); i > 0; i--)
+		ocf_dirty_index_mark(cache, lines[i - 1]);
+
+	for (i = 0, line = ocf_dirty_index_next(cache, 0); line < ENTRIES;
+			i++, line = ocf_dirty_index_next(cache, line + 1)) {
+		assert_true(i < ARRAY_SIZE(lines));
+		assert_int_equal(line, lines[i]);
+	}
+	assert_int_equal(i, ARRAY_SIZE(lines));
+
+	/* Search starting in the middle of word */
+	assert_int_equal(ocf_dirty_index_next(cache, 2), WORD_BITS - 1);
+	assert_int_equal(ocf_dirty_index_next(cache, WORD_BITS + 1),
+			5 * WORD_BITS + 3);
+	assert_int_equal(ocf_dirty_index_next(cache, ENTRIES), ENTRIES);
+
+	teardown_cache(cache);
+}
+
+static void ocf_dirty_index_next_test02(void **state)
+{
+	ocf_cache_t cache = setup_cache();
+	struct ocf_dirty_index *index;
+	uint64_t word = WORD_BITS + 7;
+	ocf_cache_line_t line = word * WORD_BITS + 9;
+
+	print_test_description("Summary bit of cleaned word is cleared "
+			"lazily by search\n");
+
+	index = cache->device->dirty_index;
+
+	ocf_dirty_index_mark(cache, line);
+	ocf_dirty_index_mark(cache, ENTRIES - 1);
+	assert_true(env_bit_test(word, index->summary));
+
+	/* Unmark leaves summary bit set */
+	ocf_dirty_index_unmark(cache, line);
+	assert_true(env_bit_test(word, index->summary));
+
+	/* Search through the word clears it */
+	assert_int_equal(ocf_dirty_index_next(cache, 0), ENTRIES - 1);
+	assert_false(env_bit_test(word, index->summary));
+	assert_true(env_bit_test((ENTRIES - 1) / WORD_BITS, index->summary));
+
+	teardown_cache(cache);
+}
+
+static void ocf_dirty_index_next_test03(void **state)
+{
+	ocf_cache_t cache = setup_cache();
+	struct ocf_dirty_index *index;
+	ocf_cache_line_t line = 3 * WORD_BITS + 1;
+
+	print_test_description("Line marked after its summary bit was "
+			"cleared is found\n");
+
+	index = cache->device->dirty_index;
+
+	ocf_dirty_index_mark(cache, line);
+	ocf_dirty_index_unmark(cache, line);
+	assert_int_equal(ocf_dirty_index_next(cache, 0), ENTRIES);
+	assert_false(env_bit_test(line / WORD_BITS, index->summary));
+
+	/* Other line of the same word */
+	ocf_dirty_index_mark(cache, line + 5);
+	assert_true(env_bit_test(line / WORD_BITS, index->summary));
+	assert_int_equal(ocf_dirty_index_next(cache, 0), line + 5);
+
+	ocf_dirty_index_mark(cache, line);
+	assert_int_equal(ocf_dirty_index_next(cache, 0), line);
+	assert_int_equal(ocf_dirty_index_next(cache, line + 1), line + 5);
+	assert_int_equal(ocf_dirty_index_next(cache, line + 6), ENTRIES);
+
+	teardown_cache(cache);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(ocf_dirty_index_next_test01),
+		cmocka_unit_test(ocf_dirty_index_next_test02),
+		cmocka_unit_test(ocf_dirty_index_next_test03)
+	};
+
+	print_message("Unit test for ocf_dirty_index_next\n");
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,121 @@
+/*
+ * <tested_file_path>src/utils/utils_freq_sketch.c</tested_file_path>
+ * <tested_function>ocf_freq_sketch_record</tested_function>
+ * <functions_to_leave>
+ *	freq_sketch_width
+ *	ocf_freq_sketch_sizeof
+ *	ocf_freq_sketch_create
+ *	ocf_freq_sketch_destroy
+ *	freq_sketch_index
+ *	freq_sketch_counter_get
+ *	freq_sketch_counter_inc
+ *	freq_sketch_doorkeeper_bit
+ *	freq_sketch_doorkeeper_test
+ *	freq_sketch_doorkeeper_set
+ *	freq_sketch_reset
+ *	ocf_freq_sketch_estimate
+ * </functions_to_leave>
+ */
+
+#undef static
+
+#undef inline
+
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include "print_desc.h"
+
+#include "utils_freq_sketch.h"
+
+#include "utils/utils_freq_sketch.c/ocf_freq_sketch_record_generated_wraps.c"
+
+#define ENTRIES 1024
+
+static void ocf_freq_sketch_record_test01(void **state)
+{
+	struct ocf_freq_sketch *sketch = ocf_freq_sketch_create(ENTRIES);
+	uint64_t hash = ocf_freq_sketch_hash(0, 1);
+	uint32_t i;
+
+	print_test_description("First access only sets doorkeeper, next "
+			"ones count up to maximum\n");
+
+	assert_non_null(sketch);
+	assert_int_equal(ocf_freq_sketch_estimate(sketch, hash), 0);
+
+	ocf_freq_sketch_record(sketch, hash);
+	assert_int_equal(ocf_freq_sketch_estimate(sketch, hash), 1);
+	assert_int_equal(freq_sketch_counter_get(sketch->rows[0],
+			freq_sketch_index(sketch, hash, 0)), 0);
+
+	for (i = 2; i <= OCF_FREQ_SKETCH_MAX; i++) {
+		ocf_freq_sketch_record(sketch, hash);
+		assert_int_equal(ocf_freq_sketch_estimate(sketch, hash), i);
+	}
+
+	/* Counters saturate */
+	ocf_freq_sketch_record(sketch, hash);
+	assert_int_equal(ocf_freq_sketch_estimate(sketch, hash),
+			OCF_FREQ_SKETCH_MAX);
+
+	/* Other keys are not affected */
+	assert_int_equal(ocf_freq_sketch_estimate(sketch,
+			ocf_freq_sketch_hash(0, 2)), 0);
+	assert_int_equal(ocf_freq_sketch_estimate(sketch,
+			ocf_freq_sketch_hash(1, 1)), 0);
+
+	ocf_freq_sketch_destroy(sketch);
+}
+
+static void ocf_freq_sketch_record_test02(void **state)
+{
+	struct ocf_freq_sketch *sketch = ocf_freq_sketch_create(ENTRIES);
+	uint64_t hash = ocf_freq_sketch_hash(0, 1);
+	uint64_t other = ocf_freq_sketch_hash(0, 2);
+	uint64_t i;
+
+	print_test_description("Counters are halved and doorkeeper cleared "
+			"after sample size accesses\n");
+
+	assert_int_equal(sketch->sample_size, 10 * ENTRIES);
+
+	/* Doorkeeper plus 7 in counters */
+	for (i = 0; i < 8; i++)
+		ocf_freq_sketch_record(sketch, hash);
+	assert_int_equal(ocf_freq_sketch_estimate(sketch, hash), 8);
+
+	for (i = 8; i < sketch->sample_size - 1; i++)
+		ocf_freq_sketch_record(sketch, other);
+	assert_int_equal(ocf_freq_sketch_estimate(sketch, hash), 8);
+	assert_int_equal(ocf_freq_sketch_estimate(sketch, other),
+			OCF_FREQ_SKETCH_MAX);
+
+	/* Access number sample_size halves the sketch */
+	ocf_freq_sketch_record(sketch, other);
+	assert_int_equal(ocf_freq_sketch_estimate(sketch, hash), 3);
+	assert_int_equal(ocf_freq_sketch_estimate(sketch, other), 7);
+	assert_int_equal(env_atomic64_read(&sketch->additions), 0);
+
+	/* Doorkeeper was cleared, next access sets it again */
+	ocf_freq_sketch_record(sketch, hash);
+	assert_int_equal(ocf_freq_sketch_estimate(sketch, hash), 4);
+	ocf_freq_sketch_record(sketch, hash);
+	assert_int_equal(ocf_freq_sketch_estimate(sketch, hash), 5);
+
+	ocf_freq_sketch_destroy(sketch);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(ocf_freq_sketch_record_test01),
+		cmocka_unit_test(ocf_freq_sketch_record_test02)
+	};
+
+	print_message("Unit test for ocf_freq_sketch_record\n");
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}